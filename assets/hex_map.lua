@@ -0,0 +1,23 @@
+-- 100x100 hex map in a handful of C calls: intern once, build positions in Lua,
+-- stamp them out with one spawn_many. Run from the console with: lua assets/hex_map.lua
+local tile = model_id("pickup1")
+if not tile then
+  console_print("hex_map: load setup.lua first (needs the pickup1 model)")
+  return
+end
+
+local size = 0.6 -- hex radius, pointy-top layout
+local w = math.sqrt(3) * size
+local positions = {}
+local n = 0
+for r = 0, 99 do
+  for q = 0, 99 do
+    positions[n + 1] = w * (q + r * 0.5) - 75
+    positions[n + 2] = -1
+    positions[n + 3] = 1.5 * size * r - 45
+    n = n + 3
+  end
+end
+
+local tiles = spawn_many(tile, positions, {}, 0.5)
+console_print("hex_map: spawned " .. #tiles .. " tiles")
@@ -117,16 +117,22 @@ class HOTLOAD_OT_export(bpy.types.Operator):
         else:
             use_selection = False
 
-        # Export GLB
+        # Export GLB to a temp file, then rename over the target so the
+        # viewer never sees a half-written file
+        root, ext = os.path.splitext(export_path)
+        temp_path = root + ".exporting" + ext
         try:
             bpy.ops.export_scene.gltf(
-                filepath=export_path,
+                filepath=temp_path,
                 use_selection=use_selection,
                 export_format='GLB',
                 export_apply=props.apply_modifiers,
             )
+            os.replace(temp_path, export_path)
             self.report({'INFO'}, f"Exported to {export_path}")
         except Exception as e:
+            if os.path.exists(temp_path):
+                os.remove(temp_path)
             self.report({'ERROR'}, f"Export failed: {e}")
             return {'CANCELLED'}
 
@@ -1,5 +1,6 @@
 #!/bin/bash
-# Regenerate embedded_assets.hpp from all files in assets/
+# Rebuild build/assets.pack from every AssetId in src/mylibs/uid_assets.hpp
+# (pass --raw to keep images as PNG bytes instead of decoded pixels)
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 cd "$SCRIPT_DIR"
@@ -10,14 +11,10 @@ if [ ! -f build/embed_binary ]; then
   cmake --build build --target embed_binary
 fi
 
-# Find all files in assets/
-ASSETS=(assets/*)
-
-if [ ${#ASSETS[@]} -eq 0 ] || [ ! -e "${ASSETS[0]}" ]; then
-  echo "No assets found in assets/ directory"
-  echo "Add files to assets/ and run this script again"
-  exit 0
+DECODE=--decode
+if [ "$1" == "--raw" ]; then
+  DECODE=
 fi
 
-echo "Embedding ${#ASSETS[@]} asset(s)..."
-./build/embed_binary src/mylibs/embedded_assets.hpp "${ASSETS[@]}"
+echo "Packing assets..."
+./build/embed_binary $DECODE build/assets.pack
@@ -0,0 +1,745 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="aabb tree*"
+exit
+#endif
+/**
+ * @file aabb_tree.hpp
+ * @brief Dynamic AABB tree (BVH) for ray picking, frustum / box queries and pair finding
+ *
+ * Leaves keep the exact box plus a "fat" copy grown by `margin`; internal
+ * nodes bound the fat boxes. move() only touches the tree when a box leaves
+ * its fat box, so objects jittering in place cost one containment test.
+ * Inserts pick the sibling with the cheapest surface-area growth and
+ * rotations keep the tree balanced (as in Box2D's b2DynamicTree).
+ *
+ * Proxy ids are node indices and stay valid until remove(), including
+ * across rebuild(), which re-derives all internal nodes top-down (use it
+ * after laying out many boxes at once).
+ *
+ * Each leaf carries a layer mask; queries skip leaves that don't share a
+ * bit with the mask they are given (e.g. PICKABLE vs COLLIDABLE).
+ *
+ * Usage:
+ *   AabbTree<thing_ref> tree;
+ *   int proxy = tree.insert(box, ref);
+ *   tree.move(proxy, new_box);            // every frame, cheap when it barely moved
+ *   auto hit = tree.ray_closest(ray);     // hit.proxy == AabbTree<>::NONE on a miss
+ *   tree.query(camera_frustum(cam, aspect), [&](thing_ref& ref, int proxy) { ... });
+ */
+
+#pragma once
+#include "job_system.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <raylib.h>
+#include <raymath.h>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Frustum
+// ============================================================================
+
+/// Six planes (a, b, c, d) with a*x + b*y + c*z + d >= 0 on the inside
+struct Frustum {
+  Vector4 planes[6];
+};
+
+/// @brief Planes of a clip-space volume, from MatrixMultiply(view, projection).
+inline Frustum frustum_from_matrix(Matrix m) {
+  Frustum f;
+  f.planes[0] = {m.m3 + m.m0, m.m7 + m.m4, m.m11 + m.m8, m.m15 + m.m12};  // left
+  f.planes[1] = {m.m3 - m.m0, m.m7 - m.m4, m.m11 - m.m8, m.m15 - m.m12};  // right
+  f.planes[2] = {m.m3 + m.m1, m.m7 + m.m5, m.m11 + m.m9, m.m15 + m.m13};  // bottom
+  f.planes[3] = {m.m3 - m.m1, m.m7 - m.m5, m.m11 - m.m9, m.m15 - m.m13};  // top
+  f.planes[4] = {m.m3 + m.m2, m.m7 + m.m6, m.m11 + m.m10, m.m15 + m.m14}; // near
+  f.planes[5] = {m.m3 - m.m2, m.m7 - m.m6, m.m11 - m.m10, m.m15 - m.m14}; // far
+  return f;
+}
+
+/**
+ * @brief View frustum of a perspective Camera3D, matching BeginMode3D's projection.
+ * @param aspect Viewport width / height
+ */
+inline Frustum camera_frustum(const Camera3D& cam, float aspect, float near_plane = 0.01f,
+                              float far_plane = 1000.0f) {
+  Matrix view = MatrixLookAt(cam.position, cam.target, cam.up);
+  Matrix proj = MatrixPerspective(cam.fovy * DEG2RAD, aspect, near_plane, far_plane);
+  return frustum_from_matrix(MatrixMultiply(view, proj));
+}
+
+/// @brief False only if the box is entirely outside one plane (may keep a few near corners).
+inline bool frustum_overlaps(const Frustum& f, const BoundingBox& b) {
+  for (const Vector4& p : f.planes) {
+    // The box corner furthest along the plane normal
+    float x = p.x >= 0 ? b.max.x : b.min.x;
+    float y = p.y >= 0 ? b.max.y : b.min.y;
+    float z = p.z >= 0 ? b.max.z : b.min.z;
+    if (p.x * x + p.y * y + p.z * z + p.w < 0)
+      return false;
+  }
+  return true;
+}
+
+// ============================================================================
+// AabbTree
+// ============================================================================
+
+template <typename User = int> struct AabbTree {
+  static constexpr int NONE = -1;
+  static constexpr int MAX_DEPTH = 128; ///< Traversal stack size; balanced trees stay far below
+  static constexpr uint32_t ALL_LAYERS = ~0u;
+
+  struct Node {
+    BoundingBox box;   ///< Fat box for leaves, union of children otherwise
+    BoundingBox tight; ///< Leaves: the box as given to insert / move
+    User user{};
+    int parent = NONE; ///< Next free node while on the free list
+    int left = NONE;
+    int right = NONE;
+    int height = -1; ///< 0 for leaves, -1 while free
+    uint32_t layers = ALL_LAYERS;
+
+    bool leaf() const { return left == NONE; }
+  };
+
+  struct Hit {
+    int proxy = NONE;
+    float distance = FLT_MAX;
+  };
+
+  using ProxyPair = std::pair<int, int>;
+
+  std::vector<Node> nodes;
+  int root = NONE;
+  float margin = 0.1f;        ///< Fat box padding on each side
+  size_t candidate_count = 0; ///< Leaf box tests done by the last overlapping_pairs()
+
+  /// @brief Drop every proxy, keeping node capacity.
+  void clear() {
+    nodes.clear();
+    root = NONE;
+    free_list = NONE;
+    leaves = 0;
+  }
+
+  size_t size() const { return leaves; }
+
+  /// @brief Add a box. @return Proxy id, valid until remove().
+  int insert(BoundingBox box, User user, uint32_t layers = ALL_LAYERS) {
+    int leaf = alloc_node();
+    Node& n = nodes[leaf];
+    n.tight = box;
+    n.box = fatten(box);
+    n.user = user;
+    n.height = 0;
+    n.layers = layers;
+    insert_leaf(leaf);
+    leaves++;
+    return leaf;
+  }
+
+  void remove(int proxy) {
+    assert(is_leaf(proxy));
+    remove_leaf(proxy);
+    free_node(proxy);
+    leaves--;
+  }
+
+  /**
+   * @brief Update a proxy's box.
+   * @return True if it left its fat box and was reinserted.
+   */
+  bool move(int proxy, BoundingBox box) {
+    assert(is_leaf(proxy));
+    nodes[proxy].tight = box;
+    if (contains(nodes[proxy].box, box))
+      return false;
+    remove_leaf(proxy);
+    nodes[proxy].box = fatten(box);
+    insert_leaf(proxy);
+    return true;
+  }
+
+  void set_layers(int proxy, uint32_t layers) { nodes[proxy].layers = layers; }
+  User& user(int proxy) { return nodes[proxy].user; }
+  const BoundingBox& box(int proxy) const { return nodes[proxy].tight; }
+  int height() const { return root == NONE ? 0 : nodes[root].height; }
+
+  /**
+   * @brief Rebuild every internal node top-down (median split on the widest axis).
+   * Proxy ids are kept; call after a bulk layout for a tighter tree than inserts give.
+   */
+  void rebuild() {
+    std::vector<int> leaf_ids;
+    leaf_ids.reserve(leaves);
+    for (int i = 0; i < (int)nodes.size(); i++) {
+      if (nodes[i].height < 0)
+        continue;
+      if (nodes[i].leaf()) {
+        nodes[i].box = fatten(nodes[i].tight);
+        leaf_ids.push_back(i);
+      } else {
+        free_node(i);
+      }
+    }
+    root = build(leaf_ids, 0, (int)leaf_ids.size());
+    if (root != NONE)
+      nodes[root].parent = NONE;
+  }
+
+  // ---- queries ----
+
+  /// @brief fn(user, proxy) for every leaf whose box overlaps `box`.
+  template <typename Fn> void query(const BoundingBox& box, Fn&& fn, uint32_t layers = ALL_LAYERS) {
+    traverse([&](const Node& n) { return overlaps(n.box, box); },
+             [&](int leaf) {
+               if (overlaps(nodes[leaf].tight, box))
+                 fn(nodes[leaf].user, leaf);
+             },
+             layers);
+  }
+
+  /// @brief fn(user, proxy) for every leaf that may be inside the frustum.
+  template <typename Fn> void query(const Frustum& f, Fn&& fn, uint32_t layers = ALL_LAYERS) {
+    traverse([&](const Node& n) { return frustum_overlaps(f, n.box); },
+             [&](int leaf) {
+               if (frustum_overlaps(f, nodes[leaf].tight))
+                 fn(nodes[leaf].user, leaf);
+             },
+             layers);
+  }
+
+  /// @brief fn(user, proxy, distance) for every leaf the ray hits, in no particular order.
+  template <typename Fn> void raycast(Ray ray, Fn&& fn, uint32_t layers = ALL_LAYERS) {
+    Vector3 inv = inverse(ray.direction);
+    float scale = Vector3Length(ray.direction);
+    traverse([&](const Node& n) { return ray_enter(ray.position, inv, n.box, FLT_MAX) >= 0; },
+             [&](int leaf) {
+               float t = ray_enter(ray.position, inv, nodes[leaf].tight, FLT_MAX);
+               if (t >= 0)
+                 fn(nodes[leaf].user, leaf, t * scale);
+             },
+             layers);
+  }
+
+  /// @brief Nearest leaf the ray hits; skips subtrees further than the best hit so far.
+  Hit ray_closest(Ray ray, uint32_t layers = ALL_LAYERS) const {
+    Hit best;
+    if (root == NONE)
+      return best;
+    Vector3 inv = inverse(ray.direction);
+    float best_t = FLT_MAX;
+    int stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+      const Node& n = nodes[stack[--top]];
+      if (ray_enter(ray.position, inv, n.box, best_t) < 0)
+        continue;
+      if (n.leaf()) {
+        float t = (n.layers & layers) ? ray_enter(ray.position, inv, n.tight, best_t) : -1;
+        if (t >= 0) {
+          best_t = t;
+          best.proxy = (int)(&n - nodes.data());
+        }
+        continue;
+      }
+      assert(top + 2 <= MAX_DEPTH);
+      stack[top++] = n.left;
+      stack[top++] = n.right;
+    }
+    if (best.proxy != NONE)
+      best.distance = best_t * Vector3Length(ray.direction);
+    return best;
+  }
+
+  /**
+   * @brief Every pair of overlapping leaves (by exact box) that both match `layers`.
+   * @return Proxy pairs with first < second, sorted.
+   */
+  const std::vector<ProxyPair>& overlapping_pairs(uint32_t layers = ALL_LAYERS) {
+    pairs.clear();
+    candidate_count = 0;
+    for (int i = 0; i < (int)nodes.size(); i++)
+      if (is_leaf(i) && (nodes[i].layers & layers))
+        candidate_count += pairs_of(i, layers, pairs);
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  }
+
+  /// @brief overlapping_pairs() with leaves split across the job system; same result.
+  const std::vector<ProxyPair>& overlapping_pairs(JobSystem& jobs,
+                                                  uint32_t layers = ALL_LAYERS) {
+    pairs.clear();
+    thread_pairs.resize((size_t)jobs.thread_count());
+    thread_candidates.assign((size_t)jobs.thread_count(), 0);
+    for (auto& tp : thread_pairs)
+      tp.clear();
+    jobs.parallel_for(0, (int)nodes.size(), 128, [&](int lo, int hi, int thread) {
+      for (int i = lo; i < hi; i++)
+        if (is_leaf(i) && (nodes[i].layers & layers))
+          thread_candidates[thread] += pairs_of(i, layers, thread_pairs[thread]);
+    });
+    candidate_count = 0;
+    for (size_t t = 0; t < thread_pairs.size(); t++) {
+      pairs.insert(pairs.end(), thread_pairs[t].begin(), thread_pairs[t].end());
+      candidate_count += thread_candidates[t];
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  }
+
+  /// @brief Check parent links, heights and that every node bounds its children (for tests).
+  bool validate() const {
+    size_t found = 0;
+    return root == NONE ? leaves == 0 : validate_node(root, NONE, found) && found == leaves;
+  }
+
+private:
+  int free_list = NONE;
+  size_t leaves = 0;
+  std::vector<ProxyPair> pairs;
+  std::vector<std::vector<ProxyPair>> thread_pairs;
+  std::vector<size_t> thread_candidates;
+
+  bool is_leaf(int i) const {
+    return i >= 0 && i < (int)nodes.size() && nodes[i].height == 0 && nodes[i].leaf();
+  }
+
+  int alloc_node() {
+    if (free_list == NONE) {
+      nodes.push_back({});
+      return (int)nodes.size() - 1;
+    }
+    int i = free_list;
+    free_list = nodes[i].parent;
+    nodes[i] = Node{};
+    return i;
+  }
+
+  void free_node(int i) {
+    nodes[i].height = -1;
+    nodes[i].left = nodes[i].right = NONE;
+    nodes[i].parent = free_list;
+    free_list = i;
+  }
+
+  BoundingBox fatten(BoundingBox b) const {
+    Vector3 m = {margin, margin, margin};
+    return {Vector3Subtract(b.min, m), Vector3Add(b.max, m)};
+  }
+
+  static BoundingBox merge(const BoundingBox& a, const BoundingBox& b) {
+    return {Vector3Min(a.min, b.min), Vector3Max(a.max, b.max)};
+  }
+
+  static float area(const BoundingBox& b) {
+    Vector3 d = Vector3Subtract(b.max, b.min);
+    return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+
+  static bool contains(const BoundingBox& outer, const BoundingBox& inner) {
+    return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y &&
+           outer.min.z <= inner.min.z && inner.max.x <= outer.max.x &&
+           inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+  }
+
+  static bool overlaps(const BoundingBox& a, const BoundingBox& b) {
+    return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+           b.min.y <= a.max.y && a.min.z <= b.max.z && b.min.z <= a.max.z;
+  }
+
+  static Vector3 inverse(Vector3 d) {
+    return {d.x != 0 ? 1.0f / d.x : FLT_MAX, d.y != 0 ? 1.0f / d.y : FLT_MAX,
+            d.z != 0 ? 1.0f / d.z : FLT_MAX};
+  }
+
+  /// Slab test: ray parameter where it enters the box (0 if it starts inside), or -1.
+  static float ray_enter(Vector3 o, Vector3 inv, const BoundingBox& b, float max_t) {
+    float t0 = 0.0f, t1 = max_t;
+    const float os[3] = {o.x, o.y, o.z};
+    const float is[3] = {inv.x, inv.y, inv.z};
+    const float lo[3] = {b.min.x, b.min.y, b.min.z};
+    const float hi[3] = {b.max.x, b.max.y, b.max.z};
+    for (int a = 0; a < 3; a++) {
+      float ta = (lo[a] - os[a]) * is[a];
+      float tb = (hi[a] - os[a]) * is[a];
+      if (ta > tb)
+        std::swap(ta, tb);
+      // Parallel to the slab: inside it or never
+      if (is[a] == FLT_MAX && (os[a] < lo[a] || os[a] > hi[a]))
+        return -1;
+      if (is[a] != FLT_MAX) {
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+      }
+      if (t0 > t1)
+        return -1;
+    }
+    return t0;
+  }
+
+  /// Depth-first walk; enter(node) decides whether to descend, visit(leaf) sees matching leaves.
+  template <typename Enter, typename Visit>
+  void traverse(Enter&& enter, Visit&& visit, uint32_t layers) const {
+    if (root == NONE)
+      return;
+    int stack[MAX_DEPTH];
+    int top = 0;
+    stack[top++] = root;
+    while (top > 0) {
+      int i = stack[--top];
+      const Node& n = nodes[i];
+      if (!enter(n))
+        continue;
+      if (n.leaf()) {
+        if (n.layers & layers)
+          visit(i);
+        continue;
+      }
+      assert(top + 2 <= MAX_DEPTH);
+      stack[top++] = n.left;
+      stack[top++] = n.right;
+    }
+  }
+
+  /// Leaves after `leaf` (by id) overlapping it; each pair is found once, from its lower id.
+  size_t pairs_of(int leaf, uint32_t layers, std::vector<ProxyPair>& out) const {
+    size_t candidates = 0;
+    const BoundingBox& box = nodes[leaf].tight;
+    traverse([&](const Node& n) { return overlaps(n.box, box); },
+             [&](int other) {
+               if (other <= leaf)
+                 return;
+               candidates++;
+               if (overlaps(nodes[other].tight, box))
+                 out.push_back({leaf, other});
+             },
+             layers);
+    return candidates;
+  }
+
+  void insert_leaf(int leaf) {
+    if (root == NONE) {
+      root = leaf;
+      nodes[leaf].parent = NONE;
+      return;
+    }
+
+    // Walk down to the sibling whose merge grows the total surface area least
+    BoundingBox box = nodes[leaf].box;
+    int i = root;
+    while (!nodes[i].leaf()) {
+      const Node& n = nodes[i];
+      float node_area = area(n.box);
+      float merged_area = area(merge(n.box, box));
+      float cost_here = 2.0f * merged_area;            // new parent of this node and the leaf
+      float inherited = 2.0f * (merged_area - node_area); // growth pushed onto the ancestors
+      auto descend_cost = [&](int c) {
+        const Node& child = nodes[c];
+        float grown = area(merge(box, child.box));
+        return (child.leaf() ? grown : grown - area(child.box)) + inherited;
+      };
+      float cost_left = descend_cost(n.left);
+      float cost_right = descend_cost(n.right);
+      if (cost_here < cost_left && cost_here < cost_right)
+        break;
+      i = cost_left < cost_right ? n.left : n.right;
+    }
+
+    int sibling = i;
+    int old_parent = nodes[sibling].parent;
+    int new_parent = alloc_node();
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].box = merge(box, nodes[sibling].box);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].left = sibling;
+    nodes[new_parent].right = leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+    if (old_parent == NONE)
+      root = new_parent;
+    else if (nodes[old_parent].left == sibling)
+      nodes[old_parent].left = new_parent;
+    else
+      nodes[old_parent].right = new_parent;
+
+    refit_from(nodes[leaf].parent);
+  }
+
+  void remove_leaf(int leaf) {
+    if (leaf == root) {
+      root = NONE;
+      return;
+    }
+    int parent = nodes[leaf].parent;
+    int grand = nodes[parent].parent;
+    int sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+    free_node(parent);
+    nodes[leaf].parent = NONE;
+    if (grand == NONE) {
+      root = sibling;
+      nodes[sibling].parent = NONE;
+      return;
+    }
+    if (nodes[grand].left == parent)
+      nodes[grand].left = sibling;
+    else
+      nodes[grand].right = sibling;
+    nodes[sibling].parent = grand;
+    refit_from(grand);
+  }
+
+  /// Rebalance and recompute boxes / heights from `i` up to the root.
+  void refit_from(int i) {
+    while (i != NONE) {
+      i = balance(i);
+      Node& n = nodes[i];
+      n.height = 1 + std::max(nodes[n.left].height, nodes[n.right].height);
+      n.box = merge(nodes[n.left].box, nodes[n.right].box);
+      i = n.parent;
+    }
+  }
+
+  /// Rotate a child of `a` up if its subtrees differ in height by more than one.
+  /// @return The node now at a's position.
+  int balance(int a) {
+    Node& A = nodes[a];
+    if (A.leaf() || A.height < 2)
+      return a;
+    int b = A.left, c = A.right;
+    int diff = nodes[c].height - nodes[b].height;
+    if (diff > 1)
+      return rotate_up(a, c, false);
+    if (diff < -1)
+      return rotate_up(a, b, true);
+    return a;
+  }
+
+  /// Make child `up` (left child if `up_is_left`) the parent of `a`.
+  int rotate_up(int a, int up, bool up_is_left) {
+    Node& A = nodes[a];
+    Node& U = nodes[up];
+    int f = U.left, g = U.right;
+    int other = up_is_left ? A.right : A.left; // a's child that stays
+
+    U.left = a;
+    U.parent = A.parent;
+    A.parent = up;
+    if (U.parent == NONE)
+      root = up;
+    else if (nodes[U.parent].left == a)
+      nodes[U.parent].left = up;
+    else
+      nodes[U.parent].right = up;
+
+    // The taller grandchild stays with `up`, the shorter one moves under `a`
+    int keep = nodes[f].height > nodes[g].height ? f : g;
+    int give = keep == f ? g : f;
+    U.right = keep;
+    if (up_is_left)
+      A.left = give;
+    else
+      A.right = give;
+    nodes[give].parent = a;
+
+    A.box = merge(nodes[other].box, nodes[give].box);
+    A.height = 1 + std::max(nodes[other].height, nodes[give].height);
+    U.box = merge(A.box, nodes[keep].box);
+    U.height = 1 + std::max(A.height, nodes[keep].height);
+    return up;
+  }
+
+  int build(std::vector<int>& ids, int lo, int hi) {
+    if (hi <= lo)
+      return NONE;
+    if (hi - lo == 1)
+      return ids[lo];
+
+    BoundingBox centers = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+    for (int k = lo; k < hi; k++) {
+      Vector3 c = center(nodes[ids[k]].box);
+      centers = merge(centers, {c, c});
+    }
+    Vector3 extent = Vector3Subtract(centers.max, centers.min);
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+    int mid = (lo + hi) / 2;
+    std::nth_element(ids.begin() + lo, ids.begin() + mid, ids.begin() + hi, [&](int x, int y) {
+      Vector3 cx = center(nodes[x].box), cy = center(nodes[y].box);
+      return axis == 0 ? cx.x < cy.x : (axis == 1 ? cx.y < cy.y : cx.z < cy.z);
+    });
+
+    int left = build(ids, lo, mid);
+    int right = build(ids, mid, hi);
+    int n = alloc_node(); // after the recursion: alloc may grow `nodes`
+    nodes[n].left = left;
+    nodes[n].right = right;
+    nodes[n].box = merge(nodes[left].box, nodes[right].box);
+    nodes[n].height = 1 + std::max(nodes[left].height, nodes[right].height);
+    nodes[left].parent = n;
+    nodes[right].parent = n;
+    return n;
+  }
+
+  static Vector3 center(const BoundingBox& b) {
+    return Vector3Scale(Vector3Add(b.min, b.max), 0.5f);
+  }
+
+  bool validate_node(int i, int parent, size_t& found) const {
+    const Node& n = nodes[i];
+    if (n.parent != parent || n.height < 0)
+      return false;
+    if (n.leaf()) {
+      found++;
+      return n.height == 0 && contains(n.box, n.tight);
+    }
+    const Node& l = nodes[n.left];
+    const Node& r = nodes[n.right];
+    return n.height == 1 + std::max(l.height, r.height) && contains(n.box, l.box) &&
+           contains(n.box, r.box) && validate_node(n.left, i, found) &&
+           validate_node(n.right, i, found);
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+static BoundingBox aabb_tree_box(float x, float y, float z, float half = 0.5f) {
+  return {{x - half, y - half, z - half}, {x + half, y + half, z + half}};
+}
+
+TEST_CASE("aabb tree queries match brute force") {
+  AabbTree<int> tree;
+  std::vector<BoundingBox> boxes;
+  std::vector<int> proxies;
+  uint32_t seed = 777;
+  auto rnd = [&](float lo, float hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(seed >> 8) / (float)(1u << 24);
+  };
+  for (int i = 0; i < 500; i++) {
+    boxes.push_back(aabb_tree_box(rnd(-30, 30), rnd(-2, 2), rnd(-30, 30), rnd(0.2f, 1.0f)));
+    proxies.push_back(tree.insert(boxes.back(), i, i % 2 ? 1u : 2u));
+  }
+  REQUIRE(tree.validate());
+  CHECK(tree.size() == 500);
+  CHECK(tree.height() < 24);
+
+  auto check_all = [&] {
+    REQUIRE(tree.validate());
+    // Box query
+    BoundingBox probe = aabb_tree_box(3, 0, -4, 6.0f);
+    std::vector<int> found, expected;
+    tree.query(probe, [&](int& user, int) { found.push_back(user); });
+    for (int i = 0; i < (int)boxes.size(); i++)
+      if (proxies[i] >= 0 && CheckCollisionBoxes(boxes[i], probe))
+        expected.push_back(i);
+    std::sort(found.begin(), found.end());
+    CHECK(found == expected);
+
+    // Ray: closest hit and all hits against a slab test done by hand
+    Ray ray = {{-40, 0.1f, -3}, Vector3Normalize({1, 0, 0.1f})};
+    int hits = 0;
+    tree.raycast(ray, [&](int&, int, float) { hits++; });
+    auto best = tree.ray_closest(ray);
+    int brute_hits = 0, brute_best = -1;
+    float brute_dist = FLT_MAX;
+    for (int i = 0; i < (int)boxes.size(); i++) {
+      if (proxies[i] < 0)
+        continue;
+      const BoundingBox& b = boxes[i];
+      float t0 = 0, t1 = FLT_MAX;
+      float o[3] = {ray.position.x, ray.position.y, ray.position.z};
+      float d[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+      float lo[3] = {b.min.x, b.min.y, b.min.z}, hi[3] = {b.max.x, b.max.y, b.max.z};
+      for (int a = 0; a < 3; a++) {
+        if (d[a] == 0) {
+          if (o[a] < lo[a] || o[a] > hi[a])
+            t0 = FLT_MAX;
+          continue;
+        }
+        float ta = (lo[a] - o[a]) / d[a], tb = (hi[a] - o[a]) / d[a];
+        t0 = std::max(t0, std::min(ta, tb));
+        t1 = std::min(t1, std::max(ta, tb));
+      }
+      if (t0 <= t1) {
+        brute_hits++;
+        if (t0 < brute_dist) {
+          brute_dist = t0;
+          brute_best = i;
+        }
+      }
+    }
+    CHECK(hits == brute_hits);
+    if (brute_best >= 0) {
+      REQUIRE(best.proxy != AabbTree<int>::NONE);
+      CHECK(tree.user(best.proxy) == brute_best);
+      CHECK(best.distance == doctest::Approx(brute_dist));
+    }
+
+    // Pairs, serial and parallel, filtered to layer 1
+    std::vector<std::pair<int, int>> expected_pairs;
+    for (int i = 0; i < (int)boxes.size(); i++)
+      for (int j = i + 1; j < (int)boxes.size(); j++)
+        if (proxies[i] >= 0 && proxies[j] >= 0 && i % 2 && j % 2 &&
+            CheckCollisionBoxes(boxes[i], boxes[j]))
+          expected_pairs.push_back(std::minmax(proxies[i], proxies[j]));
+    std::sort(expected_pairs.begin(), expected_pairs.end());
+    CHECK(tree.overlapping_pairs(1u) == expected_pairs);
+    JobSystem jobs;
+    jobs.start(3);
+    CHECK(tree.overlapping_pairs(jobs, 1u) == expected_pairs);
+  };
+  check_all();
+
+  // Small moves stay inside the fat box; big ones reinsert
+  int reinserted = 0;
+  for (int i = 0; i < (int)boxes.size(); i++) {
+    float step = i % 5 == 0 ? 4.0f : 0.01f;
+    boxes[i].min.x += step;
+    boxes[i].max.x += step;
+    reinserted += tree.move(proxies[i], boxes[i]);
+  }
+  CHECK(reinserted == 100);
+  for (int i = 0; i < (int)boxes.size(); i += 3) {
+    tree.remove(proxies[i]);
+    proxies[i] = -1;
+  }
+  check_all();
+
+  // Rebuild keeps proxies and results
+  tree.rebuild();
+  check_all();
+}
+
+TEST_CASE("aabb tree frustum") {
+  Camera3D cam = {};
+  cam.position = {0, 0, 10};
+  cam.target = {0, 0, 0};
+  cam.up = {0, 1, 0};
+  cam.fovy = 45.0f;
+  Frustum f = camera_frustum(cam, 16.0f / 9.0f);
+  CHECK(frustum_overlaps(f, aabb_tree_box(0, 0, 0)));
+  CHECK_FALSE(frustum_overlaps(f, aabb_tree_box(0, 0, 20)));  // behind the camera
+  CHECK_FALSE(frustum_overlaps(f, aabb_tree_box(40, 0, 0)));  // off to the side
+  CHECK(frustum_overlaps(f, aabb_tree_box(0, 0, -500, 1)));   // far ahead, before far plane
+
+  AabbTree<int> tree;
+  for (int i = 0; i < 50; i++)
+    tree.insert(aabb_tree_box((float)i * 4 - 100, 0, 0), i);
+  std::vector<int> visible;
+  tree.query(f, [&](int& user, int) { visible.push_back(user); });
+  // At z = 0, ten units ahead, the half-width is about 10 * tan(22.5) * 16/9 = 7.4
+  CHECK(!visible.empty());
+  for (int user : visible)
+    CHECK(fabsf((float)user * 4 - 100) < 9.0f);
+}
+
+#endif
@@ -0,0 +1,458 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="archetype store*"
+exit
+#endif
+/**
+ * @file archetype_store.hpp
+ * @brief Archetype-based component storage with thing_ref handles
+ *
+ * Entities with the same set of component types share an archetype: one
+ * contiguous column per component, one row per entity. Systems name the
+ * components they need and only visit the archetypes that have all of them,
+ * so an update loop touches packed arrays of exactly the data it uses.
+ *
+ * Handles are thing_refs (generation-checked, like things_list), so code
+ * that keys side data or ModelAPI buckets by thing_ref keeps working.
+ *
+ * Components must be trivially copyable (rows move with memcpy when an
+ * entity gains or loses a component). Empty structs are tags: they take
+ * part in matching but have no column.
+ *
+ * Usage:
+ *   ArchetypeStore scene;
+ *   thing_ref ref = scene.create(Position{...}, Velocity{...});
+ *   scene.add(ref, Wander{});
+ *   scene.each<Position, Velocity>([&](Position& p, Velocity& v) { ... });
+ *   scene.each<Position, Wander>([&](thing_ref ref, Position& p, Wander&) { ... });
+ *
+ * Pointers from get() and the references handed to each() are valid until
+ * the next structural change (create / destroy / add / remove), which is
+ * not allowed inside each(): collect refs and apply the changes after.
+ */
+
+#pragma once
+#include "ilist.hpp"
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+struct ArchetypeStore {
+  static constexpr int MAX_COMPONENTS = 64;
+  using Mask = uint64_t;
+
+  // ---- component type ids (shared by all stores) ----
+
+  /// Bytes per row for each component id; 0 for tags
+  static std::vector<size_t>& component_sizes() {
+    static std::vector<size_t> sizes;
+    return sizes;
+  }
+
+  /// @brief Stable id for component type C, assigned on first use.
+  template <typename C> static int component_id() {
+    static_assert(std::is_trivially_copyable_v<C>, "components must be trivially copyable");
+    static_assert(alignof(C) <= alignof(std::max_align_t), "over-aligned component");
+    static const int id = [] {
+      auto& sizes = component_sizes();
+      assert(sizes.size() < MAX_COMPONENTS && "Too many component types");
+      sizes.push_back(std::is_empty_v<C> ? 0 : sizeof(C));
+      return (int)sizes.size() - 1;
+    }();
+    return id;
+  }
+
+  template <typename C> static Mask bit() { return Mask(1) << component_id<C>(); }
+  template <typename... Cs> static Mask mask() { return (Mask(0) | ... | bit<Cs>()); }
+
+  // ---- storage ----
+
+  struct Archetype {
+    Mask mask = 0;
+    std::vector<int> ids;                            ///< Components with a column
+    std::vector<size_t> sizes;                       ///< Bytes per row, parallel to ids
+    std::vector<std::vector<unsigned char>> columns; ///< Parallel to ids
+    int8_t column_of[MAX_COMPONENTS];                ///< Component id -> column, -1 if none
+    std::vector<thing_ref> owners;                   ///< Row -> entity
+
+    size_t size() const { return owners.size(); }
+    void* at(size_t col, size_t row) { return columns[col].data() + row * sizes[col]; }
+  };
+
+  struct Record {
+    int gen = 0;
+    uint32_t archetype = 0;
+    uint32_t row = 0;
+    bool live = false;
+  };
+
+  struct Query {
+    std::vector<uint32_t> archetypes; ///< Matching archetype indices
+    size_t scanned = 0;               ///< Archetypes checked so far (new ones are appended)
+  };
+
+  std::vector<Archetype> archetypes; ///< [0] is the empty archetype
+  std::unordered_map<Mask, uint32_t> by_mask;
+  std::unordered_map<Mask, Query> queries;
+  std::vector<Record> records; ///< Indexed by thing_ref::idx
+  std::vector<int> free_records;
+  size_t live = 0;
+  int iterating = 0;
+
+  ArchetypeStore() { archetype_for(0); }
+
+  size_t size() const { return live; }
+  bool empty() const { return live == 0; }
+
+  bool alive(thing_ref ref) const {
+    if (ref.kind == ilist_kind::nil || ref.idx < 0 || (size_t)ref.idx >= records.size())
+      return false;
+    const Record& r = records[ref.idx];
+    return r.live && r.gen == ref.gen_id;
+  }
+
+  /// @brief New entity with no components.
+  thing_ref create() { return create_in(0); }
+
+  /// @brief New entity placed straight into the archetype for Cs (no intermediate moves).
+  template <typename... Cs> thing_ref create(const Cs&... values) {
+    thing_ref ref = create_in(archetype_for(mask<Cs...>()));
+    const Record& r = records[ref.idx];
+    (write(archetypes[r.archetype], r.row, values), ...);
+    return ref;
+  }
+
+  void destroy(thing_ref ref) {
+    assert(!iterating && "structural change inside each()");
+    if (!alive(ref))
+      return;
+    Record& r = records[ref.idx];
+    pop_row(archetypes[r.archetype], r.row);
+    r.live = false;
+    free_records.push_back(ref.idx);
+    live--;
+  }
+
+  /// @brief Destroy everything. Handles from before stay stale.
+  void clear() {
+    assert(!iterating && "structural change inside each()");
+    for (size_t i = 0; i < records.size(); i++)
+      if (records[i].live)
+        destroy({ilist_kind::item, records[i].gen, (int)i});
+  }
+
+  Mask mask_of(thing_ref ref) const {
+    return alive(ref) ? archetypes[records[ref.idx].archetype].mask : 0;
+  }
+
+  template <typename C> bool has(thing_ref ref) const { return (mask_of(ref) & bit<C>()) != 0; }
+
+  /// @brief Component of an entity, or nullptr if it is stale or lacks C.
+  template <typename C> C* get(thing_ref ref) {
+    if (!alive(ref))
+      return nullptr;
+    const Record& r = records[ref.idx];
+    Archetype& arch = archetypes[r.archetype];
+    if (!(arch.mask & bit<C>()))
+      return nullptr;
+    return column<C>(arch) + (std::is_empty_v<C> ? 0 : r.row);
+  }
+
+  /// @brief Add (or overwrite) a component. Moves the entity to the wider archetype.
+  template <typename C> C* add(thing_ref ref, const C& value = {}) {
+    assert(!iterating && "structural change inside each()");
+    if (!alive(ref))
+      return nullptr;
+    Mask m = archetypes[records[ref.idx].archetype].mask;
+    if (!(m & bit<C>()))
+      move(ref, archetype_for(m | bit<C>()));
+    Record& r = records[ref.idx];
+    write(archetypes[r.archetype], r.row, value);
+    return get<C>(ref);
+  }
+
+  template <typename C> void remove(thing_ref ref) {
+    assert(!iterating && "structural change inside each()");
+    Mask m = mask_of(ref);
+    if (m & bit<C>())
+      move(ref, archetype_for(m & ~bit<C>()));
+  }
+
+  /**
+   * @brief Run fn over every entity that has all of Cs.
+   * fn takes (Cs&...) or (thing_ref, Cs&...). Only archetypes that match are
+   * visited; within one, rows are walked in column order.
+   */
+  template <typename... Cs, typename Fn> void each(Fn&& fn) {
+    static_assert(sizeof...(Cs) > 0, "each<> needs at least one component");
+    const Query& q = match(mask<Cs...>());
+    iterating++;
+    for (uint32_t a : q.archetypes) {
+      Archetype& arch = archetypes[a];
+      if (arch.size())
+        run_rows<Cs...>(arch, fn, column<Cs>(arch)...);
+    }
+    iterating--;
+  }
+
+  /// @brief Number of entities that have all of Cs, without visiting them.
+  template <typename... Cs> size_t count() {
+    size_t n = 0;
+    for (uint32_t a : match(mask<Cs...>()).archetypes)
+      n += archetypes[a].size();
+    return n;
+  }
+
+  // ---- things_list-style access to one component ----
+
+  /// thing_base look-alike, so code written against things_list (ModelAPI buckets) can read
+  /// components: `!thing` for stale refs, this_ref(), and -> for the component.
+  template <typename C> struct ComponentRef {
+    C* ptr = nullptr;
+    thing_ref ref;
+    explicit operator bool() const { return ptr != nullptr; }
+    thing_ref this_ref() const { return ref; }
+    C* operator->() const { return ptr; }
+    C& operator*() const { return *ptr; }
+  };
+
+  template <typename C> struct ComponentView {
+    using thing = ComponentRef<C>;
+    ArchetypeStore* store;
+    thing operator[](thing_ref ref) const { return {store->get<C>(ref), ref}; }
+  };
+
+  template <typename C> ComponentView<C> view() { return {this}; }
+
+private:
+  thing_ref create_in(uint32_t archetype) {
+    assert(!iterating && "structural change inside each()");
+    int idx;
+    if (!free_records.empty()) {
+      idx = free_records.back();
+      free_records.pop_back();
+    } else {
+      idx = (int)records.size();
+      records.emplace_back();
+    }
+    Record& r = records[idx];
+    r.gen++;
+    r.live = true;
+    thing_ref ref = {ilist_kind::item, r.gen, idx};
+    r.archetype = archetype;
+    r.row = push_row(archetypes[archetype], ref);
+    live++;
+    return ref;
+  }
+
+  template <typename C> static C& pick(C* col, size_t row) {
+    if constexpr (std::is_empty_v<C>)
+      return *col;
+    else
+      return col[row];
+  }
+
+  template <typename... Cs, typename Fn>
+  static void run_rows(Archetype& arch, Fn& fn, Cs*... cols) {
+    for (size_t row = 0, n = arch.size(); row < n; row++) {
+      if constexpr (std::is_invocable_v<Fn&, thing_ref, Cs&...>)
+        fn(arch.owners[row], pick(cols, row)...);
+      else
+        fn(pick(cols, row)...);
+    }
+  }
+
+  /// Tags all share one dummy instance; real components point at their column.
+  template <typename C> C* column(Archetype& arch) {
+    if constexpr (std::is_empty_v<C>) {
+      static C tag;
+      return &tag;
+    } else {
+      int c = arch.column_of[component_id<C>()];
+      return c < 0 ? nullptr : reinterpret_cast<C*>(arch.columns[c].data());
+    }
+  }
+
+  template <typename C> void write(Archetype& arch, uint32_t row, const C& value) {
+    if constexpr (!std::is_empty_v<C>)
+      memcpy(arch.at(arch.column_of[component_id<C>()], row), &value, sizeof(C));
+  }
+
+  uint32_t archetype_for(Mask m) {
+    auto it = by_mask.find(m);
+    if (it != by_mask.end())
+      return it->second;
+    Archetype arch;
+    arch.mask = m;
+    memset(arch.column_of, -1, sizeof(arch.column_of));
+    for (int id = 0; id < MAX_COMPONENTS; id++) {
+      if (!(m & (Mask(1) << id)))
+        continue;
+      size_t bytes = component_sizes()[id];
+      if (bytes == 0)
+        continue;
+      arch.column_of[id] = (int8_t)arch.ids.size();
+      arch.ids.push_back(id);
+      arch.sizes.push_back(bytes);
+      arch.columns.emplace_back();
+    }
+    uint32_t a = (uint32_t)archetypes.size();
+    archetypes.push_back(std::move(arch));
+    by_mask.emplace(m, a);
+    return a;
+  }
+
+  const Query& match(Mask want) {
+    Query& q = queries[want];
+    for (; q.scanned < archetypes.size(); q.scanned++)
+      if ((archetypes[q.scanned].mask & want) == want)
+        q.archetypes.push_back((uint32_t)q.scanned);
+    return q;
+  }
+
+  /// Append a zeroed row. @return Its index.
+  static uint32_t push_row(Archetype& arch, thing_ref owner) {
+    for (size_t c = 0; c < arch.columns.size(); c++)
+      arch.columns[c].resize(arch.columns[c].size() + arch.sizes[c]);
+    arch.owners.push_back(owner);
+    return (uint32_t)arch.owners.size() - 1;
+  }
+
+  /// Swap-remove a row, fixing up the record of the entity moved into its place.
+  void pop_row(Archetype& arch, uint32_t row) {
+    uint32_t last = (uint32_t)arch.size() - 1;
+    if (row != last) {
+      for (size_t c = 0; c < arch.columns.size(); c++)
+        memcpy(arch.at(c, row), arch.at(c, last), arch.sizes[c]);
+      arch.owners[row] = arch.owners[last];
+      records[arch.owners[row].idx].row = row;
+    }
+    for (size_t c = 0; c < arch.columns.size(); c++)
+      arch.columns[c].resize(arch.columns[c].size() - arch.sizes[c]);
+    arch.owners.pop_back();
+  }
+
+  /// Move an entity's row to another archetype, keeping the components both have.
+  void move(thing_ref ref, uint32_t to) {
+    Record& r = records[ref.idx];
+    Archetype& src = archetypes[r.archetype];
+    Archetype& dst = archetypes[to];
+    uint32_t row = push_row(dst, ref);
+    for (size_t c = 0; c < src.ids.size(); c++) {
+      int d = dst.column_of[src.ids[c]];
+      if (d >= 0)
+        memcpy(dst.at(d, row), src.at(c, r.row), src.sizes[c]);
+    }
+    pop_row(src, r.row);
+    r.archetype = to;
+    r.row = row;
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+namespace archetype_test {
+struct Pos {
+  float x = 0, y = 0;
+};
+struct Vel {
+  float dx = 0, dy = 0;
+};
+struct Hp {
+  int value = 10;
+};
+struct Frozen {};
+} // namespace archetype_test
+
+TEST_CASE("archetype store components and handles") {
+  using namespace archetype_test;
+  ArchetypeStore store;
+  thing_ref a = store.create(Pos{1, 2}, Vel{3, 4});
+  thing_ref b = store.create(Pos{5, 6});
+  CHECK(store.size() == 2);
+  CHECK(store.has<Vel>(a));
+  CHECK_FALSE(store.has<Vel>(b));
+  CHECK(store.get<Pos>(b)->x == 5);
+  CHECK(store.get<Vel>(b) == nullptr);
+
+  // Adding and removing moves rows between archetypes but keeps values
+  REQUIRE(store.add(b, Hp{7}));
+  store.add(b, Frozen{});
+  CHECK(store.get<Pos>(b)->y == 6);
+  CHECK(store.get<Hp>(b)->value == 7);
+  CHECK(store.has<Frozen>(b));
+  store.remove<Pos>(a);
+  CHECK_FALSE(store.has<Pos>(a));
+  CHECK(store.get<Vel>(a)->dy == 4);
+  store.add(a, Hp{}); // default member initializers apply
+  CHECK(store.get<Hp>(a)->value == 10);
+
+  // Destroyed handles go stale; the slot is reused with a new generation
+  store.destroy(a);
+  CHECK_FALSE(store.alive(a));
+  CHECK(store.get<Vel>(a) == nullptr);
+  thing_ref c = store.create(Pos{9, 9});
+  CHECK(c.idx == a.idx);
+  CHECK(c.gen_id != a.gen_id);
+  CHECK_FALSE(store.alive(a));
+  CHECK(store.get<Pos>(b)->x == 5); // swap-remove fixed up the moved row
+
+  auto view = store.view<Pos>();
+  CHECK((bool)view[b]);
+  CHECK(view[b]->x == 5);
+  CHECK_FALSE((bool)view[a]);
+
+  store.clear();
+  CHECK(store.empty());
+  CHECK_FALSE(store.alive(b));
+}
+
+TEST_CASE("archetype store each visits matching archetypes") {
+  using namespace archetype_test;
+  ArchetypeStore store;
+  std::vector<thing_ref> movers;
+  for (int i = 0; i < 100; i++) {
+    thing_ref r = store.create(Pos{(float)i, 0}, Vel{1, 2});
+    movers.push_back(r);
+    if (i % 4 == 0)
+      store.add(r, Frozen{});
+  }
+  for (int i = 0; i < 50; i++)
+    store.create(Pos{-1, -1}, Hp{});
+
+  CHECK(store.count<Pos>() == 150);
+  CHECK(store.count<Pos, Vel>() == 100);
+  CHECK(store.count<Vel, Frozen>() == 25);
+
+  int visited = 0;
+  store.each<Pos, Vel>([&](Pos& p, Vel& v) {
+    p.x += v.dx;
+    p.y += v.dy;
+    visited++;
+  });
+  CHECK(visited == 100);
+  CHECK(store.get<Pos>(movers[10])->x == 11);
+  CHECK(store.get<Pos>(movers[10])->y == 2);
+
+  // With the ref, and a tag narrowing the set
+  std::vector<thing_ref> frozen;
+  store.each<Pos, Frozen>([&](thing_ref ref, Pos&, Frozen&) { frozen.push_back(ref); });
+  CHECK(frozen.size() == 25);
+  for (thing_ref r : frozen)
+    CHECK(store.has<Frozen>(r));
+
+  // Structural changes after the loop; the cached query picks up new archetypes
+  for (thing_ref r : frozen)
+    store.remove<Vel>(r);
+  CHECK(store.count<Pos, Vel>() == 75);
+  CHECK(store.count<Pos, Frozen>() == 25);
+}
+
+#endif
@@ -4,13 +4,21 @@ exit
 #endif
 
 #pragma once
+#include "async_loader.hpp"
+#include "model_api.hpp"
+#include "texture_cook.hpp"
 #include "traits.hpp"
 #include "uid_assets.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <raylib.h>
+#include <raymath.h>
 #include <rlgl.h>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 struct AssetTraits {
   TRAIT_DEF(flip_h)
@@ -37,6 +45,7 @@ struct Asset {
   Color silhouette_color = BLACK;
   float vertex_radius = 0.15f;
   float line_thickness = 0.08f;
+  int atlas_page = -1; ///< Set by AssetCache::to_atlas; source is then a rect on that page
 
   static Asset make_2d(AssetId id) {
     Asset a;
@@ -89,9 +98,62 @@ struct Asset {
   }
 };
 
+/**
+ * @brief Shelf packer for atlas pages.
+ *
+ * Rects are placed tallest first, left to right on shelves; a new page is
+ * opened when one fills up. Rects larger than a page get page = -1.
+ */
+struct AtlasPacker {
+  struct Placement {
+    int page = -1;
+    Rectangle rect = {0, 0, 0, 0};
+  };
+
+  static std::vector<Placement> pack(const std::vector<Vector2>& sizes, int page_size, int padding,
+                                     int* page_count = nullptr) {
+    std::vector<Placement> out(sizes.size());
+    std::vector<size_t> order(sizes.size());
+    for (size_t i = 0; i < order.size(); i++)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return sizes[a].y > sizes[b].y; });
+
+    int page = 0, x = padding, y = padding, shelf_h = 0;
+    bool page_used = false;
+    for (size_t i : order) {
+      int w = (int)sizes[i].x, h = (int)sizes[i].y;
+      if (w + 2 * padding > page_size || h + 2 * padding > page_size)
+        continue; // doesn't fit on any page
+      if (x + w + padding > page_size) { // next shelf
+        x = padding;
+        y += shelf_h + padding;
+        shelf_h = 0;
+      }
+      if (y + h + padding > page_size) { // next page
+        page++;
+        x = padding;
+        y = padding;
+        shelf_h = 0;
+      }
+      out[i] = {page, {(float)x, (float)y, (float)w, (float)h}};
+      page_used = true;
+      x += w + padding;
+      shelf_h = std::max(shelf_h, h);
+    }
+    if (page_count)
+      *page_count = page_used ? page + 1 : 0;
+    return out;
+  }
+};
+
 struct AssetCache {
   std::unordered_map<int, Texture2D> textures;
   AssetLoader loader;
+  /// If set, get_texture() decodes on the loader's workers and returns the NONE
+  /// texture until the upload lands in async->pump(). The cache must outlive the loader's jobs.
+  AsyncLoader* async = nullptr;
+  std::unordered_set<int> pending;
 
   struct AssetRenderBuffersCtx {
     RenderTexture2D outlineLayer;
@@ -108,6 +170,96 @@ struct AssetCache {
   };
   HexResources hexResources;
 
+  struct AtlasEntry {
+    int page = -1; ///< -1 = not in the atlas (drawn from its own texture)
+    Rectangle rect = {0, 0, 0, 0};
+  };
+  std::vector<Texture2D> atlas_pages;
+  std::array<AtlasEntry, ASSET_ID_COUNT> atlas = {};
+
+  /**
+   * @brief Pack every AssetId image into shared atlas pages. Requires a window.
+   * @param page_size Page width/height in pixels
+   * @param padding Transparent gutter around each image
+   */
+  void build_atlas(int page_size = 2048, int padding = 2) {
+    unload_atlas();
+    std::vector<Image> images;
+    std::vector<Vector2> sizes;
+    for (AssetId id : ALL_ASSET_IDS) {
+      Image img = {0};
+      if (loader.decoded_image(id, &img)) {
+        // A copy (pack pixels are read-only), decoded if cooked, at the size it draws at
+        img = TextureCook::decode(*loader.pack, (uint32_t)id);
+      } else {
+        LoadedBinary& bin = loader.get(id);
+        if (bin.size())
+          img = LoadImageFromMemory(".png", bin.ptr(), (int)bin.size());
+      }
+      if (img.data)
+        ImageFormat(&img, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+      images.push_back(img);
+      sizes.push_back(img.data ? Vector2{(float)img.width, (float)img.height} : Vector2{0, 0});
+    }
+
+    int page_count = 0;
+    auto placements = AtlasPacker::pack(sizes, page_size, padding, &page_count);
+    std::vector<Image> pages;
+    for (int i = 0; i < page_count; i++)
+      pages.push_back(GenImageColor(page_size, page_size, BLANK));
+
+    for (size_t i = 0; i < images.size(); i++) {
+      auto& p = placements[i];
+      if (images[i].data && p.page >= 0 && sizes[i].x > 0) {
+        Rectangle src = {0, 0, sizes[i].x, sizes[i].y};
+        ImageDraw(&pages[p.page], images[i], src, p.rect, WHITE);
+        atlas[(size_t)ALL_ASSET_IDS[i]] = {p.page, p.rect};
+      }
+      if (images[i].data)
+        UnloadImage(images[i]);
+    }
+    for (auto& img : pages) {
+      atlas_pages.push_back(LoadTextureFromImage(img));
+      UnloadImage(img);
+    }
+  }
+
+  /// @brief Atlas placement for an asset id (page -1 if not packed).
+  const AtlasEntry& atlas_entry(AssetId id) const { return atlas[(size_t)id]; }
+
+  /**
+   * @brief Rewrite an asset's source rect onto its atlas page.
+   * An empty source becomes the whole image; a sub-rect is offset into the page.
+   */
+  void to_atlas(Asset& asset) const {
+    if (asset.atlas_page >= 0 || (size_t)asset.id >= atlas.size())
+      return;
+    const AtlasEntry& e = atlas[(size_t)asset.id];
+    if (e.page < 0)
+      return;
+    if (asset.source.width == 0 && asset.source.height == 0) {
+      asset.source = e.rect;
+    } else {
+      asset.source.x += e.rect.x;
+      asset.source.y += e.rect.y;
+    }
+    asset.atlas_page = e.page;
+  }
+
+  /// @brief Texture an asset samples from: its atlas page, or its own texture.
+  Texture2D& texture_for(const Asset& asset) {
+    if (asset.atlas_page >= 0 && asset.atlas_page < (int)atlas_pages.size())
+      return atlas_pages[asset.atlas_page];
+    return get_texture(asset.id);
+  }
+
+  void unload_atlas() {
+    for (auto& tex : atlas_pages)
+      UnloadTexture(tex);
+    atlas_pages.clear();
+    atlas = {};
+  }
+
   void BeginRenderingContext() {
     auto s_h = GetScreenHeight();
     auto s_w = GetScreenWidth();
@@ -155,6 +307,9 @@ struct AssetCache {
     return hexResources;
   }
 
+  /// @brief True while an async decode for this asset is in flight.
+  bool is_pending(AssetId id) const { return pending.count(static_cast<int>(id)) != 0; }
+
   Texture2D& get_texture(AssetId id) {
     int key = static_cast<int>(id);
     auto it = textures.find(key);
@@ -168,6 +323,32 @@ struct AssetCache {
       UnloadImage(img);
       return textures[key];
     }
+    // Pre-decoded in the pack: upload straight from the mapping (at the pre-cook size)
+    Texture2D packed;
+    if (loader.pack && TextureCook::upload(*loader.pack, (uint32_t)key, &packed)) {
+      textures[key] = packed;
+      return textures[key];
+    }
+    // Cooked sidecar (mip chain / BC1 / BC3), see texture_cook.hpp
+    const char* source = get_asset_info(id).filepath;
+    Texture2D cooked;
+    if (source && TextureCook::load_cooked(source, &cooked)) {
+      textures[key] = cooked;
+      return textures[key];
+    }
+    bool in_pack = loader.pack && loader.pack->find((uint32_t)key);
+    if (async && !in_pack) {
+      const char* path = get_asset_info(id).filepath;
+      if (path && pending.insert(key).second) {
+        async->decode_image(path, [this, key](AsyncLoader::Result& r) {
+          pending.erase(key);
+          if (r.ok)
+            textures[key] = LoadTextureFromImage(r.image);
+          UnloadImage(r.image);
+        });
+      }
+      return get_texture(AssetId::NONE);
+    }
     LoadedBinary& bin = loader.get(id);
     Image img = LoadImageFromMemory(".png", bin.ptr(), (int)bin.size());
     Texture2D tex = LoadTextureFromImage(img);
@@ -187,19 +368,28 @@ struct AssetCache {
       UnloadTexture(tex);
     }
     textures.clear();
+    unload_atlas();
     loader.clear();
   }
 };
 
-// 2D draw_asset - basic
-inline void draw_asset(AssetCache& cache, Asset& asset, float x, float y) {
-  if (asset.rot_speed != 0.0f) {
-    asset.rotation += asset.rot_speed * GetFrameTime();
-  }
-  Texture2D& tex = cache.get_texture(asset.id);
+/// @brief Resolved 2D quad for an asset: source rect (with flips), destination and origin.
+struct AssetQuad {
+  Rectangle src;
+  Rectangle dst;
+  Vector2 origin;
+};
+
+/**
+ * @brief Compute the 2D quad draw_asset would submit.
+ * @param full Full source rect used when asset.source is empty
+ * @param size Destination size before scale, or nullptr to use the source size
+ */
+inline AssetQuad asset_quad(const Asset& asset, Rectangle full, float x, float y,
+                            const Vector2* size = nullptr) {
   Rectangle src = asset.source;
   if (src.width == 0 && src.height == 0) {
-    src = {0, 0, (float)tex.width, (float)tex.height};
+    src = full;
   }
   if (asset.traits.flip_h)
     src.width = -src.width;
@@ -207,39 +397,102 @@ inline void draw_asset(AssetCache& cache, Asset& asset, float x, float y) {
     src.height = -src.height;
   float abs_w = src.width < 0 ? -src.width : src.width;
   float abs_h = src.height < 0 ? -src.height : src.height;
-  float dst_w = abs_w * asset.scale.x;
-  float dst_h = abs_h * asset.scale.y;
+  float dst_w = (size ? size->x : abs_w) * asset.scale.x;
+  float dst_h = (size ? size->y : abs_h) * asset.scale.y;
   Vector2 origin = asset.origin;
   if ((asset.traits.sprite || asset.traits.tile) && origin.x == 0 && origin.y == 0) {
     origin = {dst_w / 2.0f, dst_h / 2.0f};
   }
-  Rectangle dst = {x, y, dst_w, dst_h};
-  DrawTexturePro(tex, src, dst, origin, asset.rotation, asset.tint);
+  return {src, {x, y, dst_w, dst_h}, origin};
 }
 
-// 2D draw_asset - with size
-inline void draw_asset(AssetCache& cache, Asset& asset, float x, float y, Vector2 size) {
+inline void advance_rotation(Asset& asset) {
   if (asset.rot_speed != 0.0f) {
     asset.rotation += asset.rot_speed * GetFrameTime();
   }
-  Texture2D& tex = cache.get_texture(asset.id);
-  Rectangle src = asset.source;
-  if (src.width == 0 && src.height == 0) {
-    src = {0, 0, (float)tex.width, (float)tex.height};
+}
+
+// 2D draw_asset - basic
+inline void draw_asset(AssetCache& cache, Asset& asset, float x, float y) {
+  advance_rotation(asset);
+  Texture2D& tex = cache.texture_for(asset);
+  AssetQuad q = asset_quad(asset, {0, 0, (float)tex.width, (float)tex.height}, x, y);
+  DrawTexturePro(tex, q.src, q.dst, q.origin, asset.rotation, asset.tint);
+}
+
+// 2D draw_asset - with size
+inline void draw_asset(AssetCache& cache, Asset& asset, float x, float y, Vector2 size) {
+  advance_rotation(asset);
+  Texture2D& tex = cache.texture_for(asset);
+  AssetQuad q = asset_quad(asset, {0, 0, (float)tex.width, (float)tex.height}, x, y, &size);
+  DrawTexturePro(tex, q.src, q.dst, q.origin, asset.rotation, asset.tint);
+}
+
+/**
+ * @brief Deferred 2D sprite submission, sorted by layer then texture.
+ *
+ * Collect a frame's sprites with add(), then flush() draws them layer by
+ * layer; within a layer, sprites sharing a texture (atlas page) are drawn
+ * back to back so raylib's batch doesn't break on texture switches.
+ * Submission order is kept among sprites with the same layer and texture.
+ */
+struct SpriteBatch {
+  struct Sprite {
+    int layer;
+    uint32_t order;
+    Texture2D texture;
+    AssetQuad quad;
+    float rotation;
+    Color tint;
+  };
+  std::vector<Sprite> sprites;
+
+  void add(AssetCache& cache, Asset& asset, float x, float y, int layer = 0) {
+    advance_rotation(asset);
+    Texture2D& tex = cache.texture_for(asset);
+    push(layer, tex, asset_quad(asset, {0, 0, (float)tex.width, (float)tex.height}, x, y), asset);
   }
-  if (asset.traits.flip_h)
-    src.width = -src.width;
-  if (asset.traits.flip_v)
-    src.height = -src.height;
-  float dst_w = size.x * asset.scale.x;
-  float dst_h = size.y * asset.scale.y;
-  Vector2 origin = asset.origin;
-  if ((asset.traits.sprite || asset.traits.tile) && origin.x == 0 && origin.y == 0) {
-    origin = {dst_w / 2.0f, dst_h / 2.0f};
+
+  void add(AssetCache& cache, Asset& asset, float x, float y, Vector2 size, int layer = 0) {
+    advance_rotation(asset);
+    Texture2D& tex = cache.texture_for(asset);
+    push(layer, tex, asset_quad(asset, {0, 0, (float)tex.width, (float)tex.height}, x, y, &size),
+         asset);
+  }
+
+  /// @brief Order sprites by layer, texture, then submission.
+  void sort() {
+    std::sort(sprites.begin(), sprites.end(), [](const Sprite& a, const Sprite& b) {
+      if (a.layer != b.layer)
+        return a.layer < b.layer;
+      if (a.texture.id != b.texture.id)
+        return a.texture.id < b.texture.id;
+      return a.order < b.order;
+    });
+  }
+
+  /// @brief Number of texture changes a flush of the current (sorted) list would make.
+  size_t texture_switches() const {
+    size_t n = 0;
+    for (size_t i = 0; i < sprites.size(); i++)
+      if (i == 0 || sprites[i].texture.id != sprites[i - 1].texture.id)
+        n++;
+    return n;
+  }
+
+  /// @brief Sort, draw everything and clear (keeps capacity).
+  void flush() {
+    sort();
+    for (auto& s : sprites)
+      DrawTexturePro(s.texture, s.quad.src, s.quad.dst, s.quad.origin, s.rotation, s.tint);
+    sprites.clear();
   }
-  Rectangle dst = {x, y, dst_w, dst_h};
-  DrawTexturePro(tex, src, dst, origin, asset.rotation, asset.tint);
-}
+
+private:
+  void push(int layer, const Texture2D& tex, AssetQuad quad, const Asset& asset) {
+    sprites.push_back({layer, (uint32_t)sprites.size(), tex, quad, asset.rotation, asset.tint});
+  }
+};
 
 // 3D draw_asset - hex tile with camera
 inline void draw_asset(AssetCache& cache, Asset& asset, Camera3D& camera) {
@@ -289,6 +542,164 @@ inline void draw_asset(AssetCache& cache, Asset& asset, Camera3D& camera) {
   }
 }
 
+/**
+ * @brief Batched 3D hex tile renderer.
+ *
+ * Submit every tile Asset for the frame, then flush() once:
+ * - all silhouettes go to outlineLayer in one render-target pass
+ * - all bodies and billboards go to mainLayer in one more pass
+ * - tiles without a silhouette (or without render buffers) draw straight to the screen
+ * Within a pass, draws are grouped by colour (bodies, silhouettes) or texture
+ * (billboards) and each group is one DrawMeshInstanced call, using the
+ * ModelAPI instancing shader (per-instance DrawMesh if it's unavailable).
+ * Colour/texture overrides are restored after each group, so the shared
+ * hex and plane materials are left untouched.
+ */
+struct HexTileBatch {
+  struct ColorGroup {
+    Color color;
+    std::vector<Matrix> transforms;
+  };
+  struct TextureGroup {
+    Texture2D texture;
+    std::vector<Matrix> transforms;
+  };
+  struct Pass {
+    std::vector<ColorGroup> bodies;
+    std::vector<TextureGroup> billboards;
+    size_t tiles = 0;
+
+    void clear() {
+      // Keep groups (and their buffers) alive across frames; empty ones are skipped
+      for (auto& g : bodies)
+        g.transforms.clear();
+      for (auto& g : billboards)
+        g.transforms.clear();
+      tiles = 0;
+    }
+  };
+
+  std::vector<ColorGroup> silhouettes;
+  Pass outlined; ///< Bodies/billboards of silhouetted tiles (mainLayer)
+  Pass plain;    ///< Tiles drawn directly to the screen
+
+  void clear() {
+    for (auto& g : silhouettes)
+      g.transforms.clear();
+    outlined.clear();
+    plain.clear();
+  }
+
+  /// @brief Queue a tile for this frame (advances its rotation like draw_asset).
+  void submit(AssetCache& cache, Asset& asset) {
+    advance_rotation(asset);
+    add(asset, cache.get_texture(asset.id), cache.renderBuffers.initialized);
+  }
+
+  /// @brief Queue a tile with an already resolved billboard texture.
+  void add(const Asset& asset, const Texture2D& texture, bool use_layers) {
+    float scale = asset.scale.x;
+    Vector3 bill_pos = {asset.pos.x, asset.pos.y + 0.01f, asset.pos.z};
+    bool outlined_tile = asset.traits.has_silhouette && use_layers;
+    Pass& pass = outlined_tile ? outlined : plain;
+
+    color_group(pass.bodies, asset.tint)
+        .transforms.push_back(tile_transform(asset.pos, asset.rotation, {scale, scale, scale}));
+    texture_group(pass.billboards, texture)
+        .transforms.push_back(tile_transform(bill_pos, asset.rotation + asset.billboard_rotation,
+                                             {asset.bill_size.x, 1.0f, asset.bill_size.y}));
+    pass.tiles++;
+
+    if (outlined_tile) {
+      float sil = scale * asset.silhouette_size;
+      color_group(silhouettes, asset.silhouette_color)
+          .transforms.push_back(tile_transform(asset.pos, asset.rotation, {sil, sil, sil}));
+    }
+  }
+
+  /// @brief Draw everything queued and clear. Call between cache.BeginFrame() and EndFrame().
+  void flush(AssetCache& cache, Camera3D& camera) {
+    auto& hex = cache.get_hex_resources();
+    bool instanced = ModelAPI::instancing_ready();
+
+    if (outlined.tiles > 0) {
+      BeginTextureMode(cache.renderBuffers.outlineLayer);
+      BeginMode3D(camera);
+      rlDisableBackfaceCulling();
+      for (auto& g : silhouettes)
+        draw_group(hex.model, g.transforms, &g.color, nullptr, instanced);
+      rlEnableBackfaceCulling();
+      EndMode3D();
+      EndTextureMode();
+
+      BeginTextureMode(cache.renderBuffers.mainLayer);
+      draw_pass(hex, outlined, camera, instanced);
+      EndTextureMode();
+    }
+    if (plain.tiles > 0)
+      draw_pass(hex, plain, camera, instanced);
+    clear();
+  }
+
+  static Matrix tile_transform(Vector3 pos, float angle_deg, Vector3 scale) {
+    Matrix m = MatrixMultiply(MatrixScale(scale.x, scale.y, scale.z),
+                              MatrixRotate({0, 1, 0}, angle_deg * DEG2RAD));
+    return MatrixMultiply(m, MatrixTranslate(pos.x, pos.y, pos.z));
+  }
+
+private:
+  static ColorGroup& color_group(std::vector<ColorGroup>& groups, Color c) {
+    for (auto& g : groups)
+      if (g.color.r == c.r && g.color.g == c.g && g.color.b == c.b && g.color.a == c.a)
+        return g;
+    groups.push_back({c, {}});
+    return groups.back();
+  }
+
+  static TextureGroup& texture_group(std::vector<TextureGroup>& groups, const Texture2D& tex) {
+    for (auto& g : groups)
+      if (g.texture.id == tex.id)
+        return g;
+    groups.push_back({tex, {}});
+    return groups.back();
+  }
+
+  static void draw_pass(AssetCache::HexResources& hex, Pass& pass, Camera3D& camera,
+                        bool instanced) {
+    BeginMode3D(camera);
+    rlDisableBackfaceCulling();
+    for (auto& g : pass.bodies)
+      draw_group(hex.model, g.transforms, &g.color, nullptr, instanced);
+    for (auto& g : pass.billboards)
+      draw_group(hex.planeModel, g.transforms, nullptr, &g.texture, instanced);
+    rlEnableBackfaceCulling();
+    EndMode3D();
+  }
+
+  /// One instanced draw of the model's first mesh with an optional colour / texture override.
+  static void draw_group(Model& model, const std::vector<Matrix>& transforms, const Color* color,
+                         const Texture2D* texture, bool instanced) {
+    if (transforms.empty())
+      return;
+    Material mat = model.materials[0];
+    MaterialMap& diffuse = mat.maps[MATERIAL_MAP_DIFFUSE];
+    MaterialMap original = diffuse;
+    if (color)
+      diffuse.color = *color;
+    if (texture)
+      diffuse.texture = *texture;
+
+    if (instanced) {
+      mat.shader = ModelAPI::instancing;
+      DrawMeshInstanced(model.meshes[0], mat, transforms.data(), (int)transforms.size());
+    } else {
+      for (auto& t : transforms)
+        DrawMesh(model.meshes[0], mat, t);
+    }
+    diffuse = original;
+  }
+};
+
 // ============================================================================
 // DOCTEST - Unit and visual tests
 // ============================================================================
@@ -346,6 +757,113 @@ TEST_CASE("Asset source rect and transforms") {
   CHECK(a.scale.y == doctest::Approx(2.0f));
 }
 
+TEST_CASE("atlas packer") {
+  std::vector<Vector2> sizes = {{64, 64}, {32, 100}, {200, 20}, {600, 600}, {128, 128}};
+  int pages = 0;
+  auto placed = AtlasPacker::pack(sizes, 256, 2, &pages);
+  REQUIRE(placed.size() == sizes.size());
+  CHECK(placed[3].page == -1); // larger than a page
+  CHECK(pages >= 1);
+
+  for (size_t i = 0; i < placed.size(); i++) {
+    if (placed[i].page < 0)
+      continue;
+    Rectangle r = placed[i].rect;
+    CHECK(r.width == sizes[i].x);
+    CHECK(r.x >= 2);
+    CHECK(r.x + r.width <= 254);
+    CHECK(r.y + r.height <= 254);
+    for (size_t j = i + 1; j < placed.size(); j++)
+      if (placed[j].page == placed[i].page)
+        CHECK(!CheckCollisionRecs(r, placed[j].rect));
+  }
+}
+
+TEST_CASE("atlas source rewrite and sprite batch order") {
+  AssetCache cache;
+  cache.atlas[(size_t)AssetId::GRASSPATCH59_PNG] = {0, {100, 50, 64, 64}};
+
+  Asset whole = Asset::make_tile(AssetId::GRASSPATCH59_PNG);
+  cache.to_atlas(whole);
+  CHECK(whole.atlas_page == 0);
+  CHECK(whole.source.x == doctest::Approx(100.0f));
+  CHECK(whole.source.width == doctest::Approx(64.0f));
+  cache.to_atlas(whole); // idempotent
+  CHECK(whole.source.x == doctest::Approx(100.0f));
+
+  Asset sub = Asset::make_2d(AssetId::GRASSPATCH59_PNG);
+  sub.source = {16, 16, 16, 16};
+  cache.to_atlas(sub);
+  CHECK(sub.source.x == doctest::Approx(116.0f));
+  CHECK(sub.source.y == doctest::Approx(66.0f));
+
+  Asset loose = Asset::make_2d(AssetId::TESTBACKGROUND_PNG); // not packed
+  cache.to_atlas(loose);
+  CHECK(loose.atlas_page == -1);
+
+  // Centered tile quad matches draw_asset's math
+  AssetQuad q = asset_quad(whole, {0, 0, 1, 1}, 10, 20);
+  CHECK(q.dst.width == doctest::Approx(64.0f));
+  CHECK(q.origin.x == doctest::Approx(32.0f));
+
+  SpriteBatch batch;
+  Texture2D a = {}, b = {};
+  a.id = 1;
+  b.id = 2;
+  int tex_of[] = {1, 2, 1, 2, 1};
+  int layer_of[] = {0, 0, 0, 0, 1};
+  for (int i = 0; i < 5; i++) {
+    SpriteBatch::Sprite s = {};
+    s.layer = layer_of[i];
+    s.order = i;
+    s.texture = tex_of[i] == 1 ? a : b;
+    batch.sprites.push_back(s);
+  }
+  CHECK(batch.texture_switches() == 5);
+  batch.sort();
+  CHECK(batch.texture_switches() == 3); // layer 0: 1,1,2,2  layer 1: 1
+  uint32_t expected[] = {0, 2, 1, 3, 4};
+  for (int i = 0; i < 5; i++)
+    CHECK(batch.sprites[i].order == expected[i]);
+}
+
+TEST_CASE("hex tile batch grouping") {
+  HexTileBatch batch;
+  Texture2D grass = {};
+  grass.id = 7;
+  Texture2D sand = {};
+  sand.id = 9;
+
+  for (int i = 0; i < 6; i++) {
+    Asset tile = Asset::make_hex_tile(AssetId::GRASSPATCH59_PNG, {(float)i, 0, 0});
+    tile.tint = i % 2 ? GREEN : YELLOW;
+    batch.add(tile, i < 4 ? grass : sand, true);
+  }
+  Asset loose = Asset::make_tile(AssetId::GRASSPATCH59_PNG); // no silhouette
+  batch.add(loose, grass, true);
+
+  CHECK(batch.outlined.tiles == 6);
+  CHECK(batch.plain.tiles == 1);
+  REQUIRE(batch.silhouettes.size() == 1);
+  CHECK(batch.silhouettes[0].transforms.size() == 6);
+  CHECK(batch.outlined.bodies.size() == 2);
+  REQUIRE(batch.outlined.billboards.size() == 2);
+  CHECK(batch.outlined.billboards[0].transforms.size() == 4);
+
+  // Silhouette is the body scaled by silhouette_size, at the tile position
+  Matrix sil = batch.silhouettes[0].transforms[2];
+  CHECK(sil.m0 == doctest::Approx(1.1f));
+  CHECK(sil.m12 == doctest::Approx(2.0f));
+
+  // Without render buffers everything is drawn as plain tiles
+  batch.clear();
+  Asset tile = Asset::make_hex_tile(AssetId::GRASSPATCH59_PNG, {0, 0, 0});
+  batch.add(tile, grass, false);
+  CHECK(batch.outlined.tiles == 0);
+  CHECK(batch.plain.tiles == 1);
+  CHECK(batch.silhouettes[0].transforms.empty());
+}
+
 TEST_CASE("hex grid visual test" * doctest::skip()) {
   // Run with: ./mylibs_tests --no-skip -tc="hex grid visual test"
   const int screenWidth = 800;
@@ -355,6 +873,9 @@ TEST_CASE("hex grid visual test" * doctest::skip()) {
   rlImGuiSetup(true);
 
   AssetCache cache;
+  AssetPack pack; // ./embed_assets.sh builds it; file paths are used if missing
+  if (pack.open("build/assets.pack"))
+    cache.loader.pack = &pack;
   cache.BeginRenderingContext();
 
   // Create a grid of hex assets - just like the single hex but multiple
@@ -386,6 +907,7 @@ TEST_CASE("hex grid visual test" * doctest::skip()) {
 
   bool cameraEnabled = false;
   float hexScale = 1.0f;
+  HexTileBatch batch;
 
   while (!WindowShouldClose()) {
     if (IsKeyPressed(KEY_TAB)) {
@@ -411,8 +933,9 @@ TEST_CASE("hex grid visual test" * doctest::skip()) {
 
     cache.BeginFrame();
     for (auto& hex : hexes) {
-      draw_asset(cache, hex, camera);
+      batch.submit(cache, hex);
     }
+    batch.flush(cache, camera);
     cache.EndFrame();
 
     rlImGuiBegin();
@@ -0,0 +1,398 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="asset pack*"
+exit
+#endif
+/**
+ * @file asset_pack.hpp
+ * @brief Single-file binary asset archive, read in place via mmap
+ *
+ * Layout (little-endian, produced by the embed_binary tool):
+ *   Header              magic "RPAK", version, entry count
+ *   Entry[count]        sorted by id (AssetId value)
+ *   payloads            each starting on a PACK_ALIGN boundary
+ *
+ * Entries are either raw file bytes or pre-decoded pixels (kind Image),
+ * which can go straight to LoadTextureFromImage() with no decode step.
+ * Lookups return spans into the mapping, so nothing is copied.
+ *
+ * For release builds the same file can be linked into the binary with
+ * `.incbin` (see asset_pack_incbin.cpp, EMBED_ASSET_PACK in CMake); AssetLoader
+ * then reads from embedded_asset_pack() unless told otherwise.
+ */
+
+#pragma once
+#include <raylib.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+struct AssetPack {
+  static constexpr uint32_t MAGIC = 0x4B415052; // "RPAK"
+  static constexpr uint32_t VERSION = 2;
+  static constexpr size_t PACK_ALIGN = 64;
+
+  enum class Kind : uint32_t { Raw = 0, Image = 1 };
+
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+  };
+
+  struct Entry {
+    uint32_t id;
+    Kind kind;
+    uint64_t offset;       ///< From the start of the pack, PACK_ALIGN aligned
+    uint64_t size;
+    int32_t width;         ///< Image only
+    int32_t height;        ///< Image only
+    int32_t format;        ///< PixelFormat, Image only
+    int32_t mipmaps;       ///< Image only; levels are stored back to back
+    int32_t source_width;  ///< Image only; size before cooking, which may have resampled it
+    int32_t source_height; ///< Image only; this is the size to draw it at
+  };
+  static_assert(sizeof(Header) == 16 && sizeof(Entry) == 48, "pack layout changed");
+
+  const uint8_t* base = nullptr;
+  size_t length = 0;
+  bool mapped = false;
+  std::vector<uint8_t> owned; ///< Fallback buffer where mmap is unavailable
+
+  AssetPack() = default;
+  AssetPack(const AssetPack&) = delete;
+  AssetPack& operator=(const AssetPack&) = delete;
+  ~AssetPack() { close(); }
+
+  /// @brief Map a pack file read-only. Returns false (and stays closed) if missing or invalid.
+  bool open(const char* path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st;
+    void* p = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+      p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (p == MAP_FAILED)
+      return false;
+    base = static_cast<const uint8_t*>(p);
+    length = (size_t)st.st_size;
+    mapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+      return false;
+    owned.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(owned.data()), (std::streamsize)owned.size());
+    base = owned.data();
+    length = owned.size();
+#endif
+    if (!valid()) {
+      TraceLog(LOG_WARNING, "AssetPack: invalid pack: %s", path);
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  /// @brief Use a pack already in memory (e.g. linked with .incbin). The memory is not owned.
+  bool open_memory(const void* data, size_t size) {
+    close();
+    base = static_cast<const uint8_t*>(data);
+    length = size;
+    if (!valid()) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void close() {
+#ifndef _WIN32
+    if (mapped)
+      munmap(const_cast<uint8_t*>(base), length);
+#endif
+    owned.clear();
+    base = nullptr;
+    length = 0;
+    mapped = false;
+  }
+
+  bool is_open() const { return base != nullptr; }
+
+  const Header& header() const { return *reinterpret_cast<const Header*>(base); }
+  std::span<const Entry> entries() const {
+    if (!base)
+      return {};
+    return {reinterpret_cast<const Entry*>(base + sizeof(Header)), header().count};
+  }
+
+  /// @brief Entry for an id, or nullptr. Binary search over the sorted TOC.
+  const Entry* find(uint32_t id) const {
+    auto toc = entries();
+    auto it = std::lower_bound(toc.begin(), toc.end(), id,
+                               [](const Entry& e, uint32_t v) { return e.id < v; });
+    return it != toc.end() && it->id == id ? &*it : nullptr;
+  }
+
+  /// @brief Payload bytes, pointing into the pack.
+  std::span<const uint8_t> bytes(const Entry& e) const { return {base + e.offset, e.size}; }
+
+  std::span<const uint8_t> bytes(uint32_t id) const {
+    const Entry* e = find(id);
+    return e ? bytes(*e) : std::span<const uint8_t>{};
+  }
+
+  /**
+   * @brief Pre-decoded pixels as an Image viewing the pack memory.
+   * The Image is not owned: don't UnloadImage() or modify it (ImageCopy() first).
+   */
+  bool image(uint32_t id, Image* out) const {
+    const Entry* e = find(id);
+    if (!e || e->kind != Kind::Image)
+      return false;
+    out->data = const_cast<uint8_t*>(base + e->offset);
+    out->width = e->width;
+    out->height = e->height;
+    out->format = e->format;
+    out->mipmaps = e->mipmaps;
+    return true;
+  }
+
+  /// @brief Pixel bytes of an image over all its mip levels (stored back to back).
+  static size_t image_size(int width, int height, int format, int mipmaps) {
+    size_t size = 0;
+    for (int m = 0, w = width, h = height; m < mipmaps; m++) {
+      size += (size_t)GetPixelDataSize(w, h, format);
+      w = std::max(1, w / 2);
+      h = std::max(1, h / 2);
+    }
+    return size;
+  }
+
+private:
+  // image() hands these fields to raylib, which reads image_size() bytes from the pack
+  static bool image_fits(const Entry& e) {
+    if (e.width <= 0 || e.height <= 0 || e.mipmaps <= 0 || e.mipmaps > 32)
+      return false;
+    // GetPixelDataSize works in int, and 16 bytes is the widest pixel
+    if ((uint64_t)e.width * (uint64_t)e.height > INT32_MAX / 16)
+      return false;
+    if (GetPixelDataSize(1, 1, e.format) <= 0) // unknown format
+      return false;
+    return image_size(e.width, e.height, e.format, e.mipmaps) <= e.size;
+  }
+
+  bool valid() const {
+    if (!base || length < sizeof(Header))
+      return false;
+    const Header& h = header();
+    if (h.magic != MAGIC || h.version != VERSION)
+      return false;
+    if (sizeof(Header) + (size_t)h.count * sizeof(Entry) > length)
+      return false;
+    for (const Entry& e : entries()) {
+      if (e.offset % PACK_ALIGN != 0 || e.offset > length || e.size > length - e.offset)
+        return false;
+      if (e.kind == Kind::Image && !image_fits(e))
+        return false;
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Builds an AssetPack file. Used by the embed_binary tool and tests.
+ */
+struct AssetPackWriter {
+  struct Item {
+    AssetPack::Entry entry;
+    std::vector<uint8_t> bytes;
+  };
+  std::vector<Item> items;
+
+  void add_raw(uint32_t id, std::vector<uint8_t> bytes) {
+    Item item = {};
+    item.entry.id = id;
+    item.entry.kind = AssetPack::Kind::Raw;
+    item.bytes = std::move(bytes);
+    items.push_back(std::move(item));
+  }
+
+  /**
+   * @brief Store an image's pixels (all mip levels) for decode-free loading.
+   * @param source_width, source_height Size before cooking, if cook() resized it (0 = img's)
+   */
+  void add_image(uint32_t id, const Image& img, int source_width = 0, int source_height = 0) {
+    Item item = {};
+    item.entry.id = id;
+    item.entry.kind = AssetPack::Kind::Image;
+    item.entry.width = img.width;
+    item.entry.height = img.height;
+    item.entry.format = img.format;
+    item.entry.mipmaps = img.mipmaps;
+    item.entry.source_width = source_width > 0 ? source_width : img.width;
+    item.entry.source_height = source_height > 0 ? source_height : img.height;
+    size_t size = AssetPack::image_size(img.width, img.height, img.format, img.mipmaps);
+    const uint8_t* px = static_cast<const uint8_t*>(img.data);
+    item.bytes.assign(px, px + size);
+    items.push_back(std::move(item));
+  }
+
+  /// @brief Sort by id, lay out aligned payloads and write the file.
+  bool write(const std::string& path) {
+    std::sort(items.begin(), items.end(),
+              [](const Item& a, const Item& b) { return a.entry.id < b.entry.id; });
+    AssetPack::Header header = {AssetPack::MAGIC, AssetPack::VERSION, (uint32_t)items.size(), 0};
+    uint64_t offset = align(sizeof(header) + items.size() * sizeof(AssetPack::Entry));
+    for (Item& item : items) {
+      item.entry.offset = offset;
+      item.entry.size = item.bytes.size();
+      offset = align(offset + item.bytes.size());
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const Item& item : items)
+      out.write(reinterpret_cast<const char*>(&item.entry), sizeof(item.entry));
+    static const char zeros[AssetPack::PACK_ALIGN] = {};
+    for (const Item& item : items) {
+      out.write(zeros, (std::streamsize)(item.entry.offset - (uint64_t)out.tellp()));
+      out.write(reinterpret_cast<const char*>(item.bytes.data()),
+                (std::streamsize)item.bytes.size());
+    }
+    return (bool)out;
+  }
+
+private:
+  static uint64_t align(uint64_t v) {
+    return (v + AssetPack::PACK_ALIGN - 1) / AssetPack::PACK_ALIGN * AssetPack::PACK_ALIGN;
+  }
+};
+
+#ifdef ASSET_PACK_INCBIN
+/// Pack linked into the binary by asset_pack_incbin.cpp
+extern "C" const uint8_t asset_pack_blob[];
+extern "C" const uint8_t asset_pack_blob_end[];
+
+/// @brief The linked-in pack, opened on first use.
+inline const AssetPack& embedded_asset_pack() {
+  static AssetPack pack;
+  if (!pack.is_open())
+    pack.open_memory(asset_pack_blob, (size_t)(asset_pack_blob_end - asset_pack_blob));
+  return pack;
+}
+#endif
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("asset pack round trip") {
+  const char* path = "/tmp/asset_pack_test.pack";
+  uint8_t pixels[4 * 4 * 4];
+  for (int i = 0; i < (int)sizeof(pixels); i++)
+    pixels[i] = (uint8_t)i;
+  Image img = {pixels, 4, 4, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+
+  AssetPackWriter writer;
+  writer.add_raw(7, {1, 2, 3});
+  writer.add_image(2, img);
+  writer.add_raw(3, {});
+  REQUIRE(writer.write(path));
+
+  AssetPack pack;
+  REQUIRE(pack.open(path));
+  CHECK(pack.mapped);
+  REQUIRE(pack.entries().size() == 3);
+  CHECK(pack.entries()[0].id == 2); // sorted TOC
+  for (const auto& e : pack.entries())
+    CHECK(e.offset % AssetPack::PACK_ALIGN == 0);
+
+  auto raw = pack.bytes(7);
+  REQUIRE(raw.size() == 3);
+  CHECK(raw[2] == 3);
+  CHECK(pack.bytes(3).empty());
+  CHECK(pack.find(5) == nullptr);
+
+  Image view;
+  REQUIRE(pack.image(2, &view));
+  CHECK(view.width == 4);
+  CHECK(pack.find(2)->source_width == 4); // not cooked: drawn at its own size
+  CHECK(memcmp(view.data, pixels, sizeof(pixels)) == 0);
+  CHECK_FALSE(pack.image(7, &view)); // raw entries have no pixels
+
+  // Same bytes opened from memory (the .incbin path)
+  std::vector<uint8_t> blob(pack.base, pack.base + pack.length);
+  AssetPack mem;
+  REQUIRE(mem.open_memory(blob.data(), blob.size()));
+  CHECK(mem.bytes(7).data() == blob.data() + mem.find(7)->offset);
+
+  pack.close();
+  std::remove(path);
+}
+
+TEST_CASE("asset pack rejects bad files") {
+  AssetPack pack;
+  CHECK_FALSE(pack.open("/tmp/asset_pack_missing.pack"));
+  uint8_t junk[64] = {'n', 'o', 'p', 'e'};
+  CHECK_FALSE(pack.open_memory(junk, sizeof(junk)));
+  CHECK_FALSE(pack.is_open());
+  CHECK(pack.find(1) == nullptr);
+}
+
+TEST_CASE("asset pack rejects images bigger than their payload") {
+  uint8_t pixels[4 * 4 * 4] = {};
+  Image img = {pixels, 4, 4, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  AssetPackWriter writer;
+  writer.add_image(1, img);
+  const char* path = "/tmp/asset_pack_image_test.pack";
+  REQUIRE(writer.write(path));
+  std::ifstream f(path, std::ios::binary);
+  std::vector<uint8_t> good((std::istreambuf_iterator<char>(f)), {});
+  std::remove(path);
+
+  AssetPack pack;
+  REQUIRE(pack.open_memory(good.data(), good.size()));
+  auto patched = [&](auto edit) {
+    std::vector<uint8_t> blob = good;
+    AssetPack::Entry e;
+    memcpy(&e, blob.data() + sizeof(AssetPack::Header), sizeof(e));
+    edit(e);
+    memcpy(blob.data() + sizeof(AssetPack::Header), &e, sizeof(e));
+    AssetPack p;
+    return p.open_memory(blob.data(), blob.size());
+  };
+  CHECK(patched([](AssetPack::Entry&) {}));
+  CHECK_FALSE(patched([](AssetPack::Entry& e) { e.width = 64; }));
+  CHECK_FALSE(patched([](AssetPack::Entry& e) { e.height = 0; }));
+  CHECK_FALSE(patched([](AssetPack::Entry& e) { e.mipmaps = 3; })); // levels not stored
+  CHECK_FALSE(patched([](AssetPack::Entry& e) {
+    e.format = PIXELFORMAT_UNCOMPRESSED_R32G32B32A32; // 4x the bytes
+  }));
+  CHECK_FALSE(patched([](AssetPack::Entry& e) { e.width = e.height = 1 << 20; }));
+  CHECK_FALSE(patched([](AssetPack::Entry& e) { e.format = 0; }));
+}
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file asset_pack_incbin.cpp
+ * @brief Links the asset pack into the executable (release builds)
+ *
+ * Built only with -DEMBED_ASSET_PACK=ON, which defines ASSET_PACK_INCBIN as
+ * the pack path. The bytes land in .rodata once, in this TU only; read them
+ * through embedded_asset_pack(), which every AssetLoader uses by default.
+ */
+#include "asset_pack.hpp"
+
+#ifdef ASSET_PACK_INCBIN
+#ifdef __APPLE__
+#define ASSET_PACK_SYM(name) "_" #name
+#define ASSET_PACK_SECTION ".const_data"
+#else
+#define ASSET_PACK_SYM(name) #name
+#define ASSET_PACK_SECTION ".section .rodata"
+#endif
+
+__asm__(ASSET_PACK_SECTION "\n"
+        ".global " ASSET_PACK_SYM(asset_pack_blob) "\n"
+        ".balign 64\n"
+        ASSET_PACK_SYM(asset_pack_blob) ":\n"
+        ".incbin \"" ASSET_PACK_INCBIN "\"\n"
+        ".global " ASSET_PACK_SYM(asset_pack_blob_end) "\n"
+        ASSET_PACK_SYM(asset_pack_blob_end) ":\n"
+        ".byte 0\n"
+        ".previous\n");
+#endif
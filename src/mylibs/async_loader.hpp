@@ -0,0 +1,331 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="async loader*"
+exit
+#endif
+/**
+ * @file async_loader.hpp
+ * @brief Worker-thread file I/O and image decode with a budgeted main-thread completion queue
+ *
+ * Workers read files and decode images; anything that touches GL (texture
+ * and mesh uploads) is left to the completion callback, which only runs
+ * inside pump() on the thread that calls it. Call pump() once per frame:
+ * it drains finished jobs until its time budget is spent, so a big batch
+ * of loads is spread over several frames instead of freezing one.
+ *
+ * Usage:
+ *   AsyncLoader loader;
+ *   loader.start();
+ *   loader.decode_image("a.png", [](AsyncLoader::Result& r) {
+ *     if (r.ok) tex = LoadTextureFromImage(r.image); // main thread
+ *     UnloadImage(r.image);
+ *   });
+ *   while (...) { loader.pump(4.0); ... }
+ */
+
+#pragma once
+#include <raylib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct AsyncLoader {
+  enum class JobKind { ReadFile, DecodeImage };
+
+  struct Result {
+    std::string path;
+    std::vector<uint8_t> bytes; ///< File contents (ReadFile)
+    Image image = {0};          ///< Decoded pixels (DecodeImage); the callback owns them
+    Image thumb = {0};          ///< Downscaled copy if one was asked for; the callback owns it
+    bool ok = false;
+  };
+  using Callback = std::function<void(Result&)>;
+
+  struct Job {
+    JobKind kind;
+    std::string path;
+    Callback done;
+    int thumb_size = 0;
+  };
+  struct Done {
+    Result result;
+    Callback done;
+  };
+
+  std::vector<std::thread> workers;
+  std::deque<Job> jobs;
+  std::deque<Done> finished;
+  mutable std::mutex mutex;
+  std::condition_variable wake;
+  size_t running = 0; ///< Jobs taken by a worker but not yet in `finished`
+  bool stopping = false;
+
+  AsyncLoader() = default;
+  AsyncLoader(const AsyncLoader&) = delete;
+  AsyncLoader& operator=(const AsyncLoader&) = delete;
+  ~AsyncLoader() { stop(); }
+
+  /// @brief Spawn worker threads (0 = hardware threads - 1, at least 1). No-op if running.
+  void start(int threads = 0) {
+    if (!workers.empty())
+      return;
+    if (threads <= 0)
+      threads = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+    stopping = false;
+    for (int i = 0; i < threads; i++)
+      workers.emplace_back([this] { work(); });
+  }
+
+  /**
+   * @brief Join the workers. Queued jobs are dropped and finished callbacks are not run;
+   * images decoded but never pumped are freed.
+   */
+  void stop() {
+    {
+      std::lock_guard lock(mutex);
+      stopping = true;
+      jobs.clear();
+    }
+    wake.notify_all();
+    for (auto& t : workers)
+      t.join();
+    workers.clear();
+    std::lock_guard lock(mutex);
+    for (auto& d : finished)
+      free_images(d.result);
+    finished.clear();
+    running = 0;
+  }
+
+  bool started() const { return !workers.empty(); }
+
+  /// @brief Read a whole file on a worker. `done` runs in pump() with the bytes.
+  void read_file(std::string path, Callback done) {
+    push({JobKind::ReadFile, std::move(path), std::move(done)});
+  }
+
+  /**
+   * @brief Read and decode an image on a worker. `done` runs in pump() and owns result.image.
+   * @param thumb_size If > 0, also fill result.thumb with a copy whose longer side is this
+   *                   many pixels (resized on the worker too)
+   */
+  void decode_image(std::string path, Callback done, int thumb_size = 0) {
+    push({JobKind::DecodeImage, std::move(path), std::move(done), thumb_size});
+  }
+
+  /**
+   * @brief Run finished callbacks on this thread until the budget is spent.
+   * At least one callback runs per call if any are ready, so progress never stalls.
+   * @param budget_ms Time budget (<= 0 drains everything that is ready)
+   * @return Number of callbacks run
+   */
+  size_t pump(double budget_ms = 4.0) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    size_t ran = 0;
+    for (;;) {
+      Done d;
+      {
+        std::lock_guard lock(mutex);
+        if (finished.empty())
+          break;
+        d = std::move(finished.front());
+        finished.pop_front();
+      }
+      if (d.done)
+        d.done(d.result);
+      ran++;
+      if (budget_ms > 0) {
+        double spent = std::chrono::duration<double, std::milli>(clock::now() - start).count();
+        if (spent >= budget_ms)
+          break;
+      }
+    }
+    return ran;
+  }
+
+  /// @brief Jobs queued, running, or waiting for pump().
+  size_t pending() const {
+    std::lock_guard lock(mutex);
+    return jobs.size() + running + finished.size();
+  }
+
+  bool idle() const { return pending() == 0; }
+
+  /// @brief Pump until every job has completed. For tools and tests; blocks the caller.
+  void finish_all() {
+    while (!idle()) {
+      if (pump(0) == 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+
+  /// @brief Read a file into memory. Thread-safe (no raylib calls).
+  static bool read_bytes(const std::string& path, std::vector<uint8_t>& out) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in)
+      return false;
+    std::streamsize size = in.tellg();
+    if (size < 0)
+      return false;
+    in.seekg(0);
+    out.resize((size_t)size);
+    return size == 0 || (bool)in.read(reinterpret_cast<char*>(out.data()), size);
+  }
+
+  /// @brief Copy of `src` scaled down so its longer side is at most `size` pixels.
+  static Image thumbnail(const Image& src, int size) {
+    Image thumb = ImageCopy(src);
+    float k = (float)size / (float)std::max(src.width, src.height);
+    if (k < 1.0f)
+      ImageResize(&thumb, std::max(1, (int)(src.width * k)), std::max(1, (int)(src.height * k)));
+    return thumb;
+  }
+
+private:
+  void push(Job job) {
+    if (!started()) {
+      // No workers: do the work inline, still deliver through pump()
+      Done d = {execute(job), std::move(job.done)};
+      std::lock_guard lock(mutex);
+      finished.push_back(std::move(d));
+      return;
+    }
+    {
+      std::lock_guard lock(mutex);
+      jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+  }
+
+  static void free_images(Result& r) {
+    if (r.image.data)
+      UnloadImage(r.image);
+    if (r.thumb.data)
+      UnloadImage(r.thumb);
+  }
+
+  static Result execute(const Job& job) {
+    Result r;
+    r.path = job.path;
+    r.ok = read_bytes(job.path, r.bytes);
+    if (job.kind == JobKind::DecodeImage) {
+      if (r.ok) {
+        const char* ext = strrchr(job.path.c_str(), '.');
+        // LoadImageFromMemory only touches CPU memory, so it is safe off the GL thread
+        r.image = LoadImageFromMemory(ext ? ext : ".png", r.bytes.data(), (int)r.bytes.size());
+        r.ok = r.image.data != nullptr;
+      }
+      if (r.ok && job.thumb_size > 0)
+        r.thumb = thumbnail(r.image, job.thumb_size);
+      r.bytes.clear();
+      r.bytes.shrink_to_fit();
+    }
+    return r;
+  }
+
+  void work() {
+    for (;;) {
+      Job job;
+      {
+        std::unique_lock lock(mutex);
+        wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (stopping)
+          return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+        running++;
+      }
+      Result r = execute(job);
+      std::lock_guard lock(mutex);
+      running--;
+      if (stopping) {
+        free_images(r);
+        continue;
+      }
+      finished.push_back({std::move(r), std::move(job.done)});
+    }
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <cstdio>
+#include <doctest/doctest.h>
+
+static std::string async_loader_temp_file(const char* name, const std::string& contents) {
+  std::string path = std::string("/tmp/") + name;
+  std::ofstream out(path, std::ios::binary);
+  out << contents;
+  return path;
+}
+
+TEST_CASE("async loader reads files on workers") {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 8; i++)
+    paths.push_back(async_loader_temp_file(("async_loader_" + std::to_string(i) + ".txt").c_str(),
+                                           std::string(100 + i, 'a' + i)));
+
+  AsyncLoader loader;
+  loader.start(3);
+  std::thread::id main_id = std::this_thread::get_id();
+  int done = 0;
+  bool all_on_main = true;
+  for (int i = 0; i < 8; i++) {
+    loader.read_file(paths[i], [&, i](AsyncLoader::Result& r) {
+      CHECK(r.ok);
+      CHECK(r.bytes.size() == (size_t)(100 + i));
+      CHECK(r.bytes[0] == (uint8_t)('a' + i));
+      all_on_main = all_on_main && std::this_thread::get_id() == main_id;
+      done++;
+    });
+  }
+  loader.read_file("/tmp/async_loader_missing.bin", [&](AsyncLoader::Result& r) {
+    CHECK_FALSE(r.ok);
+    done++;
+  });
+
+  // Callbacks never run outside pump()
+  CHECK(done == 0);
+  loader.finish_all();
+  CHECK(done == 9);
+  CHECK(all_on_main);
+  CHECK(loader.idle());
+
+  loader.stop();
+  for (auto& p : paths)
+    std::remove(p.c_str());
+}
+
+TEST_CASE("async loader pump budget") {
+  std::string path = async_loader_temp_file("async_loader_budget.txt", "x");
+  AsyncLoader loader; // no workers: jobs complete inline, delivery still waits for pump()
+  int done = 0;
+  for (int i = 0; i < 5; i++)
+    loader.read_file(path, [&](AsyncLoader::Result&) {
+      done++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+  CHECK(loader.pending() == 5);
+
+  // A tiny budget still makes progress, one slow callback per pump
+  CHECK(loader.pump(0.001) == 1);
+  CHECK(done == 1);
+  CHECK(loader.pump(0) == 4);
+  CHECK(done == 5);
+  CHECK(loader.idle());
+  std::remove(path.c_str());
+}
+
+#endif
@@ -0,0 +1,160 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="bench*"
+exit
+#endif
+/**
+ * @file bench.hpp
+ * @brief Minimal micro-benchmark harness for mylibs_bench
+ *
+ * Each benchmark body runs in batches whose size doubles until one batch
+ * takes at least `min_time` seconds; then `repetitions` batches are timed
+ * and the median is reported. Results are written as JSON in the shape
+ * Google Benchmark uses ({"context", "benchmarks": [{name, real_time,
+ * time_unit, iterations, items_per_second}]}), so its compare.py can diff
+ * two runs.
+ *
+ * Usage:
+ *   Bench::run("hex_round/100k", [&] { for (auto& p : pts) sink += hex_round(p).q; }, 100000);
+ *   Bench::write_json("bench.json");
+ */
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace Bench {
+
+struct Result {
+  std::string name;
+  int64_t iterations; ///< Body calls per timed batch
+  double ns_per_iter; ///< Median over repetitions
+  double items_per_second;
+};
+
+inline double min_time = 0.1; ///< Seconds per timed batch
+inline int repetitions = 5;
+inline std::string filter;  ///< Substring; empty runs everything
+inline bool verbose = true; ///< Print a line per result
+inline std::vector<Result> results;
+
+/// Keep a value alive so the optimizer can't drop the work that produced it
+template <typename T> inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void* sink;
+  sink = &value;
+#endif
+}
+
+inline double seconds_now() {
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename Fn> double time_batch(Fn& fn, int64_t n) {
+  double t0 = seconds_now();
+  for (int64_t i = 0; i < n; i++)
+    fn();
+  return seconds_now() - t0;
+}
+
+/**
+ * @brief Time fn() and record the result (skipped if it doesn't match `filter`).
+ * @param items Work items one call processes, for items_per_second (e.g. entities)
+ */
+template <typename Fn> void run(const std::string& name, Fn&& fn, int64_t items = 1) {
+  if (!filter.empty() && name.find(filter) == std::string::npos)
+    return;
+  int64_t n = 1;
+  while (time_batch(fn, n) < min_time && n < (int64_t(1) << 40))
+    n *= 2;
+  std::vector<double> times;
+  for (int r = 0; r < std::max(1, repetitions); r++)
+    times.push_back(time_batch(fn, n));
+  std::sort(times.begin(), times.end());
+  double median = times[times.size() / 2];
+  Result res = {name, n, median * 1e9 / (double)n, (double)(items * n) / std::max(median, 1e-12)};
+  if (verbose)
+    printf("%-48s %12.1f ns %14.0f items/s\n", name.c_str(), res.ns_per_iter, res.items_per_second);
+  results.push_back(res);
+}
+
+inline std::string json() {
+  char date[32] = "";
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+  std::string out = "{\n  \"context\": {\"date\": \"" + std::string(date) + "\"";
+#ifdef NDEBUG
+  out += ", \"library_build_type\": \"release\"";
+#else
+  out += ", \"library_build_type\": \"debug\"";
+#endif
+  out += ", \"compiler\": \"" __VERSION__ "\"},\n  \"benchmarks\": [";
+  char buf[512];
+  for (size_t i = 0; i < results.size(); i++) {
+    const Result& r = results[i];
+    snprintf(buf, sizeof(buf),
+             "%s\n    {\"name\": \"%s\", \"run_type\": \"iteration\", \"iterations\": %lld, "
+             "\"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\", "
+             "\"items_per_second\": %.1f}",
+             i ? "," : "", r.name.c_str(), (long long)r.iterations, r.ns_per_iter, r.ns_per_iter,
+             r.items_per_second);
+    out += buf;
+  }
+  out += "\n  ]\n}\n";
+  return out;
+}
+
+inline bool write_json(const std::string& path) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  std::string text = json();
+  bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+  return fclose(f) == 0 && ok;
+}
+
+} // namespace Bench
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("bench harness times and reports") {
+  double old_min_time = Bench::min_time;
+  int old_repetitions = Bench::repetitions;
+  bool old_verbose = Bench::verbose;
+  Bench::results.clear();
+  Bench::min_time = 0.001;
+  Bench::repetitions = 3;
+  Bench::verbose = false;
+  int calls = 0;
+  Bench::run("count/1", [&] { Bench::do_not_optimize(++calls); }, 4);
+  Bench::filter = "nothing matches";
+  Bench::run("skipped", [] {});
+  Bench::filter.clear();
+
+  REQUIRE(Bench::results.size() == 1);
+  const Bench::Result& r = Bench::results[0];
+  CHECK(r.iterations >= 1);
+  CHECK(calls >= r.iterations * 3);
+  CHECK(r.items_per_second > 0);
+
+  std::string json = Bench::json();
+  CHECK(json.find("\"benchmarks\": [") != std::string::npos);
+  CHECK(json.find("\"name\": \"count/1\"") != std::string::npos);
+  Bench::results.clear();
+  Bench::min_time = old_min_time;
+  Bench::repetitions = old_repetitions;
+  Bench::verbose = old_verbose;
+}
+
+#endif
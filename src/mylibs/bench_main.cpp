@@ -0,0 +1,532 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_bench && ./build/mylibs_bench --out bench.json
+exit
+#endif
+/**
+ * @file bench_main.cpp
+ * @brief mylibs_bench: throughput baselines for the containers, hex math and the frame loop
+ *
+ *   mylibs_bench [--out results.json] [--filter substring] [--min-time seconds]
+ *
+ * Everything runs headless (no window), so it works in CI. Build with
+ * CMAKE_BUILD_TYPE=Release for numbers worth comparing; JSON results can be
+ * diffed across commits with Google Benchmark's compare.py.
+ *
+ * Exits non-zero if the headless part of entity_demo's frame (its
+ * arena-backed FrameCtx plus the threaded trait tick) allocates from the
+ * heap once warmed up. Drawing needs a GL context and isn't covered.
+ */
+
+#include "aabb_tree.hpp"
+#include "bench.hpp"
+#include "frame_arena.hpp"
+#include "hex_nav.hpp"
+#include "hexgrid_math.hpp"
+#include "ilist.hpp"
+#include "job_system.hpp"
+#include "model_api.hpp"
+#include "snapshot.hpp"
+#include "spatial_hash.hpp"
+
+// The trait registry, frame context and world bounds still live with the entity demo
+#include "../scratch/entity_demo/frame_ctx.hpp"
+#include "../scratch/entity_demo/traits_api.cpp"
+#include "../scratch/entity_demo/world_bbox.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <unordered_set>
+
+// Every global operator new bumps this, for the zero-allocation check in bench_frame_ctx()
+static std::atomic<uint64_t> heap_allocs{0};
+static int steady_state_failures = 0;
+
+void* operator new(size_t n) {
+  heap_allocs.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = malloc(n ? n : 1))
+    return p;
+  throw std::bad_alloc();
+}
+// Out of line, or GCC inlines them into new-expressions and warns about free() on new'd memory
+[[gnu::noinline]] void operator delete(void* p) noexcept { free(p); }
+[[gnu::noinline]] void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ============================================================================
+// things_list
+// ============================================================================
+
+struct BenchItem : thing_base {
+  Vector3 position = {0, 0, 0};
+  Vector3 velocity = {1, 0, 1};
+};
+
+constexpr size_t LIST_N = 4096;
+using BenchList = things_list<BenchItem, LIST_N>;
+
+/// Fill a list to `fill` by adding everything and removing a random subset.
+static void fill_list(BenchList& list, std::vector<thing_ref>& live, double fill) {
+  std::mt19937 rng(1);
+  for (size_t i = 0; i < LIST_N; i++)
+    live.push_back(list.add({}));
+  std::shuffle(live.begin(), live.end(), rng);
+  while ((double)live.size() > fill * LIST_N) {
+    list.remove(live.back());
+    live.pop_back();
+  }
+}
+
+static void bench_things_list() {
+  for (double fill : {0.1, 0.5, 0.9}) {
+    auto list = std::make_unique<BenchList>();
+    std::vector<thing_ref> live;
+    fill_list(*list, live, fill);
+    std::string tag = std::to_string((int)(fill * 100)) + "%";
+
+    Bench::run("things_list/iterate/" + tag, [&] {
+      float sum = 0;
+      for (auto& item : *list)
+        sum += item.position.x;
+      Bench::do_not_optimize(sum);
+    }, (int64_t)live.size());
+
+    std::mt19937 rng(2);
+    Bench::run("things_list/remove_add/" + tag, [&] {
+      size_t i = rng() % live.size();
+      list->remove(live[i]);
+      live[i] = list->add({});
+    });
+  }
+
+  paged_things_list<BenchItem, 256> paged;
+  paged.reserve(LIST_N);
+  std::vector<thing_ref> refs;
+  for (size_t i = 0; i < LIST_N; i++)
+    refs.push_back(paged.add({}));
+  for (size_t i = 0; i < LIST_N; i += 2)
+    paged.remove(refs[i]);
+  Bench::run("paged_things_list/iterate/50%", [&] {
+    float sum = 0;
+    for (auto& item : paged)
+      sum += item.position.x;
+    Bench::do_not_optimize(sum);
+  }, (int64_t)paged.size());
+}
+
+// ============================================================================
+// hex math
+// ============================================================================
+
+static void bench_hex() {
+  for (int radius : {10, 50}) {
+    Bench::run("grid_hexagon/r" + std::to_string(radius), [&] {
+      auto grid = grid_hexagon(radius);
+      Bench::do_not_optimize(grid.data());
+    }, 3 * radius * (radius + 1) + 1);
+  }
+
+  Layout layout(layout_pointy, Point{1, 1}, Point{0, 0});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {50}; // radius
+  layout.n_hex = UINT_MAX; // ray_hex over the whole map
+
+  constexpr int POINTS = 100000;
+  std::vector<Point> points(POINTS);
+  std::vector<Ray> rays(POINTS);
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<float> coord(-80.0f, 80.0f);
+  for (int i = 0; i < POINTS; i++) {
+    points[i] = {coord(rng), coord(rng)};
+    Vector3 target = {points[i].x, 0, points[i].y};
+    Vector3 eye = {0, 40, -40};
+    rays[i] = {eye, Vector3Normalize(Vector3Subtract(target, eye))};
+  }
+
+  Bench::run("pixel_to_hex_fractional/100k", [&] {
+    double sum = 0;
+    for (const Point& p : points)
+      sum += pixel_to_hex_fractional(layout, p).q;
+    Bench::do_not_optimize(sum);
+  }, POINTS);
+
+  Bench::run("hex_round+pixel_to_hex/100k", [&] {
+    int sum = 0;
+    for (const Point& p : points)
+      sum += hex_round(pixel_to_hex_fractional(layout, p)).q;
+    Bench::do_not_optimize(sum);
+  }, POINTS);
+
+  std::vector<Hex> picked(POINTS, Hex(0, 0));
+  Bench::run("pixel_to_hex_batch/100k", [&] {
+    pixel_to_hex_batch<hex_batch::Kind::Pointy>(layout, points, picked);
+    Bench::do_not_optimize(picked.data());
+  }, POINTS);
+
+  // Bulk layout of a ~10k hex map (radius 57 = 9919 hexes)
+  std::vector<Hex> map_hexes = grid_hexagon(57);
+  std::vector<Point> centers(map_hexes.size());
+  std::vector<Vector3> world(map_hexes.size());
+  Bench::run("hex_to_pixel/10k", [&] {
+    for (size_t i = 0; i < map_hexes.size(); i++)
+      centers[i] = hex_to_pixel(layout, map_hexes[i]);
+    Bench::do_not_optimize(centers.data());
+  }, (int64_t)map_hexes.size());
+  Bench::run("hex_to_pixel_batch/10k", [&] {
+    hex_to_pixel_batch<hex_batch::Kind::Pointy>(layout, map_hexes, centers);
+    Bench::do_not_optimize(centers.data());
+  }, (int64_t)map_hexes.size());
+  Bench::run("hex_to_world_batch/10k", [&] {
+    hex_to_world_batch<hex_batch::Kind::Pointy>(layout, map_hexes, world);
+    Bench::do_not_optimize(world.data());
+  }, (int64_t)map_hexes.size());
+
+  // mouseray_hex without the mouse: same plane hit, rounding and id lookup
+  Bench::run("ray_hex/100k", [&] {
+    uint hits = 0;
+    for (const Ray& r : rays)
+      hits += ray_hex(layout, r) != UINT_MAX;
+    Bench::do_not_optimize(hits);
+  }, POINTS);
+
+  uint hex_count = layout.size();
+  Bench::run("layout_index/100k", [&] {
+    int sum = 0;
+    for (int i = 0; i < POINTS; i++)
+      sum += layout[(uint)i % hex_count].q;
+    Bench::do_not_optimize(sum);
+  }, POINTS);
+
+  // Navigation on the same r50 grid, 10% walls: a frame's worth of unit paths,
+  // one shared flow field, and a unit's field of view
+  HexCostMap map(layout);
+  for (uint id = 1; id < map.size(); id++)
+    if (rng() % 10 == 0)
+      map.set_wall(id, true);
+  uint center = map.find(Hex(0, 0));
+  constexpr int UNITS = 200;
+  vector<std::pair<uint, uint>> trips(UNITS);
+  for (auto& [from, to] : trips) {
+    from = rng() % map.size();
+    to = rng() % map.size();
+  }
+  HexPathfinder astar;
+  vector<uint> path;
+  Bench::run("hex_astar/r50/200", [&] {
+    size_t steps = 0;
+    for (auto [from, to] : trips) {
+      astar.find_path(map, from, to, path);
+      steps += path.size();
+    }
+    Bench::do_not_optimize(steps);
+  }, UNITS);
+
+  HexFlowField flow;
+  vector<uint> goals = {center, map.find(Hex(40, -20)), map.find(Hex(-30, 45))};
+  Bench::run("hex_flow_field/r50", [&] {
+    flow.build(map, goals);
+    Bench::do_not_optimize(flow.distance.data());
+  }, map.size());
+
+  HexFov fov;
+  Bench::run("hex_fov/r12", [&] {
+    fov.compute(map, center, 12);
+    Bench::do_not_optimize(fov.seen.size());
+  });
+}
+
+// ============================================================================
+// headless frame: bounds, picking, broad phase, pair set, trait tick
+// ============================================================================
+
+struct BenchEntity : thing_base {
+  ModelInstance model;
+  Vector3 position = {0, 0, 0};
+  float scale = 1.0f;
+  TraitMask trait_mask = 0;
+};
+
+using BenchEntities = paged_things_list<BenchEntity, 256>;
+using BenchPair = std::pair<thing_ref, thing_ref>;
+
+struct BenchPairHash {
+  size_t operator()(const BenchPair& p) const {
+    return std::hash<uint64_t>{}(((uint64_t)(uint32_t)p.first.idx << 32) |
+                                 (uint32_t)p.second.idx);
+  }
+};
+
+TRAIT_TAG(BenchWander, "bench_wander");
+
+static void drift(void* p) {
+  auto* e = static_cast<BenchEntity*>(p);
+  e->position.x += 0.001f;
+}
+
+static void bench_frame() {
+  ModelAPI::load("bench_cube", Mesh{0}); // no GL needed; bounds fall back to the unit box
+  ModelHandle cube = ModelAPI::handle("bench_cube");
+  int wander = TraitAPI::register_trait(BenchWander::name, nullptr, drift, true);
+  JobSystem jobs;
+  jobs.start();
+
+  for (int n : {1000, 10000}) {
+    BenchEntities ents;
+    ents.reserve((size_t)n);
+    std::mt19937 rng(4);
+    float extent = sqrtf((float)n) * 1.5f; // roughly constant density
+    std::uniform_real_distribution<float> coord(-extent, extent);
+    for (int i = 0; i < n; i++) {
+      BenchEntity e;
+      e.model = ModelAPI::instance(cube);
+      e.position = {coord(rng), 0, coord(rng)};
+      thing_ref ref = ents.add(e);
+      if (i % 4 == 0)
+        TraitAPI::apply(ents[ref], wander);
+    }
+    std::string tag = "/" + std::to_string(n);
+
+    Bench::run("compute_world_bbox" + tag, [&] {
+      float sum = 0;
+      for (auto& e : ents)
+        sum += compute_world_bbox(e).max.x;
+      Bench::do_not_optimize(sum);
+    }, n);
+
+    // Hover: linear ray scan (the old picking loop) vs the bounds tree
+    Ray ray = {{0, 30, -extent}, Vector3Normalize({0.2f, -30, extent})};
+    Bench::run("pick_linear" + tag, [&] {
+      int hits = 0;
+      for (auto& e : ents)
+        hits += GetRayCollisionBox(ray, compute_world_bbox(e)).hit;
+      Bench::do_not_optimize(hits);
+    }, n);
+
+    AabbTree<thing_ref> tree;
+    std::vector<int> proxies;
+    for (auto& e : ents)
+      proxies.push_back(tree.insert(compute_world_bbox(e), e.this_ref()));
+    Bench::run("pick_aabb_tree" + tag, [&] {
+      int hits = 0;
+      tree.raycast(ray, [&](thing_ref&, int, float) { hits++; });
+      Bench::do_not_optimize(hits);
+    }, n);
+
+    // The per-frame refit entity_demo does in sync_bounds(), with nothing leaving its fat box
+    Bench::run("aabb_tree_refit" + tag, [&] {
+      size_t i = 0;
+      int moved = 0;
+      for (auto& e : ents)
+        moved += tree.move(proxies[i++], compute_world_bbox(e));
+      Bench::do_not_optimize(moved);
+    }, n);
+
+    Bench::run("aabb_tree_pairs_jobs" + tag, [&] {
+      Bench::do_not_optimize(tree.overlapping_pairs(jobs).size());
+    }, n);
+
+    SpatialHash hash;
+    hash.cell_size = 2.0f;
+    std::vector<thing_ref> collidables;
+    std::unordered_set<BenchPair, BenchPairHash> pairs;
+    Bench::run("frame_collisions" + tag, [&] {
+      collidables.clear();
+      hash.clear();
+      pairs.clear();
+      for (auto& e : ents) {
+        collidables.push_back(e.this_ref());
+        hash.insert(compute_world_bbox(e));
+      }
+      for (auto [i, j] : hash.overlapping_pairs()) {
+        pairs.insert({collidables[i], collidables[j]});
+        pairs.insert({collidables[j], collidables[i]});
+      }
+      Bench::do_not_optimize(pairs.size());
+    }, n);
+
+    Bench::run("narrow_phase" + tag, [&] {
+      Bench::do_not_optimize(hash.overlapping_pairs().size());
+    }, n);
+    Bench::run("narrow_phase_jobs" + tag, [&] {
+      Bench::do_not_optimize(hash.overlapping_pairs(jobs).size());
+    }, n);
+
+    Bench::run("trait_tick_all" + tag, [&] { TraitAPI::tick_all(ents); }, n / 4);
+    Bench::run("trait_tick_all_jobs" + tag, [&] { TraitAPI::tick_all(ents, jobs); }, n / 4);
+
+    Bench::run("trait_each" + tag, [&] {
+      int visited = 0;
+      TraitAPI::each<BenchWander>(ents, [&](BenchEntity&) { visited++; });
+      Bench::do_not_optimize(visited);
+    }, n / 4);
+
+    for (auto& e : ents)
+      TraitAPI::clear(e);
+  }
+}
+
+// ============================================================================
+// frame context: entity_demo's per-frame containers, heap vs frame arena
+// ============================================================================
+
+/// Baseline: entity_demo's FrameCtx as it was before the arena, rebuilt from scratch every frame
+struct HeapFrameCtx {
+  std::vector<GameCtxAPI::FrameCtx::RayHit> under_mouse;
+  std::vector<BenchPair> collision_pairs;
+  std::vector<thing_ref> hovered;
+  std::unordered_set<BenchPair, BenchPairHash> dragging; // keyed on pairs to reuse the hash
+};
+
+/**
+ * One frame of entity_demo's update() bookkeeping: expiry list, ray hits,
+ * hover, drag set carried over from last frame, sorted collision pairs
+ * diffed against last frame's, and a label per new pair.
+ */
+template <typename Ctx, typename Vec, typename Drag, typename Label>
+static size_t frame_work(Ctx& frame, const Ctx& last, Vec& expired, Drag&& drag,
+                         const std::vector<thing_ref>& refs, const std::vector<BenchPair>& pairs,
+                         Label&& label) {
+  for (size_t i = 0; i < refs.size(); i += 16)
+    expired.push_back(refs[i]);
+  for (size_t i = 0; i < 32; i++)
+    frame.under_mouse.push_back({refs[i * 7 % refs.size()], (float)i});
+  frame.hovered.push_back(frame.under_mouse.front().ref);
+  for (size_t i = 0; i < 8; i++)
+    drag(refs[i * 3]);
+  frame.collision_pairs.reserve(pairs.size() * 2);
+  for (auto [a, b] : pairs) {
+    frame.collision_pairs.push_back({a, b});
+    frame.collision_pairs.push_back({b, a});
+  }
+  std::sort(frame.collision_pairs.begin(), frame.collision_pairs.end());
+  size_t chars = 0;
+  int fresh = 0;
+  for (auto& pair : frame.collision_pairs)
+    if (!std::binary_search(last.collision_pairs.begin(), last.collision_pairs.end(), pair) &&
+        fresh++ < 8)
+      chars += strlen(label("hit %d", pair.first.idx));
+  return chars + expired.size() + last.dragging.size();
+}
+
+static void bench_frame_ctx() {
+  BenchEntities ents;
+  std::vector<thing_ref> refs;
+  int wander = TraitAPI::register_trait(BenchWander::name, nullptr, drift, true);
+  for (int i = 0; i < 1000; i++) {
+    refs.push_back(ents.add({}));
+    TraitAPI::apply(ents[refs.back()], wander);
+  }
+  JobSystem jobs;
+  jobs.start(3); // 1000 members in 256-wide chunks: the tick really goes through the queues
+  std::mt19937 rng(5);
+  std::vector<BenchPair> pairs(400);
+  for (auto& [a, b] : pairs) {
+    a = refs[rng() % refs.size()];
+    b = refs[rng() % refs.size()];
+  }
+  uint64_t frame_no = 0;
+
+  HeapFrameCtx heap_frames[2];
+  Bench::run("frame_ctx_heap/1000", [&] {
+    HeapFrameCtx& last = heap_frames[frame_no & 1];
+    HeapFrameCtx& frame = heap_frames[++frame_no & 1];
+    frame = HeapFrameCtx{};
+    std::vector<thing_ref> expired;
+    pairs[frame_no % pairs.size()].second = refs[frame_no % refs.size()];
+    Bench::do_not_optimize(frame_work(
+        frame, last, expired, [&](thing_ref r) { frame.dragging.insert({r, r}); }, refs, pairs,
+        [](const char* fmt, int n) { return TextFormat(fmt, n); }));
+  });
+
+  // The demo's own FrameBuffer, advanced the way update() does
+  static GameCtxAPI::FrameBuffer frames;
+  auto arena_frame = [&] {
+    ++frame_no;
+    frames.advance();
+    GameCtxAPI::FrameCtx& frame = frames.current();
+    FrameArena& arena = frames.arena();
+    ArenaVector<thing_ref> expired(arena);
+    pairs[frame_no % pairs.size()].second = refs[frame_no % refs.size()];
+    Bench::do_not_optimize(frame_work(
+        frame, frames.previous(), expired, [&](thing_ref r) { frame.dragging.insert(r); }, refs,
+        pairs, [&](const char* fmt, int n) { return arena.format(fmt, n); }));
+  };
+  Bench::run("frame_ctx_arena/1000", arena_frame);
+
+  // The allocation check also runs update()'s threaded trait tick, the real TraitAPI::tick_all.
+  // Warm up here too in case --filter skipped the run above; any allocation after is a regression
+  auto steady_frame = [&] {
+    arena_frame();
+    TraitAPI::tick_all(ents, jobs);
+  };
+  for (int i = 0; i < 4; i++)
+    steady_frame();
+  uint64_t before = heap_allocs.load();
+  for (int i = 0; i < 1000; i++)
+    steady_frame();
+  uint64_t allocs = heap_allocs.load() - before;
+  printf("frame_ctx_arena + tick_all(jobs): %llu heap allocations in 1000 frames\n",
+         (unsigned long long)allocs);
+  if (allocs)
+    steady_state_failures++;
+
+  for (auto& e : ents)
+    TraitAPI::clear(e);
+}
+
+static void bench_snapshot() {
+  BenchEntities ents;
+  std::vector<thing_ref> refs;
+  for (int i = 0; i < 10000; i++)
+    refs.push_back(ents.add({.position = {(float)i, 0, 0}}));
+  for (size_t i = 0; i < refs.size(); i += 3) // leave holes, like a scene mid-game
+    ents.remove(refs[i]);
+
+  SnapshotWriter out;
+  Bench::run("snapshot_write_raw/10000", [&] {
+    out.bytes.clear();
+    ents.write_raw(out);
+    Bench::do_not_optimize(out.bytes.size());
+  }, 10000);
+
+  BenchEntities loaded;
+  Bench::run("snapshot_read_raw/10000", [&] {
+    SnapshotReader in(out.bytes);
+    Bench::do_not_optimize(loaded.read_raw(in));
+  }, 10000);
+}
+
+int main(int argc, char** argv) {
+  std::string out;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--out") && i + 1 < argc)
+      out = argv[++i];
+    else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+      Bench::filter = argv[++i];
+    else if (!strcmp(argv[i], "--min-time") && i + 1 < argc)
+      Bench::min_time = atof(argv[++i]);
+    else {
+      printf("usage: %s [--out results.json] [--filter substring] [--min-time seconds]\n",
+             argv[0]);
+      return 1;
+    }
+  }
+  SetTraceLogLevel(LOG_WARNING);
+
+  bench_things_list();
+  bench_hex();
+  bench_frame();
+  bench_frame_ctx();
+  bench_snapshot();
+
+  if (!out.empty()) {
+    if (!Bench::write_json(out)) {
+      fprintf(stderr, "failed to write %s\n", out.c_str());
+      return 1;
+    }
+    printf("wrote %s\n", out.c_str());
+  }
+  ModelAPI::unload_all();
+  return steady_state_failures ? 1 : 0;
+}
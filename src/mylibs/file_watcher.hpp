@@ -0,0 +1,308 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="file watcher*"
+exit
+#endif
+/**
+ * @file file_watcher.hpp
+ * @brief Debounced file / directory change notifications (inotify, stat polling fallback)
+ *
+ * Files are watched through their parent directory, so editors and
+ * exporters that write a temp file and rename it over the original are
+ * still seen. Every event only marks a path as dirty; poll() reports it
+ * once it has been quiet for `debounce` seconds, so a file written in
+ * several chunks is reported once, after the writer is done.
+ *
+ * Without inotify (non-Linux, or inotify_init failing) watched files are
+ * stat()ed every `poll_interval` seconds instead; directory watches need
+ * inotify.
+ *
+ * Usage:
+ *   FileWatcher watcher;
+ *   watcher.watch_file("assets/hotload.glb");
+ *   for (const std::string& path : watcher.poll()) reload(path); // once per frame
+ */
+
+#pragma once
+#include <chrono>
+#include <string>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+struct FileWatcher {
+  double debounce = 0.25;     ///< Seconds without events before a change is reported
+  double poll_interval = 0.5; ///< Polling fallback only
+
+  struct Stamp {
+    time_t mtime = 0;
+    off_t size = -1;
+  };
+
+  int fd = -1;
+  bool polling = false;
+  std::unordered_map<int, std::string> dir_of_wd;
+  std::unordered_map<std::string, int> wd_of_dir;
+  std::unordered_map<std::string, std::string> files; ///< "dir/name" -> path as given
+  std::unordered_map<std::string, bool> whole_dirs;   ///< dirs watched for any file
+  std::unordered_map<std::string, double> pending;    ///< path -> time of last event
+  std::unordered_map<std::string, Stamp> stamps;      ///< polling fallback state
+  double last_scan = -1e9;
+
+  FileWatcher() {
+#ifdef __linux__
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+    polling = fd < 0;
+  }
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  ~FileWatcher() { close(); }
+
+  /// @brief Switch to stat() polling (drops the native backend). For tests and odd filesystems.
+  void use_polling() {
+    close();
+    polling = true;
+    for (auto& [key, path] : files)
+      stamps[path] = stat_of(path);
+  }
+
+  /// @brief Watch one file. It may not exist yet; its creation counts as a change.
+  bool watch_file(const std::string& path) {
+    std::string dir = dir_of(path);
+    if (!polling && !watch_directory(dir))
+      return false;
+    files[dir + "/" + name_of(path)] = path;
+    stamps[path] = stat_of(path);
+    return true;
+  }
+
+  /// @brief Watch every file directly inside a directory (not recursive). Needs inotify.
+  bool watch_dir(const std::string& path) {
+    std::string dir = path;
+    if (dir.size() > 1 && dir.back() == '/')
+      dir.pop_back();
+    if (polling || !watch_directory(dir))
+      return false;
+    whole_dirs[dir] = true;
+    return true;
+  }
+
+  bool watching(const std::string& path) const {
+    return files.count(dir_of(path) + "/" + name_of(path)) != 0;
+  }
+
+  /// @brief Stop watching everything; the backend stays open.
+  void clear() {
+#ifdef __linux__
+    for (auto& [wd, dir] : dir_of_wd)
+      inotify_rm_watch(fd, wd);
+#endif
+    dir_of_wd.clear();
+    wd_of_dir.clear();
+    files.clear();
+    whole_dirs.clear();
+    pending.clear();
+    stamps.clear();
+  }
+
+  /**
+   * @brief Collect events and return the paths that have settled.
+   * Each change is reported once, `debounce` seconds after its last event.
+   * @param now Time in seconds (defaults to a steady clock)
+   */
+  std::vector<std::string> poll(double now = clock_seconds()) {
+    if (polling)
+      scan(now);
+    else
+      drain(now);
+
+    std::vector<std::string> ready;
+    for (auto it = pending.begin(); it != pending.end();) {
+      if (now - it->second >= debounce) {
+        ready.push_back(it->first);
+        it = pending.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return ready;
+  }
+
+  static double clock_seconds() {
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+  }
+
+private:
+  void close() {
+#ifdef __linux__
+    if (fd >= 0)
+      ::close(fd);
+#endif
+    fd = -1;
+    dir_of_wd.clear();
+    wd_of_dir.clear();
+  }
+
+  static std::string dir_of(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    if (slash == std::string::npos)
+      return ".";
+    return slash == 0 ? "/" : path.substr(0, slash);
+  }
+
+  static std::string name_of(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+  }
+
+  static Stamp stat_of(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0)
+      return {};
+    return {st.st_mtime, st.st_size};
+  }
+
+  bool watch_directory(const std::string& dir) {
+    if (wd_of_dir.count(dir))
+      return true;
+#ifdef __linux__
+    int wd = inotify_add_watch(fd, dir.c_str(),
+                               IN_CLOSE_WRITE | IN_MODIFY | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+    if (wd < 0)
+      return false;
+    dir_of_wd[wd] = dir;
+    wd_of_dir[dir] = wd;
+    return true;
+#else
+    return false;
+#endif
+  }
+
+  void drain(double now) {
+#ifdef __linux__
+    alignas(inotify_event) char buf[4096];
+    for (;;) {
+      ssize_t n = read(fd, buf, sizeof(buf));
+      if (n <= 0)
+        break;
+      for (ssize_t off = 0; off < n;) {
+        auto* ev = reinterpret_cast<inotify_event*>(buf + off);
+        off += (ssize_t)(sizeof(inotify_event) + ev->len);
+        auto dir = dir_of_wd.find(ev->wd);
+        if (dir == dir_of_wd.end() || ev->len == 0)
+          continue;
+        std::string key = dir->second + "/" + ev->name;
+        auto file = files.find(key);
+        if (file != files.end())
+          pending[file->second] = now;
+        else if (whole_dirs.count(dir->second))
+          pending[key] = now;
+      }
+    }
+#else
+    (void)now;
+#endif
+  }
+
+  void scan(double now) {
+    if (now - last_scan < poll_interval)
+      return;
+    last_scan = now;
+    for (auto& [key, path] : files) {
+      Stamp s = stat_of(path);
+      Stamp& prev = stamps[path];
+      if (s.mtime != prev.mtime || s.size != prev.size) {
+        prev = s;
+        pending[path] = now;
+      }
+    }
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <cstdio>
+#include <doctest/doctest.h>
+#include <fstream>
+
+static void file_watcher_write(const std::string& path, const std::string& text) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out << text;
+}
+
+TEST_CASE("file watcher debounces native events") {
+  std::string dir = "/tmp/file_watcher_test";
+  mkdir(dir.c_str(), 0755);
+  std::string a = dir + "/a.glb";
+  std::string other = dir + "/other.txt";
+  file_watcher_write(a, "v1");
+
+  FileWatcher watcher;
+  if (watcher.polling) {
+    MESSAGE("inotify unavailable, skipping native backend test");
+    return;
+  }
+  REQUIRE(watcher.watch_file(a));
+  CHECK(watcher.watching(a));
+  CHECK(watcher.poll(0.0).empty());
+
+  // Several writes in a burst, plus an unwatched file in the same directory
+  file_watcher_write(a, "v2");
+  file_watcher_write(a, "v2 and more");
+  file_watcher_write(other, "x");
+  CHECK(watcher.poll(10.0).empty()); // events just arrived: still settling
+  CHECK(watcher.poll(10.1).empty());
+  auto ready = watcher.poll(10.3);
+  REQUIRE(ready.size() == 1);
+  CHECK(ready[0] == a);
+  CHECK(watcher.poll(20.0).empty()); // reported once
+
+  // Replace by rename (what exporters writing a temp file do)
+  file_watcher_write(dir + "/a.tmp", "v3");
+  std::rename((dir + "/a.tmp").c_str(), a.c_str());
+  watcher.poll(30.0);
+  ready = watcher.poll(31.0);
+  REQUIRE(ready.size() == 1);
+  CHECK(ready[0] == a);
+
+  // Whole-directory watch reports any file
+  REQUIRE(watcher.watch_dir(dir));
+  file_watcher_write(other, "y");
+  watcher.poll(40.0);
+  ready = watcher.poll(41.0);
+  REQUIRE(ready.size() == 1);
+  CHECK(ready[0] == other);
+
+  std::remove(a.c_str());
+  std::remove(other.c_str());
+  rmdir(dir.c_str());
+}
+
+TEST_CASE("file watcher polling fallback") {
+  std::string path = "/tmp/file_watcher_poll.txt";
+  file_watcher_write(path, "one");
+
+  FileWatcher watcher;
+  watcher.use_polling();
+  watcher.debounce = 0.0;
+  REQUIRE(watcher.watch_file(path));
+  CHECK(watcher.poll(0.0).empty());
+
+  file_watcher_write(path, "three"); // size changes even within one mtime second
+  CHECK(watcher.poll(0.1).empty());  // inside poll_interval: not scanned yet
+  auto ready = watcher.poll(1.0);
+  REQUIRE(ready.size() == 1);
+  CHECK(ready[0] == path);
+  CHECK(watcher.poll(2.0).empty());
+  std::remove(path.c_str());
+}
+
+#endif
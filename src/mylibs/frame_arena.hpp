@@ -0,0 +1,275 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="frame arena*"
+exit
+#endif
+/**
+ * @file frame_arena.hpp
+ * @brief Linear per-frame allocator with arena-backed vector, flat set and string types
+ *
+ * Everything allocated from a FrameArena is released at once by reset();
+ * deallocate is a no-op. The arena keeps its memory across resets: if a
+ * frame overflowed the first block, reset() replaces the blocks with one
+ * block as large as all of them together, so after a frame or two of
+ * warm-up a steady workload never touches the heap.
+ *
+ * Containers take the arena through ArenaAllocator. A default-constructed
+ * allocator has no arena and falls back to the heap, so the same types
+ * work outside a frame too.
+ *
+ * Usage (double-buffered, so last frame's data stays readable):
+ *   FrameArena arenas[2];
+ *   arenas[cur ^= 1].reset();                 // containers from two frames ago must be gone
+ *   ArenaVector<thing_ref> hits(arenas[cur]);
+ *   const char* label = arenas[cur].format("hit %s", name);
+ */
+
+#pragma once
+#include <algorithm>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+struct FrameArena {
+  struct Block {
+    std::unique_ptr<std::byte[]> data;
+    size_t size = 0;
+  };
+
+  std::vector<Block> blocks; ///< Allocations go to blocks.back()
+  size_t used = 0;           ///< Bytes taken from blocks.back()
+  size_t first_block = size_t(64) << 10;
+  size_t bytes = 0;         ///< Requested since the last reset(), including alignment padding
+  size_t high_water = 0;    ///< Largest `bytes` seen at a reset()
+  uint64_t heap_blocks = 0; ///< Blocks ever taken from the heap; stops growing once warmed up
+
+  FrameArena() = default;
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  size_t capacity() const {
+    size_t total = 0;
+    for (const Block& b : blocks)
+      total += b.size;
+    return total;
+  }
+
+  void* allocate(size_t n, size_t align = alignof(std::max_align_t)) {
+    if (blocks.empty())
+      add_block(std::max(first_block, n + align));
+    uintptr_t base = (uintptr_t)blocks.back().data.get();
+    size_t start = ((base + used + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    if (start + n > blocks.back().size) {
+      add_block(std::max(blocks.back().size * 2, n + align));
+      base = (uintptr_t)blocks.back().data.get();
+      start = ((base + align - 1) & ~(uintptr_t)(align - 1)) - base;
+    }
+    bytes += start - used + n;
+    used = start + n;
+    return blocks.back().data.get() + start;
+  }
+
+  template <typename T> T* alloc_array(size_t n) {
+    return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+  }
+
+  /// @brief Release everything allocated since the last reset(); keeps (and merges) the memory.
+  void reset() {
+    high_water = std::max(high_water, bytes);
+    if (blocks.size() > 1) {
+      size_t total = capacity();
+      blocks.clear();
+      add_block(total);
+    }
+    used = 0;
+    bytes = 0;
+  }
+
+  /// @brief Copy a string into the arena, NUL-terminated.
+  const char* copy(std::string_view s) {
+    char* out = alloc_array<char>(s.size() + 1);
+    std::copy(s.begin(), s.end(), out);
+    out[s.size()] = '\0';
+    return out;
+  }
+
+  /// @brief printf into the arena; valid until the next reset().
+  const char* format(const char* fmt, ...)
+#if defined(__GNUC__) || defined(__clang__)
+      __attribute__((format(printf, 2, 3)))
+#endif
+  {
+    va_list args;
+    va_start(args, fmt);
+    va_list again;
+    va_copy(again, args);
+    int n = vsnprintf(nullptr, 0, fmt, args);
+    va_end(args);
+    char* out = alloc_array<char>(n > 0 ? (size_t)n + 1 : 1);
+    if (n > 0)
+      vsnprintf(out, (size_t)n + 1, fmt, again);
+    else
+      out[0] = '\0';
+    va_end(again);
+    return out;
+  }
+
+private:
+  void add_block(size_t size) {
+    blocks.push_back({std::make_unique<std::byte[]>(size), size});
+    used = 0;
+    heap_blocks++;
+  }
+};
+
+/// @brief std allocator over a FrameArena; with no arena it uses the heap.
+template <typename T> struct ArenaAllocator {
+  using value_type = T;
+  FrameArena* arena = nullptr;
+
+  ArenaAllocator() = default;
+  ArenaAllocator(FrameArena& a) : arena(&a) {}
+  template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+  T* allocate(size_t n) {
+    if (arena)
+      return arena->alloc_array<T>(n);
+    return static_cast<T*>(::operator new(n * sizeof(T)));
+  }
+  void deallocate(T* p, size_t) {
+    if (!arena)
+      ::operator delete(p);
+  }
+
+  template <typename U> bool operator==(const ArenaAllocator<U>& other) const {
+    return arena == other.arena;
+  }
+};
+
+template <typename T> using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+/**
+ * @brief Sorted-vector set for the handful of refs a frame tracks (dragged, selected, ...).
+ * Inserts are O(n), lookups a binary search; iteration is in sorted order.
+ */
+template <typename T> struct ArenaFlatSet {
+  ArenaVector<T> items;
+
+  ArenaFlatSet() = default;
+  explicit ArenaFlatSet(FrameArena& arena) : items(ArenaAllocator<T>(arena)) {}
+
+  bool insert(const T& value) {
+    auto it = std::lower_bound(items.begin(), items.end(), value);
+    if (it != items.end() && *it == value)
+      return false;
+    items.insert(it, value);
+    return true;
+  }
+
+  bool erase(const T& value) {
+    auto it = std::lower_bound(items.begin(), items.end(), value);
+    if (it == items.end() || !(*it == value))
+      return false;
+    items.erase(it);
+    return true;
+  }
+
+  bool contains(const T& value) const {
+    return std::binary_search(items.begin(), items.end(), value);
+  }
+  size_t count(const T& value) const { return contains(value) ? 1 : 0; }
+  size_t size() const { return items.size(); }
+  bool empty() const { return items.empty(); }
+  void clear() { items.clear(); }
+  void reserve(size_t n) { items.reserve(n); }
+  auto begin() const { return items.begin(); }
+  auto end() const { return items.end(); }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("frame arena allocates linearly and merges blocks on reset") {
+  FrameArena arena;
+  arena.first_block = 256;
+
+  auto* a = arena.alloc_array<uint8_t>(3);
+  auto* d = arena.alloc_array<double>(2);
+  CHECK((uintptr_t)d % alignof(double) == 0);
+  CHECK((std::byte*)d > (std::byte*)a);
+  CHECK(arena.heap_blocks == 1);
+
+  // Overflow the first block: a second one is added, and reset() merges them
+  for (int i = 0; i < 10; i++)
+    arena.allocate(100);
+  CHECK(arena.blocks.size() > 1);
+  size_t total = arena.capacity();
+  uint64_t blocks_before = arena.heap_blocks;
+  arena.reset();
+  CHECK(arena.blocks.size() == 1);
+  CHECK(arena.capacity() == total);
+  CHECK(arena.heap_blocks == blocks_before + 1);
+  CHECK(arena.high_water >= 1000);
+  CHECK(arena.bytes == 0);
+
+  // The same workload now fits: no more heap blocks, frame after frame
+  for (int frame = 0; frame < 5; frame++) {
+    arena.reset();
+    for (int i = 0; i < 10; i++)
+      arena.allocate(100);
+  }
+  CHECK(arena.heap_blocks == blocks_before + 1);
+
+  arena.reset();
+  CHECK(std::string_view(arena.copy("abc")) == "abc");
+  CHECK(std::string_view(arena.format("hit %s (%.1f)", "cube", 2.5)) == "hit cube (2.5)");
+  CHECK(std::string_view(arena.format("%s", "")) == "");
+}
+
+TEST_CASE("frame arena containers") {
+  FrameArena arena;
+  ArenaVector<int> v(arena);
+  for (int i = 0; i < 1000; i++)
+    v.push_back(i);
+  CHECK(v.size() == 1000);
+  CHECK(v[999] == 999);
+  CHECK(arena.bytes >= 1000 * sizeof(int));
+
+  ArenaString s(arena);
+  s = "a string longer than the small-string buffer";
+  s += " and then some";
+  CHECK(s.size() == 58);
+  CHECK(arena.bytes >= s.size());
+
+  ArenaFlatSet<int> set(arena);
+  CHECK(set.insert(5));
+  CHECK(set.insert(1));
+  CHECK(set.insert(3));
+  CHECK_FALSE(set.insert(3));
+  CHECK(set.size() == 3);
+  CHECK(set.count(3) == 1);
+  CHECK(set.count(4) == 0);
+  CHECK(std::vector<int>(set.begin(), set.end()) == std::vector<int>{1, 3, 5});
+  CHECK(set.erase(3));
+  CHECK_FALSE(set.erase(3));
+  CHECK(set.size() == 2);
+
+  // No arena: plain heap containers
+  ArenaVector<int> heap;
+  heap.assign(100, 7);
+  CHECK(heap.size() == 100);
+  ArenaFlatSet<int> heap_set;
+  heap_set.insert(2);
+  CHECK(heap_set.contains(2));
+}
+
+#endif
@@ -4,16 +4,238 @@ exit
 #endif
 #pragma once
 #include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <fstream>
 #include <functional>
 #include <imgui.h>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <typeinfo>
 #include <unordered_map>
 #include <vector>
 
+enum class LogLevel : uint8_t { Debug, Info, Warn, Error };
+
+inline const char* log_level_name(LogLevel level) {
+  static const char* names[] = {"debug", "info", "warn", "error"};
+  return names[(int)level];
+}
+
+/**
+ * @brief Fixed-capacity log: a ring of line records over one contiguous text buffer.
+ *
+ * Each line's text is stored unbroken (a line that would straddle the end
+ * of the buffer starts over at offset 0), so it can be handed to ImGui as
+ * a begin/end pair. Running out of either text bytes or line slots drops
+ * the oldest lines; nothing allocates after init().
+ */
+struct ConsoleLog {
+  struct Line {
+    uint32_t offset = 0;
+    uint32_t size = 0;
+    LogLevel level = LogLevel::Info;
+  };
+
+  std::vector<char> text;
+  std::vector<Line> lines; ///< Ring: the i-th oldest line is lines[(first + i) % lines.size()]
+  size_t first = 0;
+  size_t count = 0;
+  size_t head = 0;      ///< Where the next line's text goes
+  uint64_t dropped = 0; ///< Lines pushed out by newer ones since init()
+  uint64_t oldest = 0;  ///< Sequence number of line(0); line(i) is oldest + i
+  uint32_t resets = 0;  ///< Bumped by init(), so sequence-keyed views know to start over
+
+  explicit ConsoleLog(size_t text_bytes = size_t(1) << 20, size_t max_lines = 16384) {
+    init(text_bytes, max_lines);
+  }
+
+  void init(size_t text_bytes, size_t max_lines) {
+    text.assign(std::max<size_t>(text_bytes, 1), '\0');
+    lines.assign(std::max<size_t>(max_lines, 1), {});
+    clear();
+    dropped = 0;
+    oldest = 0;
+    resets++;
+  }
+
+  void clear() {
+    oldest += count;
+    first = 0;
+    count = 0;
+    head = 0;
+  }
+
+  size_t size() const { return count; }
+  const Line& line(size_t i) const { return lines[(first + i) % lines.size()]; }
+  std::string_view str(size_t i) const {
+    const Line& l = line(i);
+    return {text.data() + l.offset, l.size};
+  }
+
+  /// @brief Append one line (no '\n' expected); text past the buffer size is cut off.
+  void push(std::string_view s, LogLevel level = LogLevel::Info) {
+    s = s.substr(0, std::min(s.size(), text.size()));
+    if (head + s.size() > text.size()) {
+      drop_overlapping(head, text.size());
+      head = 0;
+    }
+    drop_overlapping(head, head + s.size());
+    if (count == lines.size())
+      drop_oldest();
+    std::copy(s.begin(), s.end(), text.begin() + head);
+    lines[(first + count) % lines.size()] = {(uint32_t)head, (uint32_t)s.size(), level};
+    count++;
+    head += s.size();
+  }
+
+private:
+  void drop_oldest() {
+    first = (first + 1) % lines.size();
+    count--;
+    dropped++;
+    oldest++;
+  }
+
+  // Text is written in order, so the lines in the way are always the oldest ones
+  void drop_overlapping(size_t lo, size_t hi) {
+    while (count) {
+      const Line& l = lines[first];
+      if (l.offset >= hi || l.offset + std::max<size_t>(l.size, 1) <= lo)
+        return;
+      drop_oldest();
+    }
+  }
+};
+
+/**
+ * @brief The lines of a ConsoleLog at or above a level, kept up to date incrementally.
+ *
+ * update() only scans lines pushed since the last call and forgets the ones
+ * the log has dropped, so a steady frame costs the new lines, not the whole
+ * log. Changing the level (or re-init()ing the log) rescans once.
+ */
+struct ConsoleFilter {
+  std::vector<uint64_t> seqs; ///< Sequence numbers of the shown lines, oldest first, from `start`
+  size_t start = 0;
+  uint64_t scanned = 0; ///< Sequence number of the first line not looked at yet
+  LogLevel level = LogLevel::Info;
+  uint32_t resets = 0;
+  bool built = false;
+
+  void update(const ConsoleLog& log, LogLevel min_level) {
+    if (!built || min_level != level || log.resets != resets) {
+      seqs.clear();
+      seqs.reserve(log.lines.size());
+      start = 0;
+      scanned = log.oldest;
+      level = min_level;
+      resets = log.resets;
+      built = true;
+    }
+    while (start < seqs.size() && seqs[start] < log.oldest)
+      start++;
+    if (start > seqs.size() / 2) { // compact now and then; amortised O(1) per line
+      seqs.erase(seqs.begin(), seqs.begin() + (long)start);
+      start = 0;
+    }
+    uint64_t end = log.oldest + log.size();
+    for (uint64_t seq = std::max(scanned, log.oldest); seq < end; seq++)
+      if (log.line((size_t)(seq - log.oldest)).level >= level)
+        seqs.push_back(seq);
+    scanned = end;
+  }
+
+  size_t size() const { return seqs.size() - start; }
+  /// @brief Index into the log (for ConsoleLog::line / str) of the row-th shown line
+  size_t line_index(const ConsoleLog& log, size_t row) const {
+    return (size_t)(seqs[start + row] - log.oldest);
+  }
+};
+
+/**
+ * @brief Streams log lines to a file from a background thread.
+ * write() only appends to a buffer under a lock; the thread swaps that
+ * buffer out and does the fwrite/fflush, so the caller never waits on disk.
+ */
+struct LogFileSink {
+  std::thread thread;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::string pending; ///< Written by write(), swapped out by the thread; keeps its capacity
+  bool stopping = false;
+  FILE* file = nullptr;
+
+  LogFileSink() = default;
+  LogFileSink(const LogFileSink&) = delete;
+  LogFileSink& operator=(const LogFileSink&) = delete;
+  ~LogFileSink() { close(); }
+
+  bool open(const std::string& path, bool append = false) {
+    close();
+    file = fopen(path.c_str(), append ? "ab" : "wb");
+    if (!file)
+      return false;
+    stopping = false;
+    thread = std::thread([this] { run(); });
+    return true;
+  }
+
+  bool is_open() const { return file != nullptr; }
+
+  void write(LogLevel level, std::string_view line) {
+    if (!file)
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      pending += '[';
+      pending += log_level_name(level);
+      pending += "] ";
+      pending.append(line);
+      pending += '\n';
+    }
+    wake.notify_one();
+  }
+
+  /// @brief Write out everything buffered, then stop the thread and close the file.
+  void close() {
+    if (!thread.joinable())
+      return;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stopping = true;
+    }
+    wake.notify_one();
+    thread.join();
+    fclose(file);
+    file = nullptr;
+  }
+
+private:
+  void run() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+      wake.wait(lock, [&] { return stopping || !pending.empty(); });
+      batch.swap(pending);
+      bool done = stopping;
+      lock.unlock();
+      if (!batch.empty()) {
+        fwrite(batch.data(), 1, batch.size(), file);
+        fflush(file);
+        batch.clear();
+      }
+      lock.lock();
+      if (done && pending.empty())
+        return;
+    }
+  }
+};
+
 /**
  * @brief In-game developer console with command registration, type-erased context binding, and
  * ImGui terminal.
@@ -21,12 +243,15 @@ exit
  * Namespace-style API with all static functions.
  * Commands are registered via add() or the REGISTER_CMD macro (which uses AutoCmd).
  * Runtime context is bound via bind<T>() and retrieved via ctx<T>().
+ * Output goes to a bounded ConsoleLog (oldest lines drop off) and,
+ * after open_log_file(), to disk through a LogFileSink.
  *
  * @see AutoCmd, REGISTER_CMD, CMD_CTX
  */
 struct GameConsoleAPI {
   using Args = std::vector<std::string>;
   using CmdFn = std::function<std::string(Args& args)>;
+  using Level = LogLevel;
 
   struct Entry {
     CmdFn fn;
@@ -39,11 +264,27 @@ private:
     return c;
   }
 
-  static std::vector<std::string>& log() {
-    static std::vector<std::string> l;
+  static ConsoleLog& log() {
+    static ConsoleLog l;
     return l;
   }
 
+  static LogFileSink& sink() {
+    static LogFileSink s;
+    return s;
+  }
+
+  static Level& verbosityLevel() {
+    static Level v = Level::Info;
+    return v;
+  }
+
+  // Lines at or above the verbosity; only new lines are scanned each frame
+  static ConsoleFilter& shownLines() {
+    static ConsoleFilter s;
+    return s;
+  }
+
   static std::vector<std::string>& history() {
     static std::vector<std::string> h;
     return h;
@@ -161,13 +402,40 @@ public:
       focusInput() = true;
   }
 
-  static void print(const std::string& msg) {
-    log().push_back(msg);
+  /// @brief Log a message; each '\n'-separated line becomes its own entry.
+  static void print(std::string_view msg, Level level = Level::Info) {
+    for (;;) {
+      size_t eol = msg.find('\n');
+      std::string_view line = msg.substr(0, eol);
+      log().push(line, level);
+      sink().write(level, line);
+      if (eol == std::string_view::npos)
+        break;
+      msg.remove_prefix(eol + 1);
+    }
     scrollToBottom() = true;
   }
 
   static void clear() { log().clear(); }
 
+  /// @brief The retained lines, oldest first.
+  static const ConsoleLog& lines() { return log(); }
+
+  /// @brief Resize the log (clears it); defaults are 1 MiB of text and 16384 lines.
+  static void set_log_capacity(size_t text_bytes, size_t max_lines) {
+    log().init(text_bytes, max_lines);
+  }
+
+  /// @brief Lines below this level stay in the log but aren't drawn.
+  static void set_verbosity(Level level) { verbosityLevel() = level; }
+  static Level verbosity() { return verbosityLevel(); }
+
+  /// @brief Stream every line printed from now on to `path` (truncated unless append).
+  static bool open_log_file(const std::string& path, bool append = false) {
+    return sink().open(path, append);
+  }
+  static void close_log_file() { sink().close(); }
+
   static void execute(const std::string& input) {
     print("> " + input);
     history().push_back(input);
@@ -185,13 +453,41 @@ public:
 
     ImGui::SetNextWindowSize(ImVec2(600, 400), ImGuiCond_FirstUseEver);
     if (ImGui::Begin("Console", &visibleFlag())) {
-      // Log area
+      int level = (int)verbosityLevel();
+      ImGui::SetNextItemWidth(100);
+      if (ImGui::Combo("##Verbosity", &level, "debug\0info\0warn\0error\0"))
+        verbosityLevel() = (Level)level;
+      ImGui::SameLine();
+      ImGui::TextDisabled("%zu lines, %llu dropped", log().size(),
+                          (unsigned long long)log().dropped);
+
+      // Log area: only the rows in view are submitted
+      const ConsoleLog& lines = log();
+      auto& shown = shownLines();
+      bool filtering = verbosityLevel() != Level::Debug;
+      if (filtering)
+        shown.update(lines, verbosityLevel());
       float footerHeight = ImGui::GetStyle().ItemSpacing.y + ImGui::GetFrameHeightWithSpacing();
       ImGui::BeginChild("LogRegion", ImVec2(0, -footerHeight), false,
                         ImGuiWindowFlags_HorizontalScrollbar);
-      for (const auto& line : log()) {
-        ImGui::TextUnformatted(line.c_str());
+      ImGuiListClipper clipper;
+      clipper.Begin(filtering ? (int)shown.size() : (int)lines.size());
+      while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+          size_t i = filtering ? shown.line_index(lines, (size_t)row) : (size_t)row;
+          std::string_view text = lines.str(i);
+          Level lv = lines.line(i).level;
+          bool tinted = lv != Level::Info;
+          if (tinted)
+            ImGui::PushStyleColor(ImGuiCol_Text, lv == Level::Error  ? ImVec4(1.0f, 0.4f, 0.4f, 1)
+                                                 : lv == Level::Warn ? ImVec4(1.0f, 0.8f, 0.3f, 1)
+                                                                     : ImVec4(0.6f, 0.6f, 0.6f, 1));
+          ImGui::TextUnformatted(text.data(), text.data() + text.size());
+          if (tinted)
+            ImGui::PopStyleColor();
+        }
       }
+      clipper.End();
       if (scrollToBottom()) {
         ImGui::SetScrollHereY(1.0f);
         scrollToBottom() = false;
@@ -301,6 +597,29 @@ REGISTER_CMD(clear_console, "clear console log", {
   return "";
 });
 
+REGISTER_CMD(verbosity, "verbosity [debug|info|warn|error] - lowest level the console shows", {
+  if (args.empty())
+    return std::string("verbosity: ") + log_level_name(GameConsoleAPI::verbosity());
+  for (int i = 0; i <= (int)LogLevel::Error; i++)
+    if (args[0] == log_level_name((LogLevel)i)) {
+      GameConsoleAPI::set_verbosity((LogLevel)i);
+      return std::string("verbosity: ") + args[0];
+    }
+  return "Unknown level: " + args[0];
+});
+
+REGISTER_CMD(log_file, "log_file <path>|off - stream console output to a file", {
+  if (args.empty())
+    return std::string("Usage: log_file <path>|off");
+  if (args[0] == "off") {
+    GameConsoleAPI::close_log_file();
+    return std::string("log file closed");
+  }
+  if (!GameConsoleAPI::open_log_file(args[0]))
+    return "Failed to open: " + args[0];
+  return "logging to " + args[0];
+});
+
 REGISTER_CMD(run, "run <file> - execute commands from text file", {
   if (args.empty())
     return std::string("Usage: run <file.txt>");
@@ -364,6 +683,114 @@ REGISTER_CMD(pos, "show position", {
   return std::to_string(p.x) + " " + std::to_string(p.y) + " " + std::to_string(p.z);
 });
 
+TEST_CASE("console log drops the oldest lines when full") {
+  ConsoleLog log(32, 4);
+  for (const char* s : {"one", "two", "three"})
+    log.push(s);
+  CHECK(log.size() == 3);
+  CHECK(log.str(0) == "one");
+
+  // Line slots run out first: "one" and "two" go
+  log.push("four", LogLevel::Warn);
+  log.push("five");
+  CHECK(log.size() == 4);
+  CHECK(log.str(0) == "two");
+  log.push("six");
+  CHECK(log.str(0) == "three");
+  CHECK(log.dropped == 2);
+  CHECK(log.line(1).level == LogLevel::Warn);
+
+  // 22 bytes used; a 12-byte line doesn't fit at the end, so it wraps to 0 and
+  // evicts the two lines it lands on
+  log.push("twelve bytes");
+  CHECK(log.size() == 3);
+  CHECK(log.str(0) == "five");
+  CHECK(log.line(2).offset == 0);
+  CHECK(log.str(2) == "twelve bytes");
+
+  // Longer than the buffer: truncated, and everything else goes
+  log.push(std::string(40, 'x'));
+  CHECK(log.size() == 1);
+  CHECK(log.str(0) == std::string(32, 'x'));
+  log.push(""); // takes no text, so the full-buffer line stays
+  CHECK(log.size() == 2);
+  CHECK(log.str(1).empty());
+
+  // Steady state churn never corrupts a retained line
+  ConsoleLog big(1000, 64);
+  for (int i = 0; i < 5000; i++)
+    big.push(std::string(i % 37, char('a' + i % 26)), (LogLevel)(i % 4));
+  for (size_t i = 0; i < big.size(); i++) {
+    std::string_view line = big.str(i);
+    CHECK(std::count(line.begin(), line.end(), line.empty() ? 0 : line[0]) == (long)line.size());
+  }
+  CHECK(big.size() <= 64);
+}
+
+TEST_CASE("console filter follows the log incrementally") {
+  ConsoleLog log(1 << 12, 8);
+  ConsoleFilter shown;
+  for (int i = 0; i < 6; i++)
+    log.push(std::to_string(i), i % 2 ? LogLevel::Warn : LogLevel::Info);
+  shown.update(log, LogLevel::Warn);
+  REQUIRE(shown.size() == 3);
+  CHECK(log.str(shown.line_index(log, 0)) == "1");
+  CHECK(shown.scanned == 6);
+
+  // New lines are appended; dropped ones fall off the front
+  for (int i = 6; i < 12; i++)
+    log.push(std::to_string(i), i % 2 ? LogLevel::Warn : LogLevel::Info);
+  shown.update(log, LogLevel::Warn);
+  CHECK(log.size() == 8); // lines 4..11
+  REQUIRE(shown.size() == 4);
+  for (size_t row = 0; row < shown.size(); row++)
+    CHECK(log.str(shown.line_index(log, row)) == std::to_string(5 + 2 * row));
+
+  // Nothing new: nothing rescanned
+  uint64_t scanned = shown.scanned;
+  shown.update(log, LogLevel::Warn);
+  CHECK(shown.scanned == scanned);
+  CHECK(shown.size() == 4);
+
+  // A level change or a re-init rebuilds
+  shown.update(log, LogLevel::Info);
+  CHECK(shown.size() == 8);
+  log.init(1 << 12, 8);
+  log.push("fresh", LogLevel::Error);
+  shown.update(log, LogLevel::Info);
+  REQUIRE(shown.size() == 1);
+  CHECK(log.str(shown.line_index(log, 0)) == "fresh");
+  log.clear();
+  shown.update(log, LogLevel::Info);
+  CHECK(shown.size() == 0);
+}
+
+TEST_CASE("console print splits lines, levels and file sink") {
+  GameConsoleAPI::set_log_capacity(4096, 64);
+  const char* path = "/tmp/console_sink_test.log";
+  REQUIRE(GameConsoleAPI::open_log_file(path));
+  GameConsoleAPI::print("alpha\nbeta");
+  GameConsoleAPI::print("careful", GameConsoleAPI::Level::Warn);
+  GameConsoleAPI::close_log_file();
+  GameConsoleAPI::print("not in the file");
+
+  const ConsoleLog& lines = GameConsoleAPI::lines();
+  REQUIRE(lines.size() == 4);
+  CHECK(lines.str(0) == "alpha");
+  CHECK(lines.str(1) == "beta");
+  CHECK(lines.line(2).level == LogLevel::Warn);
+
+  std::ifstream in(path);
+  std::stringstream contents;
+  contents << in.rdbuf();
+  CHECK(contents.str() == "[info] alpha\n[info] beta\n[warn] careful\n");
+
+  CHECK(GameConsoleAPI::exec("verbosity warn") == "verbosity: warn");
+  CHECK(GameConsoleAPI::verbosity() == LogLevel::Warn);
+  GameConsoleAPI::set_verbosity(LogLevel::Info);
+  GameConsoleAPI::set_log_capacity(size_t(1) << 20, 16384);
+}
+
 TEST_CASE("console visual test") {
   const int screenWidth = 1024;
   const int screenHeight = 768;
@@ -0,0 +1,487 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="hex nav*"
+exit
+#endif
+/**
+ * @file hex_nav.hpp
+ * @brief Pathfinding, flow fields and field of view over a hexgrid_math Layout
+ *
+ * Everything is keyed by the Layout's hex id (its index into the shape, see
+ * Layout::find()), so per-hex data lives in flat arrays instead of maps:
+ *
+ *   HexCostMap map(layout);            // cost to enter each hex, walls, opacity
+ *   map.set_cost(id, HexCostMap::BLOCKED);
+ *
+ *   HexPathfinder astar;               // A*; one per thread, reused for every query
+ *   astar.find_path(map, from, to, path);
+ *
+ *   HexFlowField flow;                 // Dijkstra from many sources at once; any number
+ *   flow.build(map, goals);            // of units then walk map.neighbor(id, flow.dir[id])
+ *
+ *   HexFov fov;                        // shadow casting out to a radius
+ *   fov.compute(map, eye, 8);          // fov.visible[id], fov.seen
+ *
+ * The searches keep their scratch buffers between calls and never clear them
+ * (entries are stamped with a query number instead), so after the first query
+ * on a map a query allocates nothing, not even the caller's path vector once
+ * it has grown.
+ */
+
+#pragma once
+#include "hexgrid_math.hpp"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief Per-hex movement cost, opacity and neighbor ids for one Layout shape
+ *
+ * Costs are what it takes to enter a hex; 1 is open ground and is also the
+ * minimum, which keeps the A* distance heuristic admissible.
+ */
+struct HexCostMap {
+  static constexpr uint16_t BLOCKED = UINT16_MAX;
+
+  std::shared_ptr<const HexIndex> index;       ///< Shape the ids belong to (kept alive)
+  vector<uint16_t> cost;                       ///< By id; BLOCKED = impassable
+  vector<uint8_t> opaque;                      ///< By id; blocks HexFov sight lines
+  vector<std::array<uint, HEX_DIR_COUNT>> adj; ///< By id and HexDir; UINT_MAX off the shape
+
+  HexCostMap() = default;
+  explicit HexCostMap(const Layout& layout) { build(layout); }
+
+  /// @brief Size the map for the layout's current shape: everything open, cost 1.
+  void build(const Layout& layout) {
+    index = layout.shared_index();
+    uint n = (uint)index->hexes.size();
+    cost.assign(n, 1);
+    opaque.assign(n, 0);
+    adj.resize(n);
+    for (uint id = 0; id < n; id++)
+      for (int d = 0; d < HEX_DIR_COUNT; d++)
+        adj[id][d] = index->find(hex_neighbor(index->hexes[id], d));
+  }
+
+  uint size() const { return (uint)cost.size(); }
+  Hex hex(uint id) const { return index->hexes[id]; }
+  uint find(Hex h) const { return index ? index->find(h) : UINT_MAX; }
+  uint neighbor(uint id, int dir) const { return adj[id][dir]; }
+  bool passable(uint id) const { return id < size() && cost[id] != BLOCKED; }
+
+  /// @brief Set the cost to enter a hex (clamped to at least 1; BLOCKED makes it a wall).
+  void set_cost(uint id, uint16_t c) { cost[id] = std::max<uint16_t>(c, 1); }
+
+  /// @brief Make a hex a wall that also blocks sight, or open it up again.
+  void set_wall(uint id, bool wall) {
+    cost[id] = wall ? BLOCKED : 1;
+    opaque[id] = wall;
+  }
+};
+
+/**
+ * @brief A* over a HexCostMap with pooled scratch
+ *
+ * The open list is a binary heap in a vector that keeps its capacity; node
+ * costs and parents are valid only where their stamp matches the current
+ * query, so nothing is reset between queries. Not thread-safe; use one per
+ * thread (e.g. indexed by JobSystem::this_thread) to path many units at once.
+ */
+struct HexPathfinder {
+  struct Open {
+    uint32_t f; ///< g + heuristic
+    uint id;
+    bool operator<(const Open& o) const { return f > o.f; } // min-heap with std::push_heap
+  };
+
+  vector<uint32_t> g;      ///< By id: cost from the start, if stamp[id] == query
+  vector<uint> parent;     ///< By id: previous hex on the best path found
+  vector<uint32_t> stamp;  ///< By id: query that last reached the hex
+  vector<uint32_t> closed; ///< By id: query that last expanded the hex
+  vector<Open> open;
+  uint32_t query = 0;
+  uint expanded = 0; ///< Hexes expanded by the last query, for profiling
+
+  /**
+   * @brief Find a cheapest path from start to goal.
+   * @param path Filled with hex ids start..goal (both included); cleared on failure
+   * @param max_expand Give up after expanding this many hexes (bounds worst-case cost)
+   * @return False if goal is unreachable, blocked, off the map or over max_expand
+   */
+  bool find_path(const HexCostMap& map, uint start, uint goal, vector<uint>& path,
+                 uint max_expand = UINT_MAX) {
+    path.clear();
+    expanded = 0;
+    if (!map.passable(start) || !map.passable(goal))
+      return false;
+    begin_query(map.size());
+
+    Hex target = map.hex(goal);
+    reach(start, 0, UINT_MAX);
+    open.push_back({(uint32_t)hex_distance(map.hex(start), target), start});
+    while (!open.empty()) {
+      std::pop_heap(open.begin(), open.end());
+      uint id = open.back().id;
+      open.pop_back();
+      if (closed[id] == query)
+        continue; // stale entry; the hex was re-pushed with a lower cost
+      closed[id] = query;
+      if (id == goal) {
+        for (uint at = goal; at != UINT_MAX; at = parent[at])
+          path.push_back(at);
+        std::reverse(path.begin(), path.end());
+        return true;
+      }
+      if (++expanded > max_expand)
+        return false;
+
+      for (uint next : map.adj[id]) {
+        if (!map.passable(next) || closed[next] == query)
+          continue;
+        uint32_t cost = g[id] + map.cost[next];
+        if (stamp[next] == query && g[next] <= cost)
+          continue;
+        reach(next, cost, id);
+        open.push_back({cost + (uint32_t)hex_distance(map.hex(next), target), next});
+        std::push_heap(open.begin(), open.end());
+      }
+    }
+    return false;
+  }
+
+private:
+  void begin_query(uint n) {
+    if (g.size() != n) {
+      g.assign(n, 0);
+      parent.assign(n, UINT_MAX);
+      stamp.assign(n, 0);
+      closed.assign(n, 0);
+      query = 0;
+    }
+    if (++query == 0) { // wrapped: old stamps could collide
+      std::fill(stamp.begin(), stamp.end(), 0);
+      std::fill(closed.begin(), closed.end(), 0);
+      query = 1;
+    }
+    open.clear();
+  }
+
+  void reach(uint id, uint32_t cost, uint from) {
+    g[id] = cost;
+    parent[id] = from;
+    stamp[id] = query;
+  }
+};
+
+/**
+ * @brief Cost to the nearest of several goals for every hex, plus the way there
+ *
+ * One multi-source Dijkstra pass serves every unit heading for the same
+ * goals: each unit just steps to map.neighbor(id, dir[id]) each turn.
+ */
+struct HexFlowField {
+  static constexpr uint32_t UNREACHED = UINT32_MAX;
+  static constexpr uint8_t NO_DIR = HEX_DIR_COUNT; ///< At a goal, or unreachable
+
+  vector<uint32_t> distance; ///< By id: cost to the nearest goal
+  vector<uint8_t> dir;       ///< By id: HexDir of the next step, or NO_DIR
+  vector<uint> goal_of;      ///< By id: which goal the hex drains to
+  vector<HexPathfinder::Open> open;
+
+  /// @brief Rebuild from a set of goal ids (impassable or out-of-range goals are skipped).
+  void build(const HexCostMap& map, const vector<uint>& goals) {
+    uint n = map.size();
+    distance.assign(n, UNREACHED);
+    dir.assign(n, NO_DIR);
+    goal_of.assign(n, UINT_MAX);
+    open.clear();
+    for (uint goal : goals) {
+      if (!map.passable(goal))
+        continue;
+      distance[goal] = 0;
+      goal_of[goal] = goal;
+      open.push_back({0, goal});
+    }
+    std::make_heap(open.begin(), open.end());
+
+    while (!open.empty()) {
+      std::pop_heap(open.begin(), open.end());
+      auto [d, id] = open.back();
+      open.pop_back();
+      if (d != distance[id])
+        continue; // stale
+      // A neighbor's way to the goal is the step into `id` plus the rest of id's way
+      uint32_t via = d + map.cost[id];
+      for (int k = 0; k < HEX_DIR_COUNT; k++) {
+        uint from = map.adj[id][k];
+        if (!map.passable(from) || distance[from] <= via)
+          continue;
+        distance[from] = via;
+        dir[from] = (uint8_t)((k + 3) % HEX_DIR_COUNT); // opposite of k: back towards id
+        goal_of[from] = goal_of[id];
+        open.push_back({distance[from], from});
+        std::push_heap(open.begin(), open.end());
+      }
+    }
+  }
+
+  bool reachable(uint id) const { return id < distance.size() && distance[id] != UNREACHED; }
+
+  /// @brief Next hex towards the nearest goal, or UINT_MAX at a goal / when unreachable.
+  uint next(const HexCostMap& map, uint id) const {
+    return id < dir.size() && dir[id] != NO_DIR ? map.neighbor(id, dir[id]) : UINT_MAX;
+  }
+};
+
+/**
+ * @brief Shadow-casting field of view
+ *
+ * Walks rings outward from the eye. A hex on ring k of the 6k hexes around
+ * it covers 1/(6k) of the turn (rings share corners along the six axes, so
+ * a straight sight line keeps its position in that parametrization); it is
+ * visible unless the shadows of opaque hexes on nearer rings cover its whole
+ * arc. Opaque hexes are visible themselves and cast shadow on the rings
+ * behind them. Hexes off the map count as opaque.
+ */
+struct HexFov {
+  using Arc = std::pair<float, float>; ///< [begin, end) in turns, 0 <= begin < end <= 1
+
+  vector<uint8_t> visible; ///< By id: seen by the last compute()
+  vector<uint> seen;       ///< Ids seen by the last compute(), nearest rings first
+  vector<Arc> shadows;     ///< Sorted, merged
+  vector<Arc> cast;        ///< Shadows from the ring being walked, merged in after it
+
+  void compute(const HexCostMap& map, uint eye, int radius) {
+    if (visible.size() != map.size())
+      visible.assign(map.size(), 0);
+    for (uint id : seen)
+      visible[id] = 0;
+    seen.clear();
+    shadows.clear();
+    if (eye >= map.size())
+      return;
+    mark(eye);
+
+    Hex center = map.hex(eye);
+    for (int k = 1; k <= radius && !fully_shadowed(); k++) {
+      cast.clear();
+      float span = 1.0f / (6.0f * (float)k);
+      Hex h = hex_add(center, hex_multiply(hex_direction(HEX_SW), k));
+      int j = 0;
+      for (int side = 0; side < HEX_DIR_COUNT; side++) {
+        for (int step = 0; step < k; step++, j++) {
+          float begin = ((float)j - 0.5f) * span;
+          float end = ((float)j + 0.5f) * span;
+          uint id = map.find(h);
+          if (!covered(begin, end)) {
+            if (id != UINT_MAX)
+              mark(id);
+            if (id == UINT_MAX || map.opaque[id])
+              add(cast, begin, end);
+          }
+          h = hex_neighbor(h, side);
+        }
+      }
+      for (const Arc& a : cast)
+        add(shadows, a.first, a.second);
+    }
+  }
+
+private:
+  void mark(uint id) {
+    if (!visible[id]) {
+      visible[id] = 1;
+      seen.push_back(id);
+    }
+  }
+
+  bool fully_shadowed() const {
+    return shadows.size() == 1 && shadows[0].first <= 0.0f && shadows[0].second >= 1.0f;
+  }
+
+  static bool covered_in(const vector<Arc>& arcs, float begin, float end) {
+    constexpr float EPS = 1e-5f;
+    for (const Arc& a : arcs)
+      if (a.first <= begin + EPS && a.second >= end - EPS)
+        return true; // arcs are merged, so one has to cover it all
+    return false;
+  }
+
+  /// The ring's first hex straddles angle 0, so arcs may wrap below it
+  bool covered(float begin, float end) const {
+    if (begin < 0.0f)
+      return covered_in(shadows, begin + 1.0f, 1.0f) && covered_in(shadows, 0.0f, end);
+    return covered_in(shadows, begin, end);
+  }
+
+  static void add(vector<Arc>& arcs, float begin, float end) {
+    if (begin < 0.0f) {
+      add(arcs, begin + 1.0f, 1.0f);
+      begin = 0.0f;
+    }
+    constexpr float EPS = 1e-5f;
+    auto it = std::lower_bound(arcs.begin(), arcs.end(), Arc{begin, end});
+    it = arcs.insert(it, {begin, end});
+    if (it != arcs.begin() && std::prev(it)->second >= it->first - EPS)
+      --it; // merge into the previous arc
+    while (std::next(it) != arcs.end() && std::next(it)->first <= it->second + EPS) {
+      it->second = std::max(it->second, std::next(it)->second);
+      arcs.erase(std::next(it));
+    }
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <random>
+
+/// Plain Dijkstra from one hex, as the reference the nav structures are checked against
+static vector<uint32_t> hex_nav_reference(const HexCostMap& map, uint from) {
+  vector<uint32_t> dist(map.size(), UINT32_MAX);
+  vector<std::pair<uint32_t, uint>> open = {{0, from}};
+  dist[from] = 0;
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end(), std::greater<>());
+    auto [d, id] = open.back();
+    open.pop_back();
+    if (d != dist[id])
+      continue;
+    for (uint next : map.adj[id])
+      if (map.passable(next) && d + map.cost[next] < dist[next]) {
+        dist[next] = d + map.cost[next];
+        open.push_back({dist[next], next});
+        std::push_heap(open.begin(), open.end(), std::greater<>());
+      }
+  }
+  return dist;
+}
+
+static HexCostMap hex_nav_test_map(int radius, unsigned seed) {
+  Layout layout(layout_pointy, Point{1, 1}, Point{0, 0});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {radius};
+  HexCostMap map(layout);
+  std::mt19937 rng(seed);
+  for (uint id = 1; id < map.size(); id++) { // id 0 is the center: keep it open
+    int roll = (int)(rng() % 10);
+    if (roll == 0)
+      map.set_wall(id, true);
+    else if (roll < 3)
+      map.set_cost(id, (uint16_t)(2 + rng() % 4));
+  }
+  return map;
+}
+
+TEST_CASE("hex nav A* finds cheapest paths without reallocating") {
+  HexCostMap map = hex_nav_test_map(12, 7);
+  uint center = map.find(Hex(0, 0));
+  vector<uint32_t> reference = hex_nav_reference(map, center);
+
+  HexPathfinder astar;
+  vector<uint> path;
+  path.reserve(256);
+  const uint32_t* pool = nullptr;
+  size_t open_capacity = 0;
+  int reachable = 0;
+  for (uint goal = 0; goal < map.size(); goal++) {
+    bool found = astar.find_path(map, center, goal, path);
+    CHECK(found == (reference[goal] != UINT32_MAX));
+    if (!found)
+      continue;
+    reachable++;
+    REQUIRE(path.front() == center);
+    REQUIRE(path.back() == goal);
+    uint32_t cost = 0;
+    for (size_t i = 1; i < path.size(); i++) {
+      CHECK(hex_distance(map.hex(path[i - 1]), map.hex(path[i])) == 1);
+      cost += map.cost[path[i]];
+    }
+    CHECK(cost == reference[goal]);
+
+    if (!pool) { // after the first query the pools only get reused
+      pool = astar.g.data();
+      open_capacity = astar.open.capacity();
+    }
+  }
+  CHECK(reachable > (int)map.size() / 2);
+  CHECK(astar.g.data() == pool);
+  CHECK(astar.open.capacity() >= open_capacity);
+
+  // Walls, off-map ids and the expansion cap all fail cleanly
+  uint wall = 0;
+  while (map.passable(wall))
+    wall++;
+  CHECK_FALSE(astar.find_path(map, center, wall, path));
+  CHECK(path.empty());
+  CHECK_FALSE(astar.find_path(map, center, UINT_MAX, path));
+  uint far = map.find(Hex(12, -12));
+  if (map.passable(far) && reference[far] != UINT32_MAX)
+    CHECK_FALSE(astar.find_path(map, center, far, path, 5));
+}
+
+TEST_CASE("hex nav flow field drains to the nearest goal") {
+  HexCostMap map = hex_nav_test_map(10, 11);
+  vector<uint> goals = {map.find(Hex(0, 0)), map.find(Hex(8, -8)), map.find(Hex(-6, 9))};
+  for (uint g : goals)
+    map.set_wall(g, false);
+
+  HexFlowField flow;
+  flow.build(map, goals);
+  for (uint id = 0; id < map.size(); id++) {
+    uint32_t best = UINT32_MAX;
+    if (map.passable(id)) {
+      vector<uint32_t> from_here = hex_nav_reference(map, id);
+      for (uint g : goals)
+        best = std::min(best, from_here[g]);
+    }
+    CHECK(flow.distance[id] == best);
+    if (!flow.reachable(id))
+      continue;
+
+    // Following the field reaches a goal for exactly the promised cost
+    uint32_t walked = 0;
+    uint at = id;
+    for (uint next = flow.next(map, at); next != UINT_MAX; next = flow.next(map, at)) {
+      walked += map.cost[next];
+      at = next;
+    }
+    CHECK(std::find(goals.begin(), goals.end(), at) != goals.end());
+    CHECK(walked == flow.distance[id]);
+    CHECK(flow.goal_of[id] == at);
+  }
+}
+
+TEST_CASE("hex nav field of view") {
+  Layout layout(layout_pointy, Point{1, 1}, Point{0, 0});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {8};
+  HexCostMap map(layout);
+  uint eye = map.find(Hex(0, 0));
+
+  HexFov fov;
+  fov.compute(map, eye, 5);
+  for (uint id = 0; id < map.size(); id++)
+    CHECK(fov.visible[id] == (hex_distance(map.hex(id), Hex(0, 0)) <= 5));
+  CHECK(fov.seen.size() == 3 * 5 * 6 + 1);
+
+  // A wall two hexes east: itself visible, the hexes straight behind it hidden,
+  // hexes off to the side still seen
+  uint wall = map.find(Hex(2, 0));
+  map.set_wall(wall, true);
+  fov.compute(map, eye, 6);
+  CHECK(fov.visible[wall]);
+  CHECK_FALSE(fov.visible[map.find(Hex(3, 0))]);
+  CHECK_FALSE(fov.visible[map.find(Hex(5, 0))]);
+  CHECK(fov.visible[map.find(Hex(0, 4))]);
+  CHECK(fov.visible[map.find(Hex(-4, 0))]);
+  CHECK(fov.visible[map.find(Hex(3, -3))]);
+
+  // Walled in completely: only the ring of walls is seen
+  for (int d = 0; d < HEX_DIR_COUNT; d++)
+    map.set_wall(map.find(hex_neighbor(Hex(0, 0), d)), true);
+  fov.compute(map, eye, 6);
+  CHECK(fov.seen.size() == 7);
+}
+
+#endif
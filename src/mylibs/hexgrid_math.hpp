@@ -14,14 +14,27 @@
  */
 
 #pragma once
+#include <array>
 #include <climits>
 #include <cmath>
 #include <cstdlib>
 #include <raylib.h>
 #include <raymath.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <vector>
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 using std::vector;
 
 /// @brief Point type alias for raylib's Vector2
@@ -142,26 +155,26 @@ constexpr int hex_distance(Hex a, Hex b) {
   return hex_length(hex_subtract(a, b));
 }
 
-/// @brief Direction vectors for the 6 hex neighbors
-const vector<Hex> hex_directions = {Hex(1, 0, -1), Hex(1, -1, 0), Hex(0, -1, 1),
-                                    Hex(-1, 0, 1), Hex(-1, 1, 0), Hex(0, 1, -1)};
+/// @brief Direction vectors for the 6 hex neighbors, indexed by HexDir
+inline constexpr std::array<Hex, HEX_DIR_COUNT> hex_directions = {
+    Hex(1, 0, -1), Hex(1, -1, 0), Hex(0, -1, 1), Hex(-1, 0, 1), Hex(-1, 1, 0), Hex(0, 1, -1)};
 
 /**
  * @brief Get the direction vector for a given direction index
- * @param direction Direction index (0-5, use HexDir enum)
+ * @param direction Direction index (use HexDir enum); wraps, so -1 is HEX_SE and 6 is HEX_E
  * @return Hex offset for that direction
  */
-inline Hex hex_direction(int direction /* 0 to 5 */) {
-  return hex_directions[direction];
+constexpr Hex hex_direction(int direction) {
+  return hex_directions[((direction % HEX_DIR_COUNT) + HEX_DIR_COUNT) % HEX_DIR_COUNT];
 }
 
 /**
  * @brief Get the neighboring hex in a given direction
  * @param hex Starting hex
- * @param direction Direction index (0-5, use HexDir enum)
+ * @param direction Direction index (use HexDir enum; wraps like hex_direction)
  * @return The neighboring hex
  */
-inline Hex hex_neighbor(Hex hex, int direction) {
+constexpr Hex hex_neighbor(Hex hex, int direction) {
   return hex_add(hex, hex_direction(direction));
 }
 
@@ -176,19 +189,24 @@ struct Orientation {
   const double b0, b1, b2, b3; ///< Backward matrix for pixel-to-hex
   const double start_angle;    ///< Starting angle in multiples of 60 degrees
 
-  Orientation(double f0_, double f1_, double f2_, double f3_, double b0_, double b1_, double b2_,
-              double b3_, double start_angle_)
+  constexpr Orientation(double f0_, double f1_, double f2_, double f3_, double b0_, double b1_,
+                        double b2_, double b3_, double start_angle_)
       : f0(f0_), f1(f1_), f2(f2_), f3(f3_), b0(b0_), b1(b1_), b2(b2_), b3(b3_),
         start_angle(start_angle_) {}
 };
 
+/// @brief sqrt(3), spelled out so the orientations below are constexpr
+inline constexpr double HEX_SQRT3 = 1.7320508075688772;
+
 /// @brief Orientation for pointy-top hexes (vertex pointing up)
-const Orientation layout_pointy = Orientation(sqrt(3.0), sqrt(3.0) / 2.0, 0.0, 3.0 / 2.0,
-                                              sqrt(3.0) / 3.0, -1.0 / 3.0, 0.0, 2.0 / 3.0, 0.5);
+inline constexpr Orientation layout_pointy =
+    Orientation(HEX_SQRT3, HEX_SQRT3 / 2.0, 0.0, 3.0 / 2.0, HEX_SQRT3 / 3.0, -1.0 / 3.0, 0.0,
+                2.0 / 3.0, 0.5);
 
 /// @brief Orientation for flat-top hexes (edge pointing up)
-const Orientation layout_flat = Orientation(3.0 / 2.0, 0.0, sqrt(3.0) / 2.0, sqrt(3.0), 2.0 / 3.0,
-                                            0.0, -1.0 / 3.0, sqrt(3.0) / 3.0, 0.0);
+inline constexpr Orientation layout_flat =
+    Orientation(3.0 / 2.0, 0.0, HEX_SQRT3 / 2.0, HEX_SQRT3, 2.0 / 3.0, 0.0, -1.0 / 3.0,
+                HEX_SQRT3 / 3.0, 0.0);
 
 /**
  * @brief Layout configuration for rendering hexes
@@ -216,6 +234,71 @@ struct GridParams {
   int b = 0; ///< q2/right
   int c = 0; ///< r1/top
   int d = 0; ///< r2/bottom
+
+  bool operator==(const GridParams&) const = default;
+};
+
+/**
+ * @brief Materialized hexes of a grid shape plus a reverse Hex -> id table
+ *
+ * Built once per shape/params by Layout::index(). The reverse table is a flat
+ * array over the shape's bounding q/r range, so lookups are constant time.
+ */
+struct HexIndex {
+  GridShape shape = GridShape::Hexagon; ///< Shape this index was built for
+  GridParams params = {0, 0, 0, 0};     ///< Params this index was built for
+  vector<Hex> hexes;                    ///< Hexes in generator order (id = position)
+  int q_min = 0, r_min = 0;             ///< Bounding range origin
+  int q_span = 0, r_span = 0;           ///< Bounding range extent
+  vector<uint> ids;                     ///< (q, r) -> id, UINT_MAX for holes
+
+  /**
+   * @brief Find the id of a hex in this index
+   * @param h The hex coordinate
+   * @return Position of h in hexes, or UINT_MAX if not part of the shape
+   */
+  uint find(Hex h) const {
+    int q = h.q - q_min;
+    int r = h.r - r_min;
+    if (q < 0 || r < 0 || q >= q_span || r >= r_span)
+      return UINT_MAX;
+    return ids[q * r_span + r];
+  }
+};
+
+/**
+ * @brief A Layout's HexIndex, safe to look up from several threads at once
+ *
+ * Lookups of an up-to-date index are one atomic load; building (first use,
+ * or after a shape change) happens under the mutex, so concurrent readers
+ * build it once and share it. Changing the Layout's shape while other
+ * threads read it is still a data race, as for any other field.
+ */
+struct HexIndexCache {
+  mutable std::mutex mutex;
+  std::shared_ptr<const HexIndex> owner;         ///< Guarded by mutex
+  std::atomic<const HexIndex*> current{nullptr}; ///< owner.get(), read without the lock
+
+  HexIndexCache() = default;
+  HexIndexCache(const HexIndexCache& other) : owner(other.shared()) {
+    current.store(owner.get(), std::memory_order_release);
+  }
+  HexIndexCache& operator=(const HexIndexCache& other) {
+    if (this != &other)
+      publish(other.shared());
+    return *this;
+  }
+
+  std::shared_ptr<const HexIndex> shared() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return owner;
+  }
+
+  void publish(std::shared_ptr<const HexIndex> idx) {
+    std::lock_guard<std::mutex> lock(mutex);
+    owner = std::move(idx);
+    current.store(owner.get(), std::memory_order_release);
+  }
 };
 
 /**
@@ -230,10 +313,36 @@ struct Layout {
   Point origin = {0, 0};
   GridShape shape = GridShape::Hexagon;
   GridParams params = {0, 0, 0, 0};
-  uint n_hex = 10;
+  uint n_hex = 10; ///< Cap on iteration / ray_hex; UINT_MAX (or size()) covers the whole shape
 
   Hex operator[](uint index) const;
 
+  /**
+   * @brief Get the materialized hex table for the current shape/params
+   *
+   * Built lazily on first use and rebuilt whenever shape or params change.
+   * Copies of a Layout share the table until one of them changes shape.
+   * Safe to call from several threads while the Layout isn't being changed.
+   */
+  const HexIndex& index() const;
+
+  /// @brief index(), with shared ownership for holders that outlive shape changes
+  std::shared_ptr<const HexIndex> shared_index() const {
+    index();
+    return _index.shared();
+  }
+
+  /// @brief Number of hexes in the current shape
+  uint size() const { return (uint)index().hexes.size(); }
+
+  /// @brief Hexes visited by iteration and ray_hex: size(), capped by n_hex
+  uint count() const { return n_hex < size() ? n_hex : size(); }
+
+  /// @brief Id of a hex in the current shape, or UINT_MAX if it is not part of it
+  uint find(Hex h) const { return index().find(h); }
+
+  mutable HexIndexCache _index;
+
   struct Iterator {
     const Layout* layout;
     uint index;
@@ -247,7 +356,7 @@ struct Layout {
   };
 
   Iterator begin() const { return Iterator(this, 0); }
-  Iterator end() const { return Iterator(this, n_hex); }
+  Iterator end() const { return Iterator(this, count()); }
 };
 /**
  * @brief Convert hex coordinates to screen pixel position
@@ -255,7 +364,7 @@ struct Layout {
  * @param h The hex coordinate
  * @return Center position of the hex in screen coordinates
  */
-inline Point hex_to_pixel(Layout layout, Hex h) {
+inline Point hex_to_pixel(const Layout& layout, Hex h) {
   const Orientation& M = layout.orientation;
   double x = (M.f0 * h.q + M.f1 * h.r) * layout.hex_size.x;
   double y = (M.f2 * h.q + M.f3 * h.r) * layout.hex_size.y;
@@ -268,7 +377,7 @@ inline Point hex_to_pixel(Layout layout, Hex h) {
  * @param p Screen position in pixels
  * @return Fractional hex coordinate (needs rounding for integer hex)
  */
-inline FractionalHex pixel_to_hex_fractional(Layout layout, Point p) {
+inline FractionalHex pixel_to_hex_fractional(const Layout& layout, Point p) {
   const Orientation& M = layout.orientation;
   float ptx = (p.x - layout.origin.x) / layout.hex_size.x;
   float pty = (p.y - layout.origin.y) / layout.hex_size.y;
@@ -283,7 +392,7 @@ inline FractionalHex pixel_to_hex_fractional(Layout layout, Point p) {
  * @param corner Corner index (0-5)
  * @return Offset from center to the specified corner
  */
-inline Point hex_corner_offset(Layout layout, int corner) {
+inline Point hex_corner_offset(const Layout& layout, int corner) {
   Point size = layout.hex_size;
   double angle = 2.0 * M_PI * (layout.orientation.start_angle + corner) / 6;
   return Point{(float)(size.x * cos(angle)), (float)(size.y * sin(angle))};
@@ -297,7 +406,7 @@ inline Point hex_corner_offset(Layout layout, int corner) {
  * For pointy-top: width = sqrt(3) * size.x, height = 2 * size.y
  * For flat-top: width = 2 * size.x, height = sqrt(3) * size.y
  */
-inline Point hex_bounding_size(Layout layout) {
+inline Point hex_bounding_size(const Layout& layout) {
   const float sqrt3 = 1.732050808f;
   Point size = layout.hex_size;
   // Pointy-top has start_angle 0.5, flat-top has 0.0
@@ -311,29 +420,59 @@ inline Point hex_bounding_size(Layout layout) {
 }
 
 /**
- * @brief Get all 6 corner positions of a hex in screen coordinates
+ * @brief Get all 6 corner offsets of a layout at once
+ * @param layout The layout configuration
+ * @return Offsets from any hex center to its 6 corners
+ *
+ * Offsets only depend on the layout, so compute them once and reuse them
+ * across hexes instead of calling hex_corner_offset per corner per hex.
+ */
+inline std::array<Point, 6> hex_corner_offsets(const Layout& layout) {
+  std::array<Point, 6> offsets;
+  for (int i = 0; i < 6; i++) {
+    offsets[i] = hex_corner_offset(layout, i);
+  }
+  return offsets;
+}
+
+/**
+ * @brief Get all 6 corner positions of a hex from precomputed offsets
  * @param layout The layout configuration
+ * @param offsets Corner offsets from hex_corner_offsets()
  * @param h The hex coordinate
- * @return Vector of 6 corner positions
+ * @return The 6 corner positions (no heap allocation)
  */
-inline vector<Point> polygon_corners(Layout layout, Hex h) {
-  vector<Point> corners = {};
+inline std::array<Point, 6> hex_corners(const Layout& layout, const std::array<Point, 6>& offsets,
+                                        Hex h) {
+  std::array<Point, 6> corners;
   Point center = hex_to_pixel(layout, h);
   for (int i = 0; i < 6; i++) {
-    Point offset = hex_corner_offset(layout, i);
-    corners.push_back(Point{center.x + offset.x, center.y + offset.y});
+    corners[i] = Point{center.x + offsets[i].x, center.y + offsets[i].y};
   }
   return corners;
 }
 
+/**
+ * @brief Get all 6 corner positions of a hex in screen coordinates
+ * @param layout The layout configuration
+ * @param h The hex coordinate
+ * @return Vector of 6 corner positions
+ */
+inline vector<Point> polygon_corners(const Layout& layout, Hex h) {
+  std::array<Point, 6> corners = hex_corners(layout, hex_corner_offsets(layout), h);
+  return vector<Point>(corners.begin(), corners.end());
+}
+
 /**
  * @brief Draw a hex outline using raylib
  * @param layout The layout configuration
  * @param h The hex coordinate
  * @param color Line color
+ *
+ * Issues 6 draw calls per hex; use HexGridMesh (hexgrid_mesh.hpp) for whole grids.
  */
-inline void draw_hex(Layout layout, Hex h, Color color) {
-  vector<Point> corners = polygon_corners(layout, h);
+inline void draw_hex(const Layout& layout, Hex h, Color color) {
+  std::array<Point, 6> corners = hex_corners(layout, hex_corner_offsets(layout), h);
   for (int i = 0; i < 6; i++) {
     DrawLineV(corners[i], corners[(i + 1) % 6], color);
   }
@@ -344,9 +483,11 @@ inline void draw_hex(Layout layout, Hex h, Color color) {
  * @param layout The layout configuration
  * @param h The hex coordinate
  * @param color Fill color
+ *
+ * Issues 6 draw calls per hex; use HexGridMesh (hexgrid_mesh.hpp) for whole grids.
  */
-inline void draw_hex_filled(Layout layout, Hex h, Color color) {
-  vector<Point> corners = polygon_corners(layout, h);
+inline void draw_hex_filled(const Layout& layout, Hex h, Color color) {
+  std::array<Point, 6> corners = hex_corners(layout, hex_corner_offsets(layout), h);
   Point center = hex_to_pixel(layout, h);
   for (int i = 0; i < 6; i++) {
     DrawTriangle(center, corners[i], corners[(i + 1) % 6], color);
@@ -484,53 +625,79 @@ inline vector<Hex> grid_rectangle_flat(int left, int right, int top, int bottom)
   return hexes;
 }
 
-// inline uint Layout::size() const {
-//   switch (shape) {
-//     case GridShape::Parallelogram:
-//       return grid_parallelogram(params.a, params.b, params.c, params.d).size();
-//     case GridShape::TriangleDown:
-//       return grid_triangle_down(params.a).size();
-//     case GridShape::TriangleUp:
-//       return grid_triangle_up(params.a).size();
-//     case GridShape::Hexagon:
-//       return grid_hexagon(params.a).size();
-//     case GridShape::RectanglePointy:
-//       return grid_rectangle_pointy(params.a, params.b, params.c, params.d).size();
-//     case GridShape::RectangleFlat:
-//       return grid_rectangle_flat(params.a, params.b, params.c, params.d).size();
-//   }
-//   return 0;
-// }
-
-inline Hex Layout::operator[](uint index) const {
-  vector<Hex> hexes;
+/**
+ * @brief Generate the hexes for any GridShape
+ * @param shape Shape to generate
+ * @param params Shape parameters (see GridParams)
+ * @return Vector of hex coordinates in generator order
+ */
+inline vector<Hex> grid_shape(GridShape shape, GridParams params) {
   switch (shape) {
     case GridShape::Parallelogram:
-      hexes = grid_parallelogram(params.a, params.b, params.c, params.d);
-      break;
+      return grid_parallelogram(params.a, params.b, params.c, params.d);
     case GridShape::TriangleDown:
-      hexes = grid_triangle_down(params.a);
-      break;
+      return grid_triangle_down(params.a);
     case GridShape::TriangleUp:
-      hexes = grid_triangle_up(params.a);
-      break;
+      return grid_triangle_up(params.a);
     case GridShape::Hexagon:
-      hexes = grid_hexagon(params.a);
-      break;
+      return grid_hexagon(params.a);
     case GridShape::RectanglePointy:
-      hexes = grid_rectangle_pointy(params.a, params.b, params.c, params.d);
-      break;
+      return grid_rectangle_pointy(params.a, params.b, params.c, params.d);
     case GridShape::RectangleFlat:
-      hexes = grid_rectangle_flat(params.a, params.b, params.c, params.d);
-      break;
+      return grid_rectangle_flat(params.a, params.b, params.c, params.d);
   }
+  return {};
+}
+
+inline const HexIndex& Layout::index() const {
+  const HexIndex* cur = _index.current.load(std::memory_order_acquire);
+  if (cur && cur->shape == shape && cur->params == params)
+    return *cur;
+
+  // Another thread may be building the same index; whoever gets the lock first builds it
+  std::lock_guard<std::mutex> lock(_index.mutex);
+  cur = _index.owner.get();
+  if (cur && cur->shape == shape && cur->params == params)
+    return *cur;
+
+  auto idx = std::make_shared<HexIndex>();
+  idx->shape = shape;
+  idx->params = params;
+  idx->hexes = grid_shape(shape, params);
+
+  if (!idx->hexes.empty()) {
+    int q_max = INT_MIN, r_max = INT_MIN;
+    idx->q_min = INT_MAX;
+    idx->r_min = INT_MAX;
+    for (const Hex& h : idx->hexes) {
+      idx->q_min = std::min(idx->q_min, h.q);
+      idx->r_min = std::min(idx->r_min, h.r);
+      q_max = std::max(q_max, h.q);
+      r_max = std::max(r_max, h.r);
+    }
+    idx->q_span = q_max - idx->q_min + 1;
+    idx->r_span = r_max - idx->r_min + 1;
+    idx->ids.assign((size_t)idx->q_span * idx->r_span, UINT_MAX);
+    for (uint id = 0; id < idx->hexes.size(); id++) {
+      const Hex& h = idx->hexes[id];
+      idx->ids[(h.q - idx->q_min) * idx->r_span + (h.r - idx->r_min)] = id;
+    }
+  }
+
+  _index.owner = std::move(idx);
+  _index.current.store(_index.owner.get(), std::memory_order_release);
+  return *_index.owner;
+}
+
+inline Hex Layout::operator[](uint index) const {
+  const vector<Hex>& hexes = this->index().hexes;
   if (index < hexes.size()) {
     return hexes[index];
   }
   return Hex(0, 0);
 }
 
-inline Vector3 hex_to_world(Layout layout, Hex h, float y = 0.0f) {
+inline Vector3 hex_to_world(const Layout& layout, Hex h, float y = 0.0f) {
   Point p = hex_to_pixel(layout, h);
   return Vector3{p.x, y, p.y};
 }
@@ -540,9 +707,9 @@ inline Hex hex_round(FractionalHex h) {
   int q = (int)round(h.q);
   int r = (int)round(h.r);
   int s = (int)round(h.s);
-  double q_diff = abs(q - h.q);
-  double r_diff = abs(r - h.r);
-  double s_diff = abs(s - h.s);
+  double q_diff = std::fabs(q - h.q); // not abs(): that can resolve to the int overload
+  double r_diff = std::fabs(r - h.r);
+  double s_diff = std::fabs(s - h.s);
   // Reset the component with largest rounding error
   if (q_diff > r_diff && q_diff > s_diff)
     q = -r - s;
@@ -553,22 +720,381 @@ inline Hex hex_round(FractionalHex h) {
   return Hex(q, r, s);
 }
 
-// Cast mouse ray onto XZ plane, return hex_id or UINT_MAX if missed
-inline uint mouseray_hex(Layout layout, Camera3D camera) {
-  /*
-   uint hovered_id = mouseray_hex(this->hex_layout, camera);
-    if (hovered_id != UINT_MAX && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-      for (auto& thing : things) {
-        if (thing.hex_id == hovered_id) {
-          higlighted_ref = thing.this_ref();
-          break;
-        }
-      }
-    }
+// ============================================================================
+// BATCH CONVERSIONS
+// ============================================================================
+
+/*
+ * hex_to_pixel / pixel_to_hex_fractional + hex_round over whole spans, in
+ * float: eight at a time with AVX (when built with -mavx / -march=native),
+ * four at a time with SSE2 (any x86-64) or NEON, scalar otherwise and for
+ * the tail. Kernels are templated on the orientation Kind, so pointy and
+ * flat get their zero matrix terms folded out at compile time; name the
+ * Kind when the orientation is known (hex_to_pixel_batch<Kind::Pointy>),
+ * or let the untemplated overloads pick it from layout.orientation once per
+ * call. Results match the scalar functions to float precision: exact for
+ * hex ids, except for points within rounding error of a hex edge.
  */
 
-  Ray ray = GetScreenToWorldRay(GetMousePosition(), camera);
-  // Intersect with y=0 plane
+namespace hex_batch {
+
+// Arithmetic is spelled as functions with float overloads, so one expression
+// (pixel_x and friends below) serves the vector loops and the scalar tail.
+inline float add(float a, float b) { return a + b; }
+inline float sub(float a, float b) { return a - b; }
+inline float mul(float a, float b) { return a * b; }
+
+#if defined(__AVX__)
+#define HEX_BATCH_AVX 1
+using f8 = __m256;
+inline f8 add(f8 a, f8 b) { return _mm256_add_ps(a, b); }
+inline f8 sub(f8 a, f8 b) { return _mm256_sub_ps(a, b); }
+inline f8 mul(f8 a, f8 b) { return _mm256_mul_ps(a, b); }
+inline f8 add(f8 a, float b) { return add(a, _mm256_set1_ps(b)); }
+inline f8 sub(f8 a, float b) { return sub(a, _mm256_set1_ps(b)); }
+inline f8 mul(f8 a, float b) { return mul(a, _mm256_set1_ps(b)); }
+inline f8 abs(f8 v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+inline f8 round(f8 v) {
+  f8 half = _mm256_or_ps(_mm256_and_ps(v, _mm256_set1_ps(-0.0f)), _mm256_set1_ps(0.5f));
+  return _mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_add_ps(v, half)));
+}
+inline f8 gt(f8 a, f8 b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+inline f8 both(f8 a, f8 b) { return _mm256_and_ps(a, b); }
+inline f8 but_not(f8 a, f8 b) { return _mm256_andnot_ps(b, a); }
+inline f8 select(f8 mask, f8 a, f8 b) { return _mm256_blendv_ps(b, a, mask); }
+inline void load_qr(const Hex* h, f8& q, f8& r) {
+  q = _mm256_cvtepi32_ps(_mm256_setr_epi32(h[0].q, h[1].q, h[2].q, h[3].q, h[4].q, h[5].q,
+                                           h[6].q, h[7].q));
+  r = _mm256_cvtepi32_ps(_mm256_setr_epi32(h[0].r, h[1].r, h[2].r, h[3].r, h[4].r, h[5].r,
+                                           h[6].r, h[7].r));
+}
+inline void to_ints(f8 v, int* out) {
+  _mm256_storeu_si256((__m256i*)out, _mm256_cvttps_epi32(v));
+}
+// Shuffles stay within 128-bit lanes, so points 0-3 / 4-7 are regrouped across lanes first
+inline void load_xy(const Point* p, f8& x, f8& y) {
+  f8 a = _mm256_loadu_ps(&p[0].x), b = _mm256_loadu_ps(&p[4].x);
+  f8 lo = _mm256_permute2f128_ps(a, b, 0x20); // points 0 1 | 4 5
+  f8 hi = _mm256_permute2f128_ps(a, b, 0x31); // points 2 3 | 6 7
+  x = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+  y = _mm256_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+}
+inline void store_xy(Point* p, f8 x, f8 y) {
+  f8 lo = _mm256_unpacklo_ps(x, y); // points 0 1 | 4 5
+  f8 hi = _mm256_unpackhi_ps(x, y); // points 2 3 | 6 7
+  _mm256_storeu_ps(&p[0].x, _mm256_permute2f128_ps(lo, hi, 0x20));
+  _mm256_storeu_ps(&p[4].x, _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define HEX_BATCH_F4 1
+using f4 = __m128;
+inline f4 add(f4 a, f4 b) { return _mm_add_ps(a, b); }
+inline f4 sub(f4 a, f4 b) { return _mm_sub_ps(a, b); }
+inline f4 mul(f4 a, f4 b) { return _mm_mul_ps(a, b); }
+inline f4 splat(float v) { return _mm_set1_ps(v); }
+inline f4 abs(f4 v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+/// round() semantics (halves away from zero), not the FPU's round-to-even
+inline f4 round(f4 v) {
+  f4 half = _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.0f)), _mm_set1_ps(0.5f));
+  return _mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_add_ps(v, half)));
+}
+inline f4 gt(f4 a, f4 b) { return _mm_cmpgt_ps(a, b); }
+inline f4 both(f4 a, f4 b) { return _mm_and_ps(a, b); }
+inline f4 but_not(f4 a, f4 b) { return _mm_andnot_ps(b, a); }
+inline f4 select(f4 mask, f4 a, f4 b) {
+  return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+inline void load_qr(const Hex* h, f4& q, f4& r) {
+  q = _mm_cvtepi32_ps(_mm_setr_epi32(h[0].q, h[1].q, h[2].q, h[3].q));
+  r = _mm_cvtepi32_ps(_mm_setr_epi32(h[0].r, h[1].r, h[2].r, h[3].r));
+}
+inline void to_ints(f4 v, int* out) { _mm_storeu_si128((__m128i*)out, _mm_cvttps_epi32(v)); }
+inline void load_xy(const Point* p, f4& x, f4& y) {
+  f4 a = _mm_loadu_ps(&p[0].x);
+  f4 b = _mm_loadu_ps(&p[2].x);
+  x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+  y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+}
+inline void store_xy(Point* p, f4 x, f4 y) {
+  _mm_storeu_ps(&p[0].x, _mm_unpacklo_ps(x, y));
+  _mm_storeu_ps(&p[2].x, _mm_unpackhi_ps(x, y));
+}
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define HEX_BATCH_F4 1
+using f4 = float32x4_t;
+inline f4 add(f4 a, f4 b) { return vaddq_f32(a, b); }
+inline f4 sub(f4 a, f4 b) { return vsubq_f32(a, b); }
+inline f4 mul(f4 a, f4 b) { return vmulq_f32(a, b); }
+inline f4 splat(float v) { return vdupq_n_f32(v); }
+inline f4 abs(f4 v) { return vabsq_f32(v); }
+inline f4 round(f4 v) { return vrndaq_f32(v); }
+inline f4 gt(f4 a, f4 b) { return vreinterpretq_f32_u32(vcgtq_f32(a, b)); }
+inline f4 both(f4 a, f4 b) {
+  return vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline f4 but_not(f4 a, f4 b) {
+  return vreinterpretq_f32_u32(vbicq_u32(vreinterpretq_u32_f32(a), vreinterpretq_u32_f32(b)));
+}
+inline f4 select(f4 mask, f4 a, f4 b) { return vbslq_f32(vreinterpretq_u32_f32(mask), a, b); }
+inline void load_qr(const Hex* h, f4& q, f4& r) {
+  int vq[4] = {h[0].q, h[1].q, h[2].q, h[3].q}, vr[4] = {h[0].r, h[1].r, h[2].r, h[3].r};
+  q = vcvtq_f32_s32(vld1q_s32(vq));
+  r = vcvtq_f32_s32(vld1q_s32(vr));
+}
+inline void to_ints(f4 v, int* out) { vst1q_s32(out, vcvtq_s32_f32(v)); }
+inline void load_xy(const Point* p, f4& x, f4& y) {
+  float32x4x2_t xy = vld2q_f32(&p[0].x);
+  x = xy.val[0];
+  y = xy.val[1];
+}
+inline void store_xy(Point* p, f4 x, f4 y) { vst2q_f32(&p[0].x, float32x4x2_t{{x, y}}); }
+#endif
+
+#ifdef HEX_BATCH_F4
+inline f4 add(f4 a, float b) { return add(a, splat(b)); }
+inline f4 sub(f4 a, float b) { return sub(a, splat(b)); }
+inline f4 mul(f4 a, float b) { return mul(a, splat(b)); }
+#endif
+
+/// Widest vector the kernels use: 8 (AVX), 4 (SSE2 / NEON) or 1 (scalar only)
+#if defined(HEX_BATCH_AVX)
+constexpr int simd_lanes = 8;
+#elif defined(HEX_BATCH_F4)
+constexpr int simd_lanes = 4;
+#else
+constexpr int simd_lanes = 1;
+#endif
+
+enum class Kind { Pointy, Flat, General };
+
+/// Kind of an orientation at runtime, for the untemplated batch overloads
+inline Kind kind_of(const Orientation& o) {
+  auto same = [&](const Orientation& k) {
+    return o.f0 == k.f0 && o.f1 == k.f1 && o.f2 == k.f2 && o.f3 == k.f3 && o.b0 == k.b0 &&
+           o.b1 == k.b1 && o.b2 == k.b2 && o.b3 == k.b3;
+  };
+  return same(layout_pointy) ? Kind::Pointy : same(layout_flat) ? Kind::Flat : Kind::General;
+}
+
+/// Float matrix terms with the layout's size and origin folded in
+struct Coeffs {
+  float f0, f1, f2, f3; ///< Forward, pre-scaled by hex_size
+  float b0, b1, b2, b3; ///< Backward
+  float ox, oy;         ///< Origin
+  float isx, isy;       ///< 1 / hex_size
+
+  /// Terms a kernel of kind K reads; pointy / flat take them from the constexpr orientations
+  template <Kind K> static Coeffs of(const Layout& layout) {
+    const Orientation& o = K == Kind::Pointy ? layout_pointy
+                           : K == Kind::Flat ? layout_flat
+                                             : layout.orientation;
+    float sx = layout.hex_size.x, sy = layout.hex_size.y;
+    return {(float)o.f0 * sx, (float)o.f1 * sx, (float)o.f2 * sy, (float)o.f3 * sy,
+            (float)o.b0,      (float)o.b1,      (float)o.b2,      (float)o.b3,
+            layout.origin.x,  layout.origin.y,  1.0f / sx,        1.0f / sy};
+  }
+};
+
+// T is float or a vector. Pointy has f2 = b2 = 0, flat has f1 = b1 = 0.
+template <Kind K, typename T> inline T pixel_x(const Coeffs& c, T q, T r) {
+  if constexpr (K == Kind::Flat)
+    return add(mul(q, c.f0), c.ox);
+  else
+    return add(add(mul(q, c.f0), mul(r, c.f1)), c.ox);
+}
+template <Kind K, typename T> inline T pixel_y(const Coeffs& c, T q, T r) {
+  if constexpr (K == Kind::Pointy)
+    return add(mul(r, c.f3), c.oy);
+  else
+    return add(add(mul(q, c.f2), mul(r, c.f3)), c.oy);
+}
+template <Kind K, typename T> inline T frac_q(const Coeffs& c, T tx, T ty) {
+  if constexpr (K == Kind::Flat)
+    return mul(tx, c.b0);
+  else
+    return add(mul(tx, c.b0), mul(ty, c.b1));
+}
+template <Kind K, typename T> inline T frac_r(const Coeffs& c, T tx, T ty) {
+  if constexpr (K == Kind::Pointy)
+    return mul(ty, c.b3);
+  else
+    return add(mul(tx, c.b2), mul(ty, c.b3));
+}
+
+/// hex_to_pixel for one vector's worth of hexes
+template <Kind K, typename V>
+inline void to_pixel_lanes(const Coeffs& c, const Hex* in, Point* out) {
+  V q, r;
+  load_qr(in, q, r);
+  store_xy(out, pixel_x<K>(c, q, r), pixel_y<K>(c, q, r));
+}
+
+/// pixel_to_hex + hex_round for one vector's worth of points; same steps as round_scalar
+template <Kind K, typename V>
+inline void to_hex_lanes(const Coeffs& c, const Point* in, Hex* out) {
+  constexpr int N = sizeof(V) / sizeof(float);
+  V x, y;
+  load_xy(in, x, y);
+  V tx = mul(sub(x, c.ox), c.isx);
+  V ty = mul(sub(y, c.oy), c.isy);
+  V q = frac_q<K>(c, tx, ty);
+  V r = frac_r<K>(c, tx, ty);
+  V s = mul(add(q, r), -1.0f);
+  V rq = round(q), rr = round(r), rs = round(s);
+  V dq = abs(sub(rq, q)), dr = abs(sub(rr, r)), ds = abs(sub(rs, s));
+  V fix_q = both(gt(dq, dr), gt(dq, ds));
+  V fix_r = but_not(gt(dr, ds), fix_q);
+  int oq[N], orr[N];
+  to_ints(select(fix_q, mul(add(rr, rs), -1.0f), rq), oq);
+  to_ints(select(fix_r, mul(add(rq, rs), -1.0f), rr), orr);
+  for (int k = 0; k < N; k++)
+    out[k] = Hex(oq[k], orr[k]);
+}
+
+/// Same steps as hex_round: round all three, then rebuild the one that rounded furthest
+inline Hex round_scalar(float q, float r) {
+  float s = -q - r;
+  float rq = std::round(q), rr = std::round(r), rs = std::round(s);
+  float dq = std::fabs(rq - q), dr = std::fabs(rr - r), ds = std::fabs(rs - s);
+  if (dq > dr && dq > ds)
+    rq = -rr - rs;
+  else if (dr > ds)
+    rr = -rq - rs;
+  return Hex((int)rq, (int)rr);
+}
+
+/// @tparam Simd false runs everything through the scalar tail (tests compare the two)
+template <Kind K, bool Simd = true>
+void to_pixel(const Coeffs& c, const Hex* in, Point* out, size_t n) {
+  size_t i = 0;
+  if constexpr (Simd) {
+#ifdef HEX_BATCH_AVX
+    for (; i + 8 <= n; i += 8)
+      to_pixel_lanes<K, f8>(c, in + i, out + i);
+#endif
+#ifdef HEX_BATCH_F4
+    for (; i + 4 <= n; i += 4)
+      to_pixel_lanes<K, f4>(c, in + i, out + i);
+#endif
+  }
+  for (; i < n; i++) {
+    float q = (float)in[i].q, r = (float)in[i].r;
+    out[i] = {pixel_x<K>(c, q, r), pixel_y<K>(c, q, r)};
+  }
+}
+
+template <Kind K, bool Simd = true>
+void to_hex(const Coeffs& c, const Point* in, Hex* out, size_t n) {
+  size_t i = 0;
+  if constexpr (Simd) {
+#ifdef HEX_BATCH_AVX
+    for (; i + 8 <= n; i += 8)
+      to_hex_lanes<K, f8>(c, in + i, out + i);
+#endif
+#ifdef HEX_BATCH_F4
+    for (; i + 4 <= n; i += 4)
+      to_hex_lanes<K, f4>(c, in + i, out + i);
+#endif
+  }
+  for (; i < n; i++) {
+    float tx = mul(sub(in[i].x, c.ox), c.isx);
+    float ty = mul(sub(in[i].y, c.oy), c.isy);
+    out[i] = round_scalar(frac_q<K>(c, tx, ty), frac_r<K>(c, tx, ty));
+  }
+}
+
+#undef HEX_BATCH_AVX
+#undef HEX_BATCH_F4
+
+} // namespace hex_batch
+
+/**
+ * @brief hex_to_pixel for a whole span of hexes (see BATCH CONVERSIONS)
+ * @tparam K Orientation of `layout`; Pointy / Flat ignore layout.orientation
+ * @param out Receives min(hexes.size(), out.size()) centers
+ */
+template <hex_batch::Kind K>
+void hex_to_pixel_batch(const Layout& layout, std::span<const Hex> hexes, std::span<Point> out) {
+  using namespace hex_batch;
+  to_pixel<K>(Coeffs::of<K>(layout), hexes.data(), out.data(), std::min(hexes.size(), out.size()));
+}
+
+/// @brief hex_to_pixel_batch with the kernel picked from layout.orientation
+inline void hex_to_pixel_batch(const Layout& layout, std::span<const Hex> hexes,
+                               std::span<Point> out) {
+  using hex_batch::Kind;
+  switch (hex_batch::kind_of(layout.orientation)) {
+    case Kind::Pointy:
+      return hex_to_pixel_batch<Kind::Pointy>(layout, hexes, out);
+    case Kind::Flat:
+      return hex_to_pixel_batch<Kind::Flat>(layout, hexes, out);
+    case Kind::General:
+      return hex_to_pixel_batch<Kind::General>(layout, hexes, out);
+  }
+}
+
+/**
+ * @brief hex_round(pixel_to_hex_fractional()) for a whole span of points
+ * @tparam K Orientation of `layout`; Pointy / Flat ignore layout.orientation
+ * @param out Receives min(points.size(), out.size()) hexes
+ */
+template <hex_batch::Kind K>
+void pixel_to_hex_batch(const Layout& layout, std::span<const Point> points, std::span<Hex> out) {
+  using namespace hex_batch;
+  to_hex<K>(Coeffs::of<K>(layout), points.data(), out.data(), std::min(points.size(), out.size()));
+}
+
+/// @brief pixel_to_hex_batch with the kernel picked from layout.orientation
+inline void pixel_to_hex_batch(const Layout& layout, std::span<const Point> points,
+                               std::span<Hex> out) {
+  using hex_batch::Kind;
+  switch (hex_batch::kind_of(layout.orientation)) {
+    case Kind::Pointy:
+      return pixel_to_hex_batch<Kind::Pointy>(layout, points, out);
+    case Kind::Flat:
+      return pixel_to_hex_batch<Kind::Flat>(layout, points, out);
+    case Kind::General:
+      return pixel_to_hex_batch<Kind::General>(layout, points, out);
+  }
+}
+
+/**
+ * @brief hex_to_world for a whole span of hexes: centers on the XZ plane at height y
+ * @tparam K Orientation of `layout`; Pointy / Flat ignore layout.orientation
+ * @param out Receives min(hexes.size(), out.size()) positions
+ */
+template <hex_batch::Kind K>
+void hex_to_world_batch(const Layout& layout, std::span<const Hex> hexes, std::span<Vector3> out,
+                        float y = 0.0f) {
+  constexpr size_t CHUNK = 256;
+  Point centers[CHUNK];
+  size_t n = std::min(hexes.size(), out.size());
+  for (size_t base = 0; base < n; base += CHUNK) {
+    size_t count = std::min(CHUNK, n - base);
+    hex_to_pixel_batch<K>(layout, hexes.subspan(base, count), std::span<Point>(centers, count));
+    for (size_t i = 0; i < count; i++)
+      out[base + i] = {centers[i].x, y, centers[i].y};
+  }
+}
+
+/// @brief hex_to_world_batch with the kernel picked from layout.orientation
+inline void hex_to_world_batch(const Layout& layout, std::span<const Hex> hexes,
+                               std::span<Vector3> out, float y = 0.0f) {
+  using hex_batch::Kind;
+  switch (hex_batch::kind_of(layout.orientation)) {
+    case Kind::Pointy:
+      return hex_to_world_batch<Kind::Pointy>(layout, hexes, out, y);
+    case Kind::Flat:
+      return hex_to_world_batch<Kind::Flat>(layout, hexes, out, y);
+    case Kind::General:
+      return hex_to_world_batch<Kind::General>(layout, hexes, out, y);
+  }
+}
+
+// Cast a ray onto the XZ plane, return hex_id or UINT_MAX if missed
+inline uint ray_hex(const Layout& layout, Ray ray) {
   if (fabsf(ray.direction.y) < 1e-6f)
     return UINT_MAX;
   float t = -ray.position.y / ray.direction.y;
@@ -581,13 +1107,24 @@ inline uint mouseray_hex(Layout layout, Camera3D camera) {
   };
   Hex h = hex_round(pixel_to_hex_fractional(layout, hit));
   // Find matching hex_id
-  uint id = 0;
-  for (auto valid : layout) {
-    if (valid == h)
-      return id;
-    id++;
-  }
-  return UINT_MAX;
+  uint id = layout.find(h);
+  return id < layout.count() ? id : UINT_MAX;
+}
+
+// Cast mouse ray onto XZ plane, return hex_id or UINT_MAX if missed
+inline uint mouseray_hex(const Layout& layout, Camera3D camera) {
+  /*
+   uint hovered_id = mouseray_hex(this->hex_layout, camera);
+    if (hovered_id != UINT_MAX && IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
+      for (auto& thing : things) {
+        if (thing.hex_id == hovered_id) {
+          higlighted_ref = thing.this_ref();
+          break;
+        }
+      }
+    }
+ */
+  return ray_hex(layout, GetScreenToWorldRay(GetMousePosition(), camera));
 }
 
 // ============================================================================
@@ -597,6 +1134,7 @@ inline uint mouseray_hex(Layout layout, Camera3D camera) {
 #include "imgui.h"
 #include "rlImGui.h"
 #include <doctest/doctest.h>
+#include <thread>
 
 TEST_CASE("hex construction") {
   Hex h1(1, 2, -3);
@@ -657,6 +1195,11 @@ TEST_CASE("hex directions and neighbors") {
   CHECK(hex_neighbor(origin, HEX_W) == Hex(-1, 0, 1));
   CHECK(hex_neighbor(origin, HEX_SW) == Hex(-1, 1, 0));
   CHECK(hex_neighbor(origin, HEX_SE) == Hex(0, 1, -1));
+
+  // Compile-time table; out-of-range directions wrap instead of reading past it
+  static_assert(hex_direction(HEX_W) == Hex(-1, 0, 1));
+  static_assert(hex_direction(HEX_DIR_COUNT) == hex_direction(HEX_E));
+  static_assert(hex_neighbor(Hex(2, 3), -1) == Hex(2, 4));
 }
 
 TEST_CASE("hex to pixel conversion") {
@@ -700,6 +1243,112 @@ TEST_CASE("pixel to hex roundtrip") {
   }
 }
 
+TEST_CASE("hex batch conversions match the scalar ones") {
+  static_assert(layout_pointy.f0 * layout_pointy.b0 + layout_pointy.f1 * layout_pointy.b2 > 0.999);
+
+  // A sheared orientation exercises the general kernel
+  constexpr double det = 1.5 * 1.2 - 0.3 * 0.2;
+  const Orientation sheared(1.5, 0.3, 0.2, 1.2, 1.2 / det, -0.3 / det, -0.2 / det, 1.5 / det, 0.0);
+  Layout layouts[] = {Layout(layout_pointy, Point{30, 30}, Point{640, 360}),
+                      Layout(layout_flat, Point{12, 20}, Point{-5, 7}),
+                      Layout(sheared, Point{25, 25}, Point{100, 0})};
+  CHECK(hex_batch::kind_of(layouts[0].orientation) == hex_batch::Kind::Pointy);
+  CHECK(hex_batch::kind_of(layouts[1].orientation) == hex_batch::Kind::Flat);
+  CHECK(hex_batch::kind_of(layouts[2].orientation) == hex_batch::Kind::General);
+
+  vector<Hex> hexes = grid_hexagon(40); // 4921: odd size, so the scalar tail runs too
+  vector<Point> centers(hexes.size());
+  vector<Vector3> world(hexes.size());
+  vector<Hex> back(hexes.size(), Hex(0, 0));
+  for (const Layout& layout : layouts) {
+    hex_to_pixel_batch(layout, hexes, centers);
+    hex_to_world_batch(layout, hexes, world, 2.0f);
+    for (size_t i = 0; i < hexes.size(); i++) {
+      Point p = hex_to_pixel(layout, hexes[i]);
+      CHECK(fabsf(centers[i].x - p.x) < 1e-2f);
+      CHECK(fabsf(centers[i].y - p.y) < 1e-2f);
+      CHECK(world[i].x == centers[i].x);
+      CHECK(world[i].y == 2.0f);
+      CHECK(world[i].z == centers[i].y);
+    }
+
+    // Centers round back to their hexes; random points land where the scalar path says
+    pixel_to_hex_batch(layout, centers, back);
+    CHECK(back == hexes);
+    uint32_t seed = 12345;
+    for (Point& p : centers) {
+      seed = seed * 1664525u + 1013904223u;
+      p.x += (float)((seed >> 8) % 2000) / 100.0f - 10.0f;
+      seed = seed * 1664525u + 1013904223u;
+      p.y += (float)((seed >> 8) % 2000) / 100.0f - 10.0f;
+    }
+    pixel_to_hex_batch(layout, centers, back);
+    for (size_t i = 0; i < centers.size(); i++) {
+      Point p = centers[i];
+      if (back[i] == hex_round(pixel_to_hex_fractional(layout, p)))
+        continue;
+      // Float and double may only disagree on a point right at an edge
+      bool at_edge = false;
+      for (Point nudge : {Point{0.01f, 0}, Point{-0.01f, 0}, Point{0, 0.01f}, Point{0, -0.01f}})
+        at_edge |= back[i] == hex_round(pixel_to_hex_fractional(
+                                 layout, Point{p.x + nudge.x, p.y + nudge.y}));
+      CHECK(at_edge);
+    }
+  }
+
+  // Output spans shorter than the input are filled, not overrun
+  Point two[2] = {};
+  hex_to_pixel_batch(layouts[0], hexes, two);
+  CHECK(two[1].x == doctest::Approx(hex_to_pixel(layouts[0], hexes[1]).x));
+}
+
+/// Vector kernels of kind K against the scalar tail alone, on the same float terms
+template <hex_batch::Kind K> static void check_batch_simd_matches_scalar(const Layout& layout) {
+  using namespace hex_batch;
+  vector<Hex> hexes = grid_hexagon(20); // 1261: leaves a tail after the 8- and 4-wide loops
+  size_t n = hexes.size();
+  Coeffs c = Coeffs::of<K>(layout);
+  vector<Point> simd_px(n), scalar_px(n);
+  to_pixel<K, true>(c, hexes.data(), simd_px.data(), n);
+  to_pixel<K, false>(c, hexes.data(), scalar_px.data(), n);
+  for (size_t i = 0; i < n; i++) {
+    CHECK(simd_px[i].x == doctest::Approx(scalar_px[i].x).epsilon(1e-6));
+    CHECK(simd_px[i].y == doctest::Approx(scalar_px[i].y).epsilon(1e-6));
+  }
+
+  // Jittered well inside each hex (< 0.3 size per axis), so no point sits near an edge
+  vector<Point> points = scalar_px;
+  uint32_t seed = 777;
+  for (Point& p : points) {
+    seed = seed * 1664525u + 1013904223u;
+    p.x += layout.hex_size.x * ((float)((seed >> 8) % 600) / 1000.0f - 0.3f);
+    seed = seed * 1664525u + 1013904223u;
+    p.y += layout.hex_size.y * ((float)((seed >> 8) % 600) / 1000.0f - 0.3f);
+  }
+  vector<Hex> simd_hex(n, Hex(0, 0)), scalar_hex(n, Hex(0, 0));
+  to_hex<K, true>(c, points.data(), simd_hex.data(), n);
+  to_hex<K, false>(c, points.data(), scalar_hex.data(), n);
+  CHECK(simd_hex == scalar_hex);
+  CHECK(simd_hex == hexes);
+}
+
+TEST_CASE("hex batch SIMD kernels match the scalar path for both orientations") {
+  CHECK((hex_batch::simd_lanes == 1 || hex_batch::simd_lanes == 4 || hex_batch::simd_lanes == 8));
+  check_batch_simd_matches_scalar<hex_batch::Kind::Pointy>(
+      Layout(layout_pointy, Point{30, 30}, Point{640, 360}));
+  check_batch_simd_matches_scalar<hex_batch::Kind::Flat>(
+      Layout(layout_flat, Point{12, 20}, Point{-5, 7}));
+
+  // Naming the kind gives the same answer as letting the layout pick it
+  Layout flat(layout_flat, Point{12, 20}, Point{-5, 7});
+  vector<Hex> hexes = grid_hexagon(5);
+  vector<Point> named(hexes.size()), picked(hexes.size());
+  hex_to_pixel_batch<hex_batch::Kind::Flat>(flat, hexes, named);
+  hex_to_pixel_batch(flat, hexes, picked);
+  for (size_t i = 0; i < hexes.size(); i++)
+    CHECK((named[i].x == picked[i].x && named[i].y == picked[i].y));
+}
+
 TEST_CASE("polygon corners") {
   Layout layout(layout_pointy, Point{30, 30}, Point{100, 100});
   Hex h(0, 0, 0);
@@ -743,6 +1392,111 @@ TEST_CASE("grid shape generators") {
   CHECK(rect_f.size() == 9);
 }
 
+TEST_CASE("layout hex index") {
+  Layout layout(layout_pointy, Point{30, 30}, Point{0, 0});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {3};
+
+  auto expected = grid_hexagon(3);
+  CHECK(layout.size() == expected.size());
+  for (uint i = 0; i < expected.size(); i++) {
+    CHECK(layout[i] == expected[i]);
+    CHECK(layout.find(expected[i]) == i);
+  }
+
+  // Hexes outside the shape (including inside the bounding range) are misses
+  CHECK(layout.find(Hex(3, 3)) == UINT_MAX);
+  CHECK(layout.find(Hex(10, 0)) == UINT_MAX);
+  CHECK(layout[layout.size()] == Hex(0, 0));
+
+  // Iteration stops at n_hex (10 by default) ...
+  uint n = 0;
+  for (auto h : layout) {
+    CHECK(h == expected[n]);
+    n++;
+  }
+  CHECK(n == 10);
+
+  // ... or covers the whole shape when uncapped, and never runs past it
+  layout.n_hex = UINT_MAX;
+  n = 0;
+  for (auto h : layout) {
+    CHECK(h == expected[n]);
+    n++;
+  }
+  CHECK(n == layout.size());
+  layout.n_hex = 5;
+  n = 0;
+  for (auto h : layout) {
+    CHECK(h == expected[n]);
+    n++;
+  }
+  CHECK(n == 5);
+  layout.n_hex = 1000;
+  CHECK(layout.count() == layout.size());
+}
+
+TEST_CASE("ray_hex covers the whole shape") {
+  Layout layout(layout_pointy, Point{1, 1}, Point{0, 0});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {60};
+  layout.n_hex = UINT_MAX;
+  Hex far = Hex(60, -30);
+  uint id = layout.find(far);
+  REQUIRE(id != UINT_MAX);
+  CHECK(id >= 10);
+
+  Point p = hex_to_pixel(layout, far);
+  Ray down = {{p.x, 10.0f, p.y}, {0.0f, -1.0f, 0.0f}};
+  CHECK(ray_hex(layout, down) == id);
+  layout.n_hex = id; // capped below it: a miss
+  CHECK(ray_hex(layout, down) == UINT_MAX);
+}
+
+TEST_CASE("layout hex index invalidates on change") {
+  Layout layout(layout_flat, Point{30, 30}, Point{0, 0});
+  layout.shape = GridShape::Parallelogram;
+  layout.params = {0, 2, 0, 2};
+  CHECK(layout.size() == 9);
+  const HexIndex* first = &layout.index();
+  CHECK(&layout.index() == first); // cached
+
+  layout.params = {-1, 2, 0, 2};
+  CHECK(layout.size() == 12);
+  CHECK(layout.find(Hex(-1, 0)) != UINT_MAX);
+
+  layout.shape = GridShape::RectanglePointy;
+  layout.params = {0, 2, 0, 2};
+  auto rect = grid_rectangle_pointy(0, 2, 0, 2);
+  CHECK(layout.size() == rect.size());
+  for (uint i = 0; i < rect.size(); i++)
+    CHECK(layout.find(rect[i]) == i);
+
+  // Copies share the table until one of them changes shape
+  Layout copy = layout;
+  CHECK(&copy.index() == &layout.index());
+  copy.params.b = 4;
+  CHECK(copy.size() == grid_rectangle_pointy(0, 4, 0, 2).size());
+  CHECK(layout.size() == rect.size());
+}
+
+TEST_CASE("layout hex index is built once under concurrent readers") {
+  for (int round = 0; round < 20; round++) {
+    Layout layout(layout_pointy, Point{1, 1}, Point{0, 0});
+    layout.shape = GridShape::Hexagon;
+    layout.params = {20 + round};
+    const HexIndex* seen[8] = {};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 8; t++)
+      readers.emplace_back([&, t] { seen[t] = &layout.index(); });
+    for (auto& r : readers)
+      r.join();
+    for (const HexIndex* idx : seen)
+      CHECK(idx == seen[0]);
+    CHECK(layout.shared_index().get() == seen[0]);
+  }
+}
+
 TEST_CASE("hex grid visual demo" * doctest::skip()) {
   // Run with: ./mylibs_tests --no-skip -tc="hex grid visual demo"
 
@@ -0,0 +1,335 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="hex grid mesh*"
+exit
+#endif
+/**
+ * @file hexgrid_mesh.hpp
+ * @brief Batched hex grid renderer — one mesh, one draw call per grid
+ *
+ * Bakes every hex of a Layout (fills and outlines) into a single vertex
+ * buffer. Corner offsets are computed once per build, and per-hex colours
+ * live in the mesh colour stream, which is patched in place and re-uploaded
+ * only over the dirty range.
+ *
+ * Vertex layout per hex (unindexed triangles, so grids can exceed 65k vertices):
+ * - 18 fill vertices  (6 triangles from the center to the inner corners)
+ * - 36 outline vertices (6 quads between the inner and outer corners)
+ * Texcoords span each hex's bounding box, so a material texture maps once per hex.
+ */
+
+#pragma once
+#include "hexgrid_math.hpp"
+#include <raylib.h>
+#include <raymath.h>
+#include <rlgl.h>
+
+struct HexGridMesh {
+  static constexpr int FILL_VERTS = 18;
+  static constexpr int OUTLINE_VERTS = 36;
+  static constexpr int HEX_VERTS = FILL_VERTS + OUTLINE_VERTS;
+  static constexpr int COLOR_BUFFER = 3; ///< Mesh vboId slot of the colour stream
+
+  Mesh mesh = {0};
+  Material material = {0};
+  std::shared_ptr<const HexIndex> index = nullptr; ///< Hexes baked into the mesh (id = slot)
+  uint hex_count = 0;
+  bool uploaded = false;
+  uint dirty_begin = UINT_MAX; ///< First hex id whose colours changed since the last upload
+  uint dirty_end = 0;          ///< One past the last dirty hex id
+
+  /**
+   * @brief Bake all hexes of a layout into the mesh
+   * @param layout Layout providing orientation, size, origin and shape
+   * @param fill Fill colour for every hex
+   * @param outline Outline colour for every hex
+   * @param thickness Outline thickness in layout units (0 = no outline)
+   * @param xz_plane Bake on the XZ plane (for BeginMode3D / hex_to_world) instead of XY
+   */
+  void build(const Layout& layout, Color fill, Color outline, float thickness = 1.0f,
+             bool xz_plane = false) {
+    unload();
+    index = layout.shared_index();
+    hex_count = (uint)index->hexes.size();
+    if (hex_count == 0)
+      return;
+
+    std::array<Point, 6> outer = hex_corner_offsets(layout);
+    float min_size = fminf(layout.hex_size.x, layout.hex_size.y);
+    float k = min_size > 0 ? fmaxf(0.0f, 1.0f - thickness / min_size) : 0.0f;
+    std::array<Point, 6> inner;
+    for (int i = 0; i < 6; i++) {
+      inner[i] = Point{outer[i].x * k, outer[i].y * k};
+    }
+
+    mesh.vertexCount = (int)hex_count * HEX_VERTS;
+    mesh.triangleCount = mesh.vertexCount / 3;
+    mesh.vertices = (float*)MemAlloc(mesh.vertexCount * 3 * sizeof(float));
+    mesh.texcoords = (float*)MemAlloc(mesh.vertexCount * 2 * sizeof(float));
+    mesh.colors = (unsigned char*)MemAlloc(mesh.vertexCount * 4 * sizeof(unsigned char));
+
+    float* v = mesh.vertices;
+    float* uv = mesh.texcoords;
+    float box_w = fmaxf(fabsf(layout.hex_size.x), 1e-6f) * 2.0f;
+    float box_h = fmaxf(fabsf(layout.hex_size.y), 1e-6f) * 2.0f;
+    auto emit = [&](Point c, Point off) {
+      float x = c.x + off.x;
+      float y = c.y + off.y;
+      *v++ = x;
+      *v++ = xz_plane ? 0.0f : y;
+      *v++ = xz_plane ? y : 0.0f;
+      *uv++ = 0.5f + off.x / box_w;
+      *uv++ = 0.5f + off.y / box_h;
+    };
+
+    vector<Point> centers(hex_count);
+    hex_to_pixel_batch(layout, index->hexes, centers);
+    for (uint id = 0; id < hex_count; id++) {
+      Point c = centers[id];
+      for (int i = 0; i < 6; i++) {
+        int j = (i + 1) % 6;
+        emit(c, {0, 0});
+        emit(c, inner[i]);
+        emit(c, inner[j]);
+      }
+      for (int i = 0; i < 6; i++) {
+        int j = (i + 1) % 6;
+        emit(c, inner[i]);
+        emit(c, outer[i]);
+        emit(c, outer[j]);
+        emit(c, inner[i]);
+        emit(c, outer[j]);
+        emit(c, inner[j]);
+      }
+      write_colors(id, 0, FILL_VERTS, fill);
+      write_colors(id, FILL_VERTS, OUTLINE_VERTS, outline);
+    }
+    dirty_begin = UINT_MAX;
+    dirty_end = 0;
+  }
+
+  /// @brief Set the fill colour of the hex with the given id.
+  void set_fill(uint id, Color color) {
+    if (id >= hex_count)
+      return;
+    write_colors(id, 0, FILL_VERTS, color);
+    mark_dirty(id);
+  }
+
+  /// @brief Set the outline colour of the hex with the given id.
+  void set_outline(uint id, Color color) {
+    if (id >= hex_count)
+      return;
+    write_colors(id, FILL_VERTS, OUTLINE_VERTS, color);
+    mark_dirty(id);
+  }
+
+  /// @brief Set the fill colour of a hex by coordinate. No-op if not in the grid.
+  void set_fill(Hex h, Color color) {
+    if (index)
+      set_fill(index->find(h), color);
+  }
+
+  /// @brief Set the outline colour of a hex by coordinate. No-op if not in the grid.
+  void set_outline(Hex h, Color color) {
+    if (index)
+      set_outline(index->find(h), color);
+  }
+
+  /// @brief Read back the fill colour of a hex id.
+  Color fill_of(uint id) const {
+    const unsigned char* c = mesh.colors + (size_t)id * HEX_VERTS * 4;
+    return {c[0], c[1], c[2], c[3]};
+  }
+
+  /// @brief Read back the outline colour of a hex id.
+  Color outline_of(uint id) const {
+    const unsigned char* c = mesh.colors + ((size_t)id * HEX_VERTS + FILL_VERTS) * 4;
+    return {c[0], c[1], c[2], c[3]};
+  }
+
+  /**
+   * @brief Upload to the GPU on first use, then push only the dirty colour range.
+   * Requires an active window / GL context.
+   */
+  void upload() {
+    if (hex_count == 0)
+      return;
+    if (!uploaded) {
+      UploadMesh(&mesh, true);
+      material = LoadMaterialDefault();
+      uploaded = true;
+      dirty_begin = UINT_MAX;
+      dirty_end = 0;
+      return;
+    }
+    if (dirty_begin < dirty_end) {
+      int offset = (int)(dirty_begin * HEX_VERTS * 4);
+      int size = (int)((dirty_end - dirty_begin) * HEX_VERTS * 4);
+      UpdateMeshBuffer(mesh, COLOR_BUFFER, mesh.colors + offset, size, offset);
+      dirty_begin = UINT_MAX;
+      dirty_end = 0;
+    }
+  }
+
+  /**
+   * @brief Draw the whole grid with one draw call.
+   * rlgl's pending batch (sprites, shapes) is flushed first, so whatever was
+   * drawn before this call ends up beneath the grid.
+   * @param transform Model transform (identity draws in layout space)
+   */
+  void draw(Matrix transform = MatrixIdentity()) {
+    if (hex_count == 0)
+      return;
+    upload();
+    rlDrawRenderBatchActive();
+    rlDisableBackfaceCulling();
+    DrawMesh(mesh, material, transform);
+    rlEnableBackfaceCulling();
+  }
+
+  /// @brief Free CPU and GPU data.
+  void unload() {
+    if (uploaded) {
+      UnloadMesh(mesh);
+      UnloadMaterial(material);
+    } else {
+      MemFree(mesh.vertices);
+      MemFree(mesh.texcoords);
+      MemFree(mesh.colors);
+    }
+    mesh = {0};
+    material = {0};
+    index = nullptr;
+    hex_count = 0;
+    uploaded = false;
+    dirty_begin = UINT_MAX;
+    dirty_end = 0;
+  }
+
+private:
+  void write_colors(uint id, int first, int count, Color color) {
+    unsigned char* c = mesh.colors + ((size_t)id * HEX_VERTS + first) * 4;
+    for (int i = 0; i < count; i++) {
+      c[i * 4 + 0] = color.r;
+      c[i * 4 + 1] = color.g;
+      c[i * 4 + 2] = color.b;
+      c[i * 4 + 3] = color.a;
+    }
+  }
+
+  void mark_dirty(uint id) {
+    dirty_begin = std::min(dirty_begin, id);
+    dirty_end = std::max(dirty_end, id + 1);
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("hex grid mesh build") {
+  Layout layout(layout_pointy, Point{30, 30}, Point{100, 100});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {2};
+
+  HexGridMesh grid;
+  grid.build(layout, DARKBLUE, WHITE, 2.0f);
+  CHECK(grid.hex_count == 19);
+  CHECK(grid.mesh.vertexCount == 19 * HexGridMesh::HEX_VERTS);
+  CHECK(grid.mesh.triangleCount * 3 == grid.mesh.vertexCount);
+
+  // First fill vertex is the hex center, outline reaches the outer corner
+  Hex h = layout[5];
+  Point center = hex_to_pixel(layout, h);
+  const float* v = grid.mesh.vertices + 5 * HexGridMesh::HEX_VERTS * 3;
+  CHECK(v[0] == doctest::Approx(center.x));
+  CHECK(v[1] == doctest::Approx(center.y));
+  const float* o = v + (HexGridMesh::FILL_VERTS + 1) * 3;
+  float dist = sqrtf((o[0] - center.x) * (o[0] - center.x) + (o[1] - center.y) * (o[1] - center.y));
+  CHECK(dist == doctest::Approx(30.0f).epsilon(0.01));
+
+  // Texcoords: the center is the middle of the hex's box, corners stay inside it
+  const float* uv = grid.mesh.texcoords + 5 * HexGridMesh::HEX_VERTS * 2;
+  CHECK(uv[0] == doctest::Approx(0.5f));
+  CHECK(uv[1] == doctest::Approx(0.5f));
+  float lo = 1.0f, hi = 0.0f;
+  for (int i = 0; i < grid.mesh.vertexCount * 2; i++) {
+    lo = fminf(lo, grid.mesh.texcoords[i]);
+    hi = fmaxf(hi, grid.mesh.texcoords[i]);
+  }
+  CHECK(lo >= 0.0f);
+  CHECK(hi <= 1.0f);
+
+  CHECK(grid.fill_of(0).b == DARKBLUE.b);
+  CHECK(grid.outline_of(18).r == WHITE.r);
+  grid.unload();
+  CHECK(grid.hex_count == 0);
+}
+
+TEST_CASE("hex grid mesh colour stream") {
+  Layout layout(layout_flat, Point{20, 20}, Point{0, 0});
+  layout.shape = GridShape::Parallelogram;
+  layout.params = {0, 9, 0, 9};
+
+  HexGridMesh grid;
+  grid.build(layout, BLACK, WHITE, 1.0f, true);
+  CHECK(grid.dirty_begin == UINT_MAX);
+
+  // XZ plane bake keeps y at 0
+  CHECK(grid.mesh.vertices[1] == doctest::Approx(0.0f));
+
+  grid.set_fill(Hex(3, 4), RED);
+  grid.set_outline(12u, YELLOW);
+  uint id = layout.find(Hex(3, 4));
+  CHECK(grid.fill_of(id).r == RED.r);
+  CHECK(grid.outline_of(id).r == WHITE.r);
+  CHECK(grid.outline_of(12).g == YELLOW.g);
+  CHECK(grid.dirty_begin == std::min(id, 12u));
+  CHECK(grid.dirty_end == std::max(id, 12u) + 1);
+
+  // Out of grid is a no-op
+  grid.set_fill(Hex(50, 50), RED);
+  CHECK(grid.dirty_end == std::max(id, 12u) + 1);
+  grid.unload();
+}
+
+TEST_CASE("hex grid mesh visual test" * doctest::skip()) {
+  // Run with: ./mylibs_tests --no-skip -tc="hex grid mesh visual test"
+  const int screenWidth = 1280;
+  const int screenHeight = 720;
+  InitWindow(screenWidth, screenHeight, "Hex Grid Mesh");
+  SetTargetFPS(60);
+
+  Layout layout(layout_pointy, Point{4, 4}, Point{screenWidth / 2.0f, screenHeight / 2.0f});
+  layout.shape = GridShape::Hexagon;
+  layout.params = {60};
+
+  HexGridMesh grid;
+  grid.build(layout, DARKBLUE, SKYBLUE, 0.5f);
+  uint hovered = UINT_MAX;
+
+  while (!WindowShouldClose()) {
+    FractionalHex fh = pixel_to_hex_fractional(layout, GetMousePosition());
+    uint id = layout.find(hex_round(fh));
+    if (id != hovered) {
+      grid.set_fill(hovered, DARKBLUE);
+      grid.set_fill(id, YELLOW);
+      hovered = id;
+    }
+
+    BeginDrawing();
+    ClearBackground(DARKGRAY);
+    grid.draw();
+    DrawText(TextFormat("%u hexes, 1 draw call", grid.hex_count), 10, 10, 20, WHITE);
+    DrawFPS(screenWidth - 100, 10);
+    EndDrawing();
+  }
+
+  grid.unload();
+  CloseWindow();
+  CHECK(true);
+}
+
+#endif
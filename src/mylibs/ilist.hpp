@@ -10,7 +10,13 @@ exit
  */
 
 #pragma once
+#include <bit>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #define MAX_ITEMS 1000
 
@@ -49,6 +55,13 @@ struct thing_base {
   int* _gen_id = nullptr;
 };
 
+/**
+ * @brief Fixed-capacity generational list.
+ *
+ * Live slots are tracked in a bitset, so iteration skips 64 dead slots per
+ * word and costs O(live + N/64) rather than O(N). size() is maintained on
+ * add/remove.
+ */
 template <typename T, size_t N> struct things_list {
   using Kinds = ilist_kind;
   using ref = thing_ref;
@@ -56,6 +69,11 @@ template <typename T, size_t N> struct things_list {
 
   T& operator[](thing_ref ref) { return things[ref.idx]; };
 
+  /// @brief Number of live items.
+  size_t size() const { return live; }
+  bool empty() const { return live == 0; }
+  static constexpr size_t capacity() { return N; }
+
   /**
    * @brief Iterator for iterating over active items
    */
@@ -63,21 +81,13 @@ template <typename T, size_t N> struct things_list {
     things_list* list;
     int idx;
 
-    iterator(things_list* l, int i) : list(l), idx(i) {
-      // Skip to first active item
-      while (idx < (int)N && !list->used[idx]) {
-        idx++;
-      }
-    }
+    iterator(things_list* l, int i) : list(l), idx(l->_next_live(i)) {}
 
     T& operator*() { return list->things[idx]; }
     T* operator->() { return &list->things[idx]; }
 
     iterator& operator++() {
-      idx++;
-      while (idx < (int)N && !list->used[idx]) {
-        idx++;
-      }
+      idx = list->_next_live(idx + 1);
       return *this;
     }
 
@@ -101,20 +111,13 @@ template <typename T, size_t N> struct things_list {
     const things_list* list;
     int idx;
 
-    const_iterator(const things_list* l, int i) : list(l), idx(i) {
-      while (idx < (int)N && !list->used[idx]) {
-        idx++;
-      }
-    }
+    const_iterator(const things_list* l, int i) : list(l), idx(l->_next_live(i)) {}
 
     const T& operator*() const { return list->things[idx]; }
     const T* operator->() const { return &list->things[idx]; }
 
     const_iterator& operator++() {
-      idx++;
-      while (idx < (int)N && !list->used[idx]) {
-        idx++;
-      }
+      idx = list->_next_live(idx + 1);
       return *this;
     }
 
@@ -139,8 +142,8 @@ template <typename T, size_t N> struct things_list {
   void remove(thing_ref ref) {
     if (ref.kind == Kinds::nil)
       return;
-    if (ref.gen_id != gen_id[ref.idx])
-      return; // stale ref
+    if (ref.gen_id != gen_id[ref.idx] || !_is_used(ref.idx))
+      return; // stale ref or already removed
 
     auto& slot = things[ref.idx];
 
@@ -149,7 +152,8 @@ template <typename T, size_t N> struct things_list {
 
     // Mark as nil
     slot.kind = Kinds::nil;
-    used[ref.idx] = false;
+    _set_used(ref.idx, false);
+    live--;
 
     // Prepend to free list (link directly since free list nodes are kind=nil)
     slot.next = free_head;
@@ -163,8 +167,9 @@ template <typename T, size_t N> struct things_list {
       things[i]._gen_id = &gen_id[i];
       things[i].kind = Kinds::nil;
       gen_id[i] = 0;
-      used[i] = false;
     }
+    for (auto& word : live_bits)
+      word = 0;
 
     // Build the free list chain
     for (int i = 0; i < (int)N - 1; i++) {
@@ -187,7 +192,7 @@ template <typename T, size_t N> struct things_list {
    */
   thing_ref add(T new_thing) {
     thing_ref slot_ref = _get_next_slot();
-    if (slot_ref.kind == Kinds::nil && !used[slot_ref.idx]) {
+    if (slot_ref.kind == Kinds::nil && slot_ref.idx >= 0 && !_is_used(slot_ref.idx)) {
       // We got a valid free slot — save bookkeeping before overwrite
       auto& slot = things[slot_ref.idx];
       int saved_index = slot._index;
@@ -203,7 +208,8 @@ template <typename T, size_t N> struct things_list {
       slot.prev = thing_ref{};
       slot.next = thing_ref{};
       slot_ref.kind = Kinds::item;
-      used[slot_ref.idx] = true;
+      _set_used(slot_ref.idx, true);
+      live++;
       gen_id[slot_ref.idx]++;
       slot_ref.gen_id = gen_id[slot_ref.idx];
       return slot_ref;
@@ -213,11 +219,36 @@ template <typename T, size_t N> struct things_list {
   }
 
 private:
+  static constexpr size_t WORDS = (N + 63) / 64;
+
   int gen_id[N];
-  bool used[N];
+  uint64_t live_bits[WORDS];
+  size_t live = 0;
   thing_ref free_head;
   T things[N];
 
+  bool _is_used(int i) const { return (live_bits[i / 64] >> (i % 64)) & 1; }
+
+  void _set_used(int i, bool on) {
+    uint64_t bit = uint64_t(1) << (i % 64);
+    live_bits[i / 64] = on ? (live_bits[i / 64] | bit) : (live_bits[i / 64] & ~bit);
+  }
+
+  /// First live slot at or after `from`, or N.
+  int _next_live(int from) const {
+    if (from >= (int)N)
+      return (int)N;
+    size_t w = (size_t)from / 64;
+    uint64_t bits = live_bits[w] & (~uint64_t(0) << (from % 64));
+    while (true) {
+      if (bits)
+        return (int)(w * 64 + std::countr_zero(bits));
+      if (++w >= WORDS)
+        return (int)N;
+      bits = live_bits[w];
+    }
+  }
+
   void _sublist_remove(T& slot) {
     if (slot.next.kind != Kinds::nil)
       things[slot.next.idx].prev = slot.prev;
@@ -229,11 +260,11 @@ private:
 
   /**
    * @brief Get the next available slot from the free list
-   * @return thing_ref to the slot (kind=nil if valid free slot, check used[])
+   * @return thing_ref to the slot (kind=nil if valid free slot, check _is_used)
    */
   thing_ref _get_next_slot() {
     if (free_head.kind == Kinds::nil && free_head.idx >= 0 && free_head.idx < (int)N &&
-        !used[free_head.idx]) {
+        !_is_used(free_head.idx)) {
       thing_ref result = free_head;
       auto& slot = things[free_head.idx];
 
@@ -252,11 +283,329 @@ private:
   }
 };
 
+/**
+ * @brief Per-slot side array for a things_list<T, N>, indexed by thing_ref.
+ *
+ * Use it to split fields out of T: cold or bulky data that hot loops
+ * shouldn't drag through the cache, or hot fields packed contiguously
+ * (SoA) for tight update loops. Values are not reset on remove, so write
+ * the column when the thing is added.
+ */
+template <typename C, size_t N> struct things_column {
+  C& operator[](thing_ref ref) { return data[ref.idx]; }
+  const C& operator[](thing_ref ref) const { return data[ref.idx]; }
+  C* begin() { return data; }
+  C* end() { return data + N; }
+
+  C data[N] = {};
+};
+
+/**
+ * @brief Growable side column for paged_things_list (things_column with N = 0).
+ *
+ * Grows on write to cover the slot being accessed; reads past the end
+ * return a default value.
+ */
+template <typename C> struct things_column<C, 0> {
+  C& operator[](thing_ref ref) {
+    if ((size_t)ref.idx >= data.size())
+      data.resize((size_t)ref.idx + 1);
+    return data[ref.idx];
+  }
+  const C& operator[](thing_ref ref) const {
+    static const C empty = {};
+    return (size_t)ref.idx < data.size() ? data[ref.idx] : empty;
+  }
+  auto begin() { return data.begin(); }
+  auto end() { return data.end(); }
+
+  std::vector<C> data;
+};
+
+/**
+ * @brief Growable things_list: slots live in fixed-size pages allocated on demand.
+ *
+ * Same thing_ref / thing_base contract as things_list: indices and refs stay
+ * valid across growth (pages never move), removed slots go to a free list and
+ * stale refs are rejected by generation. Nothing is constructed until the
+ * first add, so an empty list is cheap to create.
+ *
+ * Capacity policy:
+ * - reserve(n) pre-allocates pages for n slots
+ * - max_pages caps growth (add returns a nil ref when full)
+ * - shrink_to_fit() frees trailing pages with no live slots
+ *
+ * write_raw() / read_raw() dump and restore the whole list bytewise (see snapshot.hpp).
+ */
+template <typename T, size_t PAGE = 256> struct paged_things_list {
+  using Kinds = ilist_kind;
+  using ref = thing_ref;
+  using thing = T;
+
+  static constexpr size_t WORDS = (PAGE + 63) / 64;
+
+  struct Page {
+    int gen_id[PAGE] = {};
+    uint64_t live_bits[WORDS] = {};
+    T things[PAGE];
+  };
+
+  size_t max_pages = SIZE_MAX;
+
+  T& operator[](thing_ref ref) {
+    if (ref.idx < 0 || (size_t)ref.idx >= capacity())
+      return _nil_thing();
+    return _page(ref.idx).things[ref.idx % PAGE];
+  }
+  T& get(thing_ref ref) { return (*this)[ref]; }
+
+  /// @brief Number of live items.
+  size_t size() const { return live; }
+  bool empty() const { return live == 0; }
+  /// @brief Slots currently allocated (grows in PAGE steps).
+  size_t capacity() const { return pages.size() * PAGE; }
+  size_t page_count() const { return pages.size(); }
+
+  template <typename List, typename Item> struct basic_iterator {
+    List* list;
+    int idx;
+
+    basic_iterator(List* l, int i) : list(l), idx(l->_next_live(i)) {}
+
+    Item& operator*() const { return list->_page(idx).things[idx % PAGE]; }
+    Item* operator->() const { return &**this; }
+
+    basic_iterator& operator++() {
+      idx = list->_next_live(idx + 1);
+      return *this;
+    }
+    basic_iterator operator++(int) {
+      basic_iterator tmp = *this;
+      ++(*this);
+      return tmp;
+    }
+
+    bool operator==(const basic_iterator& other) const { return idx == other.idx; }
+    bool operator!=(const basic_iterator& other) const { return idx != other.idx; }
+  };
+  using iterator = basic_iterator<paged_things_list, T>;
+  using const_iterator = basic_iterator<const paged_things_list, const T>;
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, (int)capacity()); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, (int)capacity()); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  /// @brief Allocate pages until at least n slots exist (bounded by max_pages).
+  void reserve(size_t n) {
+    while (capacity() < n && pages.size() < max_pages)
+      _grow();
+  }
+
+  /**
+   * @brief Add a new item, growing by one page when the free list is empty
+   * @return Reference to the new item, or nil ref if max_pages is reached
+   */
+  thing_ref add(T new_thing) {
+    if (free_slots.empty()) {
+      if (pages.size() >= max_pages)
+        return thing_ref{};
+      _grow();
+    }
+    int idx = free_slots.back();
+    free_slots.pop_back();
+
+    Page& page = _page(idx);
+    int local = idx % (int)PAGE;
+    T& slot = page.things[local];
+    int* saved_gen_id = slot._gen_id;
+    slot = new_thing;
+    slot._index = idx;
+    slot._gen_id = saved_gen_id;
+    slot.kind = Kinds::item;
+    slot.prev = thing_ref{};
+    slot.next = thing_ref{};
+
+    page.live_bits[local / 64] |= uint64_t(1) << (local % 64);
+    live++;
+    return {Kinds::item, ++page.gen_id[local], idx};
+  }
+
+  /**
+   * @brief Remove an item and return it to the free list
+   */
+  void remove(thing_ref ref) {
+    if (ref.kind == Kinds::nil || ref.idx < 0 || (size_t)ref.idx >= capacity())
+      return;
+    Page& page = _page(ref.idx);
+    int local = ref.idx % (int)PAGE;
+    if (ref.gen_id != page.gen_id[local] || !_is_used(ref.idx))
+      return; // stale ref or already removed
+
+    T& slot = page.things[local];
+    if (slot.next.kind != Kinds::nil)
+      (*this)[slot.next].prev = slot.prev;
+    if (slot.prev.kind != Kinds::nil)
+      (*this)[slot.prev].next = slot.next;
+    slot.prev = thing_ref{};
+    slot.next = thing_ref{};
+    slot.kind = Kinds::nil;
+
+    page.live_bits[local / 64] &= ~(uint64_t(1) << (local % 64));
+    live--;
+    free_slots.push_back(ref.idx);
+  }
+
+  /// @brief Free trailing pages that hold no live items.
+  void shrink_to_fit() {
+    while (!pages.empty() && _page_empty(*pages.back())) {
+      int first = (int)((pages.size() - 1) * PAGE);
+      for (int g : pages.back()->gen_id)
+        gen_floor = g > gen_floor ? g : gen_floor;
+      std::erase_if(free_slots, [&](int i) { return i >= first; });
+      pages.pop_back();
+    }
+    free_slots.shrink_to_fit();
+  }
+
+  /**
+   * @brief Append the list's state to `out` as raw bytes: every page (generations, live
+   * bits, items), the free list, the live count and the generation floor.
+   * Out needs write(const void*, size_t). Items are copied bytewise, so any
+   * pointers they hold (other than the list's own _gen_id) mean nothing in
+   * another process; the caller saves what they point at separately.
+   */
+  template <typename Out> void write_raw(Out& out) const {
+    static_assert(std::is_trivially_copyable_v<T>, "write_raw copies items bytewise");
+    uint64_t header[6] = {PAGE, sizeof(T), pages.size(), free_slots.size(), live,
+                          (uint64_t)(int64_t)gen_floor};
+    out.write(header, sizeof(header));
+    for (const auto& page : pages)
+      out.write(page.get(), sizeof(Page));
+    out.write(free_slots.data(), free_slots.size() * sizeof(int));
+  }
+
+  /**
+   * @brief Replace the list with one written by write_raw(). In needs
+   * read(void*, size_t) returning false when short, and remaining(). On
+   * failure (truncated or corrupt data, other PAGE or item size, out-of-range
+   * free list, live count that doesn't match the live bits) the list is left
+   * untouched, and nothing is allocated for counts the input can't hold.
+   * Refs taken before the save resolve to the same items after.
+   */
+  template <typename In> bool read_raw(In& in) {
+    uint64_t header[6];
+    if (!in.read(header, sizeof(header)) || header[0] != PAGE || header[1] != sizeof(T) ||
+        header[2] > max_pages || header[2] > in.remaining() / sizeof(Page))
+      return false;
+    // Page count is bounded by the input now, so these products can't overflow
+    size_t slots = header[2] * PAGE;
+    size_t free_room = (in.remaining() - header[2] * sizeof(Page)) / sizeof(int);
+    if (header[3] > slots || header[3] > free_room || header[4] > slots)
+      return false;
+    std::vector<std::unique_ptr<Page>> loaded(header[2]);
+    size_t live_bits = 0;
+    for (size_t p = 0; p < loaded.size(); p++) {
+      loaded[p] = std::make_unique<Page>();
+      if (!in.read(loaded[p].get(), sizeof(Page)))
+        return false;
+      for (uint64_t w : loaded[p]->live_bits)
+        live_bits += (size_t)std::popcount(w);
+      for (int i = 0; i < (int)PAGE; i++) {
+        loaded[p]->things[i]._index = (int)(p * PAGE) + i;
+        loaded[p]->things[i]._gen_id = &loaded[p]->gen_id[i];
+      }
+    }
+    if (live_bits != header[4])
+      return false;
+    std::vector<int> free(header[3]);
+    if (!in.read(free.data(), free.size() * sizeof(int)))
+      return false;
+    for (int idx : free)
+      if (idx < 0 || (size_t)idx >= slots)
+        return false;
+    pages = std::move(loaded);
+    free_slots = std::move(free);
+    live = header[4];
+    gen_floor = (int)(int64_t)header[5];
+    return true;
+  }
+
+private:
+  std::vector<std::unique_ptr<Page>> pages;
+  std::vector<int> free_slots; ///< LIFO of free slot indices
+  size_t live = 0;
+  int gen_floor = 0; ///< Highest generation of any freed page, so regrown slots never reuse a gen
+
+  Page& _page(int idx) const { return *pages[(size_t)idx / PAGE]; }
+
+  bool _is_used(int idx) const {
+    int local = idx % (int)PAGE;
+    return (_page(idx).live_bits[local / 64] >> (local % 64)) & 1;
+  }
+
+  static bool _page_empty(const Page& page) {
+    for (uint64_t w : page.live_bits)
+      if (w)
+        return false;
+    return true;
+  }
+
+  /// Sentinel for out-of-range lookups, reset on every hit. thread_local so callers resolving
+  /// refs from worker threads (TraitAPI::tick_all with a JobSystem) never share or race on it.
+  static T& _nil_thing() {
+    thread_local T nil;
+    nil = T{};
+    return nil;
+  }
+
+  void _grow() {
+    int first = (int)capacity();
+    auto page = std::make_unique<Page>();
+    for (int i = 0; i < (int)PAGE; i++) {
+      page->gen_id[i] = gen_floor;
+      page->things[i]._index = first + i;
+      page->things[i]._gen_id = &page->gen_id[i];
+      page->things[i].kind = Kinds::nil;
+    }
+    pages.push_back(std::move(page));
+    // New slots go under the existing free ones, highest first, so lower indices are handed out
+    // first and pages fill in order
+    std::vector<int> fresh(PAGE);
+    for (int i = 0; i < (int)PAGE; i++)
+      fresh[i] = first + (int)PAGE - 1 - i;
+    free_slots.insert(free_slots.begin(), fresh.begin(), fresh.end());
+  }
+
+  /// First live slot at or after `from`, or capacity().
+  int _next_live(int from) const {
+    int cap = (int)capacity();
+    while (from < cap) {
+      const Page& page = _page(from);
+      int local = from % (int)PAGE;
+      size_t w = (size_t)local / 64;
+      uint64_t bits = page.live_bits[w] & (~uint64_t(0) << (local % 64));
+      while (true) {
+        if (bits)
+          return from - local + (int)(w * 64 + std::countr_zero(bits));
+        if (++w >= WORDS)
+          break;
+        bits = page.live_bits[w];
+      }
+      from = from - local + (int)PAGE;
+    }
+    return cap;
+  }
+};
+
 // ============================================================================
 // DOCTEST - Tests run when compiled with tests_main.cpp
 // ============================================================================
 #ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
+#include <thread>
 
 struct Enemy : thing_base {
   float x = 0, y = 0;
@@ -365,6 +714,133 @@ TEST_CASE("things_list remove") {
   CHECK(enemies[rf].health == 60);
 }
 
+TEST_CASE("things_list live count and sparse iteration") {
+  things_list<Enemy, 200> enemies;
+  CHECK(enemies.empty());
+  CHECK(enemies.capacity() == 200);
+
+  std::vector<thing_ref> refs;
+  for (int i = 0; i < 200; i++)
+    refs.push_back(enemies.add(Enemy{(float)i, 0, i}));
+  CHECK(enemies.size() == 200);
+  CHECK(enemies.add(Enemy{}).kind == ilist_kind::nil); // full
+
+  // Keep only a few slots spread across bitset words
+  for (int i = 0; i < 200; i++)
+    if (i != 3 && i != 64 && i != 130 && i != 199)
+      enemies.remove(refs[i]);
+  CHECK(enemies.size() == 4);
+
+  std::vector<int> seen;
+  for (auto& e : enemies)
+    seen.push_back(e.health);
+  CHECK(seen == std::vector<int>{3, 64, 130, 199});
+
+  const auto& cenemies = enemies;
+  int n = 0;
+  for (auto it = cenemies.cbegin(); it != cenemies.cend(); ++it)
+    n++;
+  CHECK(n == 4);
+
+  // Double remove doesn't corrupt the count or the free list
+  enemies.remove(refs[3]);
+  enemies.remove(refs[3]);
+  CHECK(enemies.size() == 3);
+  for (int i = 0; i < 197; i++)
+    CHECK(enemies.add(Enemy{}).kind == ilist_kind::item);
+  CHECK(enemies.size() == 200);
+  CHECK(enemies.add(Enemy{}).kind == ilist_kind::nil);
+}
+
+TEST_CASE("things_list side column") {
+  things_list<Enemy, 8> enemies;
+  things_column<float, 8> speed;
+
+  thing_ref a = enemies.add(Enemy{0, 0, 1});
+  thing_ref b = enemies.add(Enemy{0, 0, 2});
+  speed[a] = 1.5f;
+  speed[b] = 3.0f;
+  for (auto& e : enemies)
+    e.x += speed[e.this_ref()];
+  CHECK(enemies[a].x == doctest::Approx(1.5f));
+  CHECK(enemies[b].x == doctest::Approx(3.0f));
+}
+
+TEST_CASE("things_list paged growth") {
+  paged_things_list<Enemy, 64> enemies;
+  CHECK(enemies.capacity() == 0);
+  CHECK(enemies.begin() == enemies.end());
+
+  std::vector<thing_ref> refs;
+  for (int i = 0; i < 150; i++)
+    refs.push_back(enemies.add(Enemy{(float)i, 0, i}));
+  CHECK(enemies.size() == 150);
+  CHECK(enemies.page_count() == 3);
+
+  // Refs and element addresses survive growth
+  Enemy* first = &enemies[refs[0]];
+  for (int i = 0; i < 100; i++)
+    enemies.add(Enemy{});
+  CHECK(&enemies[refs[0]] == first);
+  CHECK(enemies[refs[149]].health == 149);
+  CHECK(enemies[refs[70]].this_ref() == refs[70]);
+
+  // Stale refs are rejected, slots are reused with a new generation
+  enemies.remove(refs[5]);
+  enemies.remove(refs[5]);
+  CHECK(enemies.size() == 249);
+  thing_ref reused = enemies.add(Enemy{0, 0, 500});
+  CHECK(reused.idx == refs[5].idx);
+  CHECK(reused.gen_id != refs[5].gen_id);
+  enemies.remove(refs[5]);
+  CHECK(enemies[reused].health == 500);
+
+  // Out of range refs hit a nil sentinel instead of a live slot
+  thing_ref far = {ilist_kind::item, 1, 100000};
+  CHECK(!enemies[far]);
+  enemies[far].health = 7; // scribbling on the sentinel doesn't stick
+  CHECK(enemies[far].health == 100);
+  Enemy* worker_nil = nullptr;
+  std::thread([&] { worker_nil = &enemies[far]; }).join();
+  CHECK(worker_nil != &enemies[far]); // one sentinel per thread
+
+  int n = 0;
+  for (auto& e : enemies) {
+    (void)e;
+    n++;
+  }
+  CHECK(n == (int)enemies.size());
+}
+
+TEST_CASE("things_list paged capacity policy") {
+  paged_things_list<Enemy, 32> enemies;
+  enemies.reserve(70);
+  CHECK(enemies.page_count() == 3);
+  CHECK(enemies.size() == 0);
+
+  enemies.max_pages = 3;
+  std::vector<thing_ref> refs;
+  for (int i = 0; i < 96; i++)
+    refs.push_back(enemies.add(Enemy{}));
+  CHECK(enemies.add(Enemy{}).kind == ilist_kind::nil); // capped
+
+  // Empty trailing pages are released; gens keep climbing after regrowth
+  for (int i = 40; i < 96; i++)
+    enemies.remove(refs[i]);
+  enemies.shrink_to_fit();
+  CHECK(enemies.page_count() == 2);
+  CHECK(enemies.size() == 40);
+  for (int i = 0; i < 56; i++)
+    enemies.add(Enemy{});
+  CHECK(enemies.page_count() == 3);
+  CHECK(!(enemies[refs[90]].this_ref() == refs[90]));
+
+  things_column<int, 0> tags;
+  tags[refs[39]] = 7;
+  CHECK(tags[refs[39]] == 7);
+  CHECK(std::as_const(tags)[thing_ref{ilist_kind::item, 1, 5000}] == 0);
+}
+
 TEST_CASE("things_list clear and re-add") {
   things_list<Enemy, 100> enemies;
 
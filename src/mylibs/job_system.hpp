@@ -0,0 +1,308 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="job system*"
+exit
+#endif
+/**
+ * @file job_system.hpp
+ * @brief Work-stealing thread pool with parallel_for over index ranges and things_lists
+ *
+ * Every thread in the pool (plus the thread that calls parallel_for, which
+ * is slot 0) owns a task queue. parallel_for splits its range into
+ * `grain`-sized chunks spread over all queues; each thread pops its own
+ * queue from the back and steals from the front of the others when it runs
+ * dry, and the caller works through chunks too until the range is done.
+ *
+ * The body receives the index of the thread running it (0 ..
+ * thread_count() - 1), so results can go to per-thread buffers that are
+ * merged afterwards instead of a shared container behind a lock.
+ *
+ * Bodies must not call raylib draw / GL functions; keep those on the main
+ * thread. parallel_for may be nested inside a body, but only one thread
+ * outside the pool (normally the main thread) should call it.
+ *
+ * Usage:
+ *   JobSystem jobs;
+ *   jobs.start();
+ *   std::vector<std::vector<Hit>> hits(jobs.thread_count());
+ *   jobs.parallel_for_each(entities, [&](Entity& e, int t) {
+ *     if (hit(e)) hits[t].push_back(...);
+ *   });
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct JobSystem {
+  struct Task {
+    void (*run)(void* body, int lo, int hi, int thread);
+    void* body;
+    int lo, hi;
+    std::atomic<int>* pending;
+  };
+
+  /// Ring of tasks; sized once in start() and only grows past that, so steady frames don't allocate
+  struct Queue {
+    std::mutex mutex;
+    std::vector<Task> ring;
+    size_t head = 0, count = 0;
+
+    explicit Queue(size_t capacity) : ring(capacity) {}
+
+    void push_back(const Task& t) {
+      if (count == ring.size()) {
+        std::vector<Task> bigger(std::max<size_t>(16, ring.size() * 2));
+        for (size_t i = 0; i < count; i++)
+          bigger[i] = ring[(head + i) % ring.size()];
+        ring.swap(bigger);
+        head = 0;
+      }
+      ring[(head + count++) % ring.size()] = t;
+    }
+    Task pop_back() { return ring[(head + --count) % ring.size()]; }
+    Task pop_front() {
+      Task t = ring[head];
+      head = (head + 1) % ring.size();
+      count--;
+      return t;
+    }
+  };
+
+  /// Tasks each queue holds before it has to grow: one parallel_for's chunks, plus nesting
+  static constexpr size_t QUEUE_CAPACITY = 256;
+
+  std::vector<std::thread> workers;
+  std::vector<std::unique_ptr<Queue>> queues; ///< [0] = calling thread, [i] = workers[i - 1]
+  std::mutex sleep_mutex;
+  std::condition_variable wake;
+  std::atomic<int> queued{0};
+  std::atomic<bool> stopping{false};
+
+  /// Queue / buffer index of the current thread; 0 outside the pool
+  static inline thread_local int this_thread = 0;
+
+  JobSystem() = default;
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  ~JobSystem() { stop(); }
+
+  /// @brief Spawn worker threads (0 = hardware threads - 1). No-op if running.
+  void start(int threads = 0) {
+    if (!workers.empty())
+      return;
+    if (threads <= 0)
+      threads = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+    stopping = false;
+    queues.clear();
+    for (int i = 0; i <= threads; i++)
+      queues.push_back(std::make_unique<Queue>(QUEUE_CAPACITY));
+    for (int i = 1; i <= threads; i++)
+      workers.emplace_back([this, i] { worker_loop(i); });
+  }
+
+  void stop() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto& w : workers)
+      w.join();
+    workers.clear();
+  }
+
+  /// @brief Threads that can run a body at once (workers + caller); size per-thread buffers to it.
+  int thread_count() const { return std::max(1, (int)queues.size()); }
+
+  /**
+   * @brief Run body(lo, hi, thread) over [begin, end) in chunks of `grain`, and wait.
+   * Runs inline when the pool isn't started or the range is a single chunk.
+   */
+  template <typename Fn> void parallel_for(int begin, int end, int grain, Fn&& body) {
+    if (end <= begin)
+      return;
+    grain = std::max(1, grain);
+    int chunks = (end - begin + grain - 1) / grain;
+    if (workers.empty() || chunks == 1) {
+      body(begin, end, this_thread);
+      return;
+    }
+
+    using Body = std::remove_reference_t<Fn>;
+    auto run = [](void* b, int lo, int hi, int thread) {
+      (*static_cast<Body*>(b))(lo, hi, thread);
+    };
+    void* ptr = const_cast<void*>(static_cast<const void*>(std::addressof(body)));
+    std::atomic<int> pending{chunks};
+    queued += chunks; // before the pushes, so it never undercounts what is queued
+    int start_queue = this_thread;
+    for (int c = 0; c < chunks; c++) {
+      int lo = begin + c * grain;
+      Queue& q = *queues[(size_t)(start_queue + c) % queues.size()];
+      std::lock_guard<std::mutex> lock(q.mutex);
+      q.push_back({run, ptr, lo, std::min(end, lo + grain), &pending});
+    }
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex); // no worker is between its check and wait
+    }
+    wake.notify_all();
+
+    while (pending.load(std::memory_order_acquire) > 0)
+      if (!run_one(this_thread))
+        std::this_thread::yield();
+  }
+
+  /**
+   * @brief Call body(item, thread) for every live item of a things_list / paged_things_list.
+   * Chunks are slot ranges, so dead slots cost the same as in a serial loop.
+   */
+  template <typename List, typename Fn>
+  void parallel_for_each(List& list, Fn&& body, int grain = 256) {
+    parallel_for(0, (int)list.capacity(), grain, [&](int lo, int hi, int thread) {
+      for (typename List::iterator it(&list, lo); it.idx < hi; ++it)
+        body(*it, thread);
+    });
+  }
+
+private:
+  bool pop(Queue& q, bool back, Task& out) {
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if (q.count == 0)
+      return false;
+    out = back ? q.pop_back() : q.pop_front();
+    return true;
+  }
+
+  /// Own queue first (newest task), then steal the oldest task of another thread.
+  bool run_one(int self) {
+    if (queued.load(std::memory_order_relaxed) <= 0)
+      return false;
+    Task task;
+    bool got = pop(*queues[self], true, task);
+    for (size_t i = 1; !got && i < queues.size(); i++)
+      got = pop(*queues[(self + i) % queues.size()], false, task);
+    if (!got)
+      return false;
+    queued--;
+    task.run(task.body, task.lo, task.hi, self);
+    task.pending->fetch_sub(1, std::memory_order_release);
+    return true;
+  }
+
+  void worker_loop(int self) {
+    this_thread = self;
+    while (!stopping) {
+      if (run_one(self))
+        continue;
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      wake.wait(lock, [&] { return stopping || queued.load() > 0; });
+    }
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "ilist.hpp"
+#include <doctest/doctest.h>
+#include <numeric>
+
+TEST_CASE("job system parallel_for covers the range once") {
+  JobSystem jobs;
+  std::vector<std::atomic<int>> seen(10000);
+
+  // Not started: runs inline on the caller
+  jobs.parallel_for(0, 100, 7, [&](int lo, int hi, int thread) {
+    CHECK(thread == 0);
+    for (int i = lo; i < hi; i++)
+      seen[i]++;
+  });
+
+  jobs.start(4);
+  CHECK(jobs.thread_count() == 5);
+  std::vector<int> per_thread(jobs.thread_count(), 0);
+  jobs.parallel_for(0, 10000, 64, [&](int lo, int hi, int thread) {
+    per_thread[thread] += hi - lo; // each thread owns its slot
+    for (int i = lo; i < hi; i++)
+      seen[i]++;
+  });
+  CHECK(std::accumulate(per_thread.begin(), per_thread.end(), 0) == 10000);
+  for (int i = 0; i < 10000; i++)
+    CHECK(seen[i] == (i < 100 ? 2 : 1));
+
+  // Nested ranges finish without deadlock
+  std::atomic<int> total{0};
+  jobs.parallel_for(0, 8, 1, [&](int, int, int) {
+    jobs.parallel_for(0, 100, 10, [&](int lo, int hi, int) { total += hi - lo; });
+  });
+  CHECK(total == 800);
+  jobs.stop();
+}
+
+TEST_CASE("job system queues wrap and grow past their ring") {
+  JobSystem::Queue q(4);
+  JobSystem::Task t = {};
+  for (int round = 0; round < 3; round++) { // head walks around the ring
+    for (int i = 0; i < 3; i++) {
+      t.lo = i;
+      q.push_back(t);
+    }
+    CHECK(q.pop_front().lo == 0);
+    CHECK(q.pop_back().lo == 2);
+    CHECK(q.pop_front().lo == 1);
+    CHECK(q.count == 0);
+  }
+  q.push_back(t); // leave head mid-ring before growing
+  q.pop_front();
+  for (int i = 0; i < 10; i++) {
+    t.lo = i;
+    q.push_back(t);
+  }
+  CHECK(q.ring.size() >= 10);
+  for (int i = 0; i < 10; i++)
+    CHECK(q.pop_front().lo == i);
+
+  // Far more chunks than QUEUE_CAPACITY per queue
+  JobSystem jobs;
+  jobs.start(1);
+  std::atomic<int> total{0};
+  jobs.parallel_for(0, 5000, 1, [&](int lo, int hi, int) { total += hi - lo; });
+  CHECK(total == 5000);
+}
+
+TEST_CASE("job system parallel_for_each with per-thread buffers") {
+  struct Item : thing_base {
+    int value = 0;
+  };
+  auto list = std::make_unique<things_list<Item, 2048>>();
+  std::vector<thing_ref> refs;
+  for (int i = 0; i < 2048; i++) {
+    Item item;
+    item.value = i;
+    refs.push_back(list->add(item));
+  }
+  for (int i = 0; i < 2048; i += 3)
+    list->remove(refs[i]);
+
+  JobSystem jobs;
+  jobs.start(3);
+  std::vector<std::vector<int>> found(jobs.thread_count());
+  jobs.parallel_for_each(
+      *list, [&](Item& item, int thread) { found[thread].push_back(item.value); }, 100);
+  std::vector<int> merged;
+  for (auto& f : found)
+    merged.insert(merged.end(), f.begin(), f.end());
+  std::sort(merged.begin(), merged.end());
+  REQUIRE(merged.size() == list->size());
+  for (size_t i = 0; i < merged.size(); i++)
+    CHECK(merged[i] % 3 != 0);
+}
+
+#endif
@@ -6,7 +6,16 @@ extern "C" {
 #include <lualib.h>
 }
 
+#include "file_watcher.hpp"
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 #include <string>
+#include <sys/stat.h>
+#include <unordered_map>
+#include <vector>
 
 // Forward declarations — the game must define these before including lua_api.hpp
 // or link them via its own headers. LuaAPI calls into GameCtxAPI, ModelAPI, TraitAPI,
@@ -16,50 +25,320 @@ namespace LuaAPI {
 
 inline lua_State* L = nullptr;
 
+// ---- entity handles ----
+//
+// Entities are passed to Lua as integers packing a thing_ref: gen_id in the
+// high 32 bits, slot index in the low 32. Lookups are O(1) and a handle whose
+// entity has been despawned (or whose slot was reused) is detected by
+// generation. gen_id starts at 1, so every handle is >= 2^32; smaller values
+// are treated as the old iteration-order "entity index" (O(n), kept for
+// existing scripts).
+
+inline lua_Integer pack_ref(thing_ref ref) {
+  return ((lua_Integer)(uint32_t)ref.gen_id << 32) | (lua_Integer)(uint32_t)ref.idx;
+}
+
+inline thing_ref unpack_ref(lua_Integer handle) {
+  return {ilist_kind::item, (int)(uint32_t)(handle >> 32), (int)(uint32_t)handle};
+}
+
+// Model and trait names can be interned once with model_id() / trait_id();
+// every call that takes a name also takes the id, skipping the string hash.
+
+inline lua_Integer pack_model(ModelHandle h) {
+  return ((lua_Integer)h.gen << 32) | (lua_Integer)h.idx;
+}
+
+/// Model argument: a model_id() integer or a model name. Null handle if unknown.
+inline ModelHandle check_model(lua_State* L, int arg) {
+  if (lua_type(L, arg) == LUA_TNUMBER) {
+    lua_Integer v = luaL_checkinteger(L, arg);
+    return {(uint32_t)v, (uint32_t)(v >> 32)};
+  }
+  return ModelAPI::handle(luaL_checkstring(L, arg));
+}
+
+/// Trait argument: a trait_id() integer or a trait name. -1 for an unknown name;
+/// an id that isn't a registered trait slot raises a Lua error.
+inline int check_trait(lua_State* L, int arg) {
+  if (lua_type(L, arg) == LUA_TNUMBER) {
+    lua_Integer slot = luaL_checkinteger(L, arg);
+    if (slot < 0 || slot >= MAX_TRAITS || !TraitAPI::entry_at((int)slot))
+      return luaL_argerror(L, arg, "invalid trait id");
+    return (int)slot;
+  }
+  return TraitAPI::find(luaL_checkstring(L, arg));
+}
+
+/// Push a handle, or nil for a failed spawn.
+inline void push_ref(lua_State* L, thing_ref ref) {
+  if (ref.kind == ilist_kind::nil)
+    lua_pushnil(L);
+  else
+    lua_pushinteger(L, pack_ref(ref));
+}
+
+/// Resolve argument `arg` to a live entity ref, or nil ref (with a console message).
+inline thing_ref check_ref(lua_State* L, int arg) {
+  lua_Integer v = luaL_checkinteger(L, arg);
+  if (v >= 0 && v < ((lua_Integer)1 << 32)) { // legacy entity index
+    int i = 0;
+    for (auto& e : GameCtxAPI::ctx.entities)
+      if (i++ == v)
+        return e.this_ref();
+    GameConsoleAPI::print("lua: invalid entity index " + std::to_string(v),
+                          GameConsoleAPI::Level::Warn);
+    return thing_ref::get_nil_ref();
+  }
+  thing_ref ref = unpack_ref(v);
+  auto& e = GameCtxAPI::ctx.entities[ref];
+  if (!e || e.this_ref() != ref) {
+    GameConsoleAPI::print("lua: stale entity handle", GameConsoleAPI::Level::Warn);
+    return thing_ref::get_nil_ref();
+  }
+  return ref;
+}
+
+// ---- script modules ----
+//
+// Every file run through run_file() is a module that remembers the entities
+// it declared. Each spawn call is keyed by (model slot, how many of that model
+// the script has spawned so far), so re-running an edited script matches its
+// spawns to the entities from the last run instead of creating new ones:
+//   - same key: the entity is kept; position / scale / parent are only
+//     touched if the script now says something different, so anything the
+//     game did to it in the meantime survives an unrelated edit
+//   - traits applied last run but not this run are removed
+//   - keys the script no longer reaches are despawned, new keys spawn
+// A declared entity that the game despawned (a collected pickup) is spawned
+// again. Nothing outside the module is touched; the scene is never cleared.
+
+struct Decl {
+  thing_ref ref;
+  Vector3 pos;
+  float scale;
+  thing_ref spawner;
+  TraitMask traits;  ///< Applied by the script on its last completed run
+  TraitMask applied; ///< Applied so far in the current run
+  bool seen;
+};
+
+struct Module {
+  std::string path;
+  uint64_t hash = 0; ///< Source hash of the last run, to skip touched-but-unchanged files
+  int runs = 0;
+  std::unordered_map<uint64_t, Decl> decls;
+  std::unordered_map<lua_Integer, uint64_t> key_of; ///< pack_ref(entity) -> decl key
+  std::unordered_map<uint32_t, uint32_t> ordinal;   ///< Spawns per model key this run
+};
+
+inline std::unordered_map<std::string, Module> modules;
+inline Module* running = nullptr; ///< Module whose chunk is executing, if any
+inline FileWatcher* watcher = nullptr;
+
+/// @brief Spawn on behalf of the running module, reusing last run's entity for the same key.
+inline thing_ref declare_spawn(const GameCtxAPI::SpawnArgs& args) {
+  if (!running)
+    return GameCtxAPI::spawn(args);
+  Module& m = *running;
+  ModelHandle model = args.model.valid() ? args.model : ModelAPI::handle(args.model_name);
+  // Unknown models get their own key space; idx 0 is a real slot
+  uint32_t model_key = model.valid() ? model.idx : UINT32_MAX;
+  uint64_t key = ((uint64_t)model_key << 32) | m.ordinal[model_key]++;
+
+  auto it = m.decls.find(key);
+  if (it != m.decls.end()) {
+    Decl& d = it->second;
+    if (auto* e = TraitAPI::resolve(GameCtxAPI::ctx.entities, d.ref)) {
+      d.seen = true;
+      if (d.spawner != args.spawner || !Vector3Equals(d.pos, args.pos)) {
+        e->spawner = args.spawner;
+        GameCtxAPI::entity_update_position(d.ref, args.pos);
+      }
+      if (d.scale != args.scale)
+        e->scale = args.scale;
+      d.pos = args.pos;
+      d.scale = args.scale;
+      d.spawner = args.spawner;
+      return d.ref;
+    }
+    m.key_of.erase(pack_ref(d.ref));
+  }
+
+  thing_ref ref = GameCtxAPI::spawn(args);
+  if (ref.kind == ilist_kind::nil)
+    return ref;
+  m.decls[key] = {ref, args.pos, args.scale, args.spawner, 0, 0, true};
+  m.key_of[pack_ref(ref)] = key;
+  return ref;
+}
+
+/// @brief Record a trait_add / trait_rm made by the running module.
+inline void declare_trait(thing_ref ref, int slot, bool on) {
+  if (!running || slot < 0 || slot >= MAX_TRAITS)
+    return;
+  auto key = running->key_of.find(pack_ref(ref));
+  if (key == running->key_of.end())
+    return;
+  Decl& d = running->decls[key->second];
+  d.applied = on ? d.applied | TraitAPI::bit(slot) : d.applied & ~TraitAPI::bit(slot);
+}
+
+inline void begin_module(Module& m) {
+  for (auto& [key, d] : m.decls) {
+    d.seen = false;
+    d.applied = 0;
+  }
+  m.ordinal.clear();
+}
+
+/// @brief After a successful run: drop what the script no longer declares.
+inline void finish_module(Module& m) {
+  for (auto it = m.decls.begin(); it != m.decls.end();) {
+    Decl& d = it->second;
+    if (!d.seen) {
+      GameCtxAPI::despawn(d.ref);
+      m.key_of.erase(pack_ref(d.ref));
+      it = m.decls.erase(it);
+      continue;
+    }
+    if (auto* e = TraitAPI::resolve(GameCtxAPI::ctx.entities, d.ref))
+      for (TraitMask gone = d.traits & ~d.applied; gone; gone &= gone - 1)
+        TraitAPI::remove(*e, std::countr_zero(gone));
+    d.traits = d.applied;
+    ++it;
+  }
+}
+
 // ---- Lua C functions ----
 
-// spawn(model_name, x, y, z, [scale])
+// spawn(model, x, y, z, [scale]) -> handle or nil
 static int l_spawn(lua_State* L) {
-  const char* model = luaL_checkstring(L, 1);
+  ModelHandle model = check_model(L, 1);
   float x = (float)luaL_optnumber(L, 2, 0);
   float y = (float)luaL_optnumber(L, 3, 0);
   float z = (float)luaL_optnumber(L, 4, 0);
   float scale = (float)luaL_optnumber(L, 5, 1.0);
 
-  auto ref = GameCtxAPI::spawn(
-      GameCtxAPI::SpawnArgs{.model_name = std::string(model), .pos = {x, y, z}, .scale = scale});
-  lua_pushboolean(L, ref.kind != ilist_kind::nil);
+  auto ref =
+      declare_spawn(GameCtxAPI::SpawnArgs{.model = model, .pos = {x, y, z}, .scale = scale});
+  push_ref(L, ref);
   return 1;
 }
 
-// spawn_child(parent_index, model_name, x, y, z, [scale])
+// spawn_child(parent, model, x, y, z, [scale]) -> handle or nil
 static int l_spawn_child(lua_State* L) {
-  int parent_idx = (int)luaL_checkinteger(L, 1);
-  const char* model = luaL_checkstring(L, 2);
+  thing_ref parent_ref = check_ref(L, 1);
+  ModelHandle model = check_model(L, 2);
   float x = (float)luaL_optnumber(L, 3, 0);
   float y = (float)luaL_optnumber(L, 4, 0);
   float z = (float)luaL_optnumber(L, 5, 0);
   float scale = (float)luaL_optnumber(L, 6, 1.0);
 
-  thing_ref parent_ref = thing_ref::get_nil_ref();
-  int i = 0;
-  for (auto& e : GameCtxAPI::ctx.entities) {
-    if (i == parent_idx) {
-      parent_ref = e.this_ref();
-      break;
-    }
-    i++;
+  if (parent_ref == thing_ref::get_nil_ref()) {
+    GameConsoleAPI::print("lua: spawn_child: invalid parent", GameConsoleAPI::Level::Warn);
+    lua_pushnil(L);
+    return 1;
   }
 
-  if (parent_ref == thing_ref::get_nil_ref()) {
-    GameConsoleAPI::print("lua: spawn_child: invalid parent index");
-    lua_pushboolean(L, false);
+  auto ref = declare_spawn(GameCtxAPI::SpawnArgs{
+      .model = model, .pos = {x, y, z}, .scale = scale, .spawner = parent_ref});
+  push_ref(L, ref);
+  return 1;
+}
+
+/**
+ * spawn_many(model, positions, [traits], [scale]) -> table of handles
+ *
+ * positions is flat {x1, y1, z1, x2, y2, z2, ...} or nested {{x, y, z}, ...};
+ * a flat list whose length isn't a multiple of 3 raises an argument error.
+ * traits is a list of names or trait_id()s applied to every entity. The
+ * model and traits are resolved once, so a whole grid is one C call.
+ */
+static int l_spawn_many(lua_State* L) {
+  ModelHandle model = check_model(L, 1);
+  luaL_checktype(L, 2, LUA_TTABLE);
+  float scale = (float)luaL_optnumber(L, 4, 1.0);
+  if (!ModelAPI::get(model)) {
+    GameConsoleAPI::print("lua: spawn_many: unknown model", GameConsoleAPI::Level::Warn);
+    lua_newtable(L);
     return 1;
   }
 
-  auto ref = GameCtxAPI::spawn(GameCtxAPI::SpawnArgs{
-      .model_name = std::string(model), .pos = {x, y, z}, .scale = scale, .spawner = parent_ref});
-  lua_pushboolean(L, ref.kind != ilist_kind::nil);
+  int traits[MAX_TRAITS];
+  int trait_count = 0;
+  if (lua_istable(L, 3)) {
+    lua_Integer n = luaL_len(L, 3);
+    for (lua_Integer i = 1; i <= n && trait_count < MAX_TRAITS; i++) {
+      lua_rawgeti(L, 3, i);
+      int slot = check_trait(L, -1);
+      lua_pop(L, 1);
+      if (slot >= 0)
+        traits[trait_count++] = slot;
+    }
+  }
+
+  lua_rawgeti(L, 2, 1);
+  bool nested = lua_istable(L, -1);
+  lua_pop(L, 1);
+  lua_Integer len = (lua_Integer)lua_rawlen(L, 2);
+  if (!nested && len % 3 != 0)
+    return luaL_argerror(L, 2, "flat positions need a multiple of 3 numbers");
+  lua_Integer count = nested ? len : len / 3;
+
+  GameCtxAPI::ctx.entities.reserve(GameCtxAPI::ctx.entities.size() + (size_t)count);
+  lua_createtable(L, (int)count, 0);
+  GameCtxAPI::SpawnArgs args = {.model = model, .scale = scale};
+  lua_Integer spawned = 0;
+  for (lua_Integer i = 0; i < count; i++) {
+    float xyz[3];
+    if (nested) {
+      lua_rawgeti(L, 2, i + 1);
+      for (int c = 0; c < 3; c++) {
+        lua_rawgeti(L, -1, c + 1);
+        xyz[c] = (float)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+      }
+      lua_pop(L, 1);
+    } else {
+      for (int c = 0; c < 3; c++) {
+        lua_rawgeti(L, 2, i * 3 + c + 1);
+        xyz[c] = (float)lua_tonumber(L, -1);
+        lua_pop(L, 1);
+      }
+    }
+    args.pos = {xyz[0], xyz[1], xyz[2]};
+    thing_ref ref = declare_spawn(args);
+    if (ref.kind == ilist_kind::nil)
+      break;
+    auto& e = GameCtxAPI::ctx.entities[ref];
+    for (int t = 0; t < trait_count; t++) {
+      TraitAPI::apply(e, traits[t]);
+      declare_trait(ref, traits[t], true);
+    }
+    lua_pushinteger(L, pack_ref(ref));
+    lua_rawseti(L, -2, ++spawned);
+  }
+  return 1;
+}
+
+// model_id(name) -> integer id usable wherever a model name is, or nil
+static int l_model_id(lua_State* L) {
+  ModelHandle h = ModelAPI::handle(luaL_checkstring(L, 1));
+  if (h.valid())
+    lua_pushinteger(L, pack_model(h));
+  else
+    lua_pushnil(L);
+  return 1;
+}
+
+// trait_id(name) -> integer id usable wherever a trait name is, or nil
+static int l_trait_id(lua_State* L) {
+  int slot = TraitAPI::find(luaL_checkstring(L, 1));
+  if (slot >= 0)
+    lua_pushinteger(L, slot);
+  else
+    lua_pushnil(L);
   return 1;
 }
 
@@ -83,7 +362,8 @@ static int l_load_model(lua_State* L) {
 
   bool ok = ModelAPI::load(sname, std::string(path));
   if (!ok)
-    GameConsoleAPI::print("lua: failed to load model: " + std::string(path));
+    GameConsoleAPI::print("lua: failed to load model: " + std::string(path),
+                          GameConsoleAPI::Level::Warn);
   lua_pushboolean(L, ok);
   return 1;
 }
@@ -96,6 +376,10 @@ static int l_load_primitive(lua_State* L) {
   float a = (float)luaL_optnumber(L, 3, 1.0);
   float b = (float)luaL_optnumber(L, 4, 1.0);
   float c = (float)luaL_optnumber(L, 5, 1.0);
+  if (ModelAPI::handle(name).valid()) { // already loaded (e.g. the script is being re-run)
+    lua_pushboolean(L, true);
+    return 1;
+  }
 
   Mesh mesh = {0};
   if (strcmp(type, "cube") == 0)
@@ -113,7 +397,8 @@ static int l_load_primitive(lua_State* L) {
   else if (strcmp(type, "cone") == 0)
     mesh = GenMeshCone(a, b, (int)c);
   else {
-    GameConsoleAPI::print("lua: unknown primitive type: " + std::string(type));
+    GameConsoleAPI::print("lua: unknown primitive type: " + std::string(type),
+                          GameConsoleAPI::Level::Warn);
     lua_pushboolean(L, false);
     return 1;
   }
@@ -134,43 +419,54 @@ static int l_register_trait(lua_State* L) {
 // console_print(msg)
 static int l_console_print(lua_State* L) {
   const char* msg = luaL_checkstring(L, 1);
-  GameConsoleAPI::print(std::string(msg));
+  GameConsoleAPI::print(msg);
   return 0;
 }
 
-// trait_add(entity_index, trait_name)
+// trait_add(entity, trait)
 static int l_trait_add(lua_State* L) {
-  int idx = (int)luaL_checkinteger(L, 1);
-  const char* trait = luaL_checkstring(L, 2);
-
-  int i = 0;
-  for (auto& e : GameCtxAPI::ctx.entities) {
-    if (i == idx) {
-      TraitAPI::apply(e, trait);
-      lua_pushboolean(L, true);
-      return 1;
-    }
-    i++;
+  thing_ref ref = check_ref(L, 1);
+  int trait = check_trait(L, 2);
+  if (ref == thing_ref::get_nil_ref()) {
+    lua_pushboolean(L, false);
+    return 1;
   }
-  lua_pushboolean(L, false);
+  TraitAPI::apply(GameCtxAPI::ctx.entities[ref], trait);
+  declare_trait(ref, trait, true);
+  lua_pushboolean(L, true);
   return 1;
 }
 
-// trait_rm(entity_index, trait_name)
+// trait_rm(entity, trait)
 static int l_trait_rm(lua_State* L) {
-  int idx = (int)luaL_checkinteger(L, 1);
-  const char* trait = luaL_checkstring(L, 2);
-
-  int i = 0;
-  for (auto& e : GameCtxAPI::ctx.entities) {
-    if (i == idx) {
-      TraitAPI::remove(e, trait);
-      lua_pushboolean(L, true);
-      return 1;
-    }
-    i++;
+  thing_ref ref = check_ref(L, 1);
+  int trait = check_trait(L, 2);
+  if (ref == thing_ref::get_nil_ref()) {
+    lua_pushboolean(L, false);
+    return 1;
   }
-  lua_pushboolean(L, false);
+  TraitAPI::remove(GameCtxAPI::ctx.entities[ref], trait);
+  declare_trait(ref, trait, false);
+  lua_pushboolean(L, true);
+  return 1;
+}
+
+// alive(entity) -> true while the handle still names a live entity
+static int l_alive(lua_State* L) {
+  lua_Integer v = luaL_checkinteger(L, 1);
+  thing_ref ref = unpack_ref(v);
+  auto& e = GameCtxAPI::ctx.entities[ref];
+  lua_pushboolean(L, v >= ((lua_Integer)1 << 32) && e && e.this_ref() == ref);
+  return 1;
+}
+
+// despawn(entity)
+static int l_despawn(lua_State* L) {
+  thing_ref ref = check_ref(L, 1);
+  bool ok = ref != thing_ref::get_nil_ref();
+  if (ok)
+    GameCtxAPI::despawn(ref);
+  lua_pushboolean(L, ok);
   return 1;
 }
 
@@ -195,7 +491,7 @@ static int l_color(lua_State* L) {
 
   Model* m = ModelAPI::get(std::string(name));
   if (!m) {
-    GameConsoleAPI::print("lua: unknown model: " + std::string(name));
+    GameConsoleAPI::print("lua: unknown model: " + std::string(name), GameConsoleAPI::Level::Warn);
     lua_pushboolean(L, false);
     return 1;
   }
@@ -205,32 +501,29 @@ static int l_color(lua_State* L) {
   return 1;
 }
 
-// set_flag(entity_index, flag_name, value)
+// set_flag(entity, flag_name, value)
 static int l_set_flag(lua_State* L) {
-  int idx = (int)luaL_checkinteger(L, 1);
+  thing_ref ref = check_ref(L, 1);
   const char* flag = luaL_checkstring(L, 2);
   bool val = lua_toboolean(L, 3);
+  if (ref == thing_ref::get_nil_ref()) {
+    lua_pushboolean(L, false);
+    return 1;
+  }
 
-  int i = 0;
-  for (auto& e : GameCtxAPI::ctx.entities) {
-    if (i == idx) {
-      if (strcmp(flag, "is_draggable") == 0)
-        e.flags.is_draggable = val;
-      else if (strcmp(flag, "is_collidable") == 0)
-        e.flags.is_collidable = val;
-      else if (strcmp(flag, "is_highlightable") == 0)
-        e.flags.is_highlightable = val;
-      else {
-        GameConsoleAPI::print("lua: unknown flag: " + std::string(flag));
-        lua_pushboolean(L, false);
-        return 1;
-      }
-      lua_pushboolean(L, true);
-      return 1;
-    }
-    i++;
+  auto& e = GameCtxAPI::ctx.entities[ref];
+  if (strcmp(flag, "is_draggable") == 0)
+    e.flags.is_draggable = val;
+  else if (strcmp(flag, "is_collidable") == 0)
+    e.flags.is_collidable = val;
+  else if (strcmp(flag, "is_highlightable") == 0)
+    e.flags.is_highlightable = val;
+  else {
+    GameConsoleAPI::print("lua: unknown flag: " + std::string(flag), GameConsoleAPI::Level::Warn);
+    lua_pushboolean(L, false);
+    return 1;
   }
-  lua_pushboolean(L, false);
+  lua_pushboolean(L, true);
   return 1;
 }
 
@@ -249,12 +542,17 @@ inline void init() {
 
   lua_register(L, "spawn", l_spawn);
   lua_register(L, "spawn_child", l_spawn_child);
+  lua_register(L, "spawn_many", l_spawn_many);
+  lua_register(L, "model_id", l_model_id);
+  lua_register(L, "trait_id", l_trait_id);
   lua_register(L, "load_model", l_load_model);
   lua_register(L, "load_primitive", l_load_primitive);
   lua_register(L, "register_trait", l_register_trait);
   lua_register(L, "console_print", l_console_print);
   lua_register(L, "trait_add", l_trait_add);
   lua_register(L, "trait_rm", l_trait_rm);
+  lua_register(L, "alive", l_alive);
+  lua_register(L, "despawn", l_despawn);
   lua_register(L, "entity_count", l_entity_count);
   lua_register(L, "model_count", l_model_count);
   lua_register(L, "color", l_color);
@@ -263,37 +561,201 @@ inline void init() {
 }
 
 inline void shutdown() {
+  modules.clear();
+  running = nullptr;
+  watcher = nullptr;
   if (L) {
     lua_close(L);
     L = nullptr;
   }
 }
 
-inline bool run_file(const std::string& path) {
+// ---- chunk cache ----
+//
+// Compiled chunks are kept next to the script ("setup.lua" -> "setup.luac").
+// The cache header records the source's mtime, size and FNV-1a hash. At
+// startup a matching mtime and size loads the bytecode without reading the
+// source; otherwise the source is hashed and only a changed hash recompiles
+// (so a touched file, or a fresh checkout, still hits). Bytecode from another
+// Lua build has a different version and is rebuilt.
+
+struct ChunkHeader {
+  uint32_t magic;
+  uint32_t version;
+  int64_t mtime;
+  int64_t size;
+  uint64_t hash;
+};
+
+constexpr uint32_t CHUNK_MAGIC = 0x4355414C; // "LAUC"
+inline bool chunk_cache = true;              ///< Set false to always compile from source
+
+inline uint64_t fnv1a(const std::string& bytes) {
+  uint64_t h = 1469598103934665603ull;
+  for (unsigned char c : bytes)
+    h = (h ^ c) * 1099511628211ull;
+  return h;
+}
+
+inline bool read_file(const std::string& path, std::string& out) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in)
+    return false;
+  out.resize((size_t)in.tellg());
+  in.seekg(0);
+  in.read(out.data(), (std::streamsize)out.size());
+  return (bool)in;
+}
+
+inline std::string cache_path(const std::string& path) {
+  bool lua_ext = path.size() > 4 && path.compare(path.size() - 4, 4, ".lua") == 0;
+  return lua_ext ? path + "c" : path + ".luac";
+}
+
+static int chunk_writer(lua_State*, const void* p, size_t size, void* ud) {
+  static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+  return 0;
+}
+
+/// @brief Dump the function on top of the stack to the cache (temp file + rename).
+inline void write_chunk(const std::string& path, ChunkHeader header) {
+  std::string out(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (lua_dump(L, chunk_writer, &out, 0) != 0) // keep debug info for error line numbers
+    return;
+  std::string cache = cache_path(path);
+  std::string tmp = cache + ".tmp";
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    if (!f.write(out.data(), (std::streamsize)out.size()))
+      return;
+  }
+  std::rename(tmp.c_str(), cache.c_str());
+}
+
+/**
+ * @brief Push a script's main chunk, from the cache when it is still valid.
+ * @param hash Receives the source hash
+ * @param trust_mtime Accept the cache on matching mtime / size without hashing the source
+ * @return LUA_OK, or an error status with the message on the stack (like luaL_loadfile)
+ */
+inline int load_chunk(const std::string& path, uint64_t* hash, bool trust_mtime = true) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return luaL_loadfile(L, path.c_str()); // reports the missing file
+  std::string chunkname = "@" + path;
+
+  std::string cached;
+  ChunkHeader h = {};
+  bool have = chunk_cache && read_file(cache_path(path), cached) && cached.size() > sizeof(h);
+  if (have) {
+    memcpy(&h, cached.data(), sizeof(h));
+    have = h.magic == CHUNK_MAGIC && h.version == LUA_VERSION_NUM;
+  }
+  auto load_cached = [&] {
+    if (luaL_loadbufferx(L, cached.data() + sizeof(h), cached.size() - sizeof(h),
+                         chunkname.c_str(), "b") == LUA_OK)
+      return true;
+    lua_pop(L, 1);
+    return false;
+  };
+
+  if (have && trust_mtime && h.mtime == (int64_t)st.st_mtime && h.size == (int64_t)st.st_size &&
+      load_cached()) {
+    *hash = h.hash;
+    return LUA_OK;
+  }
+
+  std::string source;
+  if (!read_file(path, source))
+    return luaL_loadfile(L, path.c_str());
+  *hash = fnv1a(source);
+  ChunkHeader fresh = {CHUNK_MAGIC, LUA_VERSION_NUM, (int64_t)st.st_mtime, (int64_t)st.st_size,
+                       *hash};
+  if (have && h.hash == *hash && load_cached()) {
+    if (h.mtime != fresh.mtime || h.size != fresh.size)
+      write_chunk(path, fresh); // same source, new stamp: skip the hash next startup
+    return LUA_OK;
+  }
+
+  int status = luaL_loadbufferx(L, source.data(), source.size(), chunkname.c_str(), "t");
+  if (status == LUA_OK && chunk_cache)
+    write_chunk(path, fresh);
+  return status;
+}
+
+inline void print_error() {
+  const char* err = lua_tostring(L, -1);
+  GameConsoleAPI::print("lua error: " + std::string(err ? err : "unknown"),
+                        GameConsoleAPI::Level::Error);
+  lua_pop(L, 1);
+}
+
+/**
+ * @brief Run a script as a module (see "script modules" above).
+ * Running it again diff-applies its declarations. A script that errors keeps
+ * whatever it declared on its last good run.
+ * @param reload Always hash the source, and skip the run if it is unchanged
+ */
+inline bool run_module(const std::string& path, bool reload) {
   if (!L) {
-    GameConsoleAPI::print("lua: not initialized");
+    GameConsoleAPI::print("lua: not initialized", GameConsoleAPI::Level::Error);
     return false;
   }
-  int result = luaL_dofile(L, path.c_str());
-  if (result != LUA_OK) {
-    const char* err = lua_tostring(L, -1);
-    GameConsoleAPI::print("lua error: " + std::string(err ? err : "unknown"));
+  Module& m = modules[path];
+  m.path = path;
+  uint64_t hash = 0;
+  if (load_chunk(path, &hash, !reload) != LUA_OK) {
+    print_error();
+    return false;
+  }
+  if (reload && m.runs > 0 && hash == m.hash) {
     lua_pop(L, 1);
+    return true;
+  }
+  if (watcher && !watcher->watching(path))
+    watcher->watch_file(path);
+
+  begin_module(m);
+  Module* outer = running;
+  running = &m;
+  int result = lua_pcall(L, 0, 0, 0);
+  running = outer;
+  if (result != LUA_OK) {
+    print_error();
     return false;
   }
+  finish_module(m);
+  m.hash = hash;
+  m.runs++;
   return true;
 }
 
+inline bool run_file(const std::string& path) { return run_module(path, false); }
+
+/// @brief Re-run modules whose files changed. Feed it FileWatcher::poll().
+inline void reload_changed(const std::vector<std::string>& paths) {
+  for (const std::string& path : paths) {
+    if (!modules.count(path))
+      continue;
+    if (run_module(path, true))
+      GameConsoleAPI::print("lua: reloaded " + path);
+  }
+}
+
+/// @brief Watch every module run so far, and any run later, for reload_changed().
+inline void watch(FileWatcher& w) {
+  watcher = &w;
+  for (auto& [path, m] : modules)
+    w.watch_file(path);
+}
+
 inline bool run_string(const std::string& code) {
   if (!L) {
-    GameConsoleAPI::print("lua: not initialized");
+    GameConsoleAPI::print("lua: not initialized", GameConsoleAPI::Level::Error);
     return false;
   }
-  int result = luaL_dostring(L, code.c_str());
-  if (result != LUA_OK) {
-    const char* err = lua_tostring(L, -1);
-    GameConsoleAPI::print("lua error: " + std::string(err ? err : "unknown"));
-    lua_pop(L, 1);
+  if (luaL_dostring(L, code.c_str()) != LUA_OK) {
+    print_error();
     return false;
   }
   return true;
@@ -3,7 +3,12 @@ cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./bui
 exit
 #endif
 #pragma once
+#include "async_loader.hpp"
+#include "file_watcher.hpp"
 #include "ilist.hpp"
+#include "texture_cook.hpp"
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <raylib.h>
 #include <raymath.h>
@@ -11,16 +16,36 @@ exit
 #include <unordered_map>
 #include <vector>
 
-// A lightweight handle to a model in the store
+/**
+ * @brief Generation-checked handle into ModelAPI's model array.
+ *
+ * Works like thing_ref: the slot index is reused after unload, but the
+ * generation changes, so stale handles resolve to nullptr. gen 0 is null.
+ */
+struct ModelHandle {
+  uint32_t idx = 0;
+  uint32_t gen = 0;
+  bool valid() const { return gen != 0; }
+  bool operator==(const ModelHandle&) const = default;
+};
+
+/**
+ * @brief A thing's reference to a model in the store, plus its own transform.
+ *
+ * Holds no Model data: get() resolves the handle each time, so it always
+ * sees the slot's current model, including after async loads, reloads and evict().
+ */
 struct ModelInstance {
-  Model model;
-  const char* name;
+  const char* name = nullptr;
+  ModelHandle handle = {};
+  Matrix transform = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
 
-  operator Model&() { return model; }
   operator const char*() { return name; }
-  bool valid() const { return name != nullptr && model.meshCount > 0; }
+  /// @brief The slot's current model, or nullptr if the handle went stale. Don't keep it.
+  Model* get() const;
+  bool valid() const;
   bool operator==(const ModelInstance& other) const {
-    return name && other.name && strcmp(name, other.name) == 0;
+    return handle.valid() && handle == other.handle;
   }
 };
 
@@ -28,88 +53,522 @@ struct ModelInstance {
  * @brief Centralized model storage — load once, instance many times.
  *
  * Namespace-style API with inline globals.
- * All loaded Model data is owned by internal storage.
+ * All loaded Model data is owned by internal storage: a contiguous slot
+ * array addressed by ModelHandle. Names are only hashed at load and spawn
+ * time; per-frame code should go through handles.
+ *
+ * Model* pointers returned by get() are valid until the next load, unload,
+ * replace or evict; resolve them per draw rather than keeping them.
+ *
+ * load_async() registers a placeholder cube straight away and swaps the real
+ * model into the same slot once it has loaded, so handles taken while it is
+ * pending stay valid. replace() unloads the old model, so never keep a Model
+ * copy: ModelInstance holds only the handle and draws whatever the slot has now.
+ *
+ * File-backed slots remember their source path. reload_async() re-reads it
+ * in the background and swaps the new model in only once it has parsed, so
+ * a half-written or broken export leaves the old model on screen.
+ * watch_all() + reload_changed() drive that from a FileWatcher.
+ *
+ * evict() drops a file-backed model's GPU data but keeps its slot and bounds;
+ * reload_async() brings it back. With gpu_bytes() that lets a Residency keep
+ * a scene's models under a memory budget.
  *
  * @see ModelInstance
  */
 namespace ModelAPI {
 
-inline std::unordered_map<std::string, Model> models;
+/// @brief Model-space bounds, computed once at load time.
+struct ModelBounds {
+  BoundingBox box = {{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}};
+  Vector3 center = {0, 0, 0}; ///< Bounding sphere center (box center)
+  float radius = 0.8660254f;  ///< Bounding sphere radius around center
+};
+
+/**
+ * @brief Per-model instancing bucket.
+ *
+ * Things join when they spawn and leave when they despawn. The transform
+ * buffer is persistent: it is refilled every frame but only grows, so
+ * steady-state frames don't allocate.
+ */
+struct InstanceBucket {
+  std::vector<thing_ref> members;
+  std::vector<Matrix> transforms;
+};
+
+struct Slot {
+  Model model = {0};
+  ModelBounds bounds;
+  InstanceBucket bucket;
+  const char* name = nullptr; ///< Points at the by_name key (node-stable)
+  uint32_t gen = 0;
+  bool used = false;
+  bool pending = false;       ///< Placeholder until an async load lands
+  bool evicted = false;       ///< GPU data dropped by evict() until reload_async() lands
+  std::string source;         ///< File the model came from ("" for generated meshes)
+  uint32_t reload_serial = 0; ///< Bumped per reload; stale completions are dropped
+};
+
+inline std::vector<Slot> slots;
+inline std::vector<uint32_t> free_slots;
+inline std::unordered_map<std::string, ModelHandle> by_name;
+inline uint32_t next_gen = 1;
+
+inline const char* INSTANCING_VS = "assets/shaders/instancing.vs";
+inline const char* INSTANCING_FS = "assets/shaders/instancing.fs";
+inline Shader instancing = {0};
+inline bool instancing_loaded = false;
+
+/// @brief Get the shared instancing shader, loading it on first use. Requires a window.
+inline Shader& instancing_shader() {
+  if (!instancing_loaded) {
+    instancing = LoadShader(INSTANCING_VS, INSTANCING_FS);
+    instancing.locs[SHADER_LOC_MATRIX_MVP] = GetShaderLocation(instancing, "mvp");
+    instancing.locs[SHADER_LOC_MATRIX_NORMAL] = GetShaderLocation(instancing, "matNormal");
+    instancing.locs[SHADER_LOC_MATRIX_MODEL] =
+        GetShaderLocationAttrib(instancing, "instanceTransform");
+    instancing_loaded = true;
+  }
+  return instancing;
+}
+
+/// @brief True if the instancing shader compiled and exposes the instance attribute.
+inline bool instancing_ready() {
+  Shader& sh = instancing_shader();
+  return IsShaderValid(sh) && sh.locs[SHADER_LOC_MATRIX_MODEL] >= 0;
+}
+
+/// @brief Resolve a handle to its slot, or nullptr if stale / null.
+inline Slot* slot(ModelHandle h) {
+  if (!h.valid() || h.idx >= slots.size())
+    return nullptr;
+  Slot& s = slots[h.idx];
+  return s.used && s.gen == h.gen ? &s : nullptr;
+}
+
+/// @brief Look up the handle for a name. Returns a null handle if not loaded.
+inline ModelHandle handle(const std::string& name) {
+  auto it = by_name.find(name);
+  return it != by_name.end() ? it->second : ModelHandle{};
+}
+
+/// @brief Scan every vertex of a model once for its AABB and bounding sphere.
+inline ModelBounds compute_bounds(const Model& model) {
+  ModelBounds b;
+  bool any = false;
+  Vector3 lo = {0, 0, 0}, hi = {0, 0, 0};
+  for (int i = 0; i < model.meshCount; i++) {
+    const Mesh& mesh = model.meshes[i];
+    if (!mesh.vertices)
+      continue;
+    for (int v = 0; v < mesh.vertexCount; v++) {
+      Vector3 p = {mesh.vertices[v * 3], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2]};
+      lo = any ? Vector3Min(lo, p) : p;
+      hi = any ? Vector3Max(hi, p) : p;
+      any = true;
+    }
+  }
+  if (!any)
+    return b;
+
+  b.box = {lo, hi};
+  b.center = Vector3Scale(Vector3Add(lo, hi), 0.5f);
+  float r2 = 0.0f;
+  for (int i = 0; i < model.meshCount; i++) {
+    const Mesh& mesh = model.meshes[i];
+    if (!mesh.vertices)
+      continue;
+    for (int v = 0; v < mesh.vertexCount; v++) {
+      Vector3 p = {mesh.vertices[v * 3], mesh.vertices[v * 3 + 1], mesh.vertices[v * 3 + 2]};
+      r2 = fmaxf(r2, Vector3DistanceSqr(p, b.center));
+    }
+  }
+  b.radius = sqrtf(r2);
+  return b;
+}
+
+/// @brief Store a model in a free slot and register its name.
+inline ModelHandle insert(const std::string& name, Model m) {
+  uint32_t idx;
+  if (!free_slots.empty()) {
+    idx = free_slots.back();
+    free_slots.pop_back();
+  } else {
+    idx = (uint32_t)slots.size();
+    slots.emplace_back();
+  }
+  ModelHandle h = {idx, next_gen++};
+  auto [it, _] = by_name.emplace(name, h);
+  Slot& s = slots[idx];
+  s.model = m;
+  s.bounds = compute_bounds(m);
+  s.bucket = {};
+  s.name = it->first.c_str();
+  s.gen = h.gen;
+  s.used = true;
+  return h;
+}
 
 /// @brief Load a model from a file path. No-op if name already loaded.
+/// Diffuse textures are swapped for cooked variants (`<path>.rtex`) when present.
 inline bool load(const std::string& name, const std::string& path) {
-  if (models.find(name) != models.end())
+  if (by_name.find(name) != by_name.end())
     return true;
   Model m = LoadModel(path.c_str());
   if (m.meshCount == 0)
     return false;
-  models[name] = m;
+  TextureCook::apply_cooked(m, path.c_str());
+  slots[insert(name, m).idx].source = path;
   return true;
 }
 
 /// @brief Load a model from an existing Mesh. No-op if name already loaded.
 /// Applies magenta color as default "placeholder" material.
 inline bool load(const std::string& name, Mesh mesh) {
-  if (models.find(name) != models.end())
+  if (by_name.find(name) != by_name.end())
     return true;
   Model m = LoadModelFromMesh(mesh);
   // Apply magenta as default placeholder color
   m.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = MAGENTA;
-  models[name] = m;
+  insert(name, m);
+  return true;
+}
+
+/**
+ * @brief Swap a slot's model in place, keeping its handle, name and bucket.
+ * The old model is unloaded and bounds are recomputed.
+ */
+inline bool replace(ModelHandle h, Model m) {
+  Slot* s = slot(h);
+  if (!s || m.meshCount == 0)
+    return false;
+  UnloadModel(s->model);
+  s->model = m;
+  s->bounds = compute_bounds(m);
+  s->pending = false;
+  s->evicted = false;
+  return true;
+}
+
+/**
+ * @brief Rough GPU footprint of a model, for residency budgets: vertex and index
+ * buffers plus its materials' diffuse textures in their actual format and mip chain.
+ */
+inline size_t gpu_bytes(const Model& m) {
+  size_t bytes = 0;
+  for (int i = 0; i < m.meshCount; i++) {
+    const Mesh& mesh = m.meshes[i];
+    size_t per_vertex = 3 * sizeof(float);
+    per_vertex += mesh.texcoords ? 2 * sizeof(float) : 0;
+    per_vertex += mesh.normals ? 3 * sizeof(float) : 0;
+    per_vertex += mesh.tangents ? 4 * sizeof(float) : 0;
+    per_vertex += mesh.colors ? 4 : 0;
+    bytes += (size_t)mesh.vertexCount * per_vertex;
+    bytes += mesh.indices ? (size_t)mesh.triangleCount * 3 * sizeof(unsigned short) : 0;
+  }
+  for (int i = 0; i < m.materialCount; i++) {
+    if (!m.materials[i].maps)
+      continue;
+    bytes += TextureCook::gpu_bytes(m.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture);
+  }
+  return bytes;
+}
+
+inline const std::vector<uint8_t>* prefetch_bytes = nullptr;
+inline const char* prefetch_path = nullptr;
+
+/// LoadFileData hook: serves the prefetched file to LoadModel, reads anything else from disk.
+inline unsigned char* load_prefetched(const char* file, int* size) {
+  std::vector<uint8_t> disk;
+  const std::vector<uint8_t>* src = &disk;
+  if (prefetch_bytes && prefetch_path && strcmp(file, prefetch_path) == 0)
+    src = prefetch_bytes;
+  else if (!AsyncLoader::read_bytes(file, disk)) {
+    *size = 0;
+    return nullptr;
+  }
+  auto* data = (unsigned char*)MemAlloc((unsigned int)std::max<size_t>(src->size(), 1));
+  if (!src->empty())
+    memcpy(data, src->data(), src->size());
+  *size = (int)src->size();
+  return data;
+}
+
+/// @brief LoadModel with the main file already in memory (glTF / OBJ parse + GPU upload).
+inline Model load_model_from_bytes(const std::string& path, const std::vector<uint8_t>& bytes) {
+  prefetch_bytes = &bytes;
+  prefetch_path = path.c_str();
+  SetLoadFileDataCallback(load_prefetched);
+  Model m = LoadModel(path.c_str());
+  SetLoadFileDataCallback(nullptr);
+  prefetch_bytes = nullptr;
+  prefetch_path = nullptr;
+  return m;
+}
+
+/**
+ * @brief Magenta cube shown while a model is loading or evicted.
+ * Without a window there is no GL context to upload to, so the cube is left
+ * out and the placeholder is an empty mesh (tests, tools).
+ */
+inline Model placeholder_model() {
+  Model m = LoadModelFromMesh(IsWindowReady() ? GenMeshCube(1.0f, 1.0f, 1.0f) : Mesh{0});
+  m.materials[0].maps[MATERIAL_MAP_DIFFUSE].color = MAGENTA;
+  return m;
+}
+
+/**
+ * @brief Register a placeholder now and load the file in the background.
+ *
+ * The file is read on a loader worker; parsing and upload happen in
+ * loader.pump() on the main thread (raylib's model loaders upload to the
+ * GPU as they parse). If the load fails the placeholder stays.
+ * @return Handle usable immediately. No-op (existing handle) if name already loaded.
+ */
+inline ModelHandle load_async(const std::string& name, const std::string& path,
+                              AsyncLoader& loader) {
+  if (by_name.find(name) != by_name.end())
+    return handle(name);
+  ModelHandle h = insert(name, placeholder_model());
+  slot(h)->pending = true;
+  slot(h)->source = path;
+  loader.read_file(path, [h](AsyncLoader::Result& r) {
+    Slot* s = slot(h);
+    if (!s) // unloaded while in flight
+      return;
+    Model m = r.ok ? load_model_from_bytes(r.path, r.bytes) : Model{0};
+    if (m.meshCount > 0)
+      TextureCook::apply_cooked(m, r.path.c_str());
+    if (!replace(h, m)) {
+      s->pending = false;
+      TraceLog(LOG_WARNING, "ModelAPI: async load failed: %s", r.path.c_str());
+    }
+  });
+  return h;
+}
+
+/**
+ * @brief False if bytes are clearly not a whole file yet.
+ * A .glb header carries the total length, so a truncated export is caught
+ * before it reaches the parser. Other formats are left to the parser.
+ */
+inline bool complete_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+  if (!IsFileExtension(path.c_str(), ".glb"))
+    return !bytes.empty();
+  uint32_t magic = 0, length = 0;
+  if (bytes.size() < 12)
+    return false;
+  memcpy(&magic, bytes.data(), 4);
+  memcpy(&length, bytes.data() + 8, 4);
+  return magic == 0x46546C67 /* "glTF" */ && length == bytes.size();
+}
+
+/**
+ * @brief Re-read a file-backed model in the background and swap it in on success.
+ *
+ * Same split as load_async(): bytes on a worker, parse in loader.pump().
+ * The slot keeps drawing the old model until the new one has parsed; if the
+ * read, the completeness check or the parse fails, the old model stays.
+ * Overlapping reloads of one slot resolve to the newest.
+ * @return False if the handle is stale or the model has no source file.
+ */
+inline bool reload_async(ModelHandle h, AsyncLoader& loader) {
+  Slot* s = slot(h);
+  if (!s || s->source.empty())
+    return false;
+  uint32_t serial = ++s->reload_serial;
+  loader.read_file(s->source, [h, serial](AsyncLoader::Result& r) {
+    Slot* cur = slot(h);
+    if (!cur || cur->reload_serial != serial) // unloaded, or a newer reload is in flight
+      return;
+    Model m = {0};
+    if (r.ok && complete_file(r.path, r.bytes))
+      m = load_model_from_bytes(r.path, r.bytes);
+    if (m.meshCount == 0) {
+      TraceLog(LOG_WARNING, "ModelAPI: reload failed, keeping old model: %s", r.path.c_str());
+      return;
+    }
+    TextureCook::apply_cooked(m, r.path.c_str());
+    replace(h, m);
+  });
   return true;
 }
 
+/// @brief Source file a model was loaded from, or nullptr (stale handle / generated mesh).
+inline const char* source_of(ModelHandle h) {
+  Slot* s = slot(h);
+  return s && !s->source.empty() ? s->source.c_str() : nullptr;
+}
+
+/// @brief Register every file-backed model's source with a watcher.
+inline void watch_all(FileWatcher& watcher) {
+  for (const Slot& s : slots)
+    if (s.used && !s.source.empty() && !watcher.watching(s.source))
+      watcher.watch_file(s.source);
+}
+
+/**
+ * @brief reload_async() every model loaded from one of the given paths.
+ * Typically fed from FileWatcher::poll(). @return Number of reloads queued.
+ */
+inline int reload_changed(const std::vector<std::string>& paths, AsyncLoader& loader) {
+  int queued = 0;
+  for (uint32_t i = 0; i < slots.size(); i++) {
+    const Slot& s = slots[i];
+    if (s.used && std::find(paths.begin(), paths.end(), s.source) != paths.end())
+      queued += reload_async({i, s.gen}, loader);
+  }
+  return queued;
+}
+
+/// @brief True while a load_async() model is still showing its placeholder.
+inline bool is_pending(ModelHandle h) {
+  Slot* s = slot(h);
+  return s && s->pending;
+}
+
+/**
+ * @brief Release a file-backed model's GPU data, keeping its handle, bounds and bucket.
+ * The slot shows a placeholder cube (and is_pending()) until reload_async() brings the
+ * model back. Nothing outside the slot holds the old Model (ModelInstance keeps only the
+ * handle), so freeing it here leaves nothing dangling; Model* from get() must not be kept.
+ * @return False for stale handles, generated meshes and pending slots.
+ */
+inline bool evict(ModelHandle h) {
+  Slot* s = slot(h);
+  if (!s || s->source.empty() || s->pending)
+    return false;
+  UnloadModel(s->model);
+  s->model = placeholder_model();
+  s->pending = true;
+  s->evicted = true;
+  return true;
+}
+
+inline bool is_evicted(ModelHandle h) {
+  Slot* s = slot(h);
+  return s && s->evicted;
+}
+
 /// @brief Check if a model is loaded.
-inline bool has(const std::string& name) { return models.find(name) != models.end(); }
+inline bool has(const std::string& name) { return by_name.find(name) != by_name.end(); }
+
+/// @brief Get raw model pointer by handle, or nullptr if stale.
+inline Model* get(ModelHandle h) {
+  Slot* s = slot(h);
+  return s ? &s->model : nullptr;
+}
 
 /// @brief Get raw model pointer, or nullptr if not found.
-inline Model* get(const std::string& name) {
-  auto it = models.find(name);
-  return it != models.end() ? &it->second : nullptr;
+inline Model* get(const std::string& name) { return get(handle(name)); }
+
+/// @brief Cached model-space bounds by handle, or nullptr if stale.
+inline const ModelBounds* bounds(ModelHandle h) {
+  Slot* s = slot(h);
+  return s ? &s->bounds : nullptr;
+}
+
+/// @brief Cached model-space bounds, or nullptr if not found.
+inline const ModelBounds* bounds(const std::string& name) { return bounds(handle(name)); }
+
+/// @brief Name a handle was loaded under, or nullptr if stale.
+inline const char* name_of(ModelHandle h) {
+  Slot* s = slot(h);
+  return s ? s->name : nullptr;
 }
 
 /// @brief Create a ModelInstance with a fresh identity transform.
-inline ModelInstance instance(const std::string& name) {
-  auto it = models.find(name);
-  if (it == models.end())
-    return {Model{0}, nullptr};
+inline ModelInstance instance(ModelHandle h) {
+  Slot* s = slot(h);
+  if (!s)
+    return {};
   ModelInstance inst;
-  inst.model = it->second;
-  inst.model.transform = MatrixIdentity();
-  inst.name = it->first.c_str();
+  inst.name = s->name;
+  inst.handle = h;
   return inst;
 }
 
+/// @brief Create a ModelInstance with a fresh identity transform.
+inline ModelInstance instance(const std::string& name) { return instance(handle(name)); }
+
+/// @brief Add a thing to a model's instancing bucket.
+inline void bucket_join(ModelHandle h, thing_ref ref) {
+  Slot* s = slot(h);
+  if (!s || ref.kind == ilist_kind::nil)
+    return;
+  s->bucket.members.push_back(ref);
+}
+
+/// @brief Remove a thing from a model's instancing bucket (swap-remove).
+inline void bucket_leave(ModelHandle h, thing_ref ref) {
+  Slot* s = slot(h);
+  if (!s)
+    return;
+  auto& members = s->bucket.members;
+  for (size_t i = 0; i < members.size(); i++) {
+    if (members[i] == ref) {
+      members[i] = members.back();
+      members.pop_back();
+      return;
+    }
+  }
+}
+
+/// @brief Empty every model's instancing bucket (e.g. before restoring a saved scene).
+inline void bucket_clear_all() {
+  for (Slot& s : slots)
+    s.bucket.members.clear();
+}
+
 /// @brief Get list of all loaded model names.
 inline std::vector<std::string> names() {
   std::vector<std::string> result;
-  result.reserve(models.size());
-  for (auto& [name, _] : models)
+  result.reserve(by_name.size());
+  for (auto& [name, _] : by_name)
     result.push_back(name);
   return result;
 }
 
 /// @brief Number of loaded models.
-inline size_t count() { return models.size(); }
+inline size_t count() { return by_name.size(); }
 
 /// @brief Unload and remove a single model by name.
 inline void unload(const std::string& name) {
-  auto it = models.find(name);
-  if (it != models.end()) {
-    UnloadModel(it->second);
-    models.erase(it);
-  }
+  auto it = by_name.find(name);
+  if (it == by_name.end())
+    return;
+  Slot& s = slots[it->second.idx];
+  UnloadModel(s.model);
+  s = Slot{.gen = s.gen};
+  free_slots.push_back(it->second.idx);
+  by_name.erase(it);
 }
 
 /// @brief Unload and remove all models.
 inline void unload_all() {
-  for (auto& [_, model] : models)
-    UnloadModel(model);
-  models.clear();
+  for (auto& s : slots)
+    if (s.used)
+      UnloadModel(s.model);
+  slots.clear();
+  free_slots.clear();
+  by_name.clear();
+  if (instancing_loaded) {
+    UnloadShader(instancing);
+    instancing = {0};
+    instancing_loaded = false;
+  }
 }
 
 } // namespace ModelAPI
 
+inline Model* ModelInstance::get() const { return ModelAPI::get(handle); }
+
+inline bool ModelInstance::valid() const {
+  const Model* m = get();
+  return name != nullptr && m && m->meshCount > 0;
+}
+
 /*
  * the way that things should be drawn is that the things in the ilist would have a modelinstance
  * then for each model in the model store it would just ittorate through the ilist and draw the
@@ -120,30 +579,77 @@ concept HasModel = requires(T t) {
   { t.model } -> std::convertible_to<ModelInstance&>;
 };
 
-template <typename T, size_t N>
-void draw_model_store(things_list<T, N>& list)
-  requires HasModel<T>
-{
-  for (const auto& name : ModelAPI::names()) {
-    Model* model = ModelAPI::get(name);
-    if (!model || model->meshCount == 0)
+/**
+ * @brief Refill a bucket's transform buffer from its live members.
+ *
+ * Members whose ref went stale (removed without leaving) are dropped.
+ * transform_of(thing, out) returns false to skip a thing this frame.
+ */
+template <typename List, typename Fn>
+void gather_instances(ModelAPI::InstanceBucket& bucket, List& list, Fn&& transform_of) {
+  bucket.transforms.clear();
+  auto& members = bucket.members;
+  for (size_t i = 0; i < members.size();) {
+    auto&& thing = list[members[i]]; // && so proxy views (ArchetypeStore::view) work too
+    if (!thing || thing.this_ref() != members[i]) {
+      members[i] = members.back();
+      members.pop_back();
       continue;
-
-    std::vector<Matrix> transforms;
-    for (auto& thing : list) {
-      if (thing.model.valid() && strcmp(thing.model.name, name.c_str()) == 0) {
-        transforms.push_back(thing.model.model.transform);
-      }
     }
-    if (transforms.empty())
+    Matrix m;
+    if (transform_of(thing, m))
+      bucket.transforms.push_back(m);
+    i++;
+  }
+}
+
+/**
+ * @brief Draw every bucket with one DrawMeshInstanced per mesh using the instancing shader.
+ *
+ * Falls back to per-instance DrawMesh if the instancing shader is unavailable.
+ * @return Number of draw calls issued
+ */
+template <typename List, typename Fn> int draw_model_buckets(List& list, Fn&& transform_of) {
+  bool instanced = ModelAPI::instancing_ready();
+  int draws = 0;
+  for (auto& slot : ModelAPI::slots) {
+    auto& bucket = slot.bucket;
+    if (!slot.used || bucket.members.empty())
+      continue;
+    Model* model = &slot.model;
+    if (model->meshCount == 0)
       continue;
 
-    Material mat = model->materials[0];
+    gather_instances(bucket, list, transform_of);
+    if (bucket.transforms.empty())
+      continue;
 
     for (int i = 0; i < model->meshCount; i++) {
-      DrawMeshInstanced(model->meshes[i], mat, transforms.data(), (int)transforms.size());
+      Material mat = model->materials[model->meshMaterial[i]];
+      if (instanced) {
+        mat.shader = ModelAPI::instancing;
+        DrawMeshInstanced(model->meshes[i], mat, bucket.transforms.data(),
+                          (int)bucket.transforms.size());
+        draws++;
+      } else {
+        for (auto& t : bucket.transforms)
+          DrawMesh(model->meshes[i], mat, t);
+        draws += (int)bucket.transforms.size();
+      }
     }
   }
+  return draws;
+}
+
+/// @brief Draw a list through the instancing buckets using each thing's model transform.
+template <typename List>
+void draw_model_store(List& list)
+  requires HasModel<typename List::thing>
+{
+  draw_model_buckets(list, [](typename List::thing& thing, Matrix& out) {
+    out = thing.model.transform;
+    return true;
+  });
 }
 
 // ============================================================================
@@ -151,6 +657,214 @@ void draw_model_store(things_list<T, N>& list)
 // ============================================================================
 #ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
+#include <fstream>
+
+struct BucketThing : thing_base {
+  ModelInstance model;
+  bool hidden = false;
+};
+
+TEST_CASE("model store instance buckets") {
+  things_list<BucketThing, 16> list;
+  REQUIRE(ModelAPI::load("tile", Mesh{0}));
+  ModelHandle tile = ModelAPI::handle("tile");
+
+  thing_ref refs[4];
+  for (int i = 0; i < 4; i++) {
+    BucketThing t;
+    t.model.transform = MatrixTranslate((float)i, 0, 0);
+    refs[i] = list.add(t);
+    ModelAPI::bucket_join(tile, refs[i]);
+  }
+  ModelAPI::bucket_join(tile, thing_ref::get_nil_ref()); // ignored
+  auto& bucket = ModelAPI::slot(tile)->bucket;
+  CHECK(bucket.members.size() == 4);
+
+  // Explicit leave
+  ModelAPI::bucket_leave(tile, refs[1]);
+  CHECK(bucket.members.size() == 3);
+
+  // Removed without leaving: pruned on the next gather
+  list.remove(refs[2]);
+  list[refs[3]].hidden = true;
+  gather_instances(bucket, list, [](BucketThing& t, Matrix& out) {
+    out = t.model.transform;
+    return !t.hidden;
+  });
+  CHECK(bucket.members.size() == 2);
+  REQUIRE(bucket.transforms.size() == 1);
+  CHECK(bucket.transforms[0].m12 == doctest::Approx(0.0f));
+
+  // Transform buffer keeps its capacity across frames
+  size_t cap = bucket.transforms.capacity();
+  gather_instances(bucket, list, [](BucketThing& t, Matrix& out) {
+    out = t.model.transform;
+    return true;
+  });
+  CHECK(bucket.transforms.size() == 2);
+  CHECK(bucket.transforms.capacity() >= cap);
+  ModelAPI::unload("tile");
+}
+
+TEST_CASE("model store handles") {
+  REQUIRE(ModelAPI::load("handle_a", Mesh{0}));
+  REQUIRE(ModelAPI::load("handle_b", Mesh{0}));
+  ModelHandle a = ModelAPI::handle("handle_a");
+  ModelHandle b = ModelAPI::handle("handle_b");
+  CHECK(a.valid());
+  CHECK(a != b);
+  CHECK(!ModelAPI::handle("missing").valid());
+  CHECK(strcmp(ModelAPI::name_of(a), "handle_a") == 0);
+
+  ModelInstance inst = ModelAPI::instance("handle_b");
+  CHECK(inst.handle == b);
+  CHECK(inst == ModelAPI::instance(b));
+  CHECK(inst.valid());
+
+  // An instance resolves through its handle, so it sees a replace() (async load landing)
+  Mesh* old_meshes = inst.get()->meshes;
+  REQUIRE(ModelAPI::replace(b, LoadModelFromMesh(Mesh{0})));
+  CHECK(inst.get() == ModelAPI::get(b));
+  CHECK(inst.get()->meshes != old_meshes);
+
+  // Unload frees the slot; the old handle goes stale, a reload reuses the slot
+  ModelAPI::unload("handle_a");
+  CHECK(ModelAPI::get(a) == nullptr);
+  CHECK(ModelAPI::name_of(a) == nullptr);
+  REQUIRE(ModelAPI::load("handle_c", Mesh{0}));
+  ModelHandle c = ModelAPI::handle("handle_c");
+  CHECK(c.idx == a.idx);
+  CHECK(c.gen != a.gen);
+  CHECK(ModelAPI::get(a) == nullptr);
+  CHECK(ModelAPI::get(c) != nullptr);
+
+  ModelAPI::unload("handle_b");
+  CHECK_FALSE(inst.valid()); // stale handle, nothing left to draw
+  CHECK(inst.get() == nullptr);
+  ModelAPI::unload("handle_c");
+}
+
+TEST_CASE("model store cached bounds") {
+  // Two triangles spanning (-1,0,0)..(3,2,0)
+  float verts[] = {-1, 0, 0, 3, 0, 0, 3, 2, 0, -1, 0, 0, 3, 2, 0, -1, 2, 0};
+  Mesh mesh = {0};
+  mesh.vertexCount = 6;
+  mesh.vertices = (float*)MemAlloc(sizeof(verts)); // owned by the model after load
+  memcpy(mesh.vertices, verts, sizeof(verts));
+
+  REQUIRE(ModelAPI::load("bounds_test", mesh));
+  const ModelAPI::ModelBounds* b = ModelAPI::bounds("bounds_test");
+  REQUIRE(b != nullptr);
+  CHECK(b->box.min.x == doctest::Approx(-1.0f));
+  CHECK(b->box.max.x == doctest::Approx(3.0f));
+  CHECK(b->box.max.y == doctest::Approx(2.0f));
+  CHECK(b->center.x == doctest::Approx(1.0f));
+  CHECK(b->radius == doctest::Approx(sqrtf(5.0f)));
+
+  CHECK(ModelAPI::bounds("missing") == nullptr);
+  ModelAPI::unload("bounds_test");
+  CHECK(ModelAPI::bounds("bounds_test") == nullptr);
+}
+
+TEST_CASE("model store replace keeps handle") {
+  REQUIRE(ModelAPI::load("replace_test", Mesh{0}));
+  ModelHandle h = ModelAPI::handle("replace_test");
+  ModelAPI::bucket_join(h, thing_ref{ilist_kind::item, 1, 1});
+  ModelAPI::slot(h)->pending = true;
+  CHECK(ModelAPI::is_pending(h));
+
+  float verts[] = {0, 0, 0, 4, 0, 0, 4, 4, 0};
+  Mesh mesh = {0};
+  mesh.vertexCount = 3;
+  mesh.vertices = (float*)MemAlloc(sizeof(verts));
+  memcpy(mesh.vertices, verts, sizeof(verts));
+  CHECK(ModelAPI::replace(h, LoadModelFromMesh(mesh)));
+
+  CHECK(ModelAPI::handle("replace_test") == h);
+  CHECK_FALSE(ModelAPI::is_pending(h));
+  CHECK(ModelAPI::slot(h)->bucket.members.size() == 1);
+  CHECK(ModelAPI::bounds(h)->box.max.x == doctest::Approx(4.0f));
+
+  // Empty models and stale handles are rejected
+  CHECK_FALSE(ModelAPI::replace(h, Model{0}));
+  ModelAPI::unload("replace_test");
+  CHECK_FALSE(ModelAPI::replace(h, Model{0}));
+}
+
+TEST_CASE("model store evict keeps handle and bounds") {
+  float verts[] = {0, 0, 0, 4, 0, 0, 4, 4, 0};
+  Mesh mesh = {0};
+  mesh.vertexCount = 3;
+  mesh.vertices = (float*)MemAlloc(sizeof(verts));
+  memcpy(mesh.vertices, verts, sizeof(verts));
+  REQUIRE(ModelAPI::load("evict_test", mesh));
+  ModelHandle h = ModelAPI::handle("evict_test");
+  CHECK(ModelAPI::gpu_bytes(*ModelAPI::get(h)) == 3 * 3 * sizeof(float));
+
+  // Textures count in their own format and mip chain; the default texture not at all
+  Texture2D& diffuse = ModelAPI::get(h)->materials[0].maps[MATERIAL_MAP_DIFFUSE].texture;
+  Texture2D keep = diffuse;
+  diffuse = {rlGetTextureIdDefault() + 1, 64, 64, 3, PIXELFORMAT_COMPRESSED_DXT1_RGB};
+  CHECK(ModelAPI::gpu_bytes(*ModelAPI::get(h)) ==
+        3 * 3 * sizeof(float) + (64 * 64 + 32 * 32 + 16 * 16) / 2);
+  diffuse.id = rlGetTextureIdDefault();
+  CHECK(ModelAPI::gpu_bytes(*ModelAPI::get(h)) == 3 * 3 * sizeof(float));
+  diffuse = keep;
+
+  ModelInstance inst = ModelAPI::instance(h);
+  Mesh* real_meshes = inst.get()->meshes;
+
+  CHECK_FALSE(ModelAPI::evict(h)); // generated mesh: nothing to reload from
+  ModelAPI::slot(h)->source = "/tmp/model_api_evict.glb";
+  CHECK(ModelAPI::evict(h));
+  CHECK(ModelAPI::is_evicted(h));
+  CHECK(ModelAPI::is_pending(h));
+  CHECK(ModelAPI::bounds(h)->box.max.x == doctest::Approx(4.0f)); // real model's bounds
+  CHECK_FALSE(ModelAPI::evict(h));                                // already a placeholder
+  // Instances taken before the evict draw the placeholder, not the freed model
+  CHECK(inst.get()->meshes != real_meshes);
+  Color placeholder = inst.get()->materials[0].maps[MATERIAL_MAP_DIFFUSE].color;
+  CHECK(placeholder.g == MAGENTA.g);
+
+  CHECK(ModelAPI::replace(h, LoadModelFromMesh(Mesh{0})));
+  CHECK_FALSE(ModelAPI::is_evicted(h));
+  ModelAPI::unload("evict_test");
+}
+
+TEST_CASE("model store reload keeps old model on failure") {
+  const char* path = "/tmp/model_api_reload.glb";
+  REQUIRE(ModelAPI::load("reload_test", Mesh{0}));
+  ModelHandle h = ModelAPI::handle("reload_test");
+  AsyncLoader loader; // not started: jobs run inline, land in pump()
+  CHECK_FALSE(ModelAPI::reload_async(h, loader)); // generated mesh has no source
+  ModelAPI::slot(h)->source = path;
+  CHECK(std::string(ModelAPI::source_of(h)) == path);
+
+  // Truncated export: header claims 64 bytes, file has 20
+  std::vector<uint8_t> glb = {'g', 'l', 'T', 'F', 2, 0, 0, 0, 64, 0, 0, 0};
+  glb.resize(20);
+  CHECK_FALSE(ModelAPI::complete_file(path, glb));
+  glb[8] = 20;
+  CHECK(ModelAPI::complete_file(path, glb));
+  glb[8] = 64;
+  {
+    std::ofstream out(path, std::ios::binary);
+    out.write((const char*)glb.data(), (std::streamsize)glb.size());
+  }
+
+  Model before = *ModelAPI::get(h);
+  REQUIRE(ModelAPI::reload_changed({path}, loader) == 1);
+  loader.finish_all();
+  CHECK(ModelAPI::get(h)->meshes == before.meshes); // untouched
+  CHECK(ModelAPI::handle("reload_test") == h);
+
+  FileWatcher watcher;
+  ModelAPI::watch_all(watcher);
+  CHECK(watcher.watching(path));
+
+  ModelAPI::unload("reload_test");
+  std::remove(path);
+}
 
 TEST_CASE("model store visual test" * doctest::skip()) {
   const int screenWidth = 1280;
@@ -191,6 +905,7 @@ TEST_CASE("model store visual test" * doctest::skip()) {
       rotationY += 30.0f * GetFrameTime();
 
     ModelInstance inst = ModelAPI::instance(modelNames[selectedIndex]);
+    Model* model = inst.get(); // resolved per frame: an async load or reload may have swapped it
 
     BeginDrawing();
     ClearBackground(DARKGRAY);
@@ -201,10 +916,10 @@ TEST_CASE("model store visual test" * doctest::skip()) {
     if (inst.valid()) {
       Vector3 pos = {0.0f, 0.5f, 0.0f};
       if (wireframe) {
-        DrawModelWiresEx(inst.model, pos, {0, 1, 0}, rotationY, {1, 1, 1}, modelColor);
+        DrawModelWiresEx(*model, pos, {0, 1, 0}, rotationY, {1, 1, 1}, modelColor);
       } else {
-        DrawModelEx(inst.model, pos, {0, 1, 0}, rotationY, {1, 1, 1}, modelColor);
-        DrawModelWiresEx(inst.model, pos, {0, 1, 0}, rotationY, {1, 1, 1}, BLACK);
+        DrawModelEx(*model, pos, {0, 1, 0}, rotationY, {1, 1, 1}, modelColor);
+        DrawModelWiresEx(*model, pos, {0, 1, 0}, rotationY, {1, 1, 1}, BLACK);
       }
     }
 
@@ -242,8 +957,8 @@ TEST_CASE("model store visual test" * doctest::skip()) {
       ImGui::Separator();
       if (inst.valid()) {
         ImGui::Text("Current: %s", inst.name);
-        ImGui::Text("Meshes: %d", inst.model.meshCount);
-        ImGui::Text("Materials: %d", inst.model.materialCount);
+        ImGui::Text("Meshes: %d", model->meshCount);
+        ImGui::Text("Materials: %d", model->materialCount);
       }
     }
     ImGui::End();
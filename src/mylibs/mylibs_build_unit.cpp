@@ -1,7 +1,22 @@
+#include "aabb_tree.hpp"
+#include "archetype_store.hpp"
 #include "asset_helpers.hpp"
+#include "asset_pack.hpp"
+#include "async_loader.hpp"
+#include "bench.hpp"
+#include "file_watcher.hpp"
+#include "frame_arena.hpp"
 #include "game_console_api.hpp"
 #include "hexgrid_math.hpp"
+#include "hexgrid_mesh.hpp"
+#include "hex_nav.hpp"
 #include "hitbox_helpers.cpp"
 #include "ilist.hpp"
+#include "job_system.hpp"
 #include "model_api.hpp"
+#include "profiler.hpp"
+#include "residency.hpp"
+#include "snapshot.hpp"
+#include "spatial_hash.hpp"
+#include "texture_cook.hpp"
 #include "zoo.hpp"
@@ -0,0 +1,471 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="profiler*"
+exit
+#endif
+/**
+ * @file profiler.hpp
+ * @brief Frame profiler: scoped zones, per-frame counters, ImGui timeline, Chrome-trace dump
+ *
+ * Zones are RAII scopes recorded into a ring of the last HISTORY frames.
+ * Timestamps are raw rdtsc ticks on x86-64 (steady_clock ns elsewhere);
+ * each frame also samples steady_clock at its start and end, and ticks are
+ * converted with that frame's own ratio, so there is no calibration spin.
+ * Frames reuse their buffers, so recording does not allocate once warm.
+ *
+ * Zone names must outlive the capture (string literals). Recording is
+ * main-thread only: zones opened on other threads are ignored.
+ *
+ * Usage:
+ *   Profiler::begin_frame();
+ *   { PROFILE_ZONE("collisions"); ... PROFILE_COUNT("pairs tested", n); }
+ *   Profiler::end_frame();
+ *   Profiler::draw_imgui(); // inside rlImGuiBegin / rlImGuiEnd
+ *
+ * Console: prof (toggle panel), prof_pause, prof_dump <file.json> [frames]
+ */
+
+#pragma once
+#include "game_console_api.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <imgui.h>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <x86intrin.h>
+#define PROFILER_RDTSC 1
+#endif
+
+namespace Profiler {
+
+constexpr int HISTORY = 240; ///< Frames kept in the ring
+constexpr int MAX_COUNTERS = 32;
+
+struct Zone {
+  const char* name;
+  uint64_t start;
+  uint64_t end;
+  int depth;
+};
+
+struct Frame {
+  uint64_t tick_start = 0, tick_end = 0;
+  double ns_start = 0, ns_end = 0; ///< steady_clock, for converting ticks
+  std::vector<Zone> zones;         ///< In open order (parents before children)
+  int64_t counters[MAX_COUNTERS] = {};
+
+  double ns_of(uint64_t tick) const {
+    if (tick_end == tick_start)
+      return ns_start;
+    return ns_start + (double)(tick - tick_start) * (ns_end - ns_start) /
+                          (double)(tick_end - tick_start);
+  }
+  double ms() const { return (ns_end - ns_start) * 1e-6; }
+};
+
+inline bool enabled = true;
+inline bool paused = false; ///< Stop recording so the ring can be inspected
+inline bool panel_visible = false;
+
+inline Frame frames[HISTORY];
+inline int frame_index = 0;  ///< Slot being recorded
+inline int frames_done = 0;  ///< Completed frames, saturating at HISTORY
+inline bool recording = false;
+inline int depth = 0;
+inline std::thread::id main_thread = std::this_thread::get_id();
+inline std::vector<const char*> counter_names;
+
+inline uint64_t ticks() {
+#ifdef PROFILER_RDTSC
+  return __rdtsc();
+#else
+  using namespace std::chrono;
+  return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline double clock_ns() {
+  using namespace std::chrono;
+  return (double)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+inline Frame& current() { return frames[frame_index]; }
+
+/// @brief A completed frame, 0 = most recent. nullptr past the history.
+inline const Frame* completed(int age) {
+  if (age < 0 || age >= frames_done)
+    return nullptr;
+  return &frames[(frame_index - 1 - age + 2 * HISTORY) % HISTORY];
+}
+
+inline void begin_frame() {
+  recording = enabled && !paused;
+  if (!recording)
+    return;
+  Frame& f = current();
+  f.zones.clear();
+  std::fill(std::begin(f.counters), std::end(f.counters), 0);
+  depth = 0;
+  f.ns_start = clock_ns();
+  f.tick_start = ticks();
+}
+
+inline void end_frame() {
+  if (!recording)
+    return;
+  Frame& f = current();
+  f.tick_end = ticks();
+  f.ns_end = clock_ns();
+  frame_index = (frame_index + 1) % HISTORY;
+  frames_done = std::min(frames_done + 1, HISTORY);
+  recording = false;
+}
+
+/// @brief Zone index for end_zone(), or -1 if not recording.
+inline int begin_zone(const char* name) {
+  if (!recording || std::this_thread::get_id() != main_thread)
+    return -1;
+  Frame& f = current();
+  f.zones.push_back({name, ticks(), 0, depth++});
+  return (int)f.zones.size() - 1;
+}
+
+inline void end_zone(int idx) {
+  if (idx < 0 || !recording)
+    return;
+  current().zones[idx].end = ticks();
+  depth--;
+}
+
+struct Scope {
+  int idx;
+  explicit Scope(const char* name) : idx(begin_zone(name)) {}
+  ~Scope() { end_zone(idx); }
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+};
+
+/// @brief Id for a counter name, registered on first use. -1 once MAX_COUNTERS are taken.
+inline int counter_id(const char* name) {
+  for (int i = 0; i < (int)counter_names.size(); i++)
+    if (std::string_view(counter_names[i]) == name)
+      return i;
+  if ((int)counter_names.size() >= MAX_COUNTERS)
+    return -1;
+  counter_names.push_back(name);
+  return (int)counter_names.size() - 1;
+}
+
+inline void count(int id, int64_t n = 1) {
+  if (recording && id >= 0 && std::this_thread::get_id() == main_thread)
+    current().counters[id] += n;
+}
+
+/// @brief Mean and max duration of every zone name over the history, in ms.
+struct ZoneStats {
+  const char* name;
+  double mean_ms;
+  double max_ms;
+  int calls;
+};
+
+inline std::vector<ZoneStats> zone_stats() {
+  std::vector<ZoneStats> out;
+  for (int age = 0; age < frames_done; age++) {
+    const Frame& f = *completed(age);
+    for (const Zone& z : f.zones) {
+      double ms = (f.ns_of(z.end) - f.ns_of(z.start)) * 1e-6;
+      auto it = std::find_if(out.begin(), out.end(), [&](const ZoneStats& s) {
+        return std::string_view(s.name) == z.name;
+      });
+      if (it == out.end())
+        it = out.insert(out.end(), {z.name, 0, 0, 0});
+      it->mean_ms += ms;
+      it->max_ms = std::max(it->max_ms, ms);
+      it->calls++;
+    }
+  }
+  for (ZoneStats& s : out)
+    s.mean_ms /= std::max(1, frames_done);
+  return out;
+}
+
+inline void json_string(std::string& out, const char* s) {
+  out += '"';
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\')
+      out += '\\';
+    out += *s;
+  }
+  out += '"';
+}
+
+/**
+ * @brief Chrome-trace JSON (chrome://tracing, Perfetto) for the last `count` frames.
+ * Zones are complete ("X") events, counters are "C" events at each frame start.
+ */
+inline std::string chrome_trace(int count = HISTORY) {
+  count = std::min(count, frames_done);
+  std::string out = "{\"traceEvents\":[\n";
+  char buf[128];
+  bool first = true;
+  auto event = [&](const char* name, const char* rest) {
+    out += first ? "" : ",\n";
+    first = false;
+    out += "{\"name\":";
+    json_string(out, name);
+    out += rest;
+  };
+  for (int age = count - 1; age >= 0; age--) {
+    const Frame& f = *completed(age);
+    double us = f.ns_start * 1e-3;
+    snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}", us,
+             f.ms() * 1e3);
+    event("frame", buf);
+    for (const Zone& z : f.zones) {
+      double start = f.ns_of(z.start) * 1e-3;
+      snprintf(buf, sizeof(buf), ",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+               start, f.ns_of(z.end) * 1e-3 - start);
+      event(z.name, buf);
+    }
+    for (int c = 0; c < (int)counter_names.size(); c++) {
+      snprintf(buf, sizeof(buf), ",\"ph\":\"C\",\"pid\":0,\"ts\":%.3f,\"args\":{\"value\":%lld}}",
+               us, (long long)f.counters[c]);
+      event(counter_names[c], buf);
+    }
+  }
+  out += "\n]}\n";
+  return out;
+}
+
+inline bool write_chrome_trace(const std::string& path, int count = HISTORY) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  std::string json = chrome_trace(count);
+  bool ok = fwrite(json.data(), 1, json.size(), f) == json.size();
+  return fclose(f) == 0 && ok;
+}
+
+inline void reset() {
+  for (Frame& f : frames)
+    f.zones.clear();
+  frame_index = 0;
+  frames_done = 0;
+  recording = false;
+  depth = 0;
+}
+
+// ---- ImGui panel ----
+
+inline ImU32 zone_color(const char* name) {
+  uint32_t h = 2166136261u;
+  for (const char* c = name; *c; c++)
+    h = (h ^ (uint8_t)*c) * 16777619u;
+  return ImGui::ColorConvertFloat4ToU32(
+      ImVec4(0.35f + (h & 0xff) / 500.0f, 0.35f + ((h >> 8) & 0xff) / 500.0f,
+             0.35f + ((h >> 16) & 0xff) / 500.0f, 1.0f));
+}
+
+/**
+ * @brief Frame time graph, a flame timeline of one selected frame, counters and zone stats.
+ * Clicking the graph picks the frame shown in the timeline.
+ */
+inline void draw_imgui() {
+  if (!panel_visible)
+    return;
+  static int selected_age = 0;
+  ImGui::SetNextWindowSize(ImVec2(700, 420), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Profiler", &panel_visible)) {
+    ImGui::End();
+    return;
+  }
+  ImGui::Checkbox("Paused", &paused);
+  ImGui::SameLine();
+  if (ImGui::Button("Dump trace"))
+    GameConsoleAPI::print(write_chrome_trace("profile.json") ? "wrote profile.json"
+                                                             : "profiler: write failed");
+
+  // Frame times, oldest on the left
+  float times[HISTORY] = {};
+  for (int i = 0; i < frames_done; i++)
+    times[i] = (float)completed(frames_done - 1 - i)->ms();
+  float avail = ImGui::GetContentRegionAvail().x;
+  ImGui::PlotHistogram("##frames", times, frames_done, 0, nullptr, 0.0f, 33.3f,
+                       ImVec2(avail, 60));
+  if (ImGui::IsItemClicked() && frames_done > 0) {
+    float x = (ImGui::GetIO().MousePos.x - ImGui::GetItemRectMin().x) / ImGui::GetItemRectSize().x;
+    selected_age = std::clamp(frames_done - 1 - (int)(x * frames_done), 0, frames_done - 1);
+  }
+  if (!paused)
+    selected_age = 0;
+
+  const Frame* f = completed(selected_age);
+  if (!f) {
+    ImGui::TextUnformatted("No frames captured");
+    ImGui::End();
+    return;
+  }
+  ImGui::Text("Frame -%d: %.2f ms, %zu zones", selected_age, f->ms(), f->zones.size());
+
+  // Timeline: one row per nesting depth
+  const float row = ImGui::GetTextLineHeightWithSpacing();
+  int max_depth = 0;
+  for (const Zone& z : f->zones)
+    max_depth = std::max(max_depth, z.depth);
+  ImVec2 origin = ImGui::GetCursorScreenPos();
+  ImVec2 size(avail, row * (max_depth + 1));
+  ImGui::InvisibleButton("##timeline", size);
+  ImDrawList* draw = ImGui::GetWindowDrawList();
+  double span = std::max(1.0, f->ns_end - f->ns_start);
+  for (const Zone& z : f->zones) {
+    float x0 = origin.x + (float)((f->ns_of(z.start) - f->ns_start) / span) * size.x;
+    float x1 = origin.x + (float)((f->ns_of(z.end) - f->ns_start) / span) * size.x;
+    x1 = std::max(x1, x0 + 1.0f);
+    float y0 = origin.y + z.depth * row;
+    ImVec2 a(x0, y0), b(x1, y0 + row - 1);
+    draw->AddRectFilled(a, b, zone_color(z.name));
+    if (x1 - x0 > ImGui::CalcTextSize(z.name).x + 4) {
+      draw->PushClipRect(a, b, true);
+      draw->AddText(ImVec2(x0 + 2, y0), IM_COL32(0, 0, 0, 255), z.name);
+      draw->PopClipRect();
+    }
+    if (ImGui::IsMouseHoveringRect(a, b))
+      ImGui::SetTooltip("%s: %.3f ms", z.name, (f->ns_of(z.end) - f->ns_of(z.start)) * 1e-6);
+  }
+
+  if (!counter_names.empty() && ImGui::CollapsingHeader("Counters", ImGuiTreeNodeFlags_DefaultOpen))
+    for (int c = 0; c < (int)counter_names.size(); c++)
+      ImGui::Text("%-24s %lld", counter_names[c], (long long)f->counters[c]);
+
+  if (ImGui::CollapsingHeader("Zones (mean / max over history)")) {
+    for (const ZoneStats& s : zone_stats())
+      ImGui::Text("%-24s %7.3f / %7.3f ms  x%.1f", s.name, s.mean_ms, s.max_ms,
+                  (double)s.calls / std::max(1, frames_done));
+  }
+  ImGui::End();
+}
+
+} // namespace Profiler
+
+#define PROFILER_CAT2(a, b) a##b
+#define PROFILER_CAT(a, b) PROFILER_CAT2(a, b)
+
+/// Time the rest of the enclosing scope as a zone named `name` (a string literal)
+#define PROFILE_ZONE(name) Profiler::Scope PROFILER_CAT(_profile_zone_, __LINE__)(name)
+
+/// Add `n` to this frame's counter `name`; the name is resolved once per call site
+#define PROFILE_COUNT(name, n)                                                                     \
+  do {                                                                                             \
+    static const int _profile_counter = Profiler::counter_id(name);                                \
+    Profiler::count(_profile_counter, (n));                                                        \
+  } while (0)
+
+// ---- Console commands ----
+
+REGISTER_CMD(prof, "toggle the profiler panel", {
+  (void)args;
+  Profiler::panel_visible = !Profiler::panel_visible;
+  return std::string(Profiler::panel_visible ? "profiler shown" : "profiler hidden");
+});
+
+REGISTER_CMD(prof_pause, "pause / resume profiler capture", {
+  (void)args;
+  Profiler::paused = !Profiler::paused;
+  return std::string(Profiler::paused ? "capture paused" : "capture resumed");
+});
+
+REGISTER_CMD(prof_dump, "prof_dump <file.json> [frames] - write a Chrome trace", {
+  if (args.empty())
+    return std::string("Usage: prof_dump <file.json> [frames]");
+  int frames = Profiler::HISTORY;
+  if (args.size() > 1) {
+    const std::string& a = args[1];
+    auto [end, ec] = std::from_chars(a.data(), a.data() + a.size(), frames);
+    if (ec != std::errc() || end != a.data() + a.size() || frames <= 0)
+      return "Usage: prof_dump <file.json> [frames] (frames must be a positive number, got '" +
+             a + "')";
+  }
+  if (!Profiler::write_chrome_trace(args[0], frames))
+    return "Failed to write " + args[0];
+  return "Wrote " + std::to_string(std::min(frames, Profiler::frames_done)) + " frames to " +
+         args[0];
+});
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("profiler records nested zones and counters") {
+  Profiler::reset();
+  for (int i = 0; i < 3; i++) {
+    Profiler::begin_frame();
+    {
+      PROFILE_ZONE("outer");
+      PROFILE_COUNT("visited", 2);
+      {
+        PROFILE_ZONE("inner");
+        PROFILE_COUNT("visited", i);
+      }
+    }
+    Profiler::end_frame();
+  }
+  Profiler::count(Profiler::counter_id("visited"), 100); // outside a frame: dropped
+
+  CHECK(Profiler::frames_done == 3);
+  const Profiler::Frame* last = Profiler::completed(0);
+  REQUIRE(last);
+  REQUIRE(last->zones.size() == 2);
+  CHECK(std::string(last->zones[0].name) == "outer");
+  CHECK(last->zones[1].depth == 1);
+  CHECK(last->zones[0].start <= last->zones[1].start);
+  CHECK(last->zones[1].end <= last->zones[0].end);
+  CHECK(last->ns_of(last->zones[0].end) <= last->ns_end);
+  CHECK(last->counters[Profiler::counter_id("visited")] == 4);
+  CHECK(Profiler::completed(2)->counters[Profiler::counter_id("visited")] == 2);
+  CHECK(Profiler::completed(3) == nullptr);
+
+  auto stats = Profiler::zone_stats();
+  CHECK(stats.size() == 2);
+
+  // Paused frames don't overwrite the ring
+  Profiler::paused = true;
+  Profiler::begin_frame();
+  { PROFILE_ZONE("ignored"); }
+  Profiler::end_frame();
+  Profiler::paused = false;
+  CHECK(Profiler::frames_done == 3);
+  CHECK(std::string(Profiler::completed(0)->zones[0].name) == "outer");
+}
+
+TEST_CASE("profiler chrome trace dump") {
+  Profiler::reset();
+  Profiler::begin_frame();
+  {
+    PROFILE_ZONE("quote\"d");
+    PROFILE_COUNT("draw calls", 7);
+  }
+  Profiler::end_frame();
+
+  std::string json = Profiler::chrome_trace();
+  CHECK(json.rfind("{\"traceEvents\":[", 0) == 0);
+  CHECK(json.find("\"name\":\"frame\"") != std::string::npos);
+  CHECK(json.find("\"name\":\"quote\\\"d\"") != std::string::npos);
+  CHECK(json.find("\"value\":7") != std::string::npos);
+
+  CHECK(GameConsoleAPI::exec("prof_dump /tmp/profiler_test.json 1").rfind("Wrote 1", 0) == 0);
+  CHECK(GameConsoleAPI::exec("prof_dump /tmp/profiler_test.json lots").rfind("Usage", 0) == 0);
+  CHECK(GameConsoleAPI::exec("prof_dump /tmp/profiler_test.json 3x").rfind("Usage", 0) == 0);
+  CHECK(GameConsoleAPI::exec("prof_dump /tmp/profiler_test.json 0").rfind("Usage", 0) == 0);
+  std::remove("/tmp/profiler_test.json");
+}
+
+#endif
@@ -1,6 +1,8 @@
 #pragma once
+#include <algorithm>
 #include <raylib.h>
 #include <raymath.h>
+#include <rlgl.h>
 #include <vector>
 
 // ============================================================================
@@ -36,103 +38,262 @@ struct RenderTraits {
 // RenderAPI - namespace-style render layer management
 // ============================================================================
 
+/**
+ * Layers are allocated on first use at (screen size * scale) and recreated
+ * when the window is resized. A layer is cleared the first time it is opened
+ * in a frame, so it can be reopened without losing what was drawn.
+ *
+ * Direct layers skip the render target and draw straight to the backbuffer
+ * (sharing its depth buffer). They are not composited, so they always end up
+ * beneath every composited layer: use them for the lowest, opaque layers.
+ *
+ * rasterize() composites the used layers with one shader pass per
+ * COMPOSITE_UNITS layers (rlgl's batch binds at most 4 textures per draw),
+ * falling back to one blit per layer if the shader is unavailable.
+ */
 namespace RenderAPI {
 
+struct LayerConfig {
+  float scale = 1.0f; ///< Resolution relative to the screen
+  bool depth = true;  ///< false = colour-only target (no depth renderbuffer)
+  bool direct = false;
+};
+
 struct LayerData {
   RenderTexture2D texture = {0};
+  LayerConfig config;
+  bool allocated = false;
   bool used = false;
 };
 
+constexpr int COMPOSITE_UNITS = 4;
+
 inline std::vector<LayerData> layers;
 inline int open_layer_id = -1;
+inline bool open_layer_direct = false;
+inline bool open_2d_target = false; ///< a 2D layer's texture mode is open until end_2d_layer()
 inline int screen_w = 0;
 inline int screen_h = 0;
 inline int layer_count = 0;
+inline Shader composite_shader = {0};
+inline int composite_count_loc = -1;
+inline int composite_sampler_locs[COMPOSITE_UNITS] = {-1, -1, -1, -1};
+
+// Straight-alpha "over" of up to 4 layers, bottom first; matches N alpha blits.
+inline const char* COMPOSITE_FS = R"(#version 330
+in vec2 fragTexCoord;
+uniform sampler2D texture0;
+uniform sampler2D layer1;
+uniform sampler2D layer2;
+uniform sampler2D layer3;
+uniform int layerCount;
+out vec4 finalColor;
+
+vec4 over(vec4 dst, vec4 src) {
+  float a = src.a + dst.a * (1.0 - src.a);
+  vec3 c = a > 0.0 ? (src.rgb * src.a + dst.rgb * dst.a * (1.0 - src.a)) / a : vec3(0.0);
+  return vec4(c, a);
+}
+
+void main() {
+  vec4 c = texture(texture0, fragTexCoord);
+  if (layerCount > 1) c = over(c, texture(layer1, fragTexCoord));
+  if (layerCount > 2) c = over(c, texture(layer2, fragTexCoord));
+  if (layerCount > 3) c = over(c, texture(layer3, fragTexCoord));
+  finalColor = c;
+}
+)";
+
+/// @brief True if the composite shader compiled (raylib falls back to its default shader).
+inline bool composite_ready() {
+  return IsShaderValid(composite_shader) && composite_shader.id != rlGetShaderIdDefault();
+}
 
 inline void close_layer() {
   if (open_layer_id >= 0) {
     EndMode3D();
-    EndTextureMode();
+    if (!open_layer_direct)
+      EndTextureMode();
     open_layer_id = -1;
+    open_layer_direct = false;
   }
 }
 
+/// @brief Render target without a depth attachment.
+inline RenderTexture2D load_color_target(int w, int h) {
+  RenderTexture2D target = {0};
+  target.id = rlLoadFramebuffer();
+  if (target.id == 0)
+    return target;
+  rlEnableFramebuffer(target.id);
+  target.texture.id = rlLoadTexture(nullptr, w, h, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8, 1);
+  target.texture.width = w;
+  target.texture.height = h;
+  target.texture.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+  target.texture.mipmaps = 1;
+  rlFramebufferAttach(target.id, target.texture.id, RL_ATTACHMENT_COLOR_CHANNEL0,
+                      RL_ATTACHMENT_TEXTURE2D, 0);
+  rlFramebufferComplete(target.id);
+  rlDisableFramebuffer();
+  return target;
+}
+
+// Also forgets the layer's use this frame, so a target reallocated mid-frame
+// (resize, configure) is cleared when reopened instead of compositing garbage
+inline void release_layer(LayerData& data) {
+  if (data.allocated)
+    UnloadRenderTexture(data.texture);
+  data.texture = {0};
+  data.allocated = false;
+  data.used = false;
+}
+
+/// @brief Drop all targets if the window size changed; they are reallocated on next use.
+inline void refresh_size() {
+  int w = GetScreenWidth();
+  int h = GetScreenHeight();
+  if (w == screen_w && h == screen_h)
+    return;
+  close_layer();
+  screen_w = w;
+  screen_h = h;
+  for (auto& data : layers)
+    release_layer(data);
+}
+
+/// @brief Allocate a layer's target if needed. Returns false for direct / invalid layers.
+inline bool ensure_layer(int idx) {
+  if (idx < 0 || idx >= layer_count)
+    return false;
+  auto& data = layers[idx];
+  if (data.config.direct)
+    return false;
+  if (!data.allocated) {
+    int w = (int)(screen_w * data.config.scale);
+    int h = (int)(screen_h * data.config.scale);
+    w = w > 0 ? w : 1;
+    h = h > 0 ? h : 1;
+    data.texture = data.config.depth ? LoadRenderTexture(w, h) : load_color_target(w, h);
+    data.allocated = true;
+  }
+  return true;
+}
+
+/// @brief Set up layer slots. No render targets are allocated until a layer is used.
 inline void init(int count = static_cast<int>(RenderLayer::COUNT)) {
   screen_w = GetScreenWidth();
   screen_h = GetScreenHeight();
   layer_count = count;
   layers.resize(count);
-  for (int i = 0; i < count; i++) {
-    layers[i].texture = LoadRenderTexture(screen_w, screen_h);
-    layers[i].used = false;
-  }
+
+  composite_shader = LoadShaderFromMemory(nullptr, COMPOSITE_FS);
+  composite_count_loc = GetShaderLocation(composite_shader, "layerCount");
+  const char* samplers[COMPOSITE_UNITS] = {"texture0", "layer1", "layer2", "layer3"};
+  for (int i = 0; i < COMPOSITE_UNITS; i++)
+    composite_sampler_locs[i] = GetShaderLocation(composite_shader, samplers[i]);
+}
+
+/// @brief Change a layer's resolution / depth / direct mode. Its target is recreated on next use.
+inline void configure(RenderLayer layer, LayerConfig config) {
+  int idx = static_cast<int>(layer);
+  if (idx < 0 || idx >= layer_count)
+    return;
+  close_layer();
+  release_layer(layers[idx]);
+  layers[idx].config = config;
 }
 
 inline void shutdown() {
   close_layer();
-  for (auto& data : layers) {
-    UnloadRenderTexture(data.texture);
-  }
+  for (auto& data : layers)
+    release_layer(data);
   layers.clear();
   layer_count = 0;
+  if (composite_ready())
+    UnloadShader(composite_shader);
+  composite_shader = {0};
 }
 
-inline void layer_start(RenderLayer layer, Camera3D& cam) {
+/// Bind a layer for drawing; clears it on its first use this frame.
+inline bool begin_layer(int idx) {
   close_layer();
-  int idx = static_cast<int>(layer);
+  refresh_size();
   if (idx < 0 || idx >= layer_count)
-    return;
-
+    return false;
   auto& data = layers[idx];
-  BeginTextureMode(data.texture);
-  ClearBackground(BLANK);
-  BeginMode3D(cam);
+  if (ensure_layer(idx)) {
+    BeginTextureMode(data.texture);
+    if (!data.used)
+      ClearBackground(BLANK);
+  }
   data.used = true;
-  open_layer_id = idx;
+  return true;
 }
 
 inline void layer_start(int layer, Camera3D& cam) {
-  close_layer();
-  if (layer < 0 || layer >= layer_count)
+  if (!begin_layer(layer))
     return;
-
-  auto& data = layers[layer];
-  BeginTextureMode(data.texture);
-  ClearBackground(BLANK);
   BeginMode3D(cam);
-  data.used = true;
   open_layer_id = layer;
+  open_layer_direct = layers[layer].config.direct;
+}
+
+inline void layer_start(RenderLayer layer, Camera3D& cam) {
+  layer_start(static_cast<int>(layer), cam);
 }
 
 // Start a layer in 2D mode (no BeginMode3D) for screen-space overlays
 inline void layer_start_2d(RenderLayer layer) {
-  close_layer();
   int idx = static_cast<int>(layer);
-  if (idx < 0 || idx >= layer_count)
+  if (!begin_layer(idx))
     return;
-
-  auto& data = layers[idx];
-  BeginTextureMode(data.texture);
-  ClearBackground(BLANK);
-  data.used = true;
   open_layer_id = -1; // not a 3D layer, so close_layer won't call EndMode3D
+  open_2d_target = !layers[idx].config.direct;
 }
 
 inline void end_2d_layer() {
-  EndTextureMode();
+  if (open_2d_target)
+    EndTextureMode();
+  open_2d_target = false;
+}
+
+inline void blit_layer(const LayerData& data) {
+  const Texture2D& tex = data.texture.texture;
+  DrawTexturePro(tex, {0, 0, (float)tex.width, (float)-tex.height},
+                 {0, 0, (float)screen_w, (float)screen_h}, {0, 0}, 0.0f, WHITE);
+}
+
+/// @brief Composite up to COMPOSITE_UNITS layers, bottom first, in one shader pass.
+inline void composite(const LayerData* const* batch, int n) {
+  if (!composite_ready()) {
+    for (int k = 0; k < n; k++)
+      blit_layer(*batch[k]);
+    return;
+  }
+  BeginShaderMode(composite_shader);
+  SetShaderValue(composite_shader, composite_count_loc, &n, SHADER_UNIFORM_INT);
+  for (int k = 1; k < n; k++)
+    SetShaderValueTexture(composite_shader, composite_sampler_locs[k], batch[k]->texture.texture);
+  blit_layer(*batch[0]);
+  EndShaderMode();
 }
 
 inline void rasterize() {
   close_layer();
+  const LayerData* batch[COMPOSITE_UNITS];
+  int n = 0;
   for (int i = 0; i < layer_count; i++) {
     auto& data = layers[i];
-    if (!data.used)
-      continue;
-    DrawTextureRec(data.texture.texture,
-                   {0, 0, (float)data.texture.texture.width, (float)-data.texture.texture.height},
-                   {0, 0}, WHITE);
+    if (data.used && !data.config.direct && data.allocated)
+      batch[n++] = &data;
     data.used = false;
+    if (n == COMPOSITE_UNITS) {
+      composite(batch, n);
+      n = 0;
+    }
   }
+  if (n > 0)
+    composite(batch, n);
 }
 
 } // namespace RenderAPI
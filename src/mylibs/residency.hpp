@@ -0,0 +1,168 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="residency*"
+exit
+#endif
+/**
+ * @file residency.hpp
+ * @brief LRU bookkeeping for streaming GPU assets in and out under a byte budget
+ *
+ * The caller owns the assets and numbers them; Residency only tracks which
+ * are resident, which are loading, how many bytes they hold and when each
+ * was last wanted. Per frame:
+ *
+ *   res.begin_frame();
+ *   for (visible or nearly visible ids) res.touch(id);   // e.g. from a frustum query
+ *   res.request_wanted([&](int id) { start_load(id); }); // capped at max_in_flight
+ *   res.evict_over_budget([&](int id) { unload(id); });  // never evicts this frame's ids
+ *
+ * and from the load completion: res.loaded(id, bytes) or res.dropped(id).
+ */
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct Residency {
+  enum class State : uint8_t { Evicted, Loading, Resident };
+
+  struct Item {
+    State state = State::Evicted;
+    size_t bytes = 0;
+    uint64_t last_seen = 0; ///< Frame of the last touch(); 0 = never
+  };
+
+  std::vector<Item> items;
+  size_t budget = size_t(256) << 20; ///< Bytes of resident assets before eviction starts
+  size_t resident_bytes = 0;
+  int max_in_flight = 8; ///< Loads request_wanted() keeps going at once
+  int in_flight = 0;
+  uint64_t frame = 1;
+
+  void resize(size_t n) { items.resize(n); }
+  void begin_frame() { frame++; }
+
+  void touch(int id) {
+    if (id >= 0 && (size_t)id < items.size())
+      items[id].last_seen = frame;
+  }
+
+  bool wanted(int id) const { return items[id].last_seen == frame; }
+  bool resident(int id) const { return items[id].state == State::Resident; }
+
+  /// @brief start(id) for ids touched this frame that are neither resident nor loading.
+  template <typename Fn> void request_wanted(Fn&& start) {
+    for (size_t i = 0; i < items.size() && in_flight < max_in_flight; i++) {
+      Item& it = items[i];
+      if (it.state != State::Evicted || it.last_seen != frame)
+        continue;
+      it.state = State::Loading;
+      in_flight++;
+      start((int)i);
+    }
+  }
+
+  /// @brief Mark an asset resident, whether or not it came from request_wanted().
+  void loaded(int id, size_t bytes) {
+    Item& it = items[id];
+    if (it.state == State::Loading)
+      in_flight--;
+    if (it.state == State::Resident)
+      resident_bytes -= it.bytes;
+    it.state = State::Resident;
+    it.bytes = bytes;
+    resident_bytes += bytes;
+  }
+
+  /// @brief A load finished without keeping the asset (failed, or no longer wanted).
+  void dropped(int id) {
+    Item& it = items[id];
+    if (it.state == State::Loading)
+      in_flight--;
+    if (it.state == State::Resident)
+      resident_bytes -= it.bytes;
+    it.state = State::Evicted;
+    it.bytes = 0;
+  }
+
+  /**
+   * @brief evict(id) least recently seen resident assets until under budget.
+   * Assets touched this frame are kept even if that leaves the budget exceeded.
+   */
+  template <typename Fn> void evict_over_budget(Fn&& evict) {
+    while (resident_bytes > budget) {
+      int victim = -1;
+      for (size_t i = 0; i < items.size(); i++) {
+        const Item& it = items[i];
+        if (it.state == State::Resident && it.last_seen != frame &&
+            (victim < 0 || it.last_seen < items[victim].last_seen))
+          victim = (int)i;
+      }
+      if (victim < 0)
+        return;
+      evict(victim);
+      dropped(victim);
+    }
+  }
+
+  void clear() {
+    items.clear();
+    resident_bytes = 0;
+    in_flight = 0;
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("residency streams wanted ids and evicts least recently seen") {
+  Residency res;
+  res.resize(6);
+  res.budget = 300;
+  res.max_in_flight = 2;
+
+  std::vector<int> started;
+  res.begin_frame();
+  for (int id : {0, 1, 2})
+    res.touch(id);
+  res.request_wanted([&](int id) { started.push_back(id); });
+  CHECK(started == std::vector<int>{0, 1}); // capped
+  CHECK(res.in_flight == 2);
+  res.loaded(0, 100);
+  res.loaded(1, 100);
+  CHECK(res.in_flight == 0);
+
+  res.begin_frame();
+  res.touch(2);
+  res.touch(3);
+  res.request_wanted([&](int id) { started.push_back(id); });
+  CHECK(started == std::vector<int>{0, 1, 2, 3});
+  res.loaded(2, 100);
+  res.dropped(3);
+  CHECK(res.items[3].state == Residency::State::Evicted);
+
+  // Over budget: the never-again-seen ids go first, oldest first; touched ones stay
+  res.begin_frame();
+  res.touch(2);
+  res.touch(4);
+  res.request_wanted([&](int) {});
+  res.loaded(4, 150);
+  CHECK(res.resident_bytes == 450);
+  std::vector<int> evicted;
+  res.evict_over_budget([&](int id) { evicted.push_back(id); });
+  CHECK(evicted == std::vector<int>{0, 1}); // 0 and 1 share last_seen; lower id first
+  CHECK(res.resident_bytes == 250);
+  CHECK(res.resident(2));
+  CHECK(res.resident(4));
+
+  // Everything resident is wanted: budget stays exceeded rather than thrashing
+  res.budget = 100;
+  evicted.clear();
+  res.evict_over_budget([&](int id) { evicted.push_back(id); });
+  CHECK(evicted.empty());
+}
+
+#endif
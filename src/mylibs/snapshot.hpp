@@ -0,0 +1,401 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="snapshot*"
+exit
+#endif
+/**
+ * @file snapshot.hpp
+ * @brief Binary blobs for quicksave / quickload, and input logs for deterministic replay
+ *
+ * SnapshotWriter appends raw bytes to a growable buffer; SnapshotReader
+ * reads them back with bounds checks, so a truncated or foreign blob fails
+ * the read instead of crashing. paged_things_list::write_raw / read_raw go
+ * through them to dump a list's pages, free list and generations as-is: a
+ * save is a handful of memcpys. Pointers inside items are the caller's to
+ * fix up, usually via a StringTable of the names they pointed at.
+ *
+ * InputRecorder holds a starting snapshot plus one input record per frame.
+ * Played back by the same build, it reproduces the session frame for frame.
+ *
+ *   SnapshotWriter w;
+ *   w.pod(header);
+ *   names.write(w);
+ *   entities.write_raw(w);
+ *   ...
+ *   SnapshotReader r(w.bytes);
+ *   if (!r.pod(header) || !names.read(r) || !entities.read_raw(r)) fail();
+ */
+
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+struct SnapshotWriter {
+  std::vector<uint8_t> bytes;
+
+  void write(const void* data, size_t n) {
+    auto* p = static_cast<const uint8_t*>(data);
+    bytes.insert(bytes.end(), p, p + n);
+  }
+
+  template <typename T> void pod(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "pod() copies bytewise");
+    write(&value, sizeof(T));
+  }
+
+  void str(std::string_view s) {
+    pod((uint32_t)s.size());
+    write(s.data(), s.size());
+  }
+
+  /// @brief Element count, then the elements bytewise.
+  template <typename T> void array(const T* data, size_t n) {
+    static_assert(std::is_trivially_copyable_v<T>, "array() copies bytewise");
+    pod((uint64_t)n);
+    write(data, n * sizeof(T));
+  }
+  template <typename T> void array(const std::vector<T>& v) { array(v.data(), v.size()); }
+};
+
+struct SnapshotReader {
+  const uint8_t* at = nullptr;
+  const uint8_t* end = nullptr;
+  bool ok = true; ///< Cleared by the first read that ran past the end; later reads fail
+
+  SnapshotReader(const void* data, size_t n)
+      : at(static_cast<const uint8_t*>(data)), end(at + n) {}
+  explicit SnapshotReader(const std::vector<uint8_t>& bytes)
+      : SnapshotReader(bytes.data(), bytes.size()) {}
+
+  size_t remaining() const { return (size_t)(end - at); }
+
+  bool read(void* out, size_t n) {
+    if (!ok || remaining() < n)
+      return ok = false;
+    if (n)
+      memcpy(out, at, n);
+    at += n;
+    return true;
+  }
+
+  template <typename T> bool pod(T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "pod() copies bytewise");
+    return read(&value, sizeof(T));
+  }
+
+  bool str(std::string& s) {
+    uint32_t n = 0;
+    if (!pod(n) || remaining() < n)
+      return ok = false;
+    s.assign(reinterpret_cast<const char*>(at), n);
+    at += n;
+    return true;
+  }
+
+  template <typename T> bool array(std::vector<T>& v) {
+    static_assert(std::is_trivially_copyable_v<T>, "array() copies bytewise");
+    uint64_t n = 0;
+    if (!pod(n) || n > remaining() / sizeof(T))
+      return ok = false;
+    v.resize((size_t)n);
+    return read(v.data(), (size_t)n * sizeof(T));
+  }
+};
+
+/**
+ * @brief Interned strings with stable storage: c_str(id) stays valid until clear().
+ * Items save name ids instead of pointers; NONE stands for a null pointer.
+ */
+struct StringTable {
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  std::deque<std::string> strings; ///< A deque, so growing never moves earlier strings
+  std::unordered_map<std::string_view, uint32_t> ids; ///< Keys view into `strings`
+
+  uint32_t intern(std::string_view s) {
+    auto it = ids.find(s);
+    if (it != ids.end())
+      return it->second;
+    uint32_t id = (uint32_t)strings.size();
+    strings.emplace_back(s);
+    ids.emplace(strings.back(), id);
+    return id;
+  }
+  uint32_t intern(const char* s) { return s ? intern(std::string_view(s)) : NONE; }
+
+  const char* c_str(uint32_t id) const {
+    return id < strings.size() ? strings[id].c_str() : nullptr;
+  }
+  size_t size() const { return strings.size(); }
+
+  void clear() {
+    ids.clear();
+    strings.clear();
+  }
+
+  void write(SnapshotWriter& out) const {
+    out.pod((uint32_t)strings.size());
+    for (const std::string& s : strings)
+      out.str(s);
+  }
+
+  /// @brief Replace the table with one written by write(); ids match the writer's.
+  bool read(SnapshotReader& in) {
+    uint32_t n = 0;
+    if (!in.pod(n))
+      return false;
+    clear();
+    std::string s;
+    for (uint32_t i = 0; i < n; i++) {
+      if (!in.str(s))
+        return false;
+      strings.emplace_back(s);
+      ids.emplace(strings.back(), i);
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Start snapshot + per-frame input records, for replaying a session exactly.
+ *
+ * Record: begin_recording(snapshot()) at a frame boundary, then push(input)
+ * every frame. Replay: restore `start`, play(), and take each frame's input
+ * from next() instead of the platform until it returns nullptr.
+ * Frame must be trivially copyable; it is saved bytewise.
+ */
+template <typename Frame> struct InputRecorder {
+  static_assert(std::is_trivially_copyable_v<Frame>, "frames are saved bytewise");
+  static constexpr uint32_t MAGIC = 0x50455249; // "IREP"
+
+  enum class Mode : uint8_t { Off, Recording, Playing };
+
+  Mode mode = Mode::Off;
+  std::vector<uint8_t> start; ///< Snapshot the recording begins from
+  std::vector<Frame> frames;
+  size_t cursor = 0; ///< Next frame next() returns
+
+  bool recording() const { return mode == Mode::Recording; }
+  bool playing() const { return mode == Mode::Playing; }
+
+  void begin_recording(std::vector<uint8_t> snapshot) {
+    start = std::move(snapshot);
+    frames.clear();
+    cursor = 0;
+    mode = Mode::Recording;
+  }
+
+  void push(const Frame& frame) {
+    if (mode == Mode::Recording)
+      frames.push_back(frame);
+  }
+
+  /// @brief Start replaying from frame 0; restore `start` first.
+  void play() {
+    cursor = 0;
+    mode = Mode::Playing;
+  }
+
+  /// @brief The next recorded frame while playing; nullptr (and Mode::Off) at the end.
+  const Frame* next() {
+    if (mode != Mode::Playing)
+      return nullptr;
+    if (cursor >= frames.size()) {
+      mode = Mode::Off;
+      return nullptr;
+    }
+    return &frames[cursor++];
+  }
+
+  void stop() { mode = Mode::Off; }
+
+  std::vector<uint8_t> serialize() const {
+    SnapshotWriter out;
+    out.pod(MAGIC);
+    out.pod((uint32_t)sizeof(Frame));
+    out.array(start);
+    out.array(frames);
+    return std::move(out.bytes);
+  }
+
+  /// @brief Load a serialize()d log (stopped); false if it isn't one from this Frame type.
+  bool deserialize(const std::vector<uint8_t>& bytes) {
+    SnapshotReader in(bytes);
+    uint32_t magic = 0, frame_size = 0;
+    std::vector<uint8_t> s;
+    std::vector<Frame> f;
+    if (!in.pod(magic) || magic != MAGIC || !in.pod(frame_size) || frame_size != sizeof(Frame) ||
+        !in.array(s) || !in.array(f))
+      return false;
+    start = std::move(s);
+    frames = std::move(f);
+    cursor = 0;
+    mode = Mode::Off;
+    return true;
+  }
+};
+
+inline bool snapshot_write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f)
+    return false;
+  bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+  return fclose(f) == 0 && ok;
+}
+
+inline bool snapshot_read_file(const std::string& path, std::vector<uint8_t>& bytes) {
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f)
+    return false;
+  bytes.clear();
+  uint8_t buf[64 << 10];
+  size_t n;
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+    bytes.insert(bytes.end(), buf, buf + n);
+  bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "ilist.hpp"
+#include <doctest/doctest.h>
+
+struct SnapItem : thing_base {
+  float hp = 0;
+  uint32_t name = StringTable::NONE;
+};
+
+TEST_CASE("snapshot round-trips a paged_things_list with holes") {
+  paged_things_list<SnapItem, 64> list;
+  std::vector<thing_ref> refs;
+  for (int i = 0; i < 150; i++) {
+    SnapItem item;
+    item.hp = (float)i;
+    refs.push_back(list.add(item));
+  }
+  for (int i = 0; i < 150; i += 3)
+    list.remove(refs[i]);
+  thing_ref readded = list.add({}); // its slot's generation has moved on by the save
+  list.remove(readded);
+
+  SnapshotWriter out;
+  out.pod(uint32_t(7));
+  list.write_raw(out);
+
+  // What the original hands out next is what the restored copy must hand out
+  thing_ref next_original = list.add({});
+
+  paged_things_list<SnapItem, 64> copy;
+  copy.add({});
+  SnapshotReader in(out.bytes);
+  uint32_t tag = 0;
+  REQUIRE(in.pod(tag));
+  CHECK(tag == 7);
+  REQUIRE(copy.read_raw(in));
+  CHECK(in.remaining() == 0);
+  CHECK(copy.size() == 100);
+  CHECK(copy.page_count() == 3);
+  for (int i = 0; i < 150; i++) {
+    SnapItem& item = copy[refs[i]];
+    if (i % 3 == 0) {
+      CHECK_FALSE(item);
+      continue;
+    }
+    REQUIRE(item);
+    CHECK(item.hp == (float)i);
+    CHECK(item.this_ref() == refs[i]);
+  }
+  CHECK_FALSE(copy[readded] && copy[readded].this_ref() == readded); // stale stays stale
+  CHECK(copy.add({}) == next_original);
+  CHECK(copy.size() == 101);
+
+  // Truncated or mismatched blobs are rejected and leave the target alone
+  paged_things_list<SnapItem, 64> other;
+  thing_ref kept = other.add({});
+  SnapshotReader cut(out.bytes.data() + 4, out.bytes.size() / 2);
+  CHECK_FALSE(other.read_raw(cut));
+  CHECK(other.size() == 1);
+  CHECK(other[kept]);
+  paged_things_list<SnapItem, 128> wrong_page;
+  SnapshotReader again(out.bytes.data() + 4, out.bytes.size() - 4);
+  CHECK_FALSE(wrong_page.read_raw(again));
+
+  // Corrupt headers fail cleanly instead of allocating what they claim
+  auto corrupt = [&](int field, uint64_t value) {
+    std::vector<uint8_t> bad(out.bytes.begin() + 4, out.bytes.end());
+    memcpy(bad.data() + field * sizeof(uint64_t), &value, sizeof(value));
+    SnapshotReader r(bad);
+    return other.read_raw(r);
+  };
+  CHECK_FALSE(corrupt(2, uint64_t(1) << 40)); // page count
+  CHECK_FALSE(corrupt(2, ~uint64_t(0)));
+  CHECK_FALSE(corrupt(3, uint64_t(1) << 62)); // free list length
+  CHECK_FALSE(corrupt(4, 99));                // live count vs live bits
+  CHECK(other.size() == 1);
+  CHECK(other[kept]);
+}
+
+TEST_CASE("snapshot string table and input recorder") {
+  StringTable names;
+  uint32_t cube = names.intern("cube");
+  CHECK(names.intern(std::string("cube")) == cube);
+  uint32_t tree = names.intern("tree");
+  CHECK(names.intern((const char*)nullptr) == StringTable::NONE);
+  const char* stable = names.c_str(cube);
+  for (int i = 0; i < 100; i++)
+    names.intern("name " + std::to_string(i));
+  CHECK(stable == names.c_str(cube)); // earlier strings never move
+  CHECK(names.c_str(StringTable::NONE) == nullptr);
+
+  SnapshotWriter out;
+  names.write(out);
+  StringTable loaded;
+  SnapshotReader in(out.bytes);
+  REQUIRE(loaded.read(in));
+  CHECK(loaded.size() == 102);
+  CHECK(std::string(loaded.c_str(tree)) == "tree");
+  CHECK(loaded.intern("tree") == tree);
+
+  struct Input {
+    float dt;
+    uint8_t keys;
+  };
+  InputRecorder<Input> rec;
+  rec.begin_recording({1, 2, 3});
+  for (int i = 0; i < 5; i++)
+    rec.push({0.016f * (float)i, (uint8_t)i});
+  rec.stop();
+  rec.push({0, 99}); // ignored once stopped
+
+  InputRecorder<Input> replay;
+  REQUIRE(replay.deserialize(rec.serialize()));
+  CHECK(replay.start == std::vector<uint8_t>{1, 2, 3});
+  replay.play();
+  int seen = 0;
+  while (const Input* in = replay.next())
+    CHECK(in->keys == seen++);
+  CHECK(seen == 5);
+  CHECK_FALSE(replay.playing());
+
+  std::vector<uint8_t> junk = {1, 2, 3, 4, 5, 6, 7, 8};
+  CHECK_FALSE(replay.deserialize(junk));
+  CHECK(replay.frames.size() == 5); // unchanged
+
+  const char* path = "/tmp/snapshot_test.bin";
+  REQUIRE(snapshot_write_file(path, rec.serialize()));
+  std::vector<uint8_t> bytes;
+  REQUIRE(snapshot_read_file(path, bytes));
+  CHECK(bytes == rec.serialize());
+}
+
+#endif
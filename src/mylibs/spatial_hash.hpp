@@ -0,0 +1,287 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="spatial hash*"
+exit
+#endif
+/**
+ * @file spatial_hash.hpp
+ * @brief Uniform-grid broad phase for AABB overlap queries
+ *
+ * Boxes are bucketed into every cell they touch, the cell list is sorted,
+ * and only boxes sharing a cell are tested against each other. Boxes too big
+ * to bucket go on a "large" list and are tested against every box instead.
+ * All buffers are kept between frames, so a steady-state rebuild doesn't allocate.
+ *
+ * Usage:
+ *   hash.clear();
+ *   for (...) hash.insert(world_box);       // returns the item id (insertion order)
+ *   for (auto [a, b] : hash.overlapping_pairs()) { ... } // a < b, each pair once
+ *   hash.overlapping_pairs(jobs);            // same result, cells split across threads
+ */
+
+#pragma once
+#include "job_system.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <raylib.h>
+#include <utility>
+#include <vector>
+
+struct SpatialHash {
+  /// Boxes spanning more cells than this on any axis skip the grid and go on the large list,
+  /// which is brute-forced against every box. Pick a cell_size close to the typical box size.
+  static constexpr int MAX_CELLS_PER_AXIS = 16;
+
+  struct Entry {
+    uint64_t cell;
+    uint32_t item;
+    bool operator<(const Entry& o) const { return cell != o.cell ? cell < o.cell : item < o.item; }
+  };
+  using ItemPair = std::pair<uint32_t, uint32_t>;
+
+  float cell_size = 2.0f;
+  std::vector<BoundingBox> boxes;
+  std::vector<Entry> entries;
+  std::vector<uint32_t> large; ///< Items not in the grid, ascending
+  std::vector<ItemPair> pairs;
+  size_t candidate_count = 0; ///< Narrow phase tests done by the last overlapping_pairs()
+
+  /// @brief Drop all boxes, keeping buffer capacity.
+  void clear() {
+    boxes.clear();
+    entries.clear();
+    large.clear();
+    pairs.clear();
+  }
+
+  /**
+   * @brief Add a box to the grid.
+   * @return Item id, equal to the number of boxes inserted before it.
+   */
+  uint32_t insert(BoundingBox box) {
+    uint32_t item = (uint32_t)boxes.size();
+    boxes.push_back(box);
+
+    int x0 = cell_of(box.min.x), x1 = cell_of(box.max.x);
+    int y0 = cell_of(box.min.y), y1 = cell_of(box.max.y);
+    int z0 = cell_of(box.min.z), z1 = cell_of(box.max.z);
+    if (x1 - x0 >= MAX_CELLS_PER_AXIS || y1 - y0 >= MAX_CELLS_PER_AXIS ||
+        z1 - z0 >= MAX_CELLS_PER_AXIS) {
+      large.push_back(item);
+      return item;
+    }
+    for (int x = x0; x <= x1; x++)
+      for (int y = y0; y <= y1; y++)
+        for (int z = z0; z <= z1; z++)
+          entries.push_back({cell_key(x, y, z), item});
+    return item;
+  }
+
+  /**
+   * @brief Find all overlapping box pairs.
+   * @return Pairs of item ids with first < second, sorted, without duplicates.
+   */
+  const std::vector<ItemPair>& overlapping_pairs() {
+    pairs.clear();
+    std::sort(entries.begin(), entries.end());
+    candidate_count = test_cells(0, entries.size(), pairs) + test_large(pairs);
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  }
+
+  /**
+   * @brief overlapping_pairs() with the narrow phase spread over the job system.
+   * Each thread fills its own pair buffer from whole cells; the buffers are
+   * merged and sorted at the end, so the result matches the serial version.
+   */
+  const std::vector<ItemPair>& overlapping_pairs(JobSystem& jobs) {
+    pairs.clear();
+    std::sort(entries.begin(), entries.end());
+
+    cell_starts.clear();
+    for (size_t i = 0; i < entries.size(); i++)
+      if (i == 0 || entries[i].cell != entries[i - 1].cell)
+        cell_starts.push_back(i);
+    cell_starts.push_back(entries.size());
+
+    thread_pairs.resize((size_t)jobs.thread_count());
+    thread_candidates.assign((size_t)jobs.thread_count(), 0);
+    for (auto& tp : thread_pairs)
+      tp.clear();
+    int cells = (int)cell_starts.size() - 1;
+    jobs.parallel_for(0, cells, 64, [&](int lo, int hi, int thread) {
+      thread_candidates[thread] +=
+          test_cells(cell_starts[lo], cell_starts[hi], thread_pairs[thread]);
+    });
+
+    candidate_count = test_large(pairs);
+    for (size_t t = 0; t < thread_pairs.size(); t++) {
+      pairs.insert(pairs.end(), thread_pairs[t].begin(), thread_pairs[t].end());
+      candidate_count += thread_candidates[t];
+    }
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+  }
+
+private:
+  std::vector<size_t> cell_starts;
+  std::vector<std::vector<ItemPair>> thread_pairs;
+  std::vector<size_t> thread_candidates;
+
+  int cell_of(float v) const { return (int)floorf(v / cell_size); }
+
+  /// Narrow phase over the sorted entries [from, to), which must start on a cell boundary.
+  /// @return Candidate tests done
+  size_t test_cells(size_t from, size_t to, std::vector<ItemPair>& out) const {
+    size_t candidates = 0;
+    for (size_t begin = from; begin < to;) {
+      size_t end = begin + 1;
+      while (end < to && entries[end].cell == entries[begin].cell)
+        end++;
+      for (size_t i = begin; i < end; i++) {
+        for (size_t j = i + 1; j < end; j++) {
+          uint32_t a = entries[i].item;
+          uint32_t b = entries[j].item;
+          // Boxes sharing several cells are only tested in the first one they share
+          if (!first_shared_cell(a, b, entries[begin].cell))
+            continue;
+          candidates++;
+          if (CheckCollisionBoxes(boxes[a], boxes[b]))
+            out.push_back({a, b});
+        }
+      }
+      begin = end;
+    }
+    return candidates;
+  }
+
+  /// Every large item against every other box; a pair of large items is tested once.
+  /// @return Candidate tests done
+  size_t test_large(std::vector<ItemPair>& out) const {
+    size_t candidates = 0;
+    for (size_t l = 0; l < large.size(); l++) {
+      uint32_t a = large[l];
+      for (uint32_t b = 0; b < (uint32_t)boxes.size(); b++) {
+        if (b == a)
+          continue;
+        // Large items before this one already tested against it
+        if (std::binary_search(large.begin(), large.begin() + (ptrdiff_t)l, b))
+          continue;
+        candidates++;
+        if (CheckCollisionBoxes(boxes[a], boxes[b]))
+          out.push_back({std::min(a, b), std::max(a, b)});
+      }
+    }
+    return candidates;
+  }
+
+  static uint64_t cell_key(int x, int y, int z) {
+    constexpr uint64_t MASK = (1u << 21) - 1;
+    return (((uint64_t)x & MASK) << 42) | (((uint64_t)y & MASK) << 21) | ((uint64_t)z & MASK);
+  }
+
+  /// True if `cell` is the lowest cell covered by both a and b.
+  bool first_shared_cell(uint32_t a, uint32_t b, uint64_t cell) const {
+    const BoundingBox& ba = boxes[a];
+    const BoundingBox& bb = boxes[b];
+    int x = std::max(cell_of(ba.min.x), cell_of(bb.min.x));
+    int y = std::max(cell_of(ba.min.y), cell_of(bb.min.y));
+    int z = std::max(cell_of(ba.min.z), cell_of(bb.min.z));
+    return cell_key(x, y, z) == cell;
+  }
+};
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+static BoundingBox spatial_hash_box(float x, float y, float z, float half = 0.5f) {
+  return {{x - half, y - half, z - half}, {x + half, y + half, z + half}};
+}
+
+TEST_CASE("spatial hash pairs") {
+  SpatialHash hash;
+  hash.cell_size = 1.0f;
+
+  hash.insert(spatial_hash_box(0, 0, 0));      // 0
+  hash.insert(spatial_hash_box(0.8f, 0, 0));   // 1 overlaps 0 across several cells
+  hash.insert(spatial_hash_box(10, 0, 0));     // 2 alone
+  hash.insert(spatial_hash_box(-0.9f, 0, 0));  // 3 overlaps 0 only
+  hash.insert(spatial_hash_box(1.5f, 0, 0, 0.1f)); // 4 touches no one
+
+  auto& pairs = hash.overlapping_pairs();
+  REQUIRE(pairs.size() == 2);
+  CHECK(pairs[0] == SpatialHash::ItemPair{0, 1});
+  CHECK(pairs[1] == SpatialHash::ItemPair{0, 3});
+}
+
+TEST_CASE("spatial hash matches brute force") {
+  SpatialHash hash;
+  hash.cell_size = 2.0f;
+  std::vector<BoundingBox> boxes;
+  uint32_t seed = 12345;
+  auto rnd = [&](float lo, float hi) {
+    seed = seed * 1664525u + 1013904223u;
+    return lo + (hi - lo) * (float)(seed >> 8) / (float)(1u << 24);
+  };
+  for (int i = 0; i < 300; i++) {
+    BoundingBox b = spatial_hash_box(rnd(-20, 20), 0, rnd(-20, 20), rnd(0.2f, 1.5f));
+    boxes.push_back(b);
+    hash.insert(b);
+  }
+
+  std::vector<SpatialHash::ItemPair> expected;
+  for (uint32_t i = 0; i < boxes.size(); i++)
+    for (uint32_t j = i + 1; j < boxes.size(); j++)
+      if (CheckCollisionBoxes(boxes[i], boxes[j]))
+        expected.push_back({i, j});
+
+  auto& pairs = hash.overlapping_pairs();
+  CHECK(pairs == expected);
+  CHECK(hash.candidate_count < boxes.size() * (boxes.size() - 1) / 2);
+
+  JobSystem jobs;
+  jobs.start(3);
+  size_t serial_candidates = hash.candidate_count;
+  CHECK(hash.overlapping_pairs(jobs) == expected);
+  CHECK(hash.candidate_count == serial_candidates);
+  jobs.stop();
+  CHECK(hash.large.empty());
+
+  // Rebuild reuses buffers
+  size_t cap = hash.entries.capacity();
+  hash.clear();
+  CHECK(hash.boxes.empty());
+  CHECK(hash.entries.capacity() == cap);
+}
+
+TEST_CASE("spatial hash large boxes") {
+  SpatialHash hash;
+  hash.cell_size = 1.0f;
+  std::vector<BoundingBox> boxes = {
+      spatial_hash_box(0, 0, 0),         // 0 small, inside the floor
+      {{-50, -1, -50}, {50, 1, 50}},     // 1 floor, far wider than MAX_CELLS_PER_AXIS cells
+      spatial_hash_box(40, 0, 40),       // 2 small, past where a clamped floor would stop
+      {{30, -5, 30}, {60, 5, 60}},       // 3 second large box overlapping the floor and 2
+      spatial_hash_box(100, 0, 100),     // 4 alone
+      spatial_hash_box(0.8f, 0, 0),      // 5 overlaps 0 in the grid
+  };
+  for (auto& b : boxes)
+    hash.insert(b);
+  CHECK(hash.large == std::vector<uint32_t>{1, 3});
+
+  std::vector<SpatialHash::ItemPair> expected = {{0, 1}, {0, 5}, {1, 2}, {1, 3},
+                                                 {1, 5}, {2, 3}};
+  CHECK(hash.overlapping_pairs() == expected);
+  size_t serial_candidates = hash.candidate_count;
+
+  JobSystem jobs;
+  jobs.start(2);
+  CHECK(hash.overlapping_pairs(jobs) == expected);
+  CHECK(hash.candidate_count == serial_candidates);
+  jobs.stop();
+}
+
+#endif
@@ -7,9 +7,24 @@
 #include "rlImGui.h"
 
 // Include headers with embedded tests
+#include "archetype_store.hpp"
+#include "async_loader.hpp"
+#include "file_watcher.hpp"
+#include "frame_arena.hpp"
+#include "aabb_tree.hpp"
 #include "ilist.hpp"
+#include "job_system.hpp"
 #include "hexgrid_math.hpp"
+#include "hexgrid_mesh.hpp"
+#include "hex_nav.hpp"
 #include "asset_helpers.hpp"
+#include "asset_pack.hpp"
+#include "bench.hpp"
 #include "zoo.hpp"
 #include "game_console_api.hpp"
 #include "model_api.hpp"
+#include "profiler.hpp"
+#include "residency.hpp"
+#include "snapshot.hpp"
+#include "spatial_hash.hpp"
+#include "texture_cook.hpp"
@@ -0,0 +1,653 @@
+#if 0
+cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./build/mylibs_tests -tc="texture cook*"
+exit
+#endif
+/**
+ * @file texture_cook.hpp
+ * @brief Offline texture cooking (mip chains, BC1/BC3) and cooked-first runtime loading
+ *
+ * cook() turns an image into a GPU-ready one: a box-filtered mip chain,
+ * optionally block-compressed to DXT1 (BC1, opaque) or DXT5 (BC3, alpha).
+ * Compressed output is resized to a square power of two first, so every
+ * mip level is whole 4x4 blocks and matches raylib's size math. The size
+ * before cooking is kept in the pack entry, and upload() reports it as the
+ * texture's width/height, so 2D draws keep the source's size and aspect.
+ * decode() turns cooked pixels back into RGBA8 at that size (e.g. for atlases).
+ *
+ * Cooked textures are stored next to their source as a one-file AssetPack
+ * (`<source>.rtex`): id 0 for an image, the material index for a model.
+ * Runtime loaders call load_cooked() / apply_cooked(), which use the cooked
+ * file when it is newer than the source, and fall back to the source (with
+ * GPU-generated mipmaps) when it is missing or the GPU rejects the format.
+ *
+ * Cooking is done by the texture_cook tool; see src/tools/texture_cook.
+ */
+
+#pragma once
+#include "asset_pack.hpp"
+#include <raylib.h>
+#include <rlgl.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace TextureCook {
+
+enum class Format { Auto, Rgba, Bc1, Bc3 };
+
+inline const char* COOKED_EXT = ".rtex";
+
+/// @brief Sidecar path for a source file.
+inline std::string cooked_path(const std::string& source) { return source + COOKED_EXT; }
+
+/// @brief Nearest power of two (ties round up).
+inline int nearest_pot(int v) {
+  int hi = 1;
+  while (hi < v)
+    hi <<= 1;
+  int lo = hi > 1 ? hi >> 1 : 1;
+  return (v - lo < hi - v) ? lo : hi;
+}
+
+inline uint16_t pack_565(const uint8_t* c) {
+  return (uint16_t)(((c[0] >> 3) << 11) | ((c[1] >> 2) << 5) | (c[2] >> 3));
+}
+
+inline void unpack_565(uint16_t v, int* out) {
+  out[0] = ((v >> 11) & 31) * 255 / 31;
+  out[1] = ((v >> 5) & 63) * 255 / 63;
+  out[2] = (v & 31) * 255 / 31;
+}
+
+/**
+ * @brief Encode a 4x4 RGBA8 block (64 bytes, row-major) as a BC1 colour block.
+ * Endpoints are the inset RGB bounding box, on the diagonal that follows the
+ * colours' correlation with the widest channel; always 4-colour mode (no punch-through).
+ */
+inline void encode_bc1(const uint8_t* block, uint8_t* out) {
+  uint8_t lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+  int mean[3] = {0, 0, 0};
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 3; c++) {
+      lo[c] = std::min(lo[c], block[i * 4 + c]);
+      hi[c] = std::max(hi[c], block[i * 4 + c]);
+      mean[c] += block[i * 4 + c];
+    }
+  for (int c = 0; c < 3; c++) {
+    int inset = (hi[c] - lo[c]) / 16;
+    lo[c] = (uint8_t)(lo[c] + inset);
+    hi[c] = (uint8_t)(hi[c] - inset);
+  }
+  // Flip channels that fall as the widest one rises, so the endpoints span the right diagonal
+  int ref = 0;
+  for (int c = 1; c < 3; c++)
+    if (hi[c] - lo[c] > hi[ref] - lo[ref])
+      ref = c;
+  for (int c = 0; c < 3; c++) {
+    if (c == ref)
+      continue;
+    int cov = 0;
+    for (int i = 0; i < 16; i++)
+      cov += (block[i * 4 + ref] * 16 - mean[ref]) * (block[i * 4 + c] * 16 - mean[c]) / 256;
+    if (cov < 0)
+      std::swap(lo[c], hi[c]);
+  }
+  uint16_t c0 = pack_565(hi);
+  uint16_t c1 = pack_565(lo);
+  if (c0 < c1)
+    std::swap(c0, c1);
+
+  uint32_t indices = 0;
+  if (c0 != c1) {
+    int p[4][3];
+    unpack_565(c0, p[0]);
+    unpack_565(c1, p[1]);
+    for (int c = 0; c < 3; c++) {
+      p[2][c] = (2 * p[0][c] + p[1][c]) / 3;
+      p[3][c] = (p[0][c] + 2 * p[1][c]) / 3;
+    }
+    for (int i = 0; i < 16; i++) {
+      int best = 0, best_d = INT32_MAX;
+      for (int k = 0; k < 4; k++) {
+        int d = 0;
+        for (int c = 0; c < 3; c++) {
+          int e = block[i * 4 + c] - p[k][c];
+          d += e * e;
+        }
+        if (d < best_d) {
+          best_d = d;
+          best = k;
+        }
+      }
+      indices |= (uint32_t)best << (i * 2);
+    }
+  }
+  out[0] = (uint8_t)(c0 & 0xFF);
+  out[1] = (uint8_t)(c0 >> 8);
+  out[2] = (uint8_t)(c1 & 0xFF);
+  out[3] = (uint8_t)(c1 >> 8);
+  for (int b = 0; b < 4; b++)
+    out[4 + b] = (uint8_t)(indices >> (b * 8));
+}
+
+/// @brief Encode the alpha of a 4x4 RGBA8 block as a BC3 alpha block (8-value mode).
+inline void encode_bc3_alpha(const uint8_t* block, uint8_t* out) {
+  uint8_t a0 = 0, a1 = 255;
+  for (int i = 0; i < 16; i++) {
+    a0 = std::max(a0, block[i * 4 + 3]);
+    a1 = std::min(a1, block[i * 4 + 3]);
+  }
+  uint64_t indices = 0;
+  if (a0 != a1) {
+    int p[8] = {a0, a1};
+    for (int k = 2; k < 8; k++)
+      p[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+    for (int i = 0; i < 16; i++) {
+      int best = 0, best_d = INT32_MAX;
+      for (int k = 0; k < 8; k++) {
+        int d = std::abs(block[i * 4 + 3] - p[k]);
+        if (d < best_d) {
+          best_d = d;
+          best = k;
+        }
+      }
+      indices |= (uint64_t)best << (i * 3);
+    }
+  }
+  out[0] = a0;
+  out[1] = a1;
+  for (int b = 0; b < 6; b++)
+    out[2 + b] = (uint8_t)(indices >> (b * 8));
+}
+
+/// @brief Block-compress one RGBA8 level. Edge blocks clamp to the last row/column.
+inline std::vector<uint8_t> encode_level(const uint8_t* rgba, int w, int h, bool alpha) {
+  int bw = std::max(1, (w + 3) / 4);
+  int bh = std::max(1, (h + 3) / 4);
+  size_t block_bytes = alpha ? 16 : 8;
+  std::vector<uint8_t> out((size_t)bw * bh * block_bytes);
+  uint8_t block[64];
+  uint8_t* dst = out.data();
+  for (int by = 0; by < bh; by++) {
+    for (int bx = 0; bx < bw; bx++) {
+      for (int y = 0; y < 4; y++)
+        for (int x = 0; x < 4; x++) {
+          int sx = std::min(bx * 4 + x, w - 1);
+          int sy = std::min(by * 4 + y, h - 1);
+          memcpy(block + (y * 4 + x) * 4, rgba + ((size_t)sy * w + sx) * 4, 4);
+        }
+      if (alpha) {
+        encode_bc3_alpha(block, dst);
+        encode_bc1(block, dst + 8);
+      } else {
+        encode_bc1(block, dst);
+      }
+      dst += block_bytes;
+    }
+  }
+  return out;
+}
+
+/// @brief Decode a BC1 colour block into 16 RGBA8 texels (alpha untouched).
+inline void decode_bc1(const uint8_t* block, uint8_t* rgba) {
+  uint16_t c0 = (uint16_t)(block[0] | block[1] << 8);
+  uint16_t c1 = (uint16_t)(block[2] | block[3] << 8);
+  uint32_t indices =
+      (uint32_t)(block[4] | block[5] << 8 | block[6] << 16 | (uint32_t)block[7] << 24);
+  int p[4][3];
+  unpack_565(c0, p[0]);
+  unpack_565(c1, p[1]);
+  for (int c = 0; c < 3; c++) {
+    p[2][c] = c0 > c1 ? (2 * p[0][c] + p[1][c]) / 3 : (p[0][c] + p[1][c]) / 2;
+    p[3][c] = c0 > c1 ? (p[0][c] + 2 * p[1][c]) / 3 : 0;
+  }
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 3; c++)
+      rgba[i * 4 + c] = (uint8_t)p[(indices >> (i * 2)) & 3][c];
+}
+
+/// @brief Decode a BC3 alpha block into the alpha of 16 RGBA8 texels.
+inline void decode_bc3_alpha(const uint8_t* block, uint8_t* rgba) {
+  int a0 = block[0], a1 = block[1];
+  int p[8] = {a0, a1};
+  for (int k = 2; k < 8; k++)
+    p[k] = a0 > a1 ? ((8 - k) * a0 + (k - 1) * a1) / 7
+                   : (k < 6 ? ((6 - k) * a0 + (k - 1) * a1) / 5 : (k == 6 ? 0 : 255));
+  uint64_t indices = 0;
+  for (int b = 0; b < 6; b++)
+    indices |= (uint64_t)block[2 + b] << (b * 8);
+  for (int i = 0; i < 16; i++)
+    rgba[i * 4 + 3] = (uint8_t)p[(indices >> (i * 3)) & 7];
+}
+
+/// @brief Decode one BC1/BC3 level to RGBA8 (w*h*4 bytes). Blocks past the edge are cropped.
+inline std::vector<uint8_t> decode_level(const uint8_t* blocks, int w, int h, bool alpha) {
+  int bw = std::max(1, (w + 3) / 4);
+  int bh = std::max(1, (h + 3) / 4);
+  std::vector<uint8_t> out((size_t)w * h * 4, 255);
+  uint8_t texels[64];
+  for (int by = 0; by < bh; by++) {
+    for (int bx = 0; bx < bw; bx++) {
+      const uint8_t* block = blocks + ((size_t)by * bw + bx) * (alpha ? 16 : 8);
+      memset(texels, 255, sizeof(texels));
+      if (alpha) {
+        decode_bc3_alpha(block, texels);
+        decode_bc1(block + 8, texels);
+      } else {
+        decode_bc1(block, texels);
+      }
+      for (int y = 0; y < 4 && by * 4 + y < h; y++)
+        for (int x = 0; x < 4 && bx * 4 + x < w; x++)
+          memcpy(&out[((size_t)(by * 4 + y) * w + bx * 4 + x) * 4], texels + (y * 4 + x) * 4, 4);
+    }
+  }
+  return out;
+}
+
+/// @brief Half-size RGBA8 level with a 2x2 box filter (odd edges clamp).
+inline std::vector<uint8_t> downsample(const uint8_t* rgba, int w, int h) {
+  int nw = std::max(1, w / 2);
+  int nh = std::max(1, h / 2);
+  std::vector<uint8_t> out((size_t)nw * nh * 4);
+  for (int y = 0; y < nh; y++) {
+    for (int x = 0; x < nw; x++) {
+      int x0 = std::min(x * 2, w - 1), x1 = std::min(x * 2 + 1, w - 1);
+      int y0 = std::min(y * 2, h - 1), y1 = std::min(y * 2 + 1, h - 1);
+      for (int c = 0; c < 4; c++) {
+        int sum = rgba[((size_t)y0 * w + x0) * 4 + c] + rgba[((size_t)y0 * w + x1) * 4 + c] +
+                  rgba[((size_t)y1 * w + x0) * 4 + c] + rgba[((size_t)y1 * w + x1) * 4 + c];
+        out[((size_t)y * nw + x) * 4 + c] = (uint8_t)((sum + 2) / 4);
+      }
+    }
+  }
+  return out;
+}
+
+/**
+ * @brief Cook an image into a GPU-ready one.
+ * @param src Any image raylib can convert to RGBA8
+ * @param format Auto picks Bc3 if any pixel has alpha < 255, else Bc1
+ * @param mipmaps Build the full chain down to 1x1
+ * @return New image owning MemAlloc'd data (UnloadImage it); data is null on failure
+ */
+inline Image cook(const Image& src, Format format = Format::Auto, bool mipmaps = true) {
+  if (!src.data || src.width <= 0 || src.height <= 0)
+    return Image{0};
+  Image rgba = ImageCopy(src);
+  if (rgba.mipmaps > 1 || rgba.format != PIXELFORMAT_UNCOMPRESSED_R8G8B8A8)
+    ImageFormat(&rgba, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+  if (format == Format::Auto) {
+    const uint8_t* px = static_cast<const uint8_t*>(rgba.data);
+    bool alpha = false;
+    for (size_t i = 0; i < (size_t)rgba.width * rgba.height && !alpha; i++)
+      alpha = px[i * 4 + 3] != 255;
+    format = alpha ? Format::Bc3 : Format::Bc1;
+  }
+  bool compressed = format != Format::Rgba;
+  if (compressed) {
+    int side = nearest_pot(std::max(rgba.width, rgba.height));
+    if (rgba.width != side || rgba.height != side)
+      ImageResize(&rgba, side, side);
+  }
+
+  std::vector<uint8_t> out;
+  int levels = 0;
+  int w = rgba.width, h = rgba.height;
+  std::vector<uint8_t> level(static_cast<const uint8_t*>(rgba.data),
+                             static_cast<const uint8_t*>(rgba.data) + (size_t)w * h * 4);
+  for (;;) {
+    if (compressed) {
+      std::vector<uint8_t> enc = encode_level(level.data(), w, h, format == Format::Bc3);
+      out.insert(out.end(), enc.begin(), enc.end());
+    } else {
+      out.insert(out.end(), level.begin(), level.end());
+    }
+    levels++;
+    if (!mipmaps || (w == 1 && h == 1))
+      break;
+    level = downsample(level.data(), w, h);
+    w = std::max(1, w / 2);
+    h = std::max(1, h / 2);
+  }
+
+  Image cooked = {0};
+  cooked.data = MemAlloc((unsigned int)out.size());
+  memcpy(cooked.data, out.data(), out.size());
+  cooked.width = rgba.width;
+  cooked.height = rgba.height;
+  cooked.mipmaps = levels;
+  cooked.format = format == Format::Bc1   ? PIXELFORMAT_COMPRESSED_DXT1_RGB
+                  : format == Format::Bc3 ? PIXELFORMAT_COMPRESSED_DXT5_RGBA
+                                          : PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+  UnloadImage(rgba);
+  return cooked;
+}
+
+/// @brief GPU bytes of a texture: every mip level at its format's size (BC1/BC3 included).
+inline size_t gpu_bytes(int width, int height, int format, int mipmaps = 1) {
+  size_t total = 0;
+  for (int m = 0; m < std::max(mipmaps, 1); m++) {
+    total += (size_t)GetPixelDataSize(width, height, format);
+    width = std::max(1, width / 2);
+    height = std::max(1, height / 2);
+  }
+  return total;
+}
+
+/**
+ * @brief gpu_bytes() of an uploaded texture; 0 for none or raylib's default texture.
+ * upload()ed 2D textures report their pre-cook size, so this counts that size, not the
+ * stored one; model textures (apply_cooked) keep their stored size.
+ */
+inline size_t gpu_bytes(const Texture2D& tex) {
+  if (tex.id == 0 || tex.id == rlGetTextureIdDefault())
+    return 0;
+  return gpu_bytes(tex.width, tex.height, tex.format, tex.mipmaps);
+}
+
+/// @brief Trilinear filtering for textures with mip chains, bilinear otherwise.
+inline void set_filter(Texture2D& tex) {
+  SetTextureFilter(tex, tex.mipmaps > 1 ? TEXTURE_FILTER_TRILINEAR : TEXTURE_FILTER_BILINEAR);
+}
+
+/**
+ * @brief Upload a pack image entry, reporting its pre-cook size. Requires a window.
+ *
+ * The cooked texels cover the whole source image, and raylib only uses a
+ * Texture2D's width/height to turn source rects into UVs, so drawing with
+ * the source size keeps 2D quads (draw_asset, SpriteBatch) the size they
+ * were. The stored size is in the pack entry, for anything that needs it.
+ * @return false if the entry is missing, not an image, or the GPU rejected its format
+ */
+inline bool upload(const AssetPack& pack, uint32_t id, Texture2D* out) {
+  Image img;
+  if (!pack.image(id, &img))
+    return false;
+  Texture2D tex = LoadTextureFromImage(img);
+  if (tex.id == 0)
+    return false;
+  const AssetPack::Entry* e = pack.find(id);
+  if (e->source_width > 0 && e->source_height > 0) {
+    tex.width = e->source_width;
+    tex.height = e->source_height;
+  }
+  *out = tex;
+  return true;
+}
+
+/**
+ * @brief RGBA8 copy of an image's top level; BC1/BC3 are decoded on the CPU.
+ * @param width, height Resize to this (e.g. the entry's source size); 0 keeps the stored size
+ * @return New image (UnloadImage it); data is null if the format can't be converted
+ */
+inline Image decode(const Image& img, int width = 0, int height = 0) {
+  if (!img.data || img.width <= 0 || img.height <= 0)
+    return Image{0};
+  Image out = {0};
+  if (img.format == PIXELFORMAT_COMPRESSED_DXT1_RGB ||
+      img.format == PIXELFORMAT_COMPRESSED_DXT5_RGBA) {
+    bool alpha = img.format == PIXELFORMAT_COMPRESSED_DXT5_RGBA;
+    std::vector<uint8_t> px =
+        decode_level(static_cast<const uint8_t*>(img.data), img.width, img.height, alpha);
+    out.data = MemAlloc((unsigned int)px.size());
+    memcpy(out.data, px.data(), px.size());
+    out.width = img.width;
+    out.height = img.height;
+    out.mipmaps = 1;
+    out.format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8;
+  } else if (img.format < PIXELFORMAT_COMPRESSED_DXT1_RGB) {
+    Image top = img;
+    top.mipmaps = 1;
+    out = ImageCopy(top);
+    ImageFormat(&out, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  } else {
+    return Image{0}; // other compressed formats: no CPU decoder
+  }
+  if (width > 0 && height > 0 && (out.width != width || out.height != height))
+    ImageResize(&out, width, height);
+  return out;
+}
+
+/// @brief decode() a pack image entry at its pre-cook size.
+inline Image decode(const AssetPack& pack, uint32_t id) {
+  Image img;
+  if (!pack.image(id, &img))
+    return Image{0};
+  const AssetPack::Entry* e = pack.find(id);
+  return decode(img, e->source_width, e->source_height);
+}
+
+/// @brief Open a source's cooked sidecar if it exists and is at least as new as the source.
+inline bool open_cooked(const char* source, AssetPack& pack) {
+  std::string path = cooked_path(source);
+  if (!FileExists(path.c_str()))
+    return false;
+  if (FileExists(source) && GetFileModTime(path.c_str()) < GetFileModTime(source))
+    return false;
+  return pack.open(path.c_str());
+}
+
+/**
+ * @brief Upload the cooked variant of an image file. Requires a window.
+ * @return false if there is no fresh cooked file or the GPU rejected its format
+ */
+inline bool load_cooked(const char* source, Texture2D* out) {
+  AssetPack pack;
+  if (!open_cooked(source, pack) || !upload(pack, 0, out))
+    return false;
+  set_filter(*out);
+  return true;
+}
+
+/// @brief Cooked variant if present, else the source with GPU-generated mipmaps.
+inline Texture2D load_texture(const char* source) {
+  Texture2D tex = {0};
+  if (load_cooked(source, &tex))
+    return tex;
+  tex = LoadTexture(source);
+  if (tex.id != 0) {
+    GenTextureMipmaps(&tex);
+    set_filter(tex);
+  }
+  return tex;
+}
+
+/**
+ * @brief Swap a loaded model's diffuse textures for their cooked variants.
+ *
+ * Materials without a cooked entry get GPU-generated mipmaps instead.
+ * Requires a window.
+ * @return Number of materials that now use a cooked texture
+ */
+inline int apply_cooked(Model& model, const char* source) {
+  AssetPack pack;
+  bool have = open_cooked(source, pack);
+  int swapped = 0;
+  for (int i = 0; i < model.materialCount; i++) {
+    Texture2D& tex = model.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture;
+    if (tex.id == 0 || tex.id == rlGetTextureIdDefault())
+      continue;
+    Image img;
+    if (have && pack.image((uint32_t)i, &img)) {
+      Texture2D cooked = LoadTextureFromImage(img);
+      if (cooked.id != 0) {
+        UnloadTexture(tex);
+        tex = cooked;
+        set_filter(tex);
+        swapped++;
+        continue;
+      }
+    }
+    if (tex.mipmaps <= 1) {
+      GenTextureMipmaps(&tex);
+      set_filter(tex);
+    }
+  }
+  return swapped;
+}
+
+} // namespace TextureCook
+
+// ============================================================================
+// DOCTEST
+// ============================================================================
+#ifdef DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+TEST_CASE("texture cook bc1 block") {
+  uint8_t block[64];
+  for (int i = 0; i < 16; i++) {
+    uint8_t v = (uint8_t)(i * 16);
+    block[i * 4 + 0] = v;
+    block[i * 4 + 1] = (uint8_t)(255 - v);
+    block[i * 4 + 2] = 40;
+    block[i * 4 + 3] = 255;
+  }
+  uint8_t out[8];
+  TextureCook::encode_bc1(block, out);
+  CHECK((out[0] | out[1] << 8) >= (out[2] | out[3] << 8)); // 4-colour mode
+
+  uint8_t decoded[64];
+  TextureCook::decode_bc1(out, decoded);
+  int max_err = 0;
+  for (int i = 0; i < 16; i++)
+    for (int c = 0; c < 3; c++)
+      max_err = std::max(max_err, std::abs(decoded[i * 4 + c] - block[i * 4 + c]));
+  CHECK(max_err < 48); // a linear ramp fits the 4-entry palette closely
+
+  // Solid colour: equal endpoints, all indices 0
+  for (int i = 0; i < 16; i++)
+    memcpy(block + i * 4, "\x80\x40\x20\xff", 4);
+  TextureCook::encode_bc1(block, out);
+  CHECK(out[4] == 0);
+  CHECK(out[7] == 0);
+}
+
+TEST_CASE("texture cook mip chains") {
+  CHECK(TextureCook::nearest_pot(840) == 1024);
+  CHECK(TextureCook::nearest_pot(600) == 512);
+  CHECK(TextureCook::nearest_pot(6) == 8);
+  CHECK(TextureCook::nearest_pot(1) == 1);
+
+  std::vector<uint8_t> pixels(6 * 5 * 4, 255);
+  Image src = {pixels.data(), 6, 5, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+
+  // Opaque -> BC1, square POT, 8/4/2/1 levels of 8 bytes per block
+  Image bc1 = TextureCook::cook(src);
+  CHECK(bc1.format == PIXELFORMAT_COMPRESSED_DXT1_RGB);
+  CHECK(bc1.width == 8);
+  CHECK(bc1.height == 8);
+  CHECK(bc1.mipmaps == 4);
+  UnloadImage(bc1);
+
+  // Any alpha -> BC3
+  pixels[3] = 0;
+  Image bc3 = TextureCook::cook(src, TextureCook::Format::Auto, false);
+  CHECK(bc3.format == PIXELFORMAT_COMPRESSED_DXT5_RGBA);
+  CHECK(bc3.mipmaps == 1);
+  UnloadImage(bc3);
+
+  // Uncompressed keeps its size: 6x5, 3x2, 1x1
+  Image rgba = TextureCook::cook(src, TextureCook::Format::Rgba);
+  CHECK(rgba.width == 6);
+  CHECK(rgba.mipmaps == 3);
+  CHECK(TextureCook::gpu_bytes(rgba.width, rgba.height, rgba.format, rgba.mipmaps) ==
+        (6 * 5 + 3 * 2 + 1) * 4);
+  UnloadImage(rgba);
+
+  // Box filter averages 2x2
+  uint8_t quad[16] = {0, 0, 0, 0, 100, 100, 100, 100, 200, 200, 200, 200, 100, 100, 100, 100};
+  auto half = TextureCook::downsample(quad, 2, 2);
+  REQUIRE(half.size() == 4);
+  CHECK(half[0] == 100);
+}
+
+TEST_CASE("texture cook sidecar pack") {
+  std::vector<uint8_t> pixels(16 * 16 * 4, 200);
+  Image src = {pixels.data(), 16, 16, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  Image cooked = TextureCook::cook(src, TextureCook::Format::Bc1);
+  std::string path = TextureCook::cooked_path("/tmp/texture_cook_test.png");
+  CHECK(path == "/tmp/texture_cook_test.png.rtex");
+
+  AssetPackWriter writer;
+  writer.add_image(0, cooked);
+  REQUIRE(writer.write(path));
+  // 16, 8, 4 -> 4 + 1 + 1 blocks; 2 and 1 -> one block each
+  CHECK(writer.items[0].bytes.size() == (16 + 4 + 1 + 1 + 1) * 8);
+  CHECK(TextureCook::gpu_bytes(16, 16, cooked.format, cooked.mipmaps) ==
+        writer.items[0].bytes.size());
+
+  AssetPack pack;
+  REQUIRE(pack.open(path.c_str()));
+  Image img;
+  REQUIRE(pack.image(0, &img));
+  CHECK(img.mipmaps == 5);
+  CHECK(memcmp(img.data, cooked.data, writer.items[0].bytes.size()) == 0);
+  CHECK(pack.find(0)->source_width == 16);
+  pack.close();
+  UnloadImage(cooked);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("texture cook keeps the source size") {
+  // 24x12 with alpha -> BC3 stored as 32x32, drawn and decoded at 24x12
+  std::vector<uint8_t> pixels(24 * 12 * 4);
+  for (size_t i = 0; i < pixels.size(); i += 4) {
+    pixels[i + 0] = 180;
+    pixels[i + 1] = 90;
+    pixels[i + 2] = 30;
+    pixels[i + 3] = i < pixels.size() / 2 ? 255 : 0;
+  }
+  Image src = {pixels.data(), 24, 12, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+  Image cooked = TextureCook::cook(src);
+  CHECK(cooked.format == PIXELFORMAT_COMPRESSED_DXT5_RGBA);
+  CHECK(cooked.width == 32);
+  CHECK(cooked.height == 32);
+
+  const char* path = "/tmp/texture_cook_size.rtex";
+  AssetPackWriter writer;
+  writer.add_image(0, cooked, src.width, src.height);
+  REQUIRE(writer.write(path));
+  AssetPack pack;
+  REQUIRE(pack.open(path));
+  CHECK(pack.find(0)->width == 32);
+  CHECK(pack.find(0)->source_width == 24);
+  CHECK(pack.find(0)->source_height == 12);
+
+  InitWindow(64, 64, "texture cook");
+  Texture2D tex;
+  if (TextureCook::upload(pack, 0, &tex)) { // false where the GPU has no BC3
+    CHECK(tex.width == 24);
+    CHECK(tex.height == 12);
+    UnloadTexture(tex);
+  }
+  CloseWindow();
+
+  // CPU decode (what atlas packing needs): colour survives, alpha splits top/bottom
+  Image rgba = TextureCook::decode(pack, 0);
+  REQUIRE(rgba.data);
+  CHECK(rgba.format == PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+  CHECK(rgba.width == 24);
+  CHECK(rgba.height == 12);
+  const uint8_t* px = static_cast<const uint8_t*>(rgba.data);
+  CHECK(std::abs(px[0] - 180) < 12);
+  CHECK(std::abs(px[1] - 90) < 12);
+  CHECK(px[3] == 255);
+  CHECK(px[(size_t)(11 * 24) * 4 + 3] == 0);
+  UnloadImage(rgba);
+
+  uint8_t block[16] = {};
+  Image etc2 = {block, 4, 4, 1, PIXELFORMAT_COMPRESSED_ETC2_RGB};
+  CHECK(TextureCook::decode(etc2).data == nullptr); // no CPU decoder
+
+  pack.close();
+  UnloadImage(cooked);
+  std::remove(path);
+}
+
+#endif
@@ -7,21 +7,31 @@ exit
  * @file uid_assets.hpp
  * @brief File-path based asset system with runtime loading
  *
- * Unlike embedded_assets.hpp which embeds binary data at compile time,
- * this system stores file paths and loads assets at runtime.
+ * Assets are addressed by AssetId and loaded at runtime, either from
+ * their file path or, if AssetLoader::pack is set, straight out of a
+ * mapped AssetPack (zero copy; see asset_pack.hpp and embed_binary).
+ * Release builds with the pack linked in (ASSET_PACK_INCBIN) default every
+ * loader to embedded_asset_pack().
  */
 
 #pragma once
+#include "asset_pack.hpp"
 #include <raylib.h>
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
 /// @brief Identifiers for assets
 enum class AssetId { NONE, GRASSLANDDENSE2_PNG, GRASSPATCH59_PNG, TESTBACKGROUND_PNG };
 
+/// @brief Every loadable asset (excludes NONE)
+inline constexpr AssetId ALL_ASSET_IDS[] = {AssetId::GRASSLANDDENSE2_PNG, AssetId::GRASSPATCH59_PNG,
+                                            AssetId::TESTBACKGROUND_PNG};
+inline constexpr size_t ASSET_ID_COUNT = (size_t)AssetId::TESTBACKGROUND_PNG + 1;
+
 /// @brief Information about an asset
 struct AssetInfo {
   const char* filepath; ///< Path to the asset file
@@ -43,18 +53,24 @@ inline AssetInfo get_asset_info(AssetId id) {
   return {nullptr, "unknown"};
 }
 
-/// @brief Loaded binary data from file
+/// @brief Loaded binary data: a view into a mapped pack, or bytes read from file
 struct LoadedBinary {
-  std::vector<uint8_t> data; ///< Binary data
-  const char* name;          ///< Asset name
+  std::vector<uint8_t> data;     ///< Owned bytes (file path fallback only)
+  std::span<const uint8_t> view; ///< The asset bytes, in `data` or in the pack
+  const char* name;              ///< Asset name
 
-  const uint8_t* ptr() const { return data.data(); }
-  size_t size() const { return data.size(); }
+  const uint8_t* ptr() const { return view.data(); }
+  size_t size() const { return view.size(); }
 };
 
 /// @brief Asset loader that caches loaded binary data
 struct AssetLoader {
   std::unordered_map<int, LoadedBinary> cache;
+#ifdef ASSET_PACK_INCBIN
+  const AssetPack* pack = &embedded_asset_pack(); ///< Checked before the file path
+#else
+  const AssetPack* pack = nullptr; ///< Checked before the file path; must outlive the loader
+#endif
 
   /// @brief Load or get cached binary data for an asset
   LoadedBinary& get(AssetId id) {
@@ -68,7 +84,10 @@ struct AssetLoader {
     LoadedBinary bin;
     bin.name = info.name;
 
-    if (info.filepath != nullptr) {
+    const AssetPack::Entry* entry = pack ? pack->find((uint32_t)key) : nullptr;
+    if (entry && entry->kind == AssetPack::Kind::Raw) {
+      bin.view = pack->bytes(*entry);
+    } else if (info.filepath != nullptr) {
       int size = 0;
       unsigned char* data = LoadFileData(info.filepath, &size);
       if (data != nullptr) {
@@ -77,15 +96,24 @@ struct AssetLoader {
       }
     }
 
-    cache[key] = std::move(bin);
-    return cache[key];
+    LoadedBinary& stored = cache[key] = std::move(bin);
+    if (stored.view.empty())
+      stored.view = stored.data;
+    return stored;
+  }
+
+  /**
+   * @brief Pre-decoded pixels for an asset, if the pack has them.
+   * The Image views pack memory: don't unload or modify it.
+   */
+  bool decoded_image(AssetId id, Image* out) const {
+    return pack && pack->image((uint32_t)static_cast<int>(id), out);
   }
 
   /// @brief Preload all assets into cache
   void preload_all() {
-    get(AssetId::GRASSLANDDENSE2_PNG);
-    get(AssetId::GRASSPATCH59_PNG);
-    get(AssetId::TESTBACKGROUND_PNG);
+    for (AssetId id : ALL_ASSET_IDS)
+      get(id);
   }
 
   /// @brief Clear all cached data
@@ -124,4 +152,34 @@ TEST_CASE("uid_assets loader") {
   CloseWindow();
 }
 
+TEST_CASE("uid_assets loader reads from pack") {
+  const char* path = "/tmp/uid_assets_test.pack";
+  AssetPackWriter writer;
+  writer.add_raw((uint32_t)AssetId::GRASSPATCH59_PNG, {9, 8, 7, 6});
+  uint8_t pixel[4] = {255, 0, 0, 255};
+  writer.add_image((uint32_t)AssetId::TESTBACKGROUND_PNG,
+                   Image{pixel, 1, 1, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8});
+  REQUIRE(writer.write(path));
+
+  AssetPack pack;
+  REQUIRE(pack.open(path));
+  AssetLoader loader;
+  loader.pack = &pack;
+
+  // Zero copy: the bytes are the pack's
+  LoadedBinary& bin = loader.get(AssetId::GRASSPATCH59_PNG);
+  CHECK(bin.size() == 4);
+  CHECK(bin.data.empty());
+  CHECK(bin.ptr() == pack.bytes((uint32_t)AssetId::GRASSPATCH59_PNG).data());
+
+  Image img;
+  CHECK(loader.decoded_image(AssetId::TESTBACKGROUND_PNG, &img));
+  CHECK(((uint8_t*)img.data)[0] == 255);
+  CHECK_FALSE(loader.decoded_image(AssetId::GRASSPATCH59_PNG, &img));
+
+  loader.clear();
+  pack.close();
+  std::remove(path);
+}
+
 #endif
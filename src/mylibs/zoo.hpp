@@ -3,6 +3,10 @@ cd "$(dirname "$0")/../.." && cmake --build build --target mylibs_tests && ./bui
 exit
 #endif
 #pragma once
+#include "aabb_tree.hpp"
+#include "async_loader.hpp"
+#include "residency.hpp"
+#include "texture_cook.hpp"
 #include <algorithm>
 #include <cmath>
 #include <cstdlib>
@@ -12,19 +16,28 @@ exit
 #include <rlgl.h>
 #include <string>
 #include <sys/stat.h>
+#include <unordered_map>
 #include <vector>
 
 struct ImageEntry {
   Texture2D texture;
+  Texture2D thumb = {0}; ///< Small copy drawn past ImageZoo::lodDistance; always resident
   std::string filename;
   std::string fullpath;
   std::string folder; // parent folder name for grouping
-  bool loaded = false;
+  bool loaded = false; ///< Full-res texture is on the GPU
+  bool hasThumb = false;
+  bool broken = false;      ///< Decode failed; not streamed again
+  Color average = DARKGRAY; ///< Impostor colour past ImageZoo::impostorDistance
   int width = 0;
   int height = 0;
   Vector3 position = {0, 0, 0};
   Model model;
   bool modelLoaded = false;
+  int boundsProxy = -1; ///< Leaf in ImageZoo::bounds
+
+  /// Width / height, or 1 while the texture is still decoding
+  float aspect() const { return height > 0 ? (float)width / (float)height : 1.0f; }
 };
 
 struct ImageZoo {
@@ -33,6 +46,7 @@ struct ImageZoo {
   float spacing = 2.5f;
   float imageScale = 1.0f;
   int selectedIndex = -1;
+  int hoveredIndex = -1;
   bool showInfo = true;
   int maxImages = 1000;
   int maxDepth = 3;
@@ -43,6 +57,21 @@ struct ImageZoo {
   bool cameraEnabled = false;
   float cameraSpeed = 0.1f;
 
+  /// If set, load_directory() only scans: images decode on the loader's workers and
+  /// show as grey placeholders until async->pump() uploads them. The zoo must outlive its jobs.
+  AsyncLoader* async = nullptr;
+  std::unordered_map<std::string, size_t> index_of; ///< fullpath -> index into images
+  AabbTree<int> bounds; ///< Image boxes for picking and culling (user = index into images)
+  int pendingCount = 0;
+
+  // Level of detail by camera distance: full-res texture, thumbnail, flat impostor
+  int thumbSize = 64;             ///< Longer side of thumbnails, in pixels
+  float lodDistance = 12.0f;      ///< Closer than this: full-res (once streamed in)
+  float impostorDistance = 40.0f; ///< Farther than this: a quad in the image's average colour
+  float prefetch = 1.5f;          ///< Stream full-res in this much wider and farther than drawn
+  Residency residency;            ///< Full-res textures by image index, under residency.budget
+  int visibleCount = 0;           ///< Images that passed the frustum test last draw()
+
   void init_camera() {
     camera.position = {0.0f, 8.0f, 12.0f};
     camera.target = {0.0f, 0.0f, 0.0f};
@@ -51,6 +80,180 @@ struct ImageZoo {
     camera.projection = CAMERA_PERSPECTIVE;
   }
 
+  /// @brief (Re)create an image's plane model at its current size and texture.
+  void build_model(ImageEntry& img) {
+    if (img.modelLoaded)
+      UnloadModel(img.model);
+    Mesh mesh = GenMeshPlane(imageScale * img.aspect(), imageScale, 1, 1);
+    img.model = LoadModelFromMesh(mesh);
+    if (img.loaded)
+      img.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = img.texture;
+    img.modelLoaded = true;
+  }
+
+  /// @brief Re-key path lookup, bounds and residency after images were added or re-sorted.
+  void rebuild_index() {
+    index_of.clear();
+    residency.clear(); // stream decodes in flight are dropped when they land
+    residency.resize(images.size());
+    for (size_t i = 0; i < images.size(); i++) {
+      index_of[images[i].fullpath] = i;
+      if (images[i].loaded)
+        residency.loaded((int)i, texture_bytes(images[i].texture));
+    }
+    rebuild_bounds();
+  }
+
+  /// Pick box of a flat image lying on the ground plane
+  BoundingBox image_box(const ImageEntry& img) const {
+    Vector3 pos = img.position;
+    float hw = imageScale * img.aspect() / 2.0f;
+    float hh = imageScale / 2.0f;
+    return {{pos.x - hw, pos.y - 0.1f, pos.z - hh}, {pos.x + hw, pos.y + 0.1f, pos.z + hh}};
+  }
+
+  /// @brief Re-insert every image after a layout change, then build the tree top-down.
+  void rebuild_bounds() {
+    bounds.clear();
+    for (size_t i = 0; i < images.size(); i++)
+      images[i].boundsProxy = bounds.insert(image_box(images[i]), (int)i);
+    bounds.rebuild();
+  }
+
+  /// @brief Index of the nearest image under the ray, or -1.
+  int pick(Ray ray) const {
+    auto hit = bounds.ray_closest(ray);
+    return hit.proxy == AabbTree<int>::NONE ? -1 : bounds.nodes[hit.proxy].user;
+  }
+
+  /// @brief GPU bytes of an image's texture, in its pixel format and mip chain.
+  static size_t texture_bytes(int width, int height, int format = PIXELFORMAT_UNCOMPRESSED_R8G8B8A8,
+                              int mipmaps = 1) {
+    return TextureCook::gpu_bytes(width, height, format, mipmaps);
+  }
+  static size_t texture_bytes(const Texture2D& tex) { return TextureCook::gpu_bytes(tex); }
+
+  static Color average_color(const Image& image) {
+    Color* pixels = LoadImageColors(image);
+    uint64_t sum[4] = {0, 0, 0, 0};
+    int n = image.width * image.height;
+    for (int i = 0; i < n; i++) {
+      sum[0] += pixels[i].r;
+      sum[1] += pixels[i].g;
+      sum[2] += pixels[i].b;
+      sum[3] += pixels[i].a;
+    }
+    UnloadImageColors(pixels);
+    if (n == 0)
+      return DARKGRAY;
+    return {(unsigned char)(sum[0] / n), (unsigned char)(sum[1] / n), (unsigned char)(sum[2] / n),
+            (unsigned char)(sum[3] / n)};
+  }
+
+  /// @brief Upload a decoded image: its thumbnail if there is none yet, the full texture if asked.
+  void upload(ImageEntry& img, const Image& full, const Image& thumb, bool keepFull) {
+    img.width = full.width;
+    img.height = full.height;
+    if (thumb.data && !img.hasThumb) {
+      img.thumb = LoadTextureFromImage(thumb);
+      img.hasThumb = img.thumb.id != 0;
+      img.average = average_color(thumb);
+    }
+    if (keepFull && !img.loaded) {
+      img.texture = LoadTextureFromImage(full);
+      img.loaded = img.texture.id != 0;
+    }
+  }
+
+  /**
+   * @brief Queue the first worker decode of an image (full + thumbnail); lands at pump time.
+   * The full-res texture is kept while it fits the budget, so the first screenful
+   * doesn't decode twice; stream() brings the rest in as the camera gets close.
+   */
+  void queue_decode(const std::string& fullpath) {
+    pendingCount++;
+    async->decode_image(
+        fullpath,
+        [this](AsyncLoader::Result& r) {
+          pendingCount--;
+          auto it = index_of.find(r.path);
+          if (it != index_of.end()) {
+            int i = (int)it->second;
+            ImageEntry& img = images[i];
+            bool requested = residency.items[i].state == Residency::State::Loading;
+            if (r.ok) {
+              size_t bytes =
+                  texture_bytes(r.image.width, r.image.height, r.image.format, r.image.mipmaps);
+              upload(img, r.image, r.thumb,
+                     requested || residency.resident_bytes + bytes <= residency.budget);
+              build_model(img);
+              if (img.boundsProxy >= 0)
+                bounds.move(img.boundsProxy, image_box(img)); // aspect is known now
+            }
+            img.broken = !r.ok;
+            if (img.loaded)
+              residency.loaded(i, texture_bytes(img.texture));
+            else if (requested)
+              residency.dropped(i);
+          }
+          UnloadImage(r.image);
+          UnloadImage(r.thumb);
+        },
+        thumbSize);
+  }
+
+  /// @brief Decode an image's full-res texture again for stream().
+  void queue_stream(int i) {
+    pendingCount++;
+    async->decode_image(images[i].fullpath, [this](AsyncLoader::Result& r) {
+      pendingCount--;
+      auto it = index_of.find(r.path);
+      int i = it == index_of.end() ? -1 : (int)it->second;
+      // Not Loading: unloaded or re-sorted meanwhile, or the scan decode got there first
+      if (i >= 0 && residency.items[i].state == Residency::State::Loading) {
+        ImageEntry& img = images[i];
+        if (r.ok)
+          upload(img, r.image, r.thumb, true);
+        img.broken = !img.loaded;
+        if (img.loaded)
+          residency.loaded(i, texture_bytes(img.texture));
+        else
+          residency.dropped(i);
+      }
+      UnloadImage(r.image);
+    });
+  }
+
+  float screen_aspect() const {
+    return GetScreenHeight() > 0 ? (float)GetScreenWidth() / (float)GetScreenHeight() : 1.0f;
+  }
+
+  /**
+   * @brief Stream full-res textures in for images near the view and evict the least
+   * recently seen ones over budget. Needs `async`; without it everything stays resident.
+   */
+  void stream() {
+    if (!async)
+      return;
+    residency.begin_frame();
+    Camera3D wide = camera;
+    wide.fovy = std::min(170.0f, camera.fovy * prefetch);
+    float reach = lodDistance * prefetch;
+    bounds.query(camera_frustum(wide, screen_aspect()), [&](int& i, int) {
+      const ImageEntry& img = images[i];
+      // width stays 0 until the scan decode lands; that one may keep full-res already
+      if (img.width > 0 && !img.broken && Vector3Distance(camera.position, img.position) < reach)
+        residency.touch(i);
+    });
+    residency.request_wanted([&](int i) { queue_stream(i); });
+    residency.evict_over_budget([&](int i) {
+      if (IsWindowReady()) // no GL context, nothing was uploaded (tests)
+        UnloadTexture(images[i].texture);
+      images[i].texture = {0};
+      images[i].loaded = false;
+    });
+  }
+
   void load_directory(const char* path, int depth = 0) {
     if (depth == 0) {
       loadedCount = 0;
@@ -101,11 +304,21 @@ struct ImageZoo {
         img.folder =
             (lastSlash != std::string::npos) ? folderPath.substr(lastSlash + 1) : folderPath;
 
-        img.texture = LoadTexture(img.fullpath.c_str());
-        if (img.texture.id != 0) {
-          img.width = img.texture.width;
-          img.height = img.texture.height;
-          img.loaded = true;
+        if (async) {
+          images.push_back(img);
+          loadedCount++;
+          queue_decode(fullpath);
+          continue;
+        }
+
+        Image full = LoadImage(img.fullpath.c_str());
+        if (full.data) {
+          Image thumb = AsyncLoader::thumbnail(full, thumbSize);
+          upload(img, full, thumb, true);
+          UnloadImage(thumb);
+        }
+        UnloadImage(full);
+        if (img.loaded) {
           images.push_back(img);
           loadedCount++;
         }
@@ -138,15 +351,9 @@ struct ImageZoo {
         images[i].position = {col * spacing - offsetX, 0.0f, row * spacing};
 
         // Create a plane mesh for each image
-        float aspect = (float)images[i].width / (float)images[i].height;
-        float planeWidth = imageScale * aspect;
-        float planeHeight = imageScale;
-
-        Mesh mesh = GenMeshPlane(planeWidth, planeHeight, 1, 1);
-        images[i].model = LoadModelFromMesh(mesh);
-        images[i].model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = images[i].texture;
-        images[i].modelLoaded = true;
+        build_model(images[i]);
       }
+      rebuild_index();
 
       TraceLog(LOG_INFO, "Loaded %d images from %s (depth=%d, max=%d)", (int)images.size(), path,
                maxDepth, maxImages);
@@ -163,25 +370,14 @@ struct ImageZoo {
     });
 
     for (size_t i = 0; i < images.size(); i++) {
-      if (images[i].modelLoaded) {
-        UnloadModel(images[i].model);
-      }
-
       int col = i % columns;
       int row = i / columns;
       float offsetX = (columns - 1) * spacing / 2.0f;
 
       images[i].position = {col * spacing - offsetX, 0.0f, row * spacing};
-
-      float aspect = (float)images[i].width / (float)images[i].height;
-      float planeWidth = imageScale * aspect;
-      float planeHeight = imageScale;
-
-      Mesh mesh = GenMeshPlane(planeWidth, planeHeight, 1, 1);
-      images[i].model = LoadModelFromMesh(mesh);
-      images[i].model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = images[i].texture;
-      images[i].modelLoaded = true;
+      build_model(images[i]);
     }
+    rebuild_index();
   }
 
   void unload_all() {
@@ -192,8 +388,14 @@ struct ImageZoo {
       if (img.loaded) {
         UnloadTexture(img.texture);
       }
+      if (img.hasThumb) {
+        UnloadTexture(img.thumb);
+      }
     }
     images.clear();
+    index_of.clear(); // decodes still in flight find no entry and are dropped
+    bounds.clear();
+    residency.clear();
   }
 
   void update() {
@@ -281,34 +483,12 @@ struct ImageZoo {
       camera.target = Vector3Add(camera.position, forward);
     }
 
-    // Mouse picking
-    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && !cameraEnabled) {
-      Ray ray = GetScreenToWorldRay(GetMousePosition(), camera);
+    // Mouse hover / picking through the bounds tree
+    hoveredIndex = cameraEnabled ? -1 : pick(GetScreenToWorldRay(GetMousePosition(), camera));
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON) && hoveredIndex >= 0)
+      selectedIndex = hoveredIndex;
 
-      float closestDist = 1000000.0f;
-      int closestIdx = -1;
-
-      for (size_t i = 0; i < images.size(); i++) {
-        // Simple bounding box check for flat images
-        Vector3 pos = images[i].position;
-        float aspect = (float)images[i].width / (float)images[i].height;
-        float hw = imageScale * aspect / 2.0f;
-        float hh = imageScale / 2.0f;
-
-        BoundingBox box = {{pos.x - hw, pos.y - 0.1f, pos.z - hh},
-                           {pos.x + hw, pos.y + 0.1f, pos.z + hh}};
-
-        RayCollision collision = GetRayCollisionBox(ray, box);
-        if (collision.hit && collision.distance < closestDist) {
-          closestDist = collision.distance;
-          closestIdx = i;
-        }
-      }
-
-      if (closestIdx >= 0) {
-        selectedIndex = closestIdx;
-      }
-    }
+    stream();
   }
 
   void draw() {
@@ -317,36 +497,44 @@ struct ImageZoo {
     // Draw ground grid
     DrawGrid(50, 1.0f);
 
-    // Draw all images
-    for (size_t i = 0; i < images.size(); i++) {
-      ImageEntry& img = images[i];
+    // Draw the images inside the view frustum
+    visibleCount = 0;
+    bounds.query(camera_frustum(camera, screen_aspect()), [&](int& i, int) { draw_image(i); });
+
+    EndMode3D();
+  }
 
-      Vector3 pos = img.position;
-      pos.y = 0.01f; // slightly above ground
+  void draw_image(int i) {
+    ImageEntry& img = images[i];
+    visibleCount++;
 
-      Color tint = WHITE;
-      if ((int)i == selectedIndex) {
-        tint = {255, 255, 200, 255};
-      }
+    Vector3 pos = img.position;
+    pos.y = 0.01f; // slightly above ground
+    float distance = Vector3Distance(camera.position, pos);
 
+    if (distance > impostorDistance || (!img.loaded && !img.hasThumb)) {
+      DrawPlane(pos, {imageScale * img.aspect(), imageScale}, img.average);
+    } else {
+      Color tint = i == selectedIndex ? Color{255, 255, 200, 255} : WHITE;
+      bool full = img.loaded && (distance < lodDistance || !img.hasThumb);
+      img.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].texture = full ? img.texture : img.thumb;
       DrawModel(img.model, pos, 1.0f, tint);
+    }
 
-      // Draw selection box
-      if ((int)i == selectedIndex) {
-        float aspect = (float)img.width / (float)img.height;
-        float hw = imageScale * aspect / 2.0f + 0.05f;
-        float hh = imageScale / 2.0f + 0.05f;
+    // Draw selection / hover box
+    if (i == selectedIndex || i == hoveredIndex) {
+      float hw = imageScale * img.aspect() / 2.0f + 0.05f;
+      float hh = imageScale / 2.0f + 0.05f;
 
-        DrawCubeWires(pos, hw * 2, 0.1f, hh * 2, YELLOW);
-      }
+      DrawCubeWires(pos, hw * 2, 0.1f, hh * 2, i == selectedIndex ? YELLOW : LIGHTGRAY);
     }
-
-    EndMode3D();
   }
 
   void draw_imgui() {
     if (ImGui::Begin("Image Zoo Controls")) {
       ImGui::Text("Images: %d / %d max", (int)images.size(), maxImages);
+      if (pendingCount > 0)
+        ImGui::Text("Decoding: %d", pendingCount);
       ImGui::Text("TAB to toggle free camera (currently %s)", cameraEnabled ? "ON" : "OFF");
       ImGui::Separator();
 
@@ -367,6 +555,15 @@ struct ImageZoo {
       ImGui::Separator();
       ImGui::SliderInt("Max Images", &maxImages, 10, 5000);
       ImGui::SliderInt("Max Depth", &maxDepth, 0, 10);
+      ImGui::Separator();
+      ImGui::Text("Visible: %d | Full-res: %.1f / %zu MB", visibleCount,
+                  (double)residency.resident_bytes / (1 << 20), residency.budget >> 20);
+      ImGui::SliderFloat("Full-res Distance", &lodDistance, 1.0f, 100.0f);
+      ImGui::SliderFloat("Impostor Distance", &impostorDistance, 5.0f, 300.0f);
+      int budgetMb = (int)(residency.budget >> 20);
+      if (ImGui::SliderInt("Texture Budget (MB)", &budgetMb, 16, 4096))
+        residency.budget = (size_t)budgetMb << 20;
+
       ImGui::Separator();
       ImGui::Checkbox("Show Info Panel", &showInfo);
 
@@ -392,10 +589,12 @@ struct ImageZoo {
         ImGui::Text("Size: %d x %d", img.width, img.height);
         ImGui::Text("Pos: %.1f, %.1f, %.1f", img.position.x, img.position.y, img.position.z);
 
-        float previewSize = 256;
-        float scale = previewSize / fmaxf(img.width, img.height);
-        ImGui::Image((ImTextureID)(intptr_t)img.texture.id,
-                     ImVec2(img.width * scale, img.height * scale));
+        if (img.loaded || img.hasThumb) {
+          float previewSize = 256;
+          float scale = previewSize / fmaxf(img.width, img.height);
+          unsigned int id = img.loaded ? img.texture.id : img.thumb.id;
+          ImGui::Image((ImTextureID)(intptr_t)id, ImVec2(img.width * scale, img.height * scale));
+        }
       }
       ImGui::End();
     }
@@ -414,6 +613,68 @@ TEST_CASE("ImageEntry defaults") {
   CHECK(entry.width == 0);
   CHECK(entry.height == 0);
   CHECK(entry.filename.empty());
+  CHECK(entry.aspect() == doctest::Approx(1.0f)); // placeholder square until decoded
+  entry.width = 200;
+  entry.height = 100;
+  CHECK(entry.aspect() == doctest::Approx(2.0f));
+}
+
+TEST_CASE("ImageZoo picks through its bounds tree") {
+  ImageZoo zoo;
+  for (int i = 0; i < 40; i++) {
+    ImageEntry img;
+    img.fullpath = "img" + std::to_string(i);
+    img.position = {(float)(i % zoo.columns) * zoo.spacing, 0,
+                    (float)(i / zoo.columns) * zoo.spacing};
+    zoo.images.push_back(img);
+  }
+  zoo.rebuild_index();
+  CHECK(zoo.bounds.size() == 40);
+
+  Vector3 target = zoo.images[17].position;
+  Ray down = {{target.x + 0.2f, 10, target.z - 0.1f}, {0, -1, 0}};
+  CHECK(zoo.pick(down) == 17);
+  Ray gap = {{target.x + zoo.spacing / 2, 10, target.z}, {0, -1, 0}};
+  CHECK(zoo.pick(gap) == -1);
+}
+
+TEST_CASE("ImageZoo streams full-res textures near the camera under budget") {
+  AsyncLoader loader; // not started: jobs run inline, land in pump()
+  ImageZoo zoo;
+  zoo.async = &loader;
+  for (int i = 0; i < 40; i++) {
+    ImageEntry img;
+    img.fullpath = "/nonexistent/img" + std::to_string(i) + ".png";
+    img.position = {(float)(i % zoo.columns) * zoo.spacing, 0,
+                    (float)(i / zoo.columns) * zoo.spacing};
+    img.texture = {2, 100, 100, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8}; // 1 is the default texture
+    img.width = img.height = 100;
+    img.loaded = true;
+    zoo.images.push_back(img);
+  }
+  zoo.rebuild_index();
+  CHECK(zoo.residency.resident_bytes == 40 * ImageZoo::texture_bytes(100, 100));
+
+  zoo.camera = {{0, 3, -3}, {0, 0, 0}, {0, 1, 0}, 45.0f, CAMERA_PERSPECTIVE};
+  zoo.lodDistance = 4.0f; // images 0 and 1 are within lodDistance * prefetch
+  zoo.residency.budget = 5 * ImageZoo::texture_bytes(100, 100);
+  zoo.stream();
+  CHECK(zoo.residency.resident_bytes == zoo.residency.budget);
+  CHECK(zoo.images[0].loaded);
+  CHECK(zoo.images[1].loaded);
+  CHECK_FALSE(zoo.images[2].loaded); // unseen, evicted first
+
+  // An evicted image in view is re-decoded; a failing decode isn't retried
+  zoo.images[0].loaded = false;
+  zoo.residency.dropped(0);
+  zoo.stream();
+  CHECK(zoo.pendingCount == 1);
+  loader.finish_all();
+  CHECK(zoo.pendingCount == 0);
+  CHECK(zoo.images[0].broken);
+  CHECK(zoo.residency.in_flight == 0);
+  zoo.stream();
+  CHECK(zoo.pendingCount == 0);
 }
 
 TEST_CASE("ImageZoo defaults") {
@@ -436,7 +697,10 @@ TEST_CASE("image zoo visual test" * doctest::skip()) {
   SetTargetFPS(60);
   rlImGuiSetup(true);
 
+  AsyncLoader loader;
+  loader.start();
   ImageZoo zoo;
+  zoo.async = &loader;
   zoo.init_camera();
 
   const char* path = getenv("IMAGE_ZOO_PATH");
@@ -454,6 +718,7 @@ TEST_CASE("image zoo visual test" * doctest::skip()) {
   }
 
   while (!WindowShouldClose()) {
+    loader.pump(4.0);
     zoo.update();
 
     BeginDrawing();
@@ -475,6 +740,7 @@ TEST_CASE("image zoo visual test" * doctest::skip()) {
     EndDrawing();
   }
 
+  loader.stop();
   zoo.unload_all();
   rlImGuiShutdown();
   CloseWindow();
@@ -8,15 +8,21 @@
  * - Arrow keys: Navigate selection
  * - ENTER: Spawn selected template (in Templates mode)
  * - DELETE: Delete selected instance (in Scene mode)
+ * - Mouse click: Select the template / instance under the cursor
  * - TAB: Toggle free camera mode
  * - WASD/QE: Move camera (in free mode)
  * - Mouse: Look around (in free mode)
  * - ~ (grave): Toggle console
  */
 
+#include "../../mylibs/aabb_tree.hpp"
+#include "../../mylibs/archetype_store.hpp"
+#include "../../mylibs/async_loader.hpp"
+#include "../../mylibs/file_watcher.hpp"
 #include "../../mylibs/game_console_api.hpp"
 #include "../../mylibs/ilist.hpp"
 #include "../../mylibs/model_api.hpp"
+#include "../../mylibs/residency.hpp"
 #include "../../mylibs/traits.hpp"
 #include <algorithm>
 #include <cmath>
@@ -37,7 +43,8 @@ struct GlbEntry : thing_base {
   std::string filename;
   std::string fullpath;
   std::string folder;
-  BoundingBox bounds;
+  BoundingBox bounds; // at load time; placeholder bounds while an async load is pending
+  ModelHandle handle; // resolved once at load, used by the draw loop
 };
 
 // Bit flags for entity behaviors
@@ -67,16 +74,20 @@ struct GameTraits {
   }
 };
 
-// A spawned instance - has ModelInstance for draw_model_store
-struct GlbInstance : thing_base {
-  ModelInstance model; // contains model ref + transform
-  GameTraits traits;
+// Spawned instances live in an ArchetypeStore: ModelInstance (model ref + transform) and
+// Motion on every instance, plus one tag component per GameTraits flag, so each behaviour
+// system only walks the instances that have it.
+struct Motion {
   float speed = 3.0f;
   float angle = 0.0f; // for orbit/wander state
 };
+struct PlayerControl {};
+struct ChasePlayer {};
+struct Wander {};
+struct Orbit {};
+struct IsPlayer {};
 
 using GlbList = things_list<GlbEntry, MAX_ITEMS>;
-using InstanceList = things_list<GlbInstance, MAX_ITEMS>;
 
 enum class ViewMode { Templates, Scene };
 
@@ -103,13 +114,14 @@ struct GlbZoo {
   GlbList entries;
   std::vector<thing_ref> entry_refs;
 
-  InstanceList instances;
-  std::vector<thing_ref> instance_refs;
+  ArchetypeStore instances;
+  std::vector<thing_ref> instance_refs; // spawn order, for selection by index
   int selectedInstance = -1;
 
   ViewMode viewMode = ViewMode::Templates;
   ZooGrid grid;
   int selectedIndex = -1;
+  int hoveredIndex = -1; ///< Template or instance under the mouse, per viewMode
   bool showInfo = true;
   int maxModels = 1000;
   int maxDepth = 3;
@@ -120,6 +132,31 @@ struct GlbZoo {
   bool cameraEnabled = false;
   float cameraSpeed = 0.1f;
 
+  AsyncLoader* async = nullptr;   ///< If set, .glb files load in the background (see load_async)
+  FileWatcher* watcher = nullptr; ///< If set, loaded files are watched and hot-reloaded
+
+  // Pick trees, user = index into entry_refs / instance_refs. Rebuilt after adds and
+  // removes (the indices shift), refit every frame otherwise; see sync_bounds().
+  AabbTree<int> template_bounds;
+  AabbTree<int> instance_bounds;
+  std::vector<int> template_proxies;
+  std::vector<int> instance_proxies;
+  bool templates_dirty = true;
+  bool instances_dirty = true;
+
+  // Only models inside the view frustum are drawn; past impostorDistance they are boxes
+  // in their base colour. With `async`, models out of view are evicted from the GPU
+  // least-recently-seen first once residency.budget is exceeded, and reload when seen.
+  float impostorDistance = 60.0f;
+  Residency residency;                ///< By ModelAPI slot index
+  std::vector<Color> impostor_colors; ///< By ModelAPI slot index; kept while evicted
+  int visibleCount = 0;
+  struct Impostor {
+    BoundingBox box;
+    Color color;
+  };
+  std::vector<Impostor> impostors; ///< Scene-view boxes, refilled each draw
+
   void init_camera() {
     camera.position = {0.0f, 8.0f, 12.0f};
     camera.target = {0.0f, 0.0f, 0.0f};
@@ -148,12 +185,15 @@ struct GlbZoo {
       uniqueName = name + "_" + std::to_string(suffix++);
     }
 
-    if (!ModelAPI::load(uniqueName, filepath)) {
+    if (async) {
+      ModelAPI::load_async(uniqueName, filepath, *async);
+    } else if (!ModelAPI::load(uniqueName, filepath)) {
       return "Failed to load: " + filepath;
     }
 
     GlbEntry entry;
     entry.name = uniqueName;
+    entry.handle = ModelAPI::handle(uniqueName);
     entry.filename = filename;
     entry.fullpath = filepath;
 
@@ -166,9 +206,8 @@ struct GlbZoo {
       entry.folder = ".";
     }
 
-    Model* m = ModelAPI::get(uniqueName);
-    if (m && m->meshCount > 0) {
-      entry.bounds = GetMeshBoundingBox(m->meshes[0]);
+    if (const ModelAPI::ModelBounds* b = ModelAPI::bounds(entry.handle)) {
+      entry.bounds = b->box;
     }
 
     thing_ref ref = entries.add(entry);
@@ -227,10 +266,13 @@ struct GlbZoo {
 
     if (depth == 0) {
       rebuild_positions();
+      if (watcher)
+        ModelAPI::watch_all(*watcher);
     }
   }
 
   void rebuild_positions() {
+    templates_dirty = true;
     std::sort(entry_refs.begin(), entry_refs.end(), [this](const thing_ref& a, const thing_ref& b) {
       auto& ea = entries[a];
       auto& eb = entries[b];
@@ -245,15 +287,16 @@ struct GlbZoo {
     for (auto& ref : entry_refs)
       entries.remove(ref);
     entry_refs.clear();
-    for (auto& ref : instance_refs)
-      instances.remove(ref);
+    instances.clear();
     instance_refs.clear();
+    instances_dirty = true;
     loadedCount = 0;
     selectedIndex = -1;
     selectedInstance = -1;
   }
 
   void unload(const std::string& name) {
+    ModelHandle handle = ModelAPI::handle(name);
     ModelAPI::unload(name);
     for (auto it = entry_refs.begin(); it != entry_refs.end(); ++it) {
       if (entries[*it].name == name) {
@@ -264,13 +307,15 @@ struct GlbZoo {
     }
     // Remove instances using this model
     for (auto it = instance_refs.begin(); it != instance_refs.end();) {
-      if (instances[*it].model.name && strcmp(instances[*it].model.name, name.c_str()) == 0) {
-        instances.remove(*it);
+      ModelInstance* inst = instances.get<ModelInstance>(*it);
+      if (!inst || inst->handle == handle) {
+        instances.destroy(*it);
         it = instance_refs.erase(it);
       } else {
         ++it;
       }
     }
+    instances_dirty = true;
     loadedCount = entry_refs.size();
     if (selectedIndex >= (int)entry_refs.size())
       selectedIndex = entry_refs.empty() ? -1 : (int)entry_refs.size() - 1;
@@ -286,17 +331,13 @@ struct GlbZoo {
     }
 
     // Set transform
-    inst.model.transform = MatrixTranslate(pos.x, pos.y, pos.z);
-
-    GlbInstance gi;
-    gi.model = inst;
-    gi.traits = traits;
+    inst.transform = MatrixTranslate(pos.x, pos.y, pos.z);
 
-    thing_ref ref = instances.add(gi);
-    if (ref.kind == ilist_kind::nil) {
-      return "Instance storage full";
-    }
+    thing_ref ref = instances.create(inst, Motion{});
+    set_traits(ref, traits);
     instance_refs.push_back(ref);
+    instances_dirty = true;
+    ModelAPI::bucket_join(inst.handle, ref);
     return "Spawned " + model_name + " [" + traits.to_string() + "]";
   }
 
@@ -310,103 +351,282 @@ struct GlbZoo {
   void despawn(int idx) {
     if (idx < 0 || idx >= (int)instance_refs.size())
       return;
-    instances.remove(instance_refs[idx]);
+    leave_bucket(instance_refs[idx]);
+    instances.destroy(instance_refs[idx]);
     instance_refs.erase(instance_refs.begin() + idx);
+    instances_dirty = true;
     if (selectedInstance >= (int)instance_refs.size())
       selectedInstance = instance_refs.empty() ? -1 : (int)instance_refs.size() - 1;
   }
 
+  void leave_bucket(thing_ref ref) {
+    if (ModelInstance* inst = instances.get<ModelInstance>(ref))
+      ModelAPI::bucket_leave(inst->handle, ref);
+  }
+
   void clear_instances() {
     for (auto& ref : instance_refs)
-      instances.remove(ref);
+      leave_bucket(ref);
+    instances.clear();
     instance_refs.clear();
+    instances_dirty = true;
     selectedInstance = -1;
   }
 
+  template <typename Tag> void set_tag(thing_ref ref, bool on) {
+    if (on)
+      instances.add(ref, Tag{});
+    else
+      instances.remove<Tag>(ref);
+  }
+
+  void set_traits(thing_ref ref, GameTraits traits) {
+    set_tag<PlayerControl>(ref, traits.player_control);
+    set_tag<ChasePlayer>(ref, traits.chase_player);
+    set_tag<Wander>(ref, traits.wander);
+    set_tag<Orbit>(ref, traits.orbit);
+    set_tag<IsPlayer>(ref, traits.is_player);
+  }
+
+  GameTraits traits_of(thing_ref ref) {
+    GameTraits t = {};
+    t.player_control = instances.has<PlayerControl>(ref);
+    t.chase_player = instances.has<ChasePlayer>(ref);
+    t.wander = instances.has<Wander>(ref);
+    t.orbit = instances.has<Orbit>(ref);
+    t.is_player = instances.has<IsPlayer>(ref);
+    return t;
+  }
+
+  static Vector3 position_of(const ModelInstance& inst) {
+    const Matrix& t = inst.transform;
+    return {t.m12, t.m13, t.m14};
+  }
+
+  static void set_position(ModelInstance& inst, Vector3 pos) {
+    inst.transform = MatrixTranslate(pos.x, pos.y, pos.z);
+  }
+
   // Find player instance
-  GlbInstance* find_player() {
-    for (auto& ref : instance_refs) {
-      auto& inst = instances[ref];
-      if (inst.traits.is_player)
-        return &inst;
-    }
-    return nullptr;
+  ModelInstance* find_player() {
+    ModelInstance* player = nullptr;
+    instances.each<ModelInstance, IsPlayer>([&](ModelInstance& inst, IsPlayer&) {
+      if (!player)
+        player = &inst;
+    });
+    return player;
   }
 
-  // Update all instances based on their traits
+  // One system per behaviour; each visits only the archetypes carrying its tag
   void update_instances(float dt) {
-    for (auto& ref : instance_refs) {
-      auto& inst = instances[ref];
-      Matrix t = inst.model.model.transform;
-      Vector3 pos = {t.m12, t.m13, t.m14};
-
-      // Player control - WASD
-      if (inst.traits.player_control && !cameraEnabled) {
-        Vector3 move = {0, 0, 0};
-        if (IsKeyDown(KEY_W))
-          move.z -= 1;
-        if (IsKeyDown(KEY_S))
-          move.z += 1;
-        if (IsKeyDown(KEY_A))
-          move.x -= 1;
-        if (IsKeyDown(KEY_D))
-          move.x += 1;
-        if (Vector3Length(move) > 0) {
-          move = Vector3Normalize(move);
-          pos = Vector3Add(pos, Vector3Scale(move, inst.speed * dt));
-        }
-      }
-
-      // Chase player
-      if (inst.traits.chase_player) {
-        GlbInstance* player = find_player();
-        if (player) {
-          Matrix pt = player->model.model.transform;
-          Vector3 player_pos = {pt.m12, pt.m13, pt.m14};
-          Vector3 dir = Vector3Subtract(player_pos, pos);
-          float dist = Vector3Length(dir);
-          if (dist > 1.5f) {
-            dir = Vector3Normalize(dir);
-            pos = Vector3Add(pos, Vector3Scale(dir, inst.speed * dt));
-          }
-        }
-      }
+    // Player control - WASD
+    Vector3 move = {0, 0, 0};
+    if (!cameraEnabled) {
+      if (IsKeyDown(KEY_W))
+        move.z -= 1;
+      if (IsKeyDown(KEY_S))
+        move.z += 1;
+      if (IsKeyDown(KEY_A))
+        move.x -= 1;
+      if (IsKeyDown(KEY_D))
+        move.x += 1;
+    }
+    if (Vector3Length(move) > 0) {
+      move = Vector3Normalize(move);
+      instances.each<ModelInstance, Motion, PlayerControl>(
+          [&](ModelInstance& inst, Motion& m, PlayerControl&) {
+            set_position(inst, Vector3Add(position_of(inst), Vector3Scale(move, m.speed * dt)));
+          });
+    }
 
-      // Wander randomly
-      if (inst.traits.wander) {
-        if (GetRandomValue(0, 100) < 2) {
-          inst.angle = GetRandomValue(0, 628) / 100.0f;
-        }
-        pos.x += cosf(inst.angle) * inst.speed * dt;
-        pos.z += sinf(inst.angle) * inst.speed * dt;
-        pos.x = Clamp(pos.x, -20.0f, 20.0f);
-        pos.z = Clamp(pos.z, -20.0f, 20.0f);
-      }
+    // Chase player
+    if (ModelInstance* player = find_player()) {
+      Vector3 player_pos = position_of(*player);
+      instances.each<ModelInstance, Motion, ChasePlayer>(
+          [&](ModelInstance& inst, Motion& m, ChasePlayer&) {
+            Vector3 pos = position_of(inst);
+            Vector3 dir = Vector3Subtract(player_pos, pos);
+            float dist = Vector3Length(dir);
+            if (dist > 1.5f) {
+              dir = Vector3Normalize(dir);
+              set_position(inst, Vector3Add(pos, Vector3Scale(dir, m.speed * dt)));
+            }
+          });
+    }
 
-      // Orbit around origin
-      if (inst.traits.orbit) {
-        inst.angle += inst.speed * 0.5f * dt;
-        float radius = 5.0f;
-        pos.x = cosf(inst.angle) * radius;
-        pos.z = sinf(inst.angle) * radius;
+    // Wander randomly
+    instances.each<ModelInstance, Motion, Wander>([&](ModelInstance& inst, Motion& m, Wander&) {
+      if (GetRandomValue(0, 100) < 2) {
+        m.angle = GetRandomValue(0, 628) / 100.0f;
       }
+      Vector3 pos = position_of(inst);
+      pos.x += cosf(m.angle) * m.speed * dt;
+      pos.z += sinf(m.angle) * m.speed * dt;
+      pos.x = Clamp(pos.x, -20.0f, 20.0f);
+      pos.z = Clamp(pos.z, -20.0f, 20.0f);
+      set_position(inst, pos);
+    });
 
-      inst.model.model.transform = MatrixTranslate(pos.x, pos.y, pos.z);
-    }
+    // Orbit around origin
+    instances.each<ModelInstance, Motion, Orbit>([&](ModelInstance& inst, Motion& m, Orbit&) {
+      m.angle += m.speed * 0.5f * dt;
+      float radius = 5.0f;
+      Vector3 pos = position_of(inst);
+      pos.x = cosf(m.angle) * radius;
+      pos.z = sinf(m.angle) * radius;
+      set_position(inst, pos);
+    });
   }
 
   // Get position from instance transform matrix
   Vector3 get_instance_position(int idx) {
     if (idx < 0 || idx >= (int)instance_refs.size())
       return {0, 0, 0};
-    Matrix t = instances[instance_refs[idx]].model.model.transform;
-    return {t.m12, t.m13, t.m14};
+    ModelInstance* inst = instances.get<ModelInstance>(instance_refs[idx]);
+    return inst ? position_of(*inst) : Vector3{0, 0, 0};
   }
 
   void set_instance_position(int idx, Vector3 pos) {
     if (idx < 0 || idx >= (int)instance_refs.size())
       return;
-    instances[instance_refs[idx]].model.model.transform = MatrixTranslate(pos.x, pos.y, pos.z);
+    if (ModelInstance* inst = instances.get<ModelInstance>(instance_refs[idx]))
+      set_position(*inst, pos);
+  }
+
+  /// World box of template i as draw_templates() places it (scaled, rotated onto the ground)
+  BoundingBox template_box(int i) {
+    auto& glb = entries[entry_refs[i]];
+    const ModelAPI::ModelBounds* mb = ModelAPI::bounds(glb.handle);
+    BoundingBox b = mb ? mb->box : glb.bounds;
+    Vector3 pos = template_position(i);
+    pos.y = 0.01f;
+    float s = grid.scale;
+    // MatrixRotateX(PI / 2) maps (x, y, z) to (x, -z, y)
+    return {{pos.x + b.min.x * s, pos.y - b.max.z * s, pos.z + b.min.y * s},
+            {pos.x + b.max.x * s, pos.y - b.min.z * s, pos.z + b.max.y * s}};
+  }
+
+  static BoundingBox world_box(const ModelInstance& inst) {
+    BoundingBox b = {{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}};
+    if (const ModelAPI::ModelBounds* mb = ModelAPI::bounds(inst.handle))
+      b = mb->box;
+    Vector3 pos = position_of(inst);
+    return {Vector3Add(b.min, pos), Vector3Add(b.max, pos)};
+  }
+
+  BoundingBox instance_box(int i) {
+    ModelInstance* inst = instances.get<ModelInstance>(instance_refs[i]);
+    return inst ? world_box(*inst) : BoundingBox{};
+  }
+
+  /// Rebuild a pick tree from scratch, or refit it; a refit that moves most leaves
+  /// (a grid re-layout) is followed by a top-down rebuild.
+  template <typename BoxFn>
+  static void sync_tree(AabbTree<int>& tree, std::vector<int>& proxies, bool& dirty, int count,
+                        BoxFn&& box_of) {
+    if (dirty || (int)proxies.size() != count) {
+      tree.clear();
+      proxies.clear();
+      for (int i = 0; i < count; i++)
+        proxies.push_back(tree.insert(box_of(i), i));
+      tree.rebuild();
+      dirty = false;
+      return;
+    }
+    int moved = 0;
+    for (int i = 0; i < count; i++)
+      moved += tree.move(proxies[i], box_of(i));
+    if (moved > count / 4)
+      tree.rebuild();
+  }
+
+  void sync_bounds() {
+    sync_tree(template_bounds, template_proxies, templates_dirty, (int)entry_refs.size(),
+              [&](int i) { return template_box(i); });
+    sync_tree(instance_bounds, instance_proxies, instances_dirty, (int)instance_refs.size(),
+              [&](int i) { return instance_box(i); });
+  }
+
+  Frustum view_frustum() const {
+    return camera_frustum(camera, (float)GetScreenWidth() / (float)GetScreenHeight());
+  }
+
+  bool near_enough(const BoundingBox& box) const {
+    Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    return Vector3Distance(camera.position, center) <= impostorDistance;
+  }
+
+  /**
+   * @brief Track which models are on the GPU, touch the ones drawn at full detail this
+   * frame, reload evicted ones that came back into view and evict over budget.
+   */
+  void update_residency() {
+    size_t n = ModelAPI::slots.size();
+    residency.resize(n);
+    impostor_colors.resize(n, GRAY);
+    residency.begin_frame();
+    for (size_t i = 0; i < n; i++) {
+      const ModelAPI::Slot& s = ModelAPI::slots[i];
+      if (!s.used) {
+        if (residency.items[i].state != Residency::State::Evicted)
+          residency.dropped((int)i);
+      } else if (!s.pending) { // loaded, reloaded, or restored after evict()
+        residency.loaded((int)i, ModelAPI::gpu_bytes(s.model));
+        impostor_colors[i] = s.model.materials[0].maps[MATERIAL_MAP_DIFFUSE].color;
+      }
+    }
+    if (!async)
+      return;
+
+    // First async loads are already on their way; only evicted slots get re-requested
+    auto touch = [&](ModelHandle h) {
+      if (!ModelAPI::is_pending(h) || ModelAPI::is_evicted(h))
+        residency.touch((int)h.idx);
+    };
+    Frustum view = view_frustum();
+    if (viewMode == ViewMode::Templates) {
+      template_bounds.query(view, [&](int& i, int proxy) {
+        if (near_enough(template_bounds.box(proxy)))
+          touch(entries[entry_refs[i]].handle);
+      });
+    } else {
+      instance_bounds.query(view, [&](int& i, int proxy) {
+        ModelInstance* inst = instances.get<ModelInstance>(instance_refs[i]);
+        if (inst && near_enough(instance_bounds.box(proxy)))
+          touch(inst->handle);
+      });
+    }
+    residency.request_wanted([&](int i) {
+      if (!ModelAPI::reload_async({(uint32_t)i, ModelAPI::slots[i].gen}, *async))
+        residency.dropped(i);
+    });
+    residency.evict_over_budget(
+        [&](int i) { ModelAPI::evict({(uint32_t)i, ModelAPI::slots[i].gen}); });
+  }
+
+  static void draw_impostor(const BoundingBox& box, Color color) {
+    Vector3 center = Vector3Scale(Vector3Add(box.min, box.max), 0.5f);
+    Vector3 size = Vector3Subtract(box.max, box.min);
+    DrawCube(center, size.x, size.y, size.z, color);
+  }
+
+  /// @brief Hover the nearest template / instance under the mouse; click selects it.
+  void update_picking() {
+    hoveredIndex = -1;
+    if (cameraEnabled || ImGui::GetIO().WantCaptureMouse)
+      return;
+    Ray ray = GetScreenToWorldRay(GetMousePosition(), camera);
+    AabbTree<int>& tree = viewMode == ViewMode::Templates ? template_bounds : instance_bounds;
+    auto hit = tree.ray_closest(ray);
+    if (hit.proxy == AabbTree<int>::NONE)
+      return;
+    hoveredIndex = tree.user(hit.proxy);
+    if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
+      if (viewMode == ViewMode::Templates)
+        selectedIndex = hoveredIndex;
+      else
+        selectedInstance = hoveredIndex;
+    }
   }
 
   void update() {
@@ -437,6 +657,9 @@ struct GlbZoo {
     // Update entities based on traits
     float dt = GetFrameTime();
     update_instances(dt);
+    sync_bounds();
+    update_picking();
+    update_residency();
 
     if (viewMode == ViewMode::Templates)
       update_templates();
@@ -542,45 +765,79 @@ struct GlbZoo {
     if (viewMode == ViewMode::Templates) {
       draw_templates();
     } else {
-      // Use instanced drawing from model_store
-      draw_model_store(instances);
+      // Instanced drawing through the model buckets, reading transforms from the store.
+      // Culled instances are skipped; far and evicted ones are drawn as boxes afterwards.
+      Frustum view = view_frustum();
+      visibleCount = 0;
+      impostors.clear();
+      auto models = instances.view<ModelInstance>();
+      draw_model_buckets(models, [&](auto& inst, Matrix& out) {
+        BoundingBox box = world_box(*inst);
+        if (!frustum_overlaps(view, box))
+          return false;
+        visibleCount++;
+        if (!near_enough(box) || ModelAPI::is_evicted(inst->handle)) {
+          impostors.push_back({box, impostor_color(inst->handle)});
+          return false;
+        }
+        out = inst->transform;
+        return true;
+      });
+      for (const Impostor& imp : impostors)
+        draw_impostor(imp.box, imp.color);
 
-      // Selection indicator
+      // Selection / hover indicator
       if (selectedInstance >= 0 && selectedInstance < (int)instance_refs.size()) {
         Vector3 pos = get_instance_position(selectedInstance);
         DrawSphereWires(pos, 0.5f, 8, 8, YELLOW);
       }
+      if (hoveredIndex >= 0 && hoveredIndex != selectedInstance &&
+          hoveredIndex < (int)instance_refs.size())
+        DrawSphereWires(get_instance_position(hoveredIndex), 0.5f, 8, 8, LIGHTGRAY);
     }
 
     EndMode3D();
   }
 
+  Color impostor_color(ModelHandle h) const {
+    return h.idx < impostor_colors.size() ? impostor_colors[h.idx] : GRAY;
+  }
+
   void draw_templates() {
-    Matrix preRotate = MatrixRotateX(PI / 2.0f);
+    visibleCount = 0;
+    template_bounds.query(view_frustum(), [&](int& i, int proxy) {
+      visibleCount++;
+      draw_template(i, template_bounds.box(proxy));
+    });
+  }
 
-    for (size_t i = 0; i < entry_refs.size(); i++) {
-      auto& glb = entries[entry_refs[i]];
-      Vector3 pos = template_position(i);
-      pos.y = 0.01f;
+  void draw_template(int i, const BoundingBox& box) {
+    auto& glb = entries[entry_refs[i]];
+    Vector3 pos = template_position(i);
+    pos.y = 0.01f;
 
-      Model* model = ModelAPI::get(glb.name);
-      if (!model)
-        continue;
+    Model* model = ModelAPI::get(glb.handle);
+    if (!model)
+      return;
 
+    if (!near_enough(box) || ModelAPI::is_evicted(glb.handle)) {
+      draw_impostor(box, impostor_color(glb.handle));
+    } else {
       Matrix transform = MatrixScale(grid.scale, grid.scale, grid.scale);
-      transform = MatrixMultiply(transform, preRotate);
+      transform = MatrixMultiply(transform, MatrixRotateX(PI / 2.0f));
       transform = MatrixMultiply(transform, MatrixTranslate(pos.x, pos.y, pos.z));
 
       for (int m = 0; m < model->meshCount; m++) {
         DrawMesh(model->meshes[m], model->materials[model->meshMaterial[m]], transform);
       }
+    }
 
-      if ((int)i == selectedIndex) {
-        BoundingBox b = glb.bounds;
-        float hw = (b.max.x - b.min.x) * grid.scale / 2.0f + 0.1f;
-        float hh = (b.max.y - b.min.y) * grid.scale / 2.0f + 0.1f;
-        DrawCubeWires(pos, hw * 2, 0.1f, hh * 2, YELLOW);
-      }
+    if (i == selectedIndex || i == hoveredIndex) {
+      const ModelAPI::ModelBounds* mb = ModelAPI::bounds(glb.handle);
+      BoundingBox b = mb ? mb->box : glb.bounds;
+      float hw = (b.max.x - b.min.x) * grid.scale / 2.0f + 0.1f;
+      float hh = (b.max.y - b.min.y) * grid.scale / 2.0f + 0.1f;
+      DrawCubeWires(pos, hw * 2, 0.1f, hh * 2, i == selectedIndex ? YELLOW : LIGHTGRAY);
     }
   }
 
@@ -609,6 +866,14 @@ struct GlbZoo {
           clear_instances();
       }
 
+      ImGui::Separator();
+      ImGui::Text("Visible: %d | GPU: %.1f / %zu MB", visibleCount,
+                  (double)residency.resident_bytes / (1 << 20), residency.budget >> 20);
+      ImGui::SliderFloat("Impostor Distance", &impostorDistance, 5.0f, 300.0f);
+      int budgetMb = (int)(residency.budget >> 20);
+      if (ImGui::SliderInt("Model Budget (MB)", &budgetMb, 16, 4096))
+        residency.budget = (size_t)budgetMb << 20;
+
       ImGui::Separator();
       ImGui::Checkbox("Show Info Panel", &showInfo);
       ImGui::Separator();
@@ -633,8 +898,8 @@ struct GlbZoo {
       } else if (viewMode == ViewMode::Scene && selectedInstance >= 0 &&
                  selectedInstance < (int)instance_refs.size()) {
         if (ImGui::Begin("Selected Instance")) {
-          auto& inst = instances[instance_refs[selectedInstance]];
-          ImGui::Text("Model: %s", inst.model.name ? inst.model.name : "?");
+          ModelInstance* inst = instances.get<ModelInstance>(instance_refs[selectedInstance]);
+          ImGui::Text("Model: %s", inst && inst->name ? inst->name : "?");
           Vector3 pos = get_instance_position(selectedInstance);
           if (ImGui::DragFloat3("Position", &pos.x, 0.1f)) {
             set_instance_position(selectedInstance, pos);
@@ -738,9 +1003,8 @@ REGISTER_CMD(despawn, "despawn [index]", {
     idx = std::stoi(args[0]);
   if (idx < 0 || idx >= (int)zoo.instance_refs.size())
     return std::string("Invalid index");
-  std::string name = zoo.instances[zoo.instance_refs[idx]].model.name
-                         ? zoo.instances[zoo.instance_refs[idx]].model.name
-                         : "?";
+  ModelInstance* inst = zoo.instances.get<ModelInstance>(zoo.instance_refs[idx]);
+  std::string name = inst && inst->name ? inst->name : "?";
   zoo.despawn(idx);
   return "Despawned " + name;
 });
@@ -752,10 +1016,11 @@ REGISTER_CMD(instances, "instances - list spawned", {
     return std::string("No instances");
   std::string out;
   for (size_t i = 0; i < zoo.instance_refs.size(); i++) {
-    auto& inst = zoo.instances[zoo.instance_refs[i]];
+    thing_ref ref = zoo.instance_refs[i];
+    ModelInstance* inst = zoo.instances.get<ModelInstance>(ref);
     Vector3 pos = zoo.get_instance_position(i);
-    out += std::to_string(i) + ": " + (inst.model.name ? inst.model.name : "?");
-    out += " [" + inst.traits.to_string() + "]";
+    out += std::to_string(i) + ": " + (inst && inst->name ? inst->name : "?");
+    out += " [" + zoo.traits_of(ref).to_string() + "]";
     out += " @ (" + std::to_string((int)pos.x) + "," + std::to_string((int)pos.z) + ")";
     if ((int)i == zoo.selectedInstance)
       out += " *";
@@ -801,7 +1066,12 @@ int main(int argc, char* argv[]) {
   SetTargetFPS(60);
   rlImGuiSetup(true);
 
+  AsyncLoader loader;
+  loader.start();
   GlbZoo zoo;
+  FileWatcher watcher; // re-export from Blender and the zoo reloads it in place
+  zoo.async = &loader;
+  zoo.watcher = &watcher;
   zoo.init_camera();
 
   // Load primitive models for testing
@@ -835,6 +1105,8 @@ int main(int argc, char* argv[]) {
   }
 
   while (!WindowShouldClose()) {
+    ModelAPI::reload_changed(watcher.poll(), loader);
+    loader.pump(4.0); // glTF parse + upload for finished reads
     if (IsKeyPressed(KEY_GRAVE))
       GameConsoleAPI::toggle_visible();
     if (!GameConsoleAPI::visible())
@@ -855,14 +1127,16 @@ int main(int argc, char* argv[]) {
     int sel = (zoo.viewMode == ViewMode::Templates) ? zoo.selectedIndex : zoo.selectedInstance;
     int count = (zoo.viewMode == ViewMode::Templates) ? (int)zoo.entry_refs.size()
                                                       : (int)zoo.instance_refs.size();
-    DrawText(TextFormat("[%s] %d | Sel: %d | F1: mode | ~: console", modeStr, count, sel), 10,
-             screenHeight - 20, 14, LIGHTGRAY);
+    DrawText(TextFormat("[%s] %d | Sel: %d | Loading: %d | F1: mode | ~: console", modeStr, count,
+                        sel, (int)loader.pending()),
+             10, screenHeight - 20, 14, LIGHTGRAY);
 
     DrawFPS(screenWidth - 100, 10);
     EndDrawing();
   }
 
   GameConsoleAPI::unbind<GlbZoo>();
+  loader.stop();
   zoo.unload_all();
   rlImGuiShutdown();
   CloseWindow();
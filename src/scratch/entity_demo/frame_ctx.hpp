@@ -0,0 +1,62 @@
+/**
+ * @file frame_ctx.hpp
+ * @brief entity_demo's per-frame containers, double-buffered on frame arenas
+ *
+ * Split out of main.cpp so mylibs_bench checks the real types for
+ * steady-state allocations (bench_frame_ctx), not a copy that can drift.
+ */
+
+#pragma once
+#include "../../mylibs/frame_arena.hpp"
+#include "../../mylibs/ilist.hpp"
+#include <memory>
+#include <raylib.h>
+#include <utility>
+
+using Pair = std::pair<thing_ref, thing_ref>;
+
+namespace GameCtxAPI {
+
+// Per-frame data lives in the frame's arena, so once warmed up these containers don't touch the heap
+struct FrameCtx {
+  FrameCtx() = default;
+  explicit FrameCtx(FrameArena& arena)
+      : under_mouse(arena), collision_pairs(arena), hovered(arena), dragging(arena) {}
+
+  Vector2 mouse = {};
+  Ray mouse_ray = {};
+  struct RayHit {
+    thing_ref ref;
+    float distance;
+  };
+  ArenaVector<RayHit> under_mouse;   // nearest first
+  ArenaVector<Pair> collision_pairs; // both orders of each overlap, sorted
+  ArenaVector<thing_ref> hovered;
+  ArenaFlatSet<thing_ref> dragging;
+};
+
+struct FrameBuffer {
+  FrameArena arenas[2]; // arenas[i] backs frames[i]
+  FrameCtx frames[2];
+  int cur = 0;
+
+  /**
+   * @brief Rotate frames: current becomes previous, and the frame before
+   * that is rebuilt empty on its own (reset) arena.
+   */
+  void advance() {
+    cur ^= 1;
+    std::destroy_at(&frames[cur]);
+    arenas[cur].reset();
+    std::construct_at(&frames[cur], arenas[cur]);
+  }
+
+  /** @brief Get the current frame context. */
+  FrameCtx& current() { return frames[cur]; }
+  /** @brief Get the previous frame context (read-only). */
+  const FrameCtx& previous() const { return frames[cur ^ 1]; }
+  /** @brief Scratch memory for the current frame, freed two advance()s from now. */
+  FrameArena& arena() { return arenas[cur]; }
+};
+
+} // namespace GameCtxAPI
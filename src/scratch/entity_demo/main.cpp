@@ -13,10 +13,16 @@ exit
 // ============================================================================
 // INCLUDES
 // ============================================================================
+#include "../../mylibs/aabb_tree.hpp"
+#include "../../mylibs/frame_arena.hpp"
 #include "../../mylibs/game_console_api.hpp"
 #include "../../mylibs/ilist.hpp"
 #include "../../mylibs/model_api.hpp"
+#include "../../mylibs/profiler.hpp"
 #include "../../mylibs/render_api.hpp"
+#include "../../mylibs/snapshot.hpp"
+#include "frame_ctx.hpp"
+#include "world_bbox.hpp"
 #include <array>
 #include <bit>
 #include <cmath>
@@ -61,6 +67,17 @@ enum class RenderLayerEnum { RENDER_LAYER_0, RENDER_LAYER_1, RENDER_LAYER_2, REN
 #define TRAIT_IS_PUSHABLE "is_pushable"
 #define TRAIT_NO_MODEL "no-model"
 #define TRAIT_IS_BILLBOARD "is_billboard"
+
+// Tag types for hot paths: has<Tag>() is a mask test, each<Tags...>() walks member lists
+TRAIT_TAG(Wsad, TRAIT_WSAD);
+TRAIT_TAG(Pickup, TRAIT_PICKUP);
+TRAIT_TAG(CrossSlashHitbox, TRAIT_CROSS_SLASH_HITBOX);
+TRAIT_TAG(IsHitbox, TRAIT_IS_HITBOX);
+TRAIT_TAG(IsText, TRAIT_IS_TEXT);
+TRAIT_TAG(IsGridAligned, TRAIT_IS_GRID_ALIGNED);
+TRAIT_TAG(IsPushable, TRAIT_IS_PUSHABLE);
+TRAIT_TAG(NoModel, TRAIT_NO_MODEL);
+TRAIT_TAG(IsBillboard, TRAIT_IS_BILLBOARD);
 // ============================================================================
 // Entity
 // ============================================================================
@@ -91,20 +108,19 @@ struct Entity : thing_base {
   float life_time = make_unset<float>();
 
   thing_ref spawner = make_unset<thing_ref>();
-  std::array<char, 128> log_text = {};
-  void* traits[MAX_TRAITS] = {};
+  TraitMask trait_mask = 0; // bit per TraitAPI slot
+  int bounds_proxy = -1;    // leaf in ctx.bounds, set by sync_bounds()
   /** @brief Implicit conversion to ModelInstance reference. */
   operator ModelInstance&() { return model; }
 };
 
-constexpr size_t MAX_ENTITIES = 1000;
-using EntityList = things_list<Entity, MAX_ENTITIES>;
+constexpr size_t ENTITY_PAGE = 256; // entities are allocated in pages of this many on demand
+using EntityList = paged_things_list<Entity, ENTITY_PAGE>;
+using LabelText = std::array<char, 128>;
 
 #include <algorithm>
 #include <unordered_set>
 
-using Pair = std::pair<thing_ref, thing_ref>;
-
 namespace std {
 template <> struct hash<thing_ref> {
   /** @brief Hash a thing_ref by combining kind, index, and generation ID. */
@@ -115,14 +131,6 @@ template <> struct hash<thing_ref> {
     return h;
   }
 };
-template <> struct hash<Pair> {
-  /** @brief Hash a pair of thing_refs for use in collision pair sets. */
-  size_t operator()(const Pair& p) const {
-    size_t h = std::hash<thing_ref>{}(p.first);
-    h ^= std::hash<thing_ref>{}(p.second) << 1;
-    return h;
-  }
-};
 } // namespace std
 
 // ============================================================================
@@ -131,37 +139,28 @@ template <> struct hash<Pair> {
 
 namespace GameCtxAPI {
 
-struct FrameCtx {
+/**
+ * @brief Everything update() reads from the platform, captured once per frame
+ * so a replay can feed the same values back.
+ */
+struct FrameInput {
+  float dt = 0;
   Vector2 mouse = {};
   Ray mouse_ray = {};
-  struct RayHit {
-    thing_ref ref;
-    float distance;
-  };
-  std::vector<RayHit> under_mouse;
-  std::unordered_set<Pair> collision_pairs;
-  std::vector<thing_ref> hovered;
-  std::unordered_set<thing_ref> dragging;
+  Camera3D camera = {}; ///< After UpdateCamera(); replays put it back
+  uint8_t keys = 0;     ///< INPUT_KEY_* bits
+  bool left_down = false;
+  bool left_pressed = false;
+  bool left_released = false;
+  bool ui_mouse = false;    ///< ImGui wants the mouse
+  bool ui_keyboard = false; ///< ImGui wants the keyboard
 };
 
-struct FrameBuffer {
-  FrameCtx current_frame;
-  FrameCtx previous_frame;
-
-  /** @brief Rotate frames: move current to previous and reset current. */
-  void advance() {
-    previous_frame = std::move(current_frame);
-    current_frame = FrameCtx{};
-  }
-
-  /** @brief Get the current frame context. */
-  FrameCtx& current() { return current_frame; }
-  /** @brief Get the previous frame context (read-only). */
-  const FrameCtx& previous() const { return previous_frame; }
-};
+constexpr uint8_t INPUT_KEY_W = 1, INPUT_KEY_S = 2, INPUT_KEY_A = 4, INPUT_KEY_D = 8;
 
 struct State {
   EntityList entities;
+  things_column<LabelText, 0> labels; // cold: text for TRAIT_IS_TEXT entities
   Camera3D camera = {
       .position = {5.0f, 5.0f, 5.0f},
       .target = {0.0f, 0.0f, 0.0f},
@@ -178,8 +177,19 @@ struct State {
   } log_layout;
 
   FrameBuffer frame_buffer;
+  AabbTree<thing_ref> bounds; // world boxes for picking and collisions, refit by sync_bounds()
+  JobSystem jobs;             // started in main(); thread-safe traits and the narrow phase
+
+  FrameInput input;                 // this frame's, from begin_frame_input()
+  InputRecorder<FrameInput> replay; // replay_record / replay_play
+  StringTable names;                // _debug_name storage for restored entities
+  std::vector<uint8_t> quicksave;   // F5 / F9
 };
 
+// Leaf layers in ctx.bounds
+constexpr uint32_t PICKABLE = 1;
+constexpr uint32_t COLLIDABLE = 2;
+
 inline State ctx; // Im not using a namspace becuse namespaces broke my reflection scripts
 // when parsing they want structs
 
@@ -199,31 +209,15 @@ inline thing_ref get_hovered() {
  */
 inline void spawn_label(const char* text, thing_ref spawner = thing_ref::get_nil_ref()) {
   Entity ent = {};
-  snprintf(ent.log_text.data(), ent.log_text.size(), "%s", text);
   ent.life_time = ctx.log_layout.fade_time_sec;
   ent._debug_name = "log_text";
   ent.spawner = spawner;
   ent.parent_offset = {0, 1.5f, 0};
   thing_ref ref = ctx.entities.add(ent);
-  TraitAPI::apply(ctx.entities[ref], TRAIT_IS_TEXT);
-}
-
-/**
- * @brief Compute the world-space bounding box for an entity.
- * @param e The entity to compute the bounding box for.
- * @return The axis-aligned bounding box in world space.
- */
-inline BoundingBox compute_world_bbox(const Entity& e) {
-  BoundingBox local = {{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}};
-  if (e.model.valid()) {
-    Model* m = ModelAPI::get(e.model.name);
-    if (m)
-      local = GetModelBoundingBox(*m);
-  }
-  BoundingBox world;
-  world.min = Vector3Add(Vector3Scale(local.min, e.scale), e.position);
-  world.max = Vector3Add(Vector3Scale(local.max, e.scale), e.position);
-  return world;
+  if (ref.kind == ilist_kind::nil)
+    return;
+  snprintf(ctx.labels[ref].data(), ctx.labels[ref].size(), "%s", text);
+  TraitAPI::apply<IsText>(ctx.entities[ref]);
 }
 
 /**
@@ -241,12 +235,12 @@ inline Matrix entity_transform(const Entity& e, float s = 0) {
 
 /**
  * @brief Draw a model with all meshes overridden to a single color.
- * @param name Name of the model in ModelAPI.
+ * @param handle Model handle from ModelAPI.
  * @param transform World transform matrix.
  * @param color Color override for all mesh materials.
  */
-inline void draw_model_colored(const char* name, Matrix transform, Color color) {
-  Model* model = ModelAPI::get(name);
+inline void draw_model_colored(ModelHandle handle, Matrix transform, Color color) {
+  Model* model = ModelAPI::get(handle);
   if (!model)
     return;
   for (int i = 0; i < model->meshCount; i++) {
@@ -260,13 +254,13 @@ inline void draw_model_colored(const char* name, Matrix transform, Color color)
 
 /**
  * @brief DrawBillboard
- * @param name Name of the model in ModelAPI.
+ * @param handle Model handle from ModelAPI.
  * @param transform World transform matrix.
  * @param color Color override for all mesh materials.
  */
 
-inline void draw_model_billboard(const char* name, Vector3 position, float size, Color tint) {
-  Model* model = ModelAPI::get(name);
+inline void draw_model_billboard(ModelHandle handle, Vector3 position, float size, Color tint) {
+  Model* model = ModelAPI::get(handle);
   if (!model)
     return;
 
@@ -286,11 +280,11 @@ inline void draw_model_billboard(const char* name, Vector3 position, float size,
 
 /**
  * @brief Draw a model using its original materials.
- * @param name Name of the model in ModelAPI.
+ * @param handle Model handle from ModelAPI.
  * @param transform World transform matrix.
  */
-inline void draw_model_normal(const char* name, Matrix transform) {
-  Model* model = ModelAPI::get(name);
+inline void draw_model_normal(ModelHandle handle, Matrix transform) {
+  Model* model = ModelAPI::get(handle);
   if (!model)
     return;
   for (int i = 0; i < model->meshCount; i++) {
@@ -302,18 +296,12 @@ inline void draw_model_normal(const char* name, Matrix transform) {
  * @brief Count the number of live entities.
  * @return The current entity count.
  */
-inline size_t entity_count() {
-  size_t count = 0;
-  for (auto& e : ctx.entities) {
-    (void)e;
-    count++;
-  }
-  return count;
-}
+inline size_t entity_count() { return ctx.entities.size(); }
 
 // ---- spawning ----
 struct SpawnArgs {
   std::string model_name;
+  ModelHandle model = {}; ///< If valid, used instead of model_name (no name lookup)
   Vector3 pos = {0, 0, 0};
   float scale = 1.0f;
   float life_time = INFINITY;
@@ -328,7 +316,8 @@ struct SpawnArgs {
  * @return Reference to the spawned entity, or nil on failure.
  */
 inline thing_ref spawn(const SpawnArgs& args) {
-  ModelInstance inst = ModelAPI::instance(args.model_name);
+  ModelInstance inst =
+      args.model.valid() ? ModelAPI::instance(args.model) : ModelAPI::instance(args.model_name);
 
   if (!inst.valid())
     return {};
@@ -353,16 +342,33 @@ inline thing_ref spawn(const SpawnArgs& args) {
   ent.flags.is_highlightable = 1;
   ent.flags.is_collidable = 1;
 
-  if (args.model_name == TRAIT_NO_MODEL) {
+  thing_ref ref = ctx.entities.add(ent);
+  ModelAPI::bucket_join(inst.handle, ref);
+
+  // Traits key on the entity's list ref, so they go on after the add
+  if (ref.kind != ilist_kind::nil && args.model_name == TRAIT_NO_MODEL) {
     // set the inst to a primitave
-    TraitAPI::apply(ent, TRAIT_NO_MODEL);
+    TraitAPI::apply<NoModel>(ctx.entities[ref]);
   }
 
-  thing_ref ref = ctx.entities.add(ent);
-
   return ref;
 }
 
+/**
+ * @brief Remove an entity and drop it from its model's instancing bucket.
+ * @param ref Reference to the entity to remove.
+ */
+inline void despawn(thing_ref ref) {
+  Entity& e = ctx.entities[ref];
+  if (!e || e.this_ref() != ref)
+    return;
+  ModelAPI::bucket_leave(e.model.handle, ref);
+  if (e.bounds_proxy >= 0)
+    ctx.bounds.remove(e.bounds_proxy);
+  TraitAPI::clear(e);
+  ctx.entities.remove(ref);
+}
+
 /**
  * @brief Remove all entities and clear the selection.
  */
@@ -372,10 +378,270 @@ inline void clear_entities() {
     // why would e not have this ref?
     refs.push_back(e.this_ref());
   for (auto& r : refs)
-    ctx.entities.remove(r);
+    despawn(r);
   ctx.selected = thing_ref::get_nil_ref();
 }
 
+/**
+ * @brief Refit every entity's leaf in ctx.bounds to its current world box.
+ * Leaves that stay inside their fat box cost a containment test; new
+ * entities get a leaf here, so they become pickable from the next frame.
+ */
+inline void sync_bounds() {
+  for (auto& e : ctx.entities) {
+    BoundingBox box = compute_world_bbox(e);
+    uint32_t layers = (e.render.visible && e.model.valid() ? PICKABLE : 0) |
+                      (e.flags.is_collidable ? COLLIDABLE : 0);
+    if (e.bounds_proxy < 0) {
+      e.bounds_proxy = ctx.bounds.insert(box, e.this_ref(), layers);
+    } else {
+      ctx.bounds.move(e.bounds_proxy, box);
+      ctx.bounds.set_layers(e.bounds_proxy, layers);
+    }
+  }
+}
+
+// ---- input ----
+
+/** @brief Read this frame's input from raylib and ImGui. */
+inline FrameInput capture_input() {
+  FrameInput in;
+  in.dt = GetFrameTime();
+  in.mouse = GetMousePosition();
+  in.mouse_ray = GetScreenToWorldRay(in.mouse, ctx.camera);
+  in.camera = ctx.camera;
+  in.keys = (IsKeyDown(KEY_W) ? INPUT_KEY_W : 0) | (IsKeyDown(KEY_S) ? INPUT_KEY_S : 0) |
+            (IsKeyDown(KEY_A) ? INPUT_KEY_A : 0) | (IsKeyDown(KEY_D) ? INPUT_KEY_D : 0);
+  in.left_down = IsMouseButtonDown(MOUSE_BUTTON_LEFT);
+  in.left_pressed = IsMouseButtonPressed(MOUSE_BUTTON_LEFT);
+  in.left_released = IsMouseButtonReleased(MOUSE_BUTTON_LEFT);
+  in.ui_mouse = ImGui::GetIO().WantCaptureMouse;
+  in.ui_keyboard = ImGui::GetIO().WantCaptureKeyboard;
+  return in;
+}
+
+/**
+ * @brief Fill ctx.input for this frame: the next recorded frame while a
+ * replay is playing, otherwise live input (appended to the log while recording).
+ */
+inline void begin_frame_input() {
+  if (ctx.replay.playing()) {
+    if (const FrameInput* in = ctx.replay.next()) {
+      ctx.input = *in;
+      ctx.camera = in->camera;
+      return;
+    }
+    GameConsoleAPI::print(TextFormat("replay finished (%zu frames)", ctx.replay.frames.size()));
+  }
+  ctx.input = capture_input();
+  ctx.replay.push(ctx.input);
+}
+
+// ---- snapshots ----
+
+struct SnapshotHeader {
+  uint32_t magic = 0x50414e53; // "SNAP"
+  uint32_t version = 1;
+  uint32_t entity_size = sizeof(Entity); // the blob is only good for the build that wrote it
+  uint32_t page = ENTITY_PAGE;
+};
+
+/// ModelAPI slot at save time; entities' handles index this table
+struct SnapshotModel {
+  uint32_t name = StringTable::NONE;
+  uint32_t gen = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<Entity>, "snapshots copy entities bytewise");
+
+/**
+ * @brief Serialize the scene between frames: entity pages as-is, plus tables
+ * for what their pointers referred to (model slots, debug names, trait
+ * slots), labels, camera, selection and the carried-over frame state.
+ */
+inline std::vector<uint8_t> snapshot() {
+  StringTable names;
+  std::vector<SnapshotModel> models(ModelAPI::slots.size());
+  for (size_t i = 0; i < models.size(); i++)
+    if (ModelAPI::slots[i].used)
+      models[i] = {names.intern(ModelAPI::slots[i].name), ModelAPI::slots[i].gen};
+  std::vector<uint32_t> traits;
+  for (auto& entry : TraitAPI::state.entries)
+    traits.push_back(names.intern(entry.name));
+  // One id per live entity, in iteration order; few distinct pointers, so cache by pointer
+  std::vector<uint32_t> debug_names;
+  debug_names.reserve(ctx.entities.size());
+  std::unordered_map<const char*, uint32_t> debug_ids;
+  for (auto& e : ctx.entities) {
+    auto [it, fresh] = debug_ids.try_emplace(e._debug_name, StringTable::NONE);
+    if (fresh)
+      it->second = names.intern(e._debug_name);
+    debug_names.push_back(it->second);
+  }
+
+  // What update() will see as last frame's
+  const FrameCtx& frame = ctx.frame_buffer.current();
+
+  SnapshotWriter out;
+  out.bytes.reserve(ctx.entities.capacity() * sizeof(Entity) + (size_t(64) << 10));
+  out.pod(SnapshotHeader{});
+  names.write(out);
+  out.array(models);
+  out.array(traits);
+  ctx.entities.write_raw(out);
+  out.array(debug_names);
+  out.array(ctx.labels.data);
+  out.pod(ctx.camera);
+  out.pod(ctx.selected);
+  out.pod((uint64_t)frame.collision_pairs.size());
+  for (auto& [a, b] : frame.collision_pairs) {
+    out.pod(a);
+    out.pod(b);
+  }
+  out.array(frame.dragging.items.data(), frame.dragging.size());
+  return std::move(out.bytes);
+}
+
+/**
+ * @brief Replace the scene with a snapshot() blob, without going through spawn():
+ * pages are copied back, then model instances, debug names, trait slots,
+ * buckets and bounds are fixed up. Models are matched by name and must be
+ * loaded already; entities whose model is missing stay, undrawn.
+ * @return false (scene untouched) if the blob is corrupt or from another build.
+ */
+inline bool restore(const std::vector<uint8_t>& blob) {
+  SnapshotReader in(blob);
+  SnapshotHeader header, expect;
+  StringTable names;
+  std::vector<SnapshotModel> models;
+  std::vector<uint32_t> traits;
+  EntityList loaded;
+  std::vector<uint32_t> debug_names;
+  std::vector<LabelText> labels;
+  Camera3D camera;
+  thing_ref selected;
+  uint64_t pair_count = 0;
+  if (!in.pod(header) || memcmp(&header, &expect, sizeof(header)) != 0 || !names.read(in) ||
+      !in.array(models) || !in.array(traits) || traits.size() > MAX_TRAITS ||
+      !loaded.read_raw(in) || !in.array(debug_names) || debug_names.size() != loaded.size() ||
+      !in.array(labels) || !in.pod(camera) || !in.pod(selected) || !in.pod(pair_count) ||
+      pair_count > in.remaining() / (2 * sizeof(thing_ref)))
+    return false;
+  std::vector<Pair> pairs((size_t)pair_count);
+  for (auto& [a, b] : pairs) {
+    in.pod(a);
+    in.pod(b);
+  }
+  std::vector<thing_ref> dragging;
+  if (!in.array(dragging))
+    return false;
+
+  // Every trait name must resolve, and the ones not registered yet must still fit
+  std::vector<std::string_view> unknown;
+  for (uint32_t id : traits) {
+    const char* name = names.c_str(id);
+    if (!name)
+      return false;
+    bool seen = std::find(unknown.begin(), unknown.end(), name) != unknown.end();
+    if (TraitAPI::find(name) < 0 && !seen)
+      unknown.push_back(name);
+  }
+  if (TraitAPI::state.entries.size() + unknown.size() > MAX_TRAITS)
+    return false;
+
+  // A recording or playback no longer matches the scene it started from
+  if (ctx.replay.mode != InputRecorder<FrameInput>::Mode::Off) {
+    GameConsoleAPI::print(ctx.replay.recording() ? "replay: recording stopped by a restore"
+                                                 : "replay: playback stopped by a restore",
+                          GameConsoleAPI::Level::Warn);
+    ctx.replay.stop();
+  }
+
+  // The old scene's side tables go; the model store and trait registry stay
+  ModelAPI::bucket_clear_all();
+  TraitAPI::clear_members();
+  ctx.bounds.clear();
+  ctx.entities = std::move(loaded);
+  ctx.labels.data = std::move(labels);
+  ctx.camera = camera;
+  ctx.selected = selected;
+
+  std::vector<ModelInstance> instances(models.size(), ModelInstance{});
+  for (size_t i = 0; i < models.size(); i++)
+    if (const char* name = names.c_str(models[i].name))
+      instances[i] = ModelAPI::instance(name);
+  int trait_slot[MAX_TRAITS];
+  for (size_t i = 0; i < traits.size(); i++)
+    trait_slot[i] = TraitAPI::register_trait(names.c_str(traits[i]));
+  std::vector<const char*> debug_ptrs(names.size(), nullptr);
+
+  size_t i = 0;
+  for (auto& e : ctx.entities) {
+    ModelHandle h = e.model.handle;
+    bool known = h.idx < models.size() && models[h.idx].gen == h.gen;
+    Matrix transform = e.model.transform;
+    e.model = known ? instances[h.idx] : ModelInstance{};
+    e.model.transform = transform;
+    ModelAPI::bucket_join(e.model.handle, e.this_ref());
+
+    uint32_t name = debug_names[i++];
+    if (name < debug_ptrs.size() && !debug_ptrs[name])
+      debug_ptrs[name] = ctx.names.c_str(ctx.names.intern(names.c_str(name)));
+    e._debug_name = name < debug_ptrs.size() ? debug_ptrs[name] : "default_name";
+
+    // Straight into the member lists: apply() would run trait init on restored state
+    TraitMask saved = e.trait_mask;
+    e.trait_mask = 0;
+    for (TraitMask m = saved; m; m &= m - 1) {
+      size_t bit = (size_t)std::countr_zero(m);
+      if (bit >= traits.size())
+        continue;
+      e.trait_mask |= TraitAPI::bit(trait_slot[bit]);
+      TraitAPI::entry_at(trait_slot[bit])->members.insert(e.this_ref());
+    }
+    e.bounds_proxy = -1;
+  }
+
+  // Next update() diffs its collisions and drags against these, as the saved session would have
+  ctx.frame_buffer.advance();
+  FrameCtx& frame = ctx.frame_buffer.current();
+  frame.collision_pairs.assign(pairs.begin(), pairs.end());
+  frame.dragging.items.assign(dragging.begin(), dragging.end());
+  sync_bounds();
+  return true;
+}
+
+/**
+ * @brief snapshot() to `path`, or to the in-memory quicksave slot if empty.
+ * @return A console message with the size and time taken.
+ */
+inline std::string save_scene(const std::string& path = "") {
+  double t0 = Profiler::clock_ns();
+  std::vector<uint8_t> blob = snapshot();
+  double ms = (Profiler::clock_ns() - t0) * 1e-6;
+  size_t kb = blob.size() >> 10;
+  if (path.empty())
+    ctx.quicksave = std::move(blob);
+  else if (!snapshot_write_file(path, blob))
+    return "Failed to write: " + path;
+  return TextFormat("Saved %zu entities (%zu KB) in %.3f ms", ctx.entities.size(), kb, ms);
+}
+
+/** @brief restore() from `path`, or from the quicksave slot if empty. */
+inline std::string load_scene(const std::string& path = "") {
+  std::vector<uint8_t> file;
+  if (!path.empty() && !snapshot_read_file(path, file))
+    return "Failed to read: " + path;
+  const std::vector<uint8_t>& blob = path.empty() ? ctx.quicksave : file;
+  if (blob.empty())
+    return "Nothing saved";
+  double t0 = Profiler::clock_ns();
+  if (!restore(blob))
+    return "Not a snapshot from this build";
+  double ms = (Profiler::clock_ns() - t0) * 1e-6;
+  return TextFormat("Restored %zu entities in %.3f ms", ctx.entities.size(), ms);
+}
+
 // ---- collision / pair handling ----
 /**
  * @brief Test AABB collision between two entities.
@@ -399,7 +665,7 @@ inline void entity_update_position(thing_ref ref, Vector3 pos) {
   if (!e)
     return;
 
-  if (TraitAPI::has(e, TRAIT_IS_GRID_ALIGNED)) {
+  if (TraitAPI::has<IsGridAligned>(e)) {
     pos.x = roundf(pos.x);
     pos.z = roundf(pos.z);
   }
@@ -429,12 +695,12 @@ inline void handle_pair(Entity& a, Entity& b) {
     return;
   }
 
-  if (TraitAPI::has(a, TRAIT_CROSS_SLASH_HITBOX) && TraitAPI::has(b, TRAIT_CROSS_SLASH_HITBOX)) {
+  if (TraitAPI::has<CrossSlashHitbox>(a) && TraitAPI::has<CrossSlashHitbox>(b)) {
     return;
   }
 
   // if a has push distance and b is pushable, set b's velocity from the action
-  if (!is_unset(a.push_distance) && TraitAPI::has(b, TRAIT_IS_PUSHABLE)) {
+  if (!is_unset(a.push_distance) && TraitAPI::has<IsPushable>(b)) {
     Vector3 dir = Vector3Subtract(b.position, a.position);
     dir.y = 0;
     float len = Vector3Length(dir);
@@ -444,27 +710,30 @@ inline void handle_pair(Entity& a, Entity& b) {
     }
   }
 
-  if (TraitAPI::has(a, TRAIT_WSAD) && TraitAPI::has(b, TRAIT_PICKUP)) {
-    GameConsoleAPI::print(std::string("Picked up ") + (b.model.valid() ? b.model.name : "???"));
-    spawn_label(TextFormat("Picked up %s", b.model.valid() ? b.model.name : "???"));
-    ctx.entities.remove(b.this_ref());
+  if (TraitAPI::has<Wsad>(a) && TraitAPI::has<Pickup>(b)) {
+    const char* msg =
+        ctx.frame_buffer.arena().format("Picked up %s", b.model.valid() ? b.model.name : "???");
+    GameConsoleAPI::print(msg);
+    spawn_label(msg);
+    despawn(b.this_ref());
   }
 
-  if (TraitAPI::has(a, TRAIT_CROSS_SLASH_HITBOX)) {
-    GameConsoleAPI::print(std::string("cross slash hit ") +
-                          (b.model.valid() ? b.model.name : "???"));
-    spawn_label(TextFormat("cross slash hit %s", b.model.valid() ? b.model.name : "???"),
-                b.this_ref());
+  if (TraitAPI::has<CrossSlashHitbox>(a)) {
+    const char* msg = ctx.frame_buffer.arena().format("cross slash hit %s",
+                                                      b.model.valid() ? b.model.name : "???");
+    GameConsoleAPI::print(msg, GameConsoleAPI::Level::Debug); // one per hitbox contact
+    spawn_label(msg, b.this_ref());
     TraceLog(LOG_INFO, "cross slash hit %s", b._debug_name);
   }
 
   // moving entity hits a stationary entity
   if (!is_unset(a.velocity) && is_unset(b.velocity)) {
     float speed = Vector3Length(a.velocity);
-    spawn_label(TextFormat("hit %s (%.1f)", b.model.valid() ? b.model.name : "???", speed),
+    spawn_label(ctx.frame_buffer.arena().format("hit %s (%.1f)",
+                                                b.model.valid() ? b.model.name : "???", speed),
                 a.this_ref());
 
-    if (TraitAPI::has(b, TRAIT_IS_PUSHABLE)) {
+    if (TraitAPI::has<IsPushable>(b)) {
       // transfer velocity to b
       b.velocity = a.velocity;
     }
@@ -480,17 +749,22 @@ inline void handle_pair(Entity& a, Entity& b) {
  */
 
 inline void update() {
+  PROFILE_ZONE("update");
   ctx.frame_buffer.advance();
   auto& frame = ctx.frame_buffer.current();
   const auto& last = ctx.frame_buffer.previous();
+  FrameArena& arena = ctx.frame_buffer.arena();
+  begin_frame_input();
+  const FrameInput& input = ctx.input;
 
   //
   // sweep expired entities
   //
 
   {
-    float dt = GetFrameTime();
-    std::vector<thing_ref> expired;
+    PROFILE_ZONE("expiry");
+    float dt = input.dt;
+    ArenaVector<thing_ref> expired(arena);
     for (auto& e : ctx.entities) {
       e.life_time -= dt;
       if (e.life_time <= 0.0f)
@@ -499,7 +773,7 @@ inline void update() {
     for (auto& r : expired) {
       if (r == ctx.selected)
         ctx.selected = thing_ref::get_nil_ref();
-      ctx.entities.remove(r);
+      despawn(r);
     }
   }
 
@@ -507,21 +781,23 @@ inline void update() {
   //  mouse ray collision
   //
 
-  frame.mouse = GetMousePosition();
-  frame.mouse_ray = GetScreenToWorldRay(frame.mouse, ctx.camera);
-  for (auto& e : ctx.entities) {
-    if (!e.render.visible || !e.model.valid())
-      continue;
-    BoundingBox wb = compute_world_bbox(e);
-    RayCollision col = GetRayCollisionBox(frame.mouse_ray, wb);
-    if (col.hit)
-      frame.under_mouse.push_back({e.this_ref(), col.distance});
-  }
-  std::sort(
-      frame.under_mouse.begin(), frame.under_mouse.end(),
-      [](const FrameCtx::RayHit& a, const FrameCtx::RayHit& b) { return a.distance < b.distance; });
-
-  if (!ImGui::GetIO().WantCaptureMouse) {
+  {
+    PROFILE_ZONE("picking");
+    frame.mouse = input.mouse;
+    frame.mouse_ray = input.mouse_ray;
+    // Boxes as of the last collision pass; nothing has moved since
+    ctx.bounds.raycast(
+        frame.mouse_ray,
+        [&](thing_ref& ref, int, float distance) { frame.under_mouse.push_back({ref, distance}); },
+        PICKABLE);
+    PROFILE_COUNT("entities under mouse", (int64_t)frame.under_mouse.size());
+    std::sort(frame.under_mouse.begin(), frame.under_mouse.end(),
+              [](const FrameCtx::RayHit& a, const FrameCtx::RayHit& b) {
+                return a.distance < b.distance;
+              });
+  }
+
+  if (!input.ui_mouse) {
     for (auto& hit : frame.under_mouse) {
       auto& e = ctx.entities[hit.ref];
       if (e.flags.is_highlightable) {
@@ -529,7 +805,7 @@ inline void update() {
         break;
       }
     }
-    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT) && !frame.hovered.empty())
+    if (input.left_pressed && !frame.hovered.empty())
       ctx.selected = frame.hovered.front();
   }
 
@@ -537,7 +813,8 @@ inline void update() {
   // entity dragging logic
   //
 
-  if (!ImGui::GetIO().WantCaptureMouse && IsMouseButtonDown(MOUSE_BUTTON_LEFT)) {
+  if (!input.ui_mouse && input.left_down) {
+    PROFILE_ZONE("dragging");
     for (auto& ref : last.dragging) {
       auto& e = ctx.entities[ref];
       if (e)
@@ -545,7 +822,7 @@ inline void update() {
     }
     for (auto& hit : frame.under_mouse) {
       auto& e = ctx.entities[hit.ref];
-      if (e && e.flags.is_draggable && !frame.dragging.count(hit.ref))
+      if (e && e.flags.is_draggable)
         frame.dragging.insert(hit.ref);
     }
   }
@@ -554,66 +831,66 @@ inline void update() {
   //  entity position update
   //
 
-  for (auto& e : ctx.entities) {
-    if (frame.dragging.count(e.this_ref())) {
-      if (frame.mouse_ray.direction.y != 0) {
-        float t = (e.position.y - frame.mouse_ray.position.y) / frame.mouse_ray.direction.y;
-        Vector3 point =
-            Vector3Add(frame.mouse_ray.position, Vector3Scale(frame.mouse_ray.direction, t));
-        entity_update_position(e.this_ref(), {point.x, e.position.y, point.z});
+  {
+    PROFILE_ZONE("integrate");
+    PROFILE_COUNT("entities integrated", (int64_t)ctx.entities.size());
+    for (auto& e : ctx.entities) {
+      if (frame.dragging.count(e.this_ref())) {
+        if (frame.mouse_ray.direction.y != 0) {
+          float t = (e.position.y - frame.mouse_ray.position.y) / frame.mouse_ray.direction.y;
+          Vector3 point =
+              Vector3Add(frame.mouse_ray.position, Vector3Scale(frame.mouse_ray.direction, t));
+          entity_update_position(e.this_ref(), {point.x, e.position.y, point.z});
+        }
+      } else if (e.spawner != thing_ref::get_nil_ref()) {
+        auto& parent = ctx.entities[e.spawner];
+        if (parent) {
+          e.position = Vector3Add(parent.position, e.parent_offset);
+          e.rotation = parent.rotation;
+        }
       }
-    } else if (e.spawner != thing_ref::get_nil_ref()) {
-      auto& parent = ctx.entities[e.spawner];
-      if (parent) {
-        e.position = Vector3Add(parent.position, e.parent_offset);
-        e.rotation = parent.rotation;
+      // velocity update with friction
+      if (!is_unset(e.velocity)) {
+        float dt = input.dt;
+        e.position = Vector3Add(e.position, Vector3Scale(e.velocity, dt));
+        constexpr float friction = 3.0f;
+        float decay = expf(-friction * dt);
+        e.velocity = Vector3Scale(e.velocity, decay);
+        if (Vector3Length(e.velocity) < 0.05f)
+          e.velocity = make_unset<Vector3>();
       }
     }
-    // velocity update with friction
-    if (!is_unset(e.velocity)) {
-      float dt = GetFrameTime();
-      e.position = Vector3Add(e.position, Vector3Scale(e.velocity, dt));
-      constexpr float friction = 3.0f;
-      float decay = expf(-friction * dt);
-      e.velocity = Vector3Scale(e.velocity, decay);
-      if (Vector3Length(e.velocity) < 0.05f)
-        e.velocity = make_unset<Vector3>();
-    }
   }
 
   //
   //   traits update
   //
 
-  TraitAPI::tick_all(ctx.entities);
+  {
+    PROFILE_ZONE("traits");
+    TraitAPI::tick_all(ctx.entities, ctx.jobs);
+  }
 
   //
   // entity collision update
   //
 
   {
-    std::vector<thing_ref> collidables;
-    for (auto& e : ctx.entities) {
-      if (e.flags.is_collidable)
-        collidables.push_back(e.this_ref());
-    }
-
-    for (size_t i = 0; i < collidables.size(); i++) { // pre filter collisions
-      auto& a = ctx.entities[collidables[i]];
-      if (!a)
-        continue;
-      for (size_t j = i + 1; j < collidables.size(); j++) {
-        auto& b = ctx.entities[collidables[j]];
-        if (!b)
-          continue;
-        if (!collides(a, b))
-          continue;
-        frame.collision_pairs.insert({a.this_ref(), b.this_ref()});
-        frame.collision_pairs.insert({b.this_ref(), a.this_ref()});
-      }
+    PROFILE_ZONE("collisions");
+    // Broad phase: refit the tree, then walk it once per collidable leaf
+    sync_bounds();
+    const auto& pairs = ctx.bounds.overlapping_pairs(ctx.jobs, COLLIDABLE);
+    PROFILE_COUNT("collision pairs tested", (int64_t)ctx.bounds.candidate_count);
+    PROFILE_COUNT("collision pairs overlapping", (int64_t)pairs.size());
+    frame.collision_pairs.reserve(pairs.size() * 2);
+    for (auto [i, j] : pairs) {
+      thing_ref a = ctx.bounds.user(i), b = ctx.bounds.user(j);
+      frame.collision_pairs.push_back({a, b});
+      frame.collision_pairs.push_back({b, a});
     }
+    std::sort(frame.collision_pairs.begin(), frame.collision_pairs.end());
     for (auto& pair : frame.collision_pairs) {
-      if (last.collision_pairs.count(pair))
+      if (std::binary_search(last.collision_pairs.begin(), last.collision_pairs.end(), pair))
         continue;
       auto& a = ctx.entities[pair.first];
       auto& b = ctx.entities[pair.second];
@@ -626,16 +903,17 @@ inline void update() {
   // mouse up logic
   //
 
-  if (!ImGui::GetIO().WantCaptureMouse && IsMouseButtonReleased(MOUSE_BUTTON_LEFT) &&
-      !last.dragging.empty()) {
+  if (!input.ui_mouse && input.left_released && !last.dragging.empty()) {
+    PROFILE_ZONE("cross slash");
     for (auto& hit : frame.under_mouse) {
       auto& target = ctx.entities[hit.ref];
-      if (!target || !TraitAPI::has(target, TRAIT_WSAD))
+      if (!target || !TraitAPI::has<Wsad>(target))
         continue;
 
       TraceLog(LOG_INFO, "cross slash on: %s", target.model.name);
-      spawn_label(TextFormat("cross slash at (%.1f, %.1f, %.1f)", target.position.x,
-                             target.position.y, target.position.z),
+      spawn_label(ctx.frame_buffer.arena().format("cross slash at (%.1f, %.1f, %.1f)",
+                                                  target.position.x, target.position.y,
+                                                  target.position.z),
                   target.this_ref());
 
       thing_ref spawner_ref = target.this_ref();
@@ -657,69 +935,88 @@ inline void update() {
             .debug_name = d.name,
             .push_distance = 1.0f,
         });
+        if (ref.kind == ilist_kind::nil)
+          continue;
         auto& ent = ctx.entities[ref];
-        TraitAPI::apply(ent, TRAIT_CROSS_SLASH_HITBOX);
-        TraitAPI::apply(ent, TRAIT_IS_HITBOX);
+        TraitAPI::apply<CrossSlashHitbox>(ent);
+        TraitAPI::apply<IsHitbox>(ent);
       }
       break;
     }
   }
 
+  PROFILE_COUNT("frame arena bytes", (int64_t)arena.bytes);
+  PROFILE_COUNT("frame arena heap blocks", (int64_t)arena.heap_blocks);
+
   //
-  //  render
+  //  render (zones time CPU-side submission, not the GPU)
   //
 
-  RenderAPI::layer_start(RenderLayer::Background, ctx.camera);
-  for (int x = -10; x <= 10; x++)
-    for (int z = -10; z <= 10; z++) {
-      Color tile = ((x + z) % 2 == 0) ? Color{60, 60, 60, 255} : Color{40, 40, 40, 255};
-      DrawPlane({(float)x, -.1f, (float)z}, {1, 1}, tile);
-    }
-
-  RenderAPI::layer_start(RenderLayer::Highlight, ctx.camera);
-  if (auto& h = ctx.entities[get_hovered()]) {
-    if (h.render.visible && h.model.valid()) {
-      draw_model_colored(h.model.name, entity_transform(h, h.scale * 1.1f), ctx.highlight_color);
-    }
+  {
+    PROFILE_ZONE("render background");
+    RenderAPI::layer_start(RenderLayer::Background, ctx.camera);
+    for (int x = -10; x <= 10; x++)
+      for (int z = -10; z <= 10; z++) {
+        Color tile = ((x + z) % 2 == 0) ? Color{60, 60, 60, 255} : Color{40, 40, 40, 255};
+        DrawPlane({(float)x, -.1f, (float)z}, {1, 1}, tile);
+      }
   }
 
-  RenderAPI::layer_start(RenderLayer::Entities, ctx.camera);
-  for (auto& e : ctx.entities) {
-
-    if (!e.render.visible || !e.model.valid()) {
-      continue;
+  {
+    PROFILE_ZONE("render highlight");
+    RenderAPI::layer_start(RenderLayer::Highlight, ctx.camera);
+    if (auto& h = ctx.entities[get_hovered()]) {
+      if (h.render.visible && h.model.valid()) {
+        draw_model_colored(h.model.handle, entity_transform(h, h.scale * 1.1f),
+                           ctx.highlight_color);
+      }
     }
+  }
 
-    draw_model_normal(e.model.name, entity_transform(e));
+  {
+    PROFILE_ZONE("render entities");
+    RenderAPI::layer_start(RenderLayer::Entities, ctx.camera);
+    // One instanced draw per model mesh
+    int draws = draw_model_buckets(ctx.entities, [](Entity& e, Matrix& out) {
+      if (!e.render.visible)
+        return false;
+      out = entity_transform(e);
+      return true;
+    });
+    PROFILE_COUNT("draw calls", draws);
+    TraitAPI::each<IsHitbox>(ctx.entities, [](Entity& e) {
+      if (e.render.visible && e.model.valid())
+        DrawBoundingBox(compute_world_bbox(e), RED);
+    });
+  }
 
-    if (TraitAPI::has(e, TRAIT_IS_HITBOX)) {
-      DrawBoundingBox(compute_world_bbox(e), RED);
+  {
+    PROFILE_ZONE("render focus");
+    RenderAPI::layer_start(RenderLayer::Focus, ctx.camera);
+    if (auto& sel = ctx.entities[ctx.selected]) {
+      if (sel.render.visible && sel.model.valid())
+        draw_model_colored(sel.model.handle, entity_transform(sel, sel.scale * 1.15f),
+                           ctx.selection_color);
     }
   }
 
-  RenderAPI::layer_start(RenderLayer::Focus, ctx.camera);
-  if (auto& sel = ctx.entities[ctx.selected]) {
-    if (sel.render.visible && sel.model.valid())
-      draw_model_colored(sel.model.name, entity_transform(sel, sel.scale * 1.15f),
-                         ctx.selection_color);
+  {
+    PROFILE_ZONE("render ui world");
+    RenderAPI::layer_start(RenderLayer::UI_World, ctx.camera);
+    TraitAPI::each<IsBillboard>(ctx.entities, [](Entity& e) {
+      draw_model_billboard(e.model.handle, e.position, e.scale, WHITE);
+    });
   }
 
-  RenderAPI::layer_start(RenderLayer::UI_World, ctx.camera);
-  for (auto& e : ctx.entities) {
-    if (TraitAPI::has(e, TRAIT_IS_BILLBOARD)) {
-      draw_model_billboard(e.model.name, e.position, e.scale, WHITE);
-    }
+  {
+    PROFILE_ZONE("rasterize");
+    RenderAPI::rasterize();
   }
 
-  RenderAPI::rasterize();
-
-  for (auto& e : ctx.entities) {
-    if (!TraitAPI::has(e, TRAIT_IS_TEXT))
-      continue;
+  TraitAPI::each<IsText>(ctx.entities, [](Entity& e) {
     Vector2 screen = GetWorldToScreen(e.position, ctx.camera);
-    float alpha = Clamp(e.life_time / ctx.log_layout.fade_time_sec, 0.0f, 1.0f);
-    DrawText(e.log_text.data(), (int)screen.x, (int)screen.y, 20, RED);
-  }
+    DrawText(ctx.labels[e.this_ref()].data(), (int)screen.x, (int)screen.y, 20, RED);
+  });
 }
 
 /**
@@ -773,7 +1070,7 @@ inline void draw_imgui() {
 
       ImGui::Separator();
       if (ImGui::Button("Delete")) {
-        ctx.entities.remove(ctx.selected);
+        despawn(ctx.selected);
         ctx.selected = thing_ref::get_nil_ref();
       }
     }
@@ -784,6 +1081,7 @@ inline void draw_imgui() {
   }
   ImGui::End();
   GameConsoleAPI::draw_imgui();
+  Profiler::draw_imgui();
   rlImGuiEnd();
 }
 
@@ -810,14 +1108,21 @@ int main() {
   SetTargetFPS(60);
   rlImGuiSetup(true);
   RenderAPI::init();
+  // Opaque geometry goes straight to the backbuffer; outline layers don't need depth
+  RenderAPI::configure(RenderLayer::Background, {.direct = true});
+  RenderAPI::configure(RenderLayer::Entities, {.direct = true});
+  RenderAPI::configure(RenderLayer::Highlight, {.depth = false});
+  RenderAPI::configure(RenderLayer::Focus, {.depth = false});
 
   LuaAPI::init();
+  GameCtxAPI::ctx.jobs.start();
 
+  // wsad reads input, so it stays on the main thread
   TraitAPI::register_trait(TRAIT_WSAD, wsad_init, wsad_update);
 
-  TraitAPI::register_trait(TRAIT_PICKUP, pickup_init, pickup_update);
+  TraitAPI::register_trait(TRAIT_PICKUP, pickup_init, pickup_update, true);
 
-  TraitAPI::register_trait(TRAIT_CROSS_SLASH_HITBOX, pickup_init, pickup_update);
+  TraitAPI::register_trait(TRAIT_CROSS_SLASH_HITBOX, pickup_init, pickup_update, true);
 
   TraitAPI::register_trait(TRAIT_IS_HITBOX);
 
@@ -831,10 +1136,25 @@ int main() {
 
   // how do I make a frame around all the items in game?
 
-  GameConsoleAPI::print("Press ~ for console.");
+  GameConsoleAPI::print("Press ~ for console, 'prof' for the profiler, F5 / F9 to quicksave and "
+                        "quickload.");
   LuaAPI::run_file("assets/setup.lua");
+  // Saving a script re-runs it, diff-applying its spawns onto the live scene
+  FileWatcher script_watcher;
+  LuaAPI::watch(script_watcher);
 
   while (!WindowShouldClose()) {
+    Profiler::begin_frame();
+    {
+      PROFILE_ZONE("script reload");
+      // A replay reproduces the recorded session; scripts saved meanwhile would change it
+      if (!GameCtxAPI::ctx.replay.playing())
+        LuaAPI::reload_changed(script_watcher.poll());
+    }
+    if (IsKeyPressed(KEY_F5))
+      GameConsoleAPI::print(GameCtxAPI::save_scene());
+    if (IsKeyPressed(KEY_F9))
+      GameConsoleAPI::print(GameCtxAPI::load_scene());
     if (IsKeyPressed(KEY_GRAVE))
       GameConsoleAPI::toggle_visible();
     if (!GameConsoleAPI::visible())
@@ -845,9 +1165,14 @@ int main() {
     GameCtxAPI::update();
     GameCtxAPI::draw_imgui();
     DrawFPS(10, 10);
-    EndDrawing();
+    {
+      PROFILE_ZONE("present");
+      EndDrawing();
+    }
+    Profiler::end_frame();
   }
 
+  GameCtxAPI::ctx.jobs.stop();
   LuaAPI::shutdown();
   GameCtxAPI::clear_entities();
   RenderAPI::shutdown();
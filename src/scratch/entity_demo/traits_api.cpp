@@ -1,90 +1,306 @@
-
 #ifndef TRAIT_API_HPP
 #define TRAIT_API_HPP
 
+#include "../../mylibs/ilist.hpp"
+#include "../../mylibs/job_system.hpp"
+#include <bit>
 #include <cassert>
-#include <cstring>
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
-constexpr int MAX_TRAITS = 10;
+constexpr int MAX_TRAITS = 64;
+
+/// One bit per trait slot; entities carry this instead of a pointer per slot
+using TraitMask = uint64_t;
+
+/**
+ * @brief Declare a trait tag type for the templated API.
+ *
+ *   TRAIT_TAG(Wsad, "wsad");
+ *   TraitAPI::has<Wsad>(e);  TraitAPI::each<Wsad, Pushable>(ents, fn);
+ *
+ * The slot behind a tag is resolved on first use and cached, so the
+ * per-call cost is a mask test. Names stay the key for the console and Lua.
+ */
+#define TRAIT_TAG(type, trait_name)                                                                \
+  struct type {                                                                                    \
+    static constexpr const char* name = trait_name;                                                \
+  }
 
 namespace TraitAPI {
 
 using InitFn = void (*)(void*);
 using UpdateFn = void (*)(void*);
 
+/**
+ * @brief Entities that have a trait, as a sparse set keyed by thing_ref::idx.
+ * dense holds the refs (what tick_all / each iterate), sparse maps an index
+ * back to its dense position so add and remove are O(1).
+ */
+struct MemberList {
+  std::vector<thing_ref> dense;
+  std::vector<uint32_t> sparse;
+
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  uint32_t position(int idx) const {
+    if (idx < 0 || (size_t)idx >= sparse.size())
+      return NONE;
+    uint32_t pos = sparse[idx];
+    return pos < dense.size() && dense[pos].idx == idx ? pos : NONE;
+  }
+
+  void insert(thing_ref ref) {
+    uint32_t pos = position(ref.idx);
+    if (pos != NONE) { // same slot: a stale ref from a despawned entity, or already in
+      dense[pos] = ref;
+      return;
+    }
+    if ((size_t)ref.idx >= sparse.size())
+      sparse.resize((size_t)ref.idx + 1, NONE);
+    sparse[ref.idx] = (uint32_t)dense.size();
+    dense.push_back(ref);
+  }
+
+  void erase(int idx) {
+    uint32_t pos = position(idx);
+    if (pos == NONE)
+      return;
+    thing_ref last = dense.back();
+    dense[pos] = last;
+    sparse[last.idx] = pos;
+    dense.pop_back();
+    sparse[idx] = NONE;
+  }
+
+  void clear() {
+    dense.clear();
+    sparse.clear();
+  }
+};
+
 struct TraitEntry {
-  const char* name;
+  const char* name; ///< Points at the by_name key (node-stable)
   int slot;
   InitFn init;
   UpdateFn update;
+  MemberList members;
+  /// update only touches the entity it is given (no spawns, no trait changes, no raylib
+  /// calls), so tick_all(ents, jobs) may run it on worker threads
+  bool thread_safe = false;
+};
+
+/// Lets find() look names up without building a std::string
+struct NameHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
 };
 
 struct State {
-  std::vector<TraitEntry> entries;
-  int next_slot = 0;
-  void* PRESENT = (void*)0x1;
+  std::vector<TraitEntry> entries; ///< Indexed by slot
+  std::unordered_map<std::string, int, NameHash, std::equal_to<>> by_name;
+  std::vector<std::vector<int>> stale; ///< Per-thread scratch for tick_all(ents, jobs), kept across frames
 };
 
 inline State state;
 
-inline int register_trait(const char* name, InitFn init = nullptr, UpdateFn update = nullptr) {
-  for (auto& e : state.entries) {
-    if (strcmp(e.name, name) == 0)
-      return e.slot;
+constexpr TraitMask bit(int slot) { return TraitMask(1) << slot; }
+
+/**
+ * @brief Register a trait, or look it up if the name is taken.
+ * A later call with callbacks fills them in, so tags used before
+ * registration still pick up their init / update.
+ * @param thread_safe See TraitEntry::thread_safe
+ */
+inline int register_trait(const char* name, InitFn init = nullptr, UpdateFn update = nullptr,
+                          bool thread_safe = false) {
+  auto it = state.by_name.find(std::string_view(name));
+  if (it != state.by_name.end()) {
+    TraitEntry& e = state.entries[it->second];
+    if (init)
+      e.init = init;
+    if (update) {
+      e.update = update;
+      e.thread_safe = thread_safe;
+    }
+    return e.slot;
   }
-  assert(state.next_slot < MAX_TRAITS && "Too many traits");
-  int slot = state.next_slot++;
-  state.entries.push_back({name, slot, init, update});
+  assert(state.entries.size() < MAX_TRAITS && "Too many traits");
+  state.entries.reserve(MAX_TRAITS); // entries never move: each() holds pointers across fn
+  int slot = (int)state.entries.size();
+  auto [key, _] = state.by_name.emplace(name, slot);
+  state.entries.push_back({key->first.c_str(), slot, init, update, {}, thread_safe});
   return slot;
 }
 
+/// @brief Slot for a name, or -1. One hash lookup; prefer slot<Tag>() in hot code.
 inline int find(const char* name) {
-  for (auto& e : state.entries) {
-    if (strcmp(e.name, name) == 0)
-      return e.slot;
-  }
-  return -1;
+  auto it = state.by_name.find(std::string_view(name));
+  return it != state.by_name.end() ? it->second : -1;
 }
 
 inline TraitEntry* entry_at(int slot) {
-  for (auto& e : state.entries) {
-    if (e.slot == slot)
-      return &e;
-  }
-  return nullptr;
+  return slot >= 0 && slot < (int)state.entries.size() ? &state.entries[slot] : nullptr;
 }
 
-template <typename E> void apply(E& e, const char* name) {
-  int slot = find(name);
-  if (slot < 0)
+/// @brief Slot for a TRAIT_TAG type, resolved once.
+template <typename Tag> int slot() {
+  static const int s = register_trait(Tag::name);
+  return s;
+}
+
+template <typename... Tags> TraitMask mask() { return (TraitMask(0) | ... | bit(slot<Tags>())); }
+
+// ---- membership by slot (the primitives everything else goes through) ----
+
+// A nil entity (or one not added to its list yet) has no ref to file under
+template <typename E> void apply(E& e, int slot) {
+  if (!e)
+    return;
+  TraitEntry* entry = entry_at(slot);
+  if (!entry || (e.trait_mask & bit(slot)))
     return;
-  e.traits[slot] = state.PRESENT;
-  auto* entry = entry_at(slot);
-  if (entry && entry->init)
+  e.trait_mask |= bit(slot);
+  entry->members.insert(e.this_ref());
+  if (entry->init)
     entry->init(&e);
 }
 
-template <typename E> void remove(E& e, const char* name) {
-  int slot = find(name);
-  if (slot >= 0)
-    e.traits[slot] = nullptr;
+template <typename E> void remove(E& e, int slot) {
+  if (!e)
+    return;
+  TraitEntry* entry = entry_at(slot);
+  if (!entry || !(e.trait_mask & bit(slot)))
+    return;
+  e.trait_mask &= ~bit(slot);
+  entry->members.erase(e.this_ref().idx);
+}
+
+template <typename E> bool has(const E& e, int slot) {
+  return slot >= 0 && slot < MAX_TRAITS && (e.trait_mask & bit(slot)) != 0;
+}
+
+/// @brief Drop every trait. Call before the entity is removed from its list.
+template <typename E> void clear(E& e) {
+  for (TraitMask m = e.trait_mask; m; m &= m - 1)
+    state.entries[std::countr_zero(m)].members.erase(e.this_ref().idx);
+  e.trait_mask = 0;
+}
+
+/// @brief Empty every member list, leaving entity masks alone; for restoring saved scenes.
+inline void clear_members() {
+  for (auto& entry : state.entries)
+    entry.members.clear();
+}
+
+// ---- by name (console, Lua) and by tag ----
+
+template <typename E> void apply(E& e, const char* name) { apply(e, find(name)); }
+template <typename E> void remove(E& e, const char* name) { remove(e, find(name)); }
+template <typename E> bool has(const E& e, const char* name) { return has(e, find(name)); }
+
+template <typename Tag, typename E> void apply(E& e) { apply(e, slot<Tag>()); }
+template <typename Tag, typename E> void remove(E& e) { remove(e, slot<Tag>()); }
+template <typename Tag, typename E> bool has(const E& e) { return has(e, slot<Tag>()); }
+
+/// @brief The entity behind a member ref, or nullptr if it has since been despawned.
+template <typename EntityList>
+typename EntityList::thing* resolve(EntityList& ents, thing_ref ref) {
+  auto& e = ents[ref];
+  return e && e.this_ref() == ref ? &e : nullptr;
+}
+
+/**
+ * @brief Call fn(entity) for every live entity that has all of Tags.
+ *
+ * Walks the smallest member list among Tags and tests the rest with one
+ * mask check, so cost follows the rarest trait, not the entity count.
+ * fn may apply / remove traits on the entity it is given.
+ */
+template <typename... Tags, typename EntityList, typename Fn> void each(EntityList& ents, Fn&& fn) {
+  static_assert(sizeof...(Tags) > 0, "each<> needs at least one trait");
+  const TraitMask want = mask<Tags...>();
+  MemberList* smallest = nullptr;
+  for (int s : {slot<Tags>()...}) {
+    MemberList& m = state.entries[s].members;
+    if (!smallest || m.dense.size() < smallest->dense.size())
+      smallest = &m;
+  }
+  // Backwards, so swap-removes of the current entry don't skip anyone
+  for (size_t i = smallest->dense.size(); i-- > 0;) {
+    if (i >= smallest->dense.size())
+      continue;
+    thing_ref ref = smallest->dense[i];
+    auto* e = resolve(ents, ref);
+    if (!e) {
+      smallest->erase(ref.idx); // despawned without clear()
+      continue;
+    }
+    if ((e->trait_mask & want) == want)
+      fn(*e);
+  }
 }
 
-template <typename E> bool has(const E& e, const char* name) {
-  int slot = find(name);
-  return slot >= 0 && e.traits[slot] != nullptr;
+/// @brief Run one trait's update over its members on the calling thread.
+template <typename EntityList> void tick(EntityList& ents, TraitEntry& entry) {
+  MemberList& m = entry.members;
+  for (size_t i = m.dense.size(); i-- > 0;) {
+    if (i >= m.dense.size())
+      continue;
+    thing_ref ref = m.dense[i];
+    auto* e = resolve(ents, ref);
+    if (!e)
+      m.erase(ref.idx);
+    else
+      entry.update(e);
+  }
 }
 
 template <typename EntityList> void tick_all(EntityList& ents) {
-  // Update all registered traits
+  // Update all registered traits, visiting only their members
+  for (auto& entry : state.entries)
+    if (entry.update)
+      tick(ents, entry);
+}
+
+/**
+ * @brief tick_all with thread-safe traits spread over the job system.
+ *
+ * Traits run one after another, so an entity never sees two updates at
+ * once; within a thread-safe trait the members are split across threads.
+ * Stale refs found on workers are erased afterwards on the caller.
+ * Traits without the flag tick serially, as in tick_all(ents).
+ */
+template <typename EntityList> void tick_all(EntityList& ents, JobSystem& jobs) {
+  auto& stale = state.stale;
+  if (stale.size() < (size_t)jobs.thread_count())
+    stale.resize(jobs.thread_count());
   for (auto& entry : state.entries) {
     if (!entry.update)
       continue;
-    for (auto& e : ents) {
-      if (e.traits[entry.slot])
-        entry.update(&e);
+    if (!entry.thread_safe) {
+      tick(ents, entry);
+      continue;
+    }
+    MemberList& m = entry.members;
+    UpdateFn update = entry.update;
+    jobs.parallel_for(0, (int)m.dense.size(), 256, [&](int lo, int hi, int thread) {
+      for (int i = lo; i < hi; i++) {
+        thing_ref ref = m.dense[i];
+        if (auto* e = resolve(ents, ref))
+          update(e);
+        else
+          stale[thread].push_back(ref.idx);
+      }
+    });
+    for (auto& list : stale) {
+      for (int idx : list)
+        m.erase(idx);
+      list.clear();
     }
   }
 }
@@ -92,7 +308,8 @@ template <typename EntityList> void tick_all(EntityList& ents) {
 inline std::string debug_registered() {
   std::string out;
   for (auto& e : state.entries) {
-    out += std::string(e.name) + " [slot " + std::to_string(e.slot) + "]\n";
+    out += std::string(e.name) + " [slot " + std::to_string(e.slot) + ", " +
+           std::to_string(e.members.dense.size()) + " members]\n";
   }
   return out;
 }
@@ -100,7 +317,7 @@ inline std::string debug_registered() {
 template <typename E> std::string debug_entity(const E& e) {
   std::string out;
   for (auto& entry : state.entries) {
-    if (!e.traits[entry.slot])
+    if (!has(e, entry.slot))
       continue;
     if (!out.empty())
       out += " | ";
@@ -0,0 +1,29 @@
+/**
+ * @file world_bbox.hpp
+ * @brief entity_demo's world-space bounds, shared with mylibs_bench
+ *
+ * Split out of main.cpp so bench_frame times the real function,
+ * not a copy that can drift.
+ */
+
+#pragma once
+#include "../../mylibs/model_api.hpp"
+#include <raylib.h>
+#include <raymath.h>
+
+/**
+ * @brief Compute the world-space bounding box for an entity.
+ * @param e The entity (anything with a ModelInstance model, Vector3 position and float scale).
+ * @return The axis-aligned bounding box in world space.
+ */
+template <class E> inline BoundingBox compute_world_bbox(const E& e) {
+  BoundingBox local = {{-0.5f, -0.5f, -0.5f}, {0.5f, 0.5f, 0.5f}};
+  if (e.model.valid()) {
+    if (const ModelAPI::ModelBounds* b = ModelAPI::bounds(e.model.handle))
+      local = b->box;
+  }
+  BoundingBox world;
+  world.min = Vector3Add(Vector3Scale(local.min, e.scale), e.position);
+  world.max = Vector3Add(Vector3Scale(local.max, e.scale), e.position);
+  return world;
+}
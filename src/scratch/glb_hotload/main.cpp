@@ -1,10 +1,14 @@
 /**
  * GLB Hotload Viewer
  *
- * Simple Raylib app that watches a GLB file and reloads when it changes.
+ * Simple Raylib app that watches GLB files and reloads them when they change.
  * Use with the Blender addon to export and see changes live.
  *
- * Usage: ./glb_hotload [path_to_glb]
+ * Changes come from FileWatcher (inotify, debounced) instead of polling the
+ * mtime; the file is read on an AsyncLoader worker and swapped into ModelAPI
+ * only once it has parsed, so a half-written export never blanks the view.
+ *
+ * Usage: ./glb_hotload [path_to_glb ...]
  * Default: ./assets/hotload.glb
  *
  * Controls:
@@ -14,21 +18,23 @@
  * - Space: Reset camera
  */
 
+#include "../../mylibs/async_loader.hpp"
+#include "../../mylibs/file_watcher.hpp"
+#include "../../mylibs/model_api.hpp"
+#include <algorithm>
 #include <cstring>
 #include <imgui.h>
 #include <raylib.h>
 #include <raymath.h>
 #include <rlImGui.h>
 #include <string>
-#include <sys/stat.h>
+#include <vector>
 
 struct HotloadViewer {
-  std::string glb_path = "./assets/hotload.glb";
-  Model model = {0};
-  bool model_loaded = false;
-  time_t last_modified = 0;
-  float check_interval = 0.5f;
-  float check_timer = 0.0f;
+  std::vector<std::string> glb_paths = {"./assets/hotload.glb"};
+  std::vector<ModelHandle> handles; ///< Parallel to glb_paths; null until the file exists
+  FileWatcher watcher;
+  AsyncLoader loader;
 
   Camera3D camera = {0};
   float orbit_angle = 0.0f;
@@ -38,9 +44,9 @@ struct HotloadViewer {
   int reload_count = 0;
   bool auto_reload = true;
 
-  void init(const char* path) {
-    if (path)
-      glb_path = path;
+  void init(int count, char** paths) {
+    if (count > 0)
+      glb_paths.assign(paths, paths + count);
 
     camera.position = {0.0f, 2.0f, 5.0f};
     camera.target = {0.0f, 0.0f, 0.0f};
@@ -48,67 +54,66 @@ struct HotloadViewer {
     camera.fovy = 45.0f;
     camera.projection = CAMERA_PERSPECTIVE;
 
-    try_load();
-  }
-
-  time_t get_file_mtime() {
-    struct stat st;
-    if (stat(glb_path.c_str(), &st) == 0) {
-      return st.st_mtime;
+    loader.start(1);
+    handles.assign(glb_paths.size(), ModelHandle{});
+    for (size_t i = 0; i < glb_paths.size(); i++) {
+      // Watch even missing files: the first export shows up as a change
+      if (!watcher.watch_file(glb_paths[i]))
+        TraceLog(LOG_WARNING, "Can't watch %s", glb_paths[i].c_str());
+      try_load(i);
     }
-    return 0;
+    if (watcher.polling)
+      TraceLog(LOG_INFO, "FileWatcher: no inotify, polling every %.1fs", watcher.poll_interval);
   }
 
-  bool file_exists() {
-    struct stat st;
-    return stat(glb_path.c_str(), &st) == 0;
+  bool model_loaded() const {
+    return std::any_of(handles.begin(), handles.end(),
+                       [](ModelHandle h) { return ModelAPI::get(h) != nullptr; });
   }
 
-  void try_load() {
-    if (!file_exists()) {
-      TraceLog(LOG_WARNING, "GLB file not found: %s", glb_path.c_str());
+  /// First load is synchronous; after that every reload goes through the loader
+  void try_load(size_t i) {
+    const std::string& path = glb_paths[i];
+    if (ModelAPI::get(handles[i])) {
+      ModelAPI::reload_async(handles[i], loader);
+      reload_count++;
       return;
     }
-
-    if (model_loaded) {
-      UnloadModel(model);
-      model_loaded = false;
+    if (!FileExists(path.c_str())) {
+      TraceLog(LOG_WARNING, "GLB file not found: %s", path.c_str());
+      return;
     }
-
-    model = LoadModel(glb_path.c_str());
-    if (model.meshCount > 0) {
-      model_loaded = true;
-      last_modified = get_file_mtime();
-      reload_count++;
-      TraceLog(LOG_INFO, "Loaded GLB: %s (meshes: %d, reload #%d)", glb_path.c_str(),
-               model.meshCount, reload_count);
+    if (ModelAPI::load(path, path)) {
+      handles[i] = ModelAPI::handle(path);
+      TraceLog(LOG_INFO, "Loaded GLB: %s (meshes: %d)", path.c_str(),
+               ModelAPI::get(handles[i])->meshCount);
     } else {
-      TraceLog(LOG_ERROR, "Failed to load GLB: %s", glb_path.c_str());
+      TraceLog(LOG_ERROR, "Failed to load GLB: %s", path.c_str());
     }
   }
 
   void check_reload() {
+    std::vector<std::string> changed = watcher.poll();
     if (!auto_reload)
       return;
-
-    time_t current_mtime = get_file_mtime();
-    if (current_mtime > 0 && current_mtime != last_modified) {
-      TraceLog(LOG_INFO, "File changed, reloading...");
-      try_load();
+    for (const std::string& path : changed) {
+      auto it = std::find(glb_paths.begin(), glb_paths.end(), path);
+      if (it == glb_paths.end())
+        continue;
+      TraceLog(LOG_INFO, "File changed, reloading %s...", path.c_str());
+      try_load((size_t)(it - glb_paths.begin()));
     }
   }
 
   void update() {
-    // Check for file changes
-    check_timer += GetFrameTime();
-    if (check_timer >= check_interval) {
-      check_timer = 0.0f;
-      check_reload();
-    }
+    // Debounced file events, then parse + swap whatever finished reading
+    check_reload();
+    loader.pump(8.0);
 
     // Force reload with R
     if (IsKeyPressed(KEY_R)) {
-      try_load();
+      for (size_t i = 0; i < glb_paths.size(); i++)
+        try_load(i);
     }
 
     // Reset camera with Space
@@ -142,9 +147,14 @@ struct HotloadViewer {
 
     DrawGrid(10, 1.0f);
 
-    if (model_loaded) {
-      DrawModel(model, {0, 0, 0}, 1.0f, WHITE);
-      DrawModelWires(model, {0, 0, 0}, 1.0f, DARKGRAY);
+    // Side by side along X; drawn through the handle so reloads show up immediately
+    for (size_t i = 0; i < handles.size(); i++) {
+      Model* model = ModelAPI::get(handles[i]);
+      if (!model)
+        continue;
+      Vector3 pos = {((float)i - (float)(handles.size() - 1) * 0.5f) * 3.0f, 0, 0};
+      DrawModel(*model, pos, 1.0f, WHITE);
+      DrawModelWires(*model, pos, 1.0f, DARKGRAY);
     }
 
     // Draw axis
@@ -157,20 +167,25 @@ struct HotloadViewer {
 
   void draw_imgui() {
     if (ImGui::Begin("GLB Hotload")) {
-      ImGui::Text("File: %s", glb_path.c_str());
-      ImGui::Text("Status: %s", model_loaded ? "Loaded" : "Not loaded");
-      if (model_loaded) {
-        ImGui::Text("Meshes: %d", model.meshCount);
-        ImGui::Text("Materials: %d", model.materialCount);
+      for (size_t i = 0; i < glb_paths.size(); i++) {
+        ImGui::Text("File: %s", glb_paths[i].c_str());
+        if (Model* model = ModelAPI::get(handles[i]))
+          ImGui::Text("  Meshes: %d | Materials: %d", model->meshCount, model->materialCount);
+        else
+          ImGui::Text("  Not loaded");
       }
-      ImGui::Text("Reload count: %d", reload_count);
+      ImGui::Text("Reload count: %d | In flight: %d", reload_count, (int)loader.pending());
+      ImGui::Text("Watcher: %s", watcher.polling ? "polling" : "inotify");
 
       ImGui::Separator();
       ImGui::Checkbox("Auto reload", &auto_reload);
-      ImGui::SliderFloat("Check interval", &check_interval, 0.1f, 2.0f, "%.1f s");
+      float debounce_ms = (float)watcher.debounce * 1000.0f;
+      if (ImGui::SliderFloat("Debounce", &debounce_ms, 0.0f, 1000.0f, "%.0f ms"))
+        watcher.debounce = debounce_ms / 1000.0f;
 
       if (ImGui::Button("Force Reload (R)")) {
-        try_load();
+        for (size_t i = 0; i < glb_paths.size(); i++)
+          try_load(i);
       }
 
       ImGui::Separator();
@@ -183,9 +198,8 @@ struct HotloadViewer {
   }
 
   void cleanup() {
-    if (model_loaded) {
-      UnloadModel(model);
-    }
+    loader.stop();
+    ModelAPI::unload_all();
   }
 };
 
@@ -198,7 +212,7 @@ int main(int argc, char* argv[]) {
   rlImGuiSetup(true);
 
   HotloadViewer viewer;
-  viewer.init(argc > 1 ? argv[1] : nullptr);
+  viewer.init(argc - 1, argv + 1);
 
   while (!WindowShouldClose()) {
     viewer.update();
@@ -215,9 +229,10 @@ int main(int argc, char* argv[]) {
     // Status bar
     DrawRectangle(0, screenHeight - 25, screenWidth, 25, {30, 30, 30, 255});
     const char* status =
-        viewer.model_loaded
-            ? TextFormat("Watching: %s | Reloads: %d", viewer.glb_path.c_str(), viewer.reload_count)
-            : TextFormat("Waiting for: %s", viewer.glb_path.c_str());
+        viewer.model_loaded()
+            ? TextFormat("Watching: %d file(s) | Reloads: %d", (int)viewer.glb_paths.size(),
+                         viewer.reload_count)
+            : TextFormat("Waiting for: %s", viewer.glb_paths[0].c_str());
     DrawText(status, 10, screenHeight - 20, 14, LIGHTGRAY);
 
     DrawFPS(screenWidth - 100, 10);
@@ -1,4 +1,6 @@
+#include "../../mylibs/asset_helpers.hpp"
 #include "../../mylibs/hexgrid_math.hpp"
+#include "../../mylibs/hexgrid_mesh.hpp"
 #include "imgui.h"
 #include "raylib.h"
 #include "rlImGui.h"
@@ -16,23 +18,103 @@ int main() {
   int gridRadius = 5;
   Vector2 origin = {screenWidth / 2.0f, screenHeight / 2.0f};
 
-  while (!WindowShouldClose()) {
-    Layout layout(layout_pointy, Point{hexSize, hexSize}, origin);
+  const Color fill = BLANK;
+  const Color highlight = ColorAlpha(YELLOW, 0.3f);
 
-    BeginDrawing();
-    ClearBackground(DARKGRAY);
+  // Layout and baked grid live across frames; the Layout caches its hex index,
+  // so both are rebuilt only when the size or radius changes
+  Layout layout(layout_pointy, Point{hexSize, hexSize}, origin);
+  layout.shape = GridShape::Hexagon;
+  HexGridMesh grid;
+  float builtSize = 0.0f;
+  int builtRadius = -1;
+  uint hoveredId = UINT_MAX;
+
+  // Textured view: every hex is a sprite from the shared atlas, drawn under the grid lines
+  AssetCache cache;
+  AssetPack pack; // ./embed_assets.sh builds it; file paths are used if missing
+  if (!cache.loader.pack && pack.open("build/assets.pack"))
+    cache.loader.pack = &pack;
+  cache.build_atlas();
+  Asset tiles[] = {Asset::make_tile(AssetId::GRASSLANDDENSE2_PNG),
+                   Asset::make_tile(AssetId::GRASSPATCH59_PNG)};
+  for (auto& tile : tiles)
+    cache.to_atlas(tile);
+  SpriteBatch sprites;
+  bool textured = false;
+  size_t textureSwitches = 0;
 
-    // Draw hex grid
-    auto hexes = grid_hexagon(gridRadius);
-    for (auto& h : hexes) {
-      draw_hex(layout, h, LIGHTGRAY);
+  // 3D view: the same grid as hex tiles (one hex = one world unit), drawn by HexTileBatch
+  cache.BeginRenderingContext();
+  HexTileBatch tileBatch;
+  bool tiles3D = false;
+  size_t tilesDrawn = 0;
+  Camera3D camera = {0};
+  camera.up = {0.0f, 1.0f, 0.0f};
+  camera.fovy = 45.0f;
+  camera.projection = CAMERA_PERSPECTIVE;
+
+  while (!WindowShouldClose()) {
+    if (hexSize != builtSize || gridRadius != builtRadius) {
+      layout.hex_size = Point{hexSize, hexSize};
+      layout.params = {gridRadius}; // new params: the next find() rebuilds the index once
+      grid.build(layout, fill, LIGHTGRAY, 1.0f);
+      builtSize = hexSize;
+      builtRadius = gridRadius;
+      hoveredId = UINT_MAX;
     }
 
-    // Highlight hex under mouse
+    // Highlight hex under mouse by patching the colour stream in place
     Point mouse = GetMousePosition();
+    if (tiles3D) {
+      camera.position = {0.0f, 2.5f * gridRadius + 4.0f, 1.5f * gridRadius + 3.0f};
+      camera.target = {0.0f, 0.0f, 0.0f};
+      // Pick on the ground plane, then map the world point back into layout pixels
+      Ray ray = GetScreenToWorldRay(mouse, camera);
+      float t = ray.direction.y != 0.0f ? -ray.position.y / ray.direction.y : -1.0f;
+      Vector3 ground = Vector3Add(ray.position, Vector3Scale(ray.direction, t));
+      mouse = t > 0.0f ? Point{origin.x + ground.x * hexSize, origin.y + ground.z * hexSize}
+                       : Point{-1e9f, -1e9f};
+    }
     FractionalHex fh = pixel_to_hex_fractional(layout, mouse);
-    Hex hovered((int)round(fh.q), (int)round(fh.r));
-    draw_hex_filled(layout, hovered, ColorAlpha(YELLOW, 0.3f));
+    Hex hovered = hex_round(fh);
+    uint id = layout.find(hovered);
+    if (id != hoveredId) {
+      grid.set_fill(hoveredId, fill);
+      grid.set_fill(id, highlight);
+      hoveredId = id;
+    }
+
+    BeginDrawing();
+    ClearBackground(DARKGRAY);
+
+    if (tiles3D) {
+      cache.BeginFrame();
+      for (Hex h : layout.index().hexes) {
+        Point c = hex_to_pixel(layout, h);
+        Vector3 pos = {(c.x - origin.x) / hexSize, 0.0f, (c.y - origin.y) / hexSize};
+        Asset tile = Asset::make_hex_tile(tiles[(h.q ^ h.r) & 1].id, pos);
+        tile.tint = h == hovered ? YELLOW : GREEN;
+        tileBatch.submit(cache, tile);
+      }
+      tilesDrawn = tileBatch.outlined.tiles + tileBatch.plain.tiles;
+      tileBatch.flush(cache, camera);
+      cache.EndFrame();
+    } else {
+      if (textured) {
+        Point hexBox = hex_bounding_size(layout);
+        // The whole shape, not Layout's n_hex-limited iteration
+        for (Hex h : layout.index().hexes) {
+          Point c = hex_to_pixel(layout, h);
+          sprites.add(cache, tiles[(h.q ^ h.r) & 1], c.x, c.y, {hexBox.x, hexBox.y});
+        }
+        sprites.sort();
+        textureSwitches = sprites.texture_switches();
+        sprites.flush();
+      }
+      // Draw hex grid (one draw call; flushes the sprites first, so they stay beneath it)
+      grid.draw();
+    }
 
     DrawText("Hexgrid Demo", 10, 10, 20, WHITE);
 
@@ -40,8 +122,16 @@ int main() {
     rlImGuiBegin();
     if (ImGui::Begin("Hex Settings")) {
       ImGui::Text("FPS: %d", GetFPS());
-      ImGui::SliderFloat("Hex Size", &hexSize, 10.0f, 60.0f);
-      ImGui::SliderInt("Grid Radius", &gridRadius, 1, 10);
+      ImGui::Text("Hexes: %u", grid.hex_count);
+      ImGui::SliderFloat("Hex Size", &hexSize, 2.0f, 60.0f);
+      ImGui::SliderInt("Grid Radius", &gridRadius, 1, 100);
+      ImGui::Checkbox("Textured", &textured);
+      ImGui::Checkbox("3D tiles", &tiles3D);
+      if (tiles3D)
+        ImGui::Text("Tiles: %zu", tilesDrawn);
+      else if (textured)
+        ImGui::Text("Texture switches: %zu (%zu atlas pages)", textureSwitches,
+                    cache.atlas_pages.size());
       ImGui::Text("Hovered: (%d, %d)", hovered.q, hovered.r);
     }
     ImGui::End();
@@ -50,6 +140,8 @@ int main() {
     EndDrawing();
   }
 
+  grid.unload();
+  cache.unload_all();
   rlImGuiShutdown();
   CloseWindow();
   return 0;
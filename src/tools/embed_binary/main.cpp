@@ -0,0 +1,90 @@
+/**
+ * embed_binary — build the asset pack
+ *
+ * Packs every AssetId from uid_assets.hpp (paths relative to the working
+ * directory) into one AssetPack file. With --decode, images are stored as
+ * decoded pixels so the runtime uploads them without a PNG decode; --cook
+ * goes further and stores them GPU-ready (mip chain, BC1/BC3, see
+ * texture_cook.hpp). Missing files are reported and left out, so one
+ * absent asset doesn't fail a build that packs the rest; the loader falls
+ * back to the file path for anything not in the pack.
+ *
+ * Usage:
+ *   embed_binary [--decode | --cook] <out.pack>
+ *
+ * See embed_assets.sh for the usual invocation.
+ */
+
+#include "../../mylibs/asset_pack.hpp"
+#include "../../mylibs/texture_cook.hpp"
+#include "../../mylibs/uid_assets.hpp"
+#include <cstdio>
+#include <cstring>
+#include <raylib.h>
+
+static bool is_image(const char* path) {
+  return IsFileExtension(path, ".png;.jpg;.jpeg;.bmp;.tga;.gif;.qoi");
+}
+
+int main(int argc, char* argv[]) {
+  bool decode = false;
+  bool cook = false;
+  const char* out = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--decode") == 0)
+      decode = true;
+    else if (strcmp(argv[i], "--cook") == 0)
+      decode = cook = true;
+    else
+      out = argv[i];
+  }
+  if (!out) {
+    fprintf(stderr, "usage: %s [--decode | --cook] <out.pack>\n", argv[0]);
+    return 1;
+  }
+
+  SetTraceLogLevel(LOG_WARNING);
+  AssetPackWriter writer;
+  int missing = 0;
+  for (AssetId id : ALL_ASSET_IDS) {
+    AssetInfo info = get_asset_info(id);
+    uint32_t key = (uint32_t)id;
+
+    if (decode && is_image(info.filepath)) {
+      Image img = LoadImage(info.filepath);
+      int source_width = img.width, source_height = img.height;
+      if (img.data && cook) {
+        Image cooked = TextureCook::cook(img);
+        UnloadImage(img);
+        img = cooked;
+      }
+      if (img.data) {
+        writer.add_image(key, img, source_width, source_height);
+        printf("  %-32s %dx%d pixels, %d mips\n", info.filepath, img.width, img.height,
+               img.mipmaps);
+        UnloadImage(img);
+        continue;
+      }
+    }
+
+    int size = 0;
+    unsigned char* data = LoadFileData(info.filepath, &size);
+    if (!data) {
+      fprintf(stderr, "  missing: %s (skipped)\n", info.filepath);
+      missing++;
+      continue;
+    }
+    printf("  %-32s %d bytes\n", info.filepath, size);
+    writer.add_raw(key, std::vector<uint8_t>(data, data + size));
+    UnloadFileData(data);
+  }
+
+  if (!writer.write(out)) {
+    fprintf(stderr, "failed to write %s\n", out);
+    return 1;
+  }
+  printf("Wrote %s (%zu assets)\n", out, writer.items.size());
+  if (missing)
+    fprintf(stderr, "warning: %d asset(s) missing, not packed\n", missing);
+  return 0;
+}
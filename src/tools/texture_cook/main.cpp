@@ -0,0 +1,165 @@
+/**
+ * texture_cook — write GPU-ready `.rtex` sidecars for images and models
+ *
+ * For every image (.png/.jpg/.bmp/.tga) and model (.glb/.gltf) under the
+ * given paths, writes `<file>.rtex` with a full mip chain, block-compressed
+ * unless --format rgba. Model textures are read back from a hidden window,
+ * one entry per material index. Up-to-date sidecars are skipped.
+ *
+ * Usage:
+ *   texture_cook [--format auto|bc1|bc3|rgba] [--no-mips] [--force] <file|dir>...
+ *
+ * e.g. texture_cook assets/glb_output_transformed assets
+ */
+
+#include "../../mylibs/asset_pack.hpp"
+#include "../../mylibs/texture_cook.hpp"
+#include <cstdio>
+#include <cstring>
+#include <dirent.h>
+#include <raylib.h>
+#include <rlgl.h>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+struct CookOptions {
+  TextureCook::Format format = TextureCook::Format::Auto;
+  bool mipmaps = true;
+  bool force = false;
+};
+
+static bool is_image(const char* path) {
+  return IsFileExtension(path, ".png;.jpg;.jpeg;.bmp;.tga");
+}
+static bool is_model(const char* path) { return IsFileExtension(path, ".glb;.gltf"); }
+
+static void collect(const std::string& path, std::vector<std::string>& out) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return;
+  if (!S_ISDIR(st.st_mode)) {
+    if (is_image(path.c_str()) || is_model(path.c_str()))
+      out.push_back(path);
+    return;
+  }
+  DIR* dir = opendir(path.c_str());
+  if (!dir)
+    return;
+  while (dirent* entry = readdir(dir)) {
+    if (entry->d_name[0] != '.')
+      collect(path + "/" + entry->d_name, out);
+  }
+  closedir(dir);
+}
+
+static bool up_to_date(const std::string& source) {
+  std::string cooked = TextureCook::cooked_path(source);
+  return FileExists(cooked.c_str()) &&
+         GetFileModTime(cooked.c_str()) >= GetFileModTime(source.c_str());
+}
+
+static const char* format_name(int format) {
+  switch (format) {
+    case PIXELFORMAT_COMPRESSED_DXT1_RGB:
+      return "BC1";
+    case PIXELFORMAT_COMPRESSED_DXT5_RGBA:
+      return "BC3";
+    default:
+      return "RGBA8";
+  }
+}
+
+static bool cook_image(const std::string& path, const CookOptions& opt) {
+  Image src = LoadImage(path.c_str());
+  if (!src.data)
+    return false;
+  Image cooked = TextureCook::cook(src, opt.format, opt.mipmaps);
+  UnloadImage(src);
+  if (!cooked.data)
+    return false;
+  AssetPackWriter writer;
+  writer.add_image(0, cooked, src.width, src.height);
+  printf("  %s: %dx%d %s (from %dx%d), %d mips\n", path.c_str(), cooked.width, cooked.height,
+         format_name(cooked.format), src.width, src.height, cooked.mipmaps);
+  UnloadImage(cooked);
+  return writer.write(TextureCook::cooked_path(path));
+}
+
+static bool cook_model(const std::string& path, const CookOptions& opt) {
+  Model model = LoadModel(path.c_str());
+  if (model.meshCount == 0)
+    return false;
+  AssetPackWriter writer;
+  for (int i = 0; i < model.materialCount; i++) {
+    Texture2D tex = model.materials[i].maps[MATERIAL_MAP_DIFFUSE].texture;
+    if (tex.id == 0 || tex.id == rlGetTextureIdDefault())
+      continue;
+    Image src = LoadImageFromTexture(tex);
+    Image cooked = TextureCook::cook(src, opt.format, opt.mipmaps);
+    UnloadImage(src);
+    if (!cooked.data)
+      continue;
+    writer.add_image((uint32_t)i, cooked, src.width, src.height);
+    UnloadImage(cooked);
+  }
+  UnloadModel(model);
+  printf("  %s: %zu material texture(s)\n", path.c_str(), writer.items.size());
+  return writer.items.empty() || writer.write(TextureCook::cooked_path(path));
+}
+
+int main(int argc, char* argv[]) {
+  CookOptions opt;
+  std::vector<std::string> files;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) {
+      const char* f = argv[++i];
+      opt.format = strcmp(f, "bc1") == 0    ? TextureCook::Format::Bc1
+                   : strcmp(f, "bc3") == 0  ? TextureCook::Format::Bc3
+                   : strcmp(f, "rgba") == 0 ? TextureCook::Format::Rgba
+                                            : TextureCook::Format::Auto;
+    } else if (strcmp(argv[i], "--no-mips") == 0) {
+      opt.mipmaps = false;
+    } else if (strcmp(argv[i], "--force") == 0) {
+      opt.force = true;
+    } else {
+      collect(argv[i], files);
+    }
+  }
+  if (files.empty()) {
+    fprintf(stderr, "usage: %s [--format auto|bc1|bc3|rgba] [--no-mips] [--force] <file|dir>...\n",
+            argv[0]);
+    return 1;
+  }
+
+  SetTraceLogLevel(LOG_WARNING);
+  bool window = false;
+  int cooked = 0, failed = 0;
+  for (const std::string& f : files) {
+    if (!opt.force && up_to_date(f))
+      continue;
+    bool ok;
+    if (is_model(f.c_str())) {
+      if (!window) {
+        // Model textures only exist on the GPU after LoadModel
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(64, 64, "texture_cook");
+        window = true;
+      }
+      ok = cook_model(f, opt);
+    } else {
+      ok = cook_image(f, opt);
+    }
+    if (ok) {
+      cooked++;
+    } else {
+      fprintf(stderr, "  failed: %s\n", f.c_str());
+      failed++;
+    }
+  }
+  if (window)
+    CloseWindow();
+  printf("Cooked %d file(s), %d failed, %zu up to date\n", cooked, failed,
+         files.size() - cooked - failed);
+  return failed ? 1 : 0;
+}